@@ -167,6 +167,7 @@ CALLIN_LIST = {
 
 	-- unsynced message callins
 	"RecvFromSynced",
+	"RecvFromSyncedQueued",
 	"RecvSkirmishAIMessage",
 
 	"DefaultCommand",
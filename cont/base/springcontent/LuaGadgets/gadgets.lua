@@ -909,6 +909,13 @@ function gadgetHandler:RecvFromSynced(...)
 end
 
 
+function gadgetHandler:RecvFromSyncedQueued(messages)
+  for _,g in r_ipairs(self.RecvFromSyncedQueuedList) do
+    g:RecvFromSyncedQueued(messages)
+  end
+end
+
+
 function gadgetHandler:GotChatMsg(msg, player)
   if ((player == 0) and Spring.IsCheatingEnabled()) then
     local sp = '^%s*'    -- start pattern
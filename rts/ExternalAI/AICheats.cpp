@@ -16,6 +16,7 @@
 #include "Net/GameServer.h"
 #include "Game/GameSetup.h"
 #include "System/SpringMath.h"
+#include "System/Threading/ThreadPool.h"
 
 #include <vector>
 
@@ -150,9 +151,9 @@ static inline bool unit_IsNeutral(CUnit* unit) {
 	return unit->IsNeutral();
 }
 
-static int myAllyTeamId = -1;
+static thread_local int myAllyTeamId = -1;
 
-/// You have to set myAllyTeamId before callign this function. NOT thread safe!
+/// You have to set myAllyTeamId (per thread) before calling this function.
 static inline bool unit_IsEnemy(CUnit* unit) {
 	return (!teamHandler.Ally(unit->allyteam, myAllyTeamId) && !unit_IsNeutral(unit));
 }
@@ -168,6 +169,7 @@ int CAICheats::GetEnemyUnits(int* unitIds, const float3& pos, float radius, bool
 		int unitIds_max)
 {
 	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = ThreadPool::GetThreadNum();
 	quadField.GetUnitsExact(qfQuery, pos, radius, spherical);
 	myAllyTeamId = teamHandler.AllyTeam(ai->GetTeamId());
 	return FilterUnitsVector(*qfQuery.units, unitIds, unitIds_max, &unit_IsEnemy);
@@ -182,6 +184,7 @@ int CAICheats::GetNeutralUnits(int* unitIds, const float3& pos, float radius, bo
 		int unitIds_max)
 {
 	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = ThreadPool::GetThreadNum();
 	quadField.GetUnitsExact(qfQuery, pos, radius, spherical);
 	return FilterUnitsVector(*qfQuery.units, unitIds, unitIds_max, &unit_IsNeutral);
 }
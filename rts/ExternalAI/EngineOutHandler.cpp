@@ -5,6 +5,7 @@
 #include "ExternalAI/SkirmishAIWrapper.h"
 #include "ExternalAI/SkirmishAIData.h"
 #include "ExternalAI/SkirmishAIHandler.h"
+#include "ExternalAI/SSkirmishAICallbackImpl.h"
 #include "ExternalAI/AILibraryManager.h"
 #include "ExternalAI/Interface/AISCommands.h"
 #include "Game/GlobalUnsynced.h"
@@ -19,9 +20,20 @@
 #include "Sim/Units/CommandAI/Command.h"
 #include "Sim/Weapons/WeaponDef.h"
 #include "Net/Protocol/NetProtocol.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
 #include "System/TimeProfiler.h"
 #include "System/SafeUtil.h"
+#include "System/Threading/ThreadPool.h"
+
+
+CONFIG(bool, ConcurrentSkirmishAIs).defaultValue(false).description(
+	"Update Skirmish AIs concurrently on worker threads at the start of each frame. "
+	"Events reach the AIs at that point (instead of while the frame is simulated), "
+	"so the state AIs see when handling e.g. UnitDestroyed differs. AI libraries "
+	"must tolerate several of their instances running at once, and can not call "
+	"LuaRules (those calls fail)."
+);
 
 
 CR_BIND(CEngineOutHandler, )
@@ -30,6 +42,13 @@ CR_REG_METADATA(CEngineOutHandler, (
 	CR_IGNORED(teamSkirmishAIs),
 	CR_IGNORED(activeSkirmishAIs),
 
+	CR_IGNORED(mainThreadCalls),
+	CR_IGNORED(mainThreadMutex),
+	CR_IGNORED(mainThreadCond),
+	CR_IGNORED(numUpdatingAIs),
+	CR_IGNORED(queueEvents),
+	CR_IGNORED(concurrentUpdate),
+
 	CR_POSTLOAD(PostLoad)
 ))
 
@@ -88,6 +107,18 @@ void CEngineOutHandler::Destroy() {
 	}
 
 
+void CEngineOutHandler::Init()
+{
+	activeSkirmishAIs.reserve(16);
+	mainThreadCalls.reserve(MAX_AIS);
+
+	numUpdatingAIs = 0;
+
+	queueEvents = configHandler->GetBool("ConcurrentSkirmishAIs");
+	concurrentUpdate = false;
+}
+
+
 void CEngineOutHandler::PostLoad()
 {
 	AI_SCOPED_TIMER();
@@ -127,7 +158,152 @@ void CEngineOutHandler::Save(std::ostream* s, const uint8_t skirmishAIId) {
 
 void CEngineOutHandler::Update() {
 	AI_SCOPED_TIMER();
-	DO_FOR_SKIRMISH_AIS(Update(gs->frameNum))
+
+	if (!queueEvents) {
+		DO_FOR_SKIRMISH_AIS(Update(gs->frameNum))
+		return;
+	}
+
+	#ifdef THREADPOOL
+	// cheats write to the sim directly, which AIs on other threads might be reading
+	const auto isCheating = [](uint8_t aiID) { return skirmishAiCallback_Cheats_isEnabled(aiID); };
+
+	if (activeSkirmishAIs.size() > 1 && ThreadPool::HasThreads() && std::none_of(activeSkirmishAIs.begin(), activeSkirmishAIs.end(), isCheating)) {
+		UpdateConcurrently();
+		return;
+	}
+	#endif
+
+	UpdateSerially(false);
+}
+
+void CEngineOutHandler::DeliverEvents() {
+	AI_SCOPED_TIMER();
+
+	if (!queueEvents)
+		return;
+
+	UpdateSerially(true);
+}
+
+
+void CEngineOutHandler::UpdateSerially(bool deliverOnly) {
+	// events raised while delivering are left for the next frame, as in UpdateConcurrently
+	for (uint8_t aiID: activeSkirmishAIs) {
+		hostSkirmishAIs[aiID].BatchEvents();
+	}
+
+	for (uint8_t aiID: activeSkirmishAIs) {
+		CSkirmishAIWrapper& ai = hostSkirmishAIs[aiID];
+
+		ai.DeliverEvents();
+
+		if (deliverOnly)
+			continue;
+
+		ai.Update(gs->frameNum);
+	}
+}
+
+void CEngineOutHandler::UpdateConcurrently() {
+	#ifdef THREADPOOL
+	const int frameNum = gs->frameNum;
+
+	std::vector< std::shared_ptr< std::future<void> > > aiTasks;
+	aiTasks.reserve(activeSkirmishAIs.size());
+
+	// the sim does not advance until every AI is done, so they all
+	// observe the same state; events raised by main-thread calls go
+	// into the (unbatched) queues and are delivered next frame
+	for (uint8_t aiID: activeSkirmishAIs) {
+		hostSkirmishAIs[aiID].BatchEvents();
+	}
+
+	numUpdatingAIs = activeSkirmishAIs.size();
+	concurrentUpdate = true;
+
+	for (uint8_t aiID: activeSkirmishAIs) {
+		CSkirmishAIWrapper* ai = &hostSkirmishAIs[aiID];
+
+		aiTasks.push_back(ThreadPool::Enqueue([this, ai, frameNum]() {
+			// count the AI as finished even if it throws, the main thread waits for all of them
+			struct FinishGuard {
+				~FinishGuard() {
+					std::lock_guard<spring::mutex> lock(owner.mainThreadMutex);
+					owner.numUpdatingAIs -= 1;
+					owner.mainThreadCond.notify_all();
+				}
+
+				CEngineOutHandler& owner;
+			} finishGuard = {*this};
+
+			ai->DeliverEvents();
+			ai->Update(frameNum);
+		}));
+	}
+
+	{
+		std::unique_lock<spring::mutex> lock(mainThreadMutex);
+
+		// serve calls from the AIs until all of them are done
+		while (true) {
+			mainThreadCond.wait(lock, [this]() { return (!mainThreadCalls.empty() || numUpdatingAIs == 0); });
+
+			if (mainThreadCalls.empty())
+				break;
+
+			MainThreadCall* call = mainThreadCalls.front();
+			mainThreadCalls.erase(mainThreadCalls.begin());
+
+			lock.unlock();
+			skirmishAIHandler.SetCurrentAIID(call->skirmishAIId);
+			(*call->func)();
+			skirmishAIHandler.SetCurrentAIID(MAX_AIS);
+			lock.lock();
+
+			call->done = true;
+			mainThreadCond.notify_all();
+		}
+	}
+
+	for (const auto& aiTask: aiTasks) {
+		aiTask->get();
+	}
+
+	concurrentUpdate = false;
+
+	// apply commands in AI order, independent of which AI finished first
+	for (uint8_t aiID: activeSkirmishAIs) {
+		hostSkirmishAIs[aiID].SendQueuedPackets();
+	}
+	#endif
+}
+
+
+void CEngineOutHandler::SendAIPacket(std::shared_ptr<const netcode::RawPacket> packet) {
+	const uint8_t aiID = skirmishAIHandler.GetCurrentAIID();
+
+	if (!concurrentUpdate || aiID >= MAX_AIS) {
+		clientNet->Send(packet);
+		return;
+	}
+
+	hostSkirmishAIs[aiID].QueuePacket(std::move(packet));
+}
+
+void CEngineOutHandler::RunOnMainThread(const std::function<void()>& func) {
+	if (!concurrentUpdate || ThreadPool::GetThreadNum() == 0) {
+		func();
+		return;
+	}
+
+	MainThreadCall call = {&func, skirmishAIHandler.GetCurrentAIID(), false};
+
+	std::unique_lock<spring::mutex> lock(mainThreadMutex);
+
+	mainThreadCalls.push_back(&call);
+	mainThreadCond.notify_all();
+	mainThreadCond.wait(lock, [&call]() { return call.done; });
 }
 
 
@@ -487,6 +663,10 @@ bool CEngineOutHandler::SendLuaMessages(int aiTeam, const char* inData, std::vec
 	if (activeSkirmishAIs.empty())
 		return false;
 
+	// reached from an AI's Lua call; the receivers might be running on other threads
+	if (concurrentUpdate)
+		return false;
+
 	unsigned int n = 0;
 
 	if (aiTeam != -1) {
@@ -537,6 +717,7 @@ void CEngineOutHandler::CreateSkirmishAI(const uint8_t skirmishAIId, bool savedG
 	}
 
 	aiInst.PreInit(skirmishAIId);
+	aiInst.SetQueueEvents(queueEvents);
 
 	teamSkirmishAIs[ aiInst.GetTeamId() ].push_back(skirmishAIId);
 	activeSkirmishAIs.push_back(skirmishAIId);
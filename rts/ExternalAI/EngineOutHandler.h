@@ -5,9 +5,12 @@
 
 #include "SkirmishAIWrapper.h"
 #include "System/Object.h"
+#include "System/Threading/SpringThreading.h"
 #include "Sim/Misc/GlobalConstants.h"
 
 #include <array>
+#include <functional>
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -31,7 +34,7 @@ public:
 	static void Create();
 	static void Destroy();
 
-	void Init() { activeSkirmishAIs.reserve(16); }
+	void Init();
 	void Kill() {
 		PreDestroy();
 
@@ -48,6 +51,26 @@ public:
 	void PreDestroy();
 
 	void Update();
+	/// hands queued events to the AIs without updating them, for frames that are skipped
+	void DeliverEvents();
+
+	/**
+	 * Sends a packet on behalf of the Skirmish AI executing on this thread.
+	 * During concurrent updates the packets are held back and sent in AI
+	 * order afterwards, so their order does not depend on thread timing.
+	 */
+	void SendAIPacket(std::shared_ptr<const netcode::RawPacket> packet);
+
+	/**
+	 * For callbacks that touch engine state which is not thread-safe:
+	 * while AIs are updated concurrently, func is executed by the main
+	 * thread on behalf of the calling AI, otherwise it runs right away.
+	 * The other AIs keep running meanwhile, so func must not change any
+	 * sim state they can read (synced Lua calls are rejected for this).
+	 */
+	void RunOnMainThread(const std::function<void()>& func);
+
+	bool IsUpdatingConcurrently() const { return concurrentUpdate; }
 
 	/** Group should return false if it doenst want the unit for some reason. */
 	bool UnitAddedToGroup(const CUnit& unit, const CGroup& group);
@@ -107,6 +130,16 @@ public:
 	void Save(std::ostream* s, const uint8_t skirmishAIId);
 
 private:
+	void UpdateConcurrently();
+	void UpdateSerially(bool deliverOnly);
+
+private:
+	struct MainThreadCall {
+		const std::function<void()>* func;
+		uint8_t skirmishAIId;
+		bool done;
+	};
+
 	/// Contains all local Skirmish AIs, indexed by their ID
 	std::array<CSkirmishAIWrapper, MAX_AIS > hostSkirmishAIs;
 
@@ -117,6 +150,19 @@ private:
 	std::array<std::vector<uint8_t>, MAX_TEAMS> teamSkirmishAIs;
 
 	std::vector<uint8_t> activeSkirmishAIs;
+
+	/// calls waiting for the main thread during a concurrent update
+	std::vector<MainThreadCall*> mainThreadCalls;
+
+	spring::mutex mainThreadMutex;
+	spring::condition_variable mainThreadCond;
+
+	int numUpdatingAIs = 0;
+
+	/// ConcurrentSkirmishAIs; events are queued and delivered in Update
+	bool queueEvents = false;
+	/// true while AIs run on pool workers
+	bool concurrentUpdate = false;
 };
 
 #define eoh CEngineOutHandler::GetInstance()
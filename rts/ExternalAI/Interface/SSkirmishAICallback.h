@@ -1645,6 +1645,13 @@ struct SSkirmishAICallback {
 	 */
 	void              (CALLING_CONV *Map_getResourceMapSpotsNearest)(int skirmishAIId, int resourceId, float* pos_posF3, float* return_posF3_out); //$ REF:resourceId->Resource
 
+	/**
+	 * Returns whether the evaluated list of resource extractor spots is available.
+	 * The spots are searched for in the background while the game loads; querying
+	 * them before this returns true blocks until the search is finished.
+	 */
+	bool              (CALLING_CONV *Map_isResourceMapSpotsReady)(int skirmishAIId, int resourceId); //$ REF:resourceId->Resource
+
 	/**
 	 * Returns the archive hash of the map.
 	 * Use this for reference to the map, eg. in a cache-file, wherever human
@@ -3,6 +3,7 @@
 #include "ExternalAI/AICallback.h"
 #include "ExternalAI/AICheats.h"
 #include "ExternalAI/AILibraryManager.h"
+#include "ExternalAI/EngineOutHandler.h"
 #include "ExternalAI/SSkirmishAICallbackImpl.h"
 #include "ExternalAI/SkirmishAILibraryInfo.h"
 #include "ExternalAI/SkirmishAIWrapper.h"
@@ -47,6 +48,7 @@
 #include "System/SpringMath.h"
 #include "System/FileSystem/ArchiveScanner.h"
 #include "System/Log/ILog.h"
+#include "System/Threading/ThreadPool.h"
 
 
 static std::array<std::pair<CAICallback, CAICheats>, MAX_AIS> AI_LEGACY_CALLBACKS;
@@ -638,9 +640,13 @@ EXPORT(int) skirmishAiCallback_Engine_executeCommand(
 	return ret;
 }
 
-EXPORT(int) skirmishAiCallback_Engine_handleCommand(
+static inline bool isUnitOrderTopic(int commandTopic) {
+	// custom orders can carry enough params to need the (shared) command-params pool
+	return ((commandTopic >= COMMAND_UNIT_BUILD && commandTopic < COMMAND_UNIT_CUSTOM) || commandTopic == COMMAND_UNIT_RECLAIM_FEATURE);
+}
+
+static int handleCommand(
 	int skirmishAIId,
-	int /*toId*/,
 	int commandId,
 	int commandTopic,
 	void* commandData
@@ -1164,6 +1170,35 @@ EXPORT(int) skirmishAiCallback_Engine_handleCommand(
 	return ret;
 }
 
+EXPORT(int) skirmishAiCallback_Engine_handleCommand(
+	int skirmishAIId,
+	int /*toId*/,
+	int commandId,
+	int commandTopic,
+	void* commandData
+) {
+	// unit orders only read the sim and send a packet, which is safe
+	// during concurrent AI updates; everything else might not be
+	if (!eoh->IsUpdatingConcurrently() || isUnitOrderTopic(commandTopic))
+		return handleCommand(skirmishAIId, commandId, commandTopic, commandData);
+
+	// synced LuaRules can change any state the other (still running) AIs
+	// are reading, so it is not reachable from concurrently updated AIs
+	if (commandTopic == COMMAND_CALL_LUA_RULES) {
+		SCallLuaRulesCommand* cmd = static_cast<SCallLuaRulesCommand*>(commandData);
+
+		if (cmd->ret_outData != nullptr)
+			cmd->ret_outData[0] = '\0';
+
+		eoh->RunOnMainThread([&]() { LOG_L(L_WARNING, "[%s] Skirmish AI %d can not call LuaRules while ConcurrentSkirmishAIs is enabled", "skirmishAiCallback_Engine_handleCommand", skirmishAIId); });
+		return -1;
+	}
+
+	int ret = 0;
+	eoh->RunOnMainThread([&]() { ret = handleCommand(skirmishAIId, commandId, commandTopic, commandData); });
+	return ret;
+}
+
 
 EXPORT(const char*) skirmishAiCallback_Engine_Version_getMajor(int skirmishAIId) {
 	return aiInterfaceCallback_Engine_Version_getMajor(-1);
@@ -1323,7 +1358,9 @@ EXPORT(void) skirmishAiCallback_Log_log(int skirmishAIId, const char* const msg)
 	const CSkirmishAILibraryInfo* info = getSkirmishAILibraryInfo(skirmishAIId);
 	const std::string& aiName = info->GetName();
 	const std::string& aiVersion = info->GetVersion();
-	LOG("Skirmish AI <%s-%s>: %s", aiName.c_str(), aiVersion.c_str(), msg);
+
+	// log sinks are not thread-safe
+	eoh->RunOnMainThread([&]() { LOG("Skirmish AI <%s-%s>: %s", aiName.c_str(), aiVersion.c_str(), msg); });
 }
 
 EXPORT(void) skirmishAiCallback_Log_exception(int skirmishAIId, const char* const msg, int severity, bool die) {
@@ -1334,12 +1371,14 @@ EXPORT(void) skirmishAiCallback_Log_exception(int skirmishAIId, const char* cons
 	const char* aiVersion = (info->GetVersion()).c_str();
 	const char* status = die? "AI shutting down" : "AI still running";
 
-	LOG_L(L_ERROR, "Skirmish AI <%s-%s>: severity %i: [%s] %s", aiName, aiVersion, severity, status, msg);
+	eoh->RunOnMainThread([&]() {
+		LOG_L(L_ERROR, "Skirmish AI <%s-%s>: severity %i: [%s] %s", aiName, aiVersion, severity, status, msg);
 
-	if (!die)
-		return;
+		if (!die)
+			return;
 
-	skirmishAIHandler.SetLocalKillFlag(skirmishAIId, 4 /* = AI crashed */);
+		skirmishAIHandler.SetLocalKillFlag(skirmishAIId, 4 /* = AI crashed */);
+	});
 }
 
 EXPORT(char) skirmishAiCallback_DataDirs_getPathSeparator(int UNUSED_skirmishAIId) {
@@ -1395,13 +1434,8 @@ EXPORT(bool) skirmishAiCallback_DataDirs_locatePath(
 EXPORT(const char*) skirmishAiCallback_DataDirs_getWriteableDir(int skirmishAIId) {
 	CheckSkirmishAIId(skirmishAIId, __func__);
 
-	static std::vector<std::string> writeableDataDirs;
-
-	// fill up writeableDataDirs until teamId index is in there
-	// if it is not yet
-	for (size_t wdd = writeableDataDirs.size(); wdd <= (size_t)skirmishAIId; ++wdd) {
-		writeableDataDirs.emplace_back("");
-	}
+	// one slot per AI, instances running concurrently do not share any
+	static std::array<std::string, MAX_AIS> writeableDataDirs;
 
 	if (writeableDataDirs[skirmishAIId].empty()) {
 		char tmpRes[1024];
@@ -1430,7 +1464,7 @@ EXPORT(bool) skirmishAiCallback_Cheats_isEnabled(int skirmishAIId) {
 EXPORT(bool) skirmishAiCallback_Cheats_setEnabled(int skirmishAIId, bool enabled)
 {
 	if ((AI_CHEAT_FLAGS[skirmishAIId].first = enabled) && !AI_CHEAT_FLAGS[skirmishAIId].second) {
-		LOG("[%s] SkirmishAI (id %i, team %i) is using cheats!", __func__, skirmishAIId, AI_TEAM_IDS[skirmishAIId]);
+		eoh->RunOnMainThread([&]() { LOG("[%s] SkirmishAI (id %i, team %i) is using cheats!", "skirmishAiCallback_Cheats_setEnabled", skirmishAIId, AI_TEAM_IDS[skirmishAIId]); });
 		AI_CHEAT_FLAGS[skirmishAIId].second = true;
 	}
 
@@ -2047,6 +2081,10 @@ EXPORT(void) skirmishAiCallback_Map_getResourceMapSpotsNearest(
 	getResourceMapAnalyzer(resourceId)->GetNearestSpot(pos_posF3, AI_TEAM_IDS[skirmishAIId]).copyInto(return_posF3_out);
 }
 
+EXPORT(bool) skirmishAiCallback_Map_isResourceMapSpotsReady(int skirmishAIId, int resourceId) {
+	return resourceHandler->IsResourceMapAnalyzed(resourceId);
+}
+
 EXPORT(int) skirmishAiCallback_Map_getHash(int skirmishAIId) {
 	return archiveScanner->GetArchiveCompleteChecksum(mapInfo->map.name);
 }
@@ -2175,7 +2213,10 @@ EXPORT(int) skirmishAiCallback_Map_getSpeedModMap(
 
 
 EXPORT(bool) skirmishAiCallback_Map_isPossibleToBuildAt(int skirmishAIId, int unitDefId, float* pos_posF3, int facing) {
-	return GetCallBack(skirmishAIId)->CanBuildAt(getUnitDefById(skirmishAIId, unitDefId), pos_posF3, facing);
+	// CGameHelper's build-square tests share static tables
+	bool ret = false;
+	eoh->RunOnMainThread([&]() { ret = GetCallBack(skirmishAIId)->CanBuildAt(getUnitDefById(skirmishAIId, unitDefId), pos_posF3, facing); });
+	return ret;
 }
 
 EXPORT(void) skirmishAiCallback_Map_findClosestBuildSite(
@@ -2188,7 +2229,9 @@ EXPORT(void) skirmishAiCallback_Map_findClosestBuildSite(
 	float* return_posF3_out
 ) {
 	const UnitDef* unitDef = getUnitDefById(skirmishAIId, unitDefId);
-	const float3 buildPos = GetCallBack(skirmishAIId)->ClosestBuildSite(unitDef, pos_posF3, searchRadius, minDist, facing);
+
+	float3 buildPos;
+	eoh->RunOnMainThread([&]() { buildPos = GetCallBack(skirmishAIId)->ClosestBuildSite(unitDef, pos_posF3, searchRadius, minDist, facing); });
 
 	buildPos.copyInto(return_posF3_out);
 }
@@ -4191,6 +4234,7 @@ EXPORT(int) skirmishAiCallback_getFeaturesIn(int skirmishAIId, float* pos_posF3,
 	if (skirmishAiCallback_Cheats_isEnabled(skirmishAIId)) {
 		// cheating
 		QuadFieldQuery qfQuery;
+		qfQuery.threadOwner = ThreadPool::GetThreadNum();
 		quadField.GetFeaturesExact(qfQuery, pos_posF3, radius, spherical);
 		const int featureIdsRealSize = qfQuery.features->size();
 
@@ -5448,6 +5492,7 @@ static void skirmishAiCallback_init(SSkirmishAICallback* callback) {
 	callback->Map_getResourceMapSpotsPositions = &skirmishAiCallback_Map_getResourceMapSpotsPositions;
 	callback->Map_getResourceMapSpotsAverageIncome = &skirmishAiCallback_Map_getResourceMapSpotsAverageIncome;
 	callback->Map_getResourceMapSpotsNearest = &skirmishAiCallback_Map_getResourceMapSpotsNearest;
+	callback->Map_isResourceMapSpotsReady = &skirmishAiCallback_Map_isResourceMapSpotsReady;
 	callback->Map_getHash = &skirmishAiCallback_Map_getHash;
 	callback->Map_getName = &skirmishAiCallback_Map_getName;
 	callback->Map_getHumanName = &skirmishAiCallback_Map_getHumanName;
@@ -878,6 +878,8 @@ EXPORT(int              ) skirmishAiCallback_Map_getResourceMapSpotsPositions(in
 
 EXPORT(float            ) skirmishAiCallback_Map_initResourceMapSpotsNearest(int skirmishAIId, int resourceId, float* pos_posF3, float* return_posF3_out);
 
+EXPORT(bool             ) skirmishAiCallback_Map_isResourceMapSpotsReady(int skirmishAIId, int resourceId);
+
 EXPORT(int              ) skirmishAiCallback_Map_getHash(int skirmishAIId);
 
 EXPORT(const char*      ) skirmishAiCallback_Map_getName(int skirmishAIId);
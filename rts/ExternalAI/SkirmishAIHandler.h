@@ -172,7 +172,7 @@ public:
 
 	const spring::unordered_set<std::string>& GetLuaAIImplShortNames() const { return luaAIShortNames; }
 
-	uint8_t GetCurrentAIID() { return currentAIId; }
+	uint8_t GetCurrentAIID() const { return currentAIId; }
 	void SetCurrentAIID(uint8_t id) { currentAIId = id; }
 
 private:
@@ -200,8 +200,8 @@ private:
 	spring::unordered_map<uint8_t, const SkirmishAIData*> skirmishAIDataMap;
 	spring::unordered_set<std::string> luaAIShortNames;
 
-	// the current local AI ID that is executing, MAX_AIS if none (e.g. LuaUI)
-	uint8_t currentAIId = MAX_AIS;
+	// the current local AI ID that is executing on this thread, MAX_AIS if none (e.g. LuaUI)
+	static thread_local uint8_t currentAIId;
 	uint8_t numSkirmishAIs = 0;
 
 	bool gameInitialized = false;
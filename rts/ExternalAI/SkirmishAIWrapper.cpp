@@ -17,6 +17,8 @@
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Misc/TeamHandler.h"
 
+#include "Net/Protocol/NetProtocol.h"
+
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
@@ -24,6 +26,7 @@
 #include "System/Platform/SharedLib.h"
 #include "System/TimeProfiler.h"
 #include "System/StringUtil.h"
+#include "System/Threading/ThreadPool.h"
 
 #include <string>
 #include <sstream>
@@ -52,6 +55,12 @@ CR_REG_METADATA(CSkirmishAIWrapper, (
 	CR_MEMBER(cheatEvents),
 	CR_MEMBER(blockEvents),
 
+	// set by CEngineOutHandler on creation
+	CR_IGNORED(queueEvents),
+	CR_IGNORED(eventQueue),
+	CR_IGNORED(eventBatch),
+	CR_IGNORED(queuedPackets),
+
 	CR_SERIALIZER(Serialize),
 	CR_POSTLOAD(PostLoad)
 ))
@@ -74,6 +83,11 @@ void CSkirmishAIWrapper::PreInit(int aiID)
 
 		cheatEvents = false;
 		blockEvents = false;
+		queueEvents = false;
+
+		eventQueue.clear();
+		eventBatch.clear();
+		queuedPackets.clear();
 	}
 	{
 		const std::string& kn = key.GetShortName();
@@ -166,6 +180,12 @@ void CSkirmishAIWrapper::Kill()
 		library = nullptr;
 		callback = nullptr;
 	}
+	{
+		// nothing queued can reach the AI anymore
+		eventQueue.clear();
+		eventBatch.clear();
+		queuedPackets.clear();
+	}
 	{
 		// mark as inactive for EngineOutHandler::{Load,Save}; AI data
 		// remains present in SkirmishAIHandler until RemoveSkirmishAI
@@ -304,25 +324,10 @@ void CSkirmishAIWrapper::Save(std::ostream* saveStream)
 
 
 
-void CSkirmishAIWrapper::UnitIdle(int unitId) {
-	const SUnitIdleEvent evtData = {unitId};
-	HandleEvent(EVENT_UNIT_IDLE, &evtData);
-}
-
-void CSkirmishAIWrapper::UnitCreated(int unitId, int builderId) {
-	const SUnitCreatedEvent evtData = {unitId, builderId};
-	HandleEvent(EVENT_UNIT_CREATED, &evtData);
-}
-
-void CSkirmishAIWrapper::UnitFinished(int unitId) {
-	const SUnitFinishedEvent evtData = {unitId};
-	HandleEvent(EVENT_UNIT_FINISHED, &evtData);
-}
-
-void CSkirmishAIWrapper::UnitDestroyed(int unitId, int attackerUnitId) {
-	const SUnitDestroyedEvent evtData = {unitId, attackerUnitId};
-	HandleEvent(EVENT_UNIT_DESTROYED, &evtData);
-}
+void CSkirmishAIWrapper::UnitIdle(int unitId) { PushEvent({EVENT_UNIT_IDLE, unitId}); }
+void CSkirmishAIWrapper::UnitCreated(int unitId, int builderId) { PushEvent({EVENT_UNIT_CREATED, unitId, builderId}); }
+void CSkirmishAIWrapper::UnitFinished(int unitId) { PushEvent({EVENT_UNIT_FINISHED, unitId}); }
+void CSkirmishAIWrapper::UnitDestroyed(int unitId, int attackerUnitId) { PushEvent({EVENT_UNIT_DESTROYED, unitId, attackerUnitId}); }
 
 void CSkirmishAIWrapper::UnitDamaged(
 	int unitId,
@@ -332,62 +337,21 @@ void CSkirmishAIWrapper::UnitDamaged(
 	int weaponDefId,
 	bool paralyzer
 ) {
-	float3 cpyDir = dir;
-	const SUnitDamagedEvent evtData = {unitId, attackerUnitId, damage, &cpyDir[0], weaponDefId, paralyzer};
-
-	HandleEvent(EVENT_UNIT_DAMAGED, &evtData);
+	PushEvent({EVENT_UNIT_DAMAGED, unitId, attackerUnitId, weaponDefId, damage, paralyzer, dir});
 }
 
-void CSkirmishAIWrapper::UnitMoveFailed(int unitId) {
-	const SUnitMoveFailedEvent evtData = {unitId};
-	HandleEvent(EVENT_UNIT_MOVE_FAILED, &evtData);
-}
+void CSkirmishAIWrapper::UnitMoveFailed(int unitId) { PushEvent({EVENT_UNIT_MOVE_FAILED, unitId}); }
+void CSkirmishAIWrapper::UnitGiven(int unitId, int oldTeam, int newTeam) { PushEvent({EVENT_UNIT_GIVEN, unitId, oldTeam, newTeam}); }
+void CSkirmishAIWrapper::UnitCaptured(int unitId, int oldTeam, int newTeam) { PushEvent({EVENT_UNIT_CAPTURED, unitId, oldTeam, newTeam}); }
 
-void CSkirmishAIWrapper::UnitGiven(int unitId, int oldTeam, int newTeam) {
-	const SUnitGivenEvent evtData = {unitId, oldTeam, newTeam};
-	HandleEvent(EVENT_UNIT_GIVEN, &evtData);
-}
 
-void CSkirmishAIWrapper::UnitCaptured(int unitId, int oldTeam, int newTeam) {
-	const SUnitCapturedEvent evtData = {unitId, oldTeam, newTeam};
-	HandleEvent(EVENT_UNIT_CAPTURED, &evtData);
-}
-
-
-void CSkirmishAIWrapper::EnemyCreated(int unitId) {
-	const SEnemyCreatedEvent evtData = {unitId};
-	HandleEvent(EVENT_ENEMY_CREATED, &evtData);
-}
-
-void CSkirmishAIWrapper::EnemyFinished(int unitId) {
-	const SEnemyFinishedEvent evtData = {unitId};
-	HandleEvent(EVENT_ENEMY_FINISHED, &evtData);
-}
-
-void CSkirmishAIWrapper::EnemyEnterLOS(int unitId) {
-	const SEnemyEnterLOSEvent evtData = {unitId};
-	HandleEvent(EVENT_ENEMY_ENTER_LOS, &evtData);
-}
-
-void CSkirmishAIWrapper::EnemyLeaveLOS(int unitId) {
-	const SEnemyLeaveLOSEvent evtData = {unitId};
-	HandleEvent(EVENT_ENEMY_LEAVE_LOS, &evtData);
-}
-
-void CSkirmishAIWrapper::EnemyEnterRadar(int unitId) {
-	const SEnemyEnterRadarEvent evtData = {unitId};
-	HandleEvent(EVENT_ENEMY_ENTER_RADAR, &evtData);
-}
-
-void CSkirmishAIWrapper::EnemyLeaveRadar(int unitId) {
-	const SEnemyLeaveRadarEvent evtData = {unitId};
-	HandleEvent(EVENT_ENEMY_LEAVE_RADAR, &evtData);
-}
-
-void CSkirmishAIWrapper::EnemyDestroyed(int enemyUnitId, int attackerUnitId) {
-	const SEnemyDestroyedEvent evtData = {enemyUnitId, attackerUnitId};
-	HandleEvent(EVENT_ENEMY_DESTROYED, &evtData);
-}
+void CSkirmishAIWrapper::EnemyCreated(int unitId) { PushEvent({EVENT_ENEMY_CREATED, unitId}); }
+void CSkirmishAIWrapper::EnemyFinished(int unitId) { PushEvent({EVENT_ENEMY_FINISHED, unitId}); }
+void CSkirmishAIWrapper::EnemyEnterLOS(int unitId) { PushEvent({EVENT_ENEMY_ENTER_LOS, unitId}); }
+void CSkirmishAIWrapper::EnemyLeaveLOS(int unitId) { PushEvent({EVENT_ENEMY_LEAVE_LOS, unitId}); }
+void CSkirmishAIWrapper::EnemyEnterRadar(int unitId) { PushEvent({EVENT_ENEMY_ENTER_RADAR, unitId}); }
+void CSkirmishAIWrapper::EnemyLeaveRadar(int unitId) { PushEvent({EVENT_ENEMY_LEAVE_RADAR, unitId}); }
+void CSkirmishAIWrapper::EnemyDestroyed(int enemyUnitId, int attackerUnitId) { PushEvent({EVENT_ENEMY_DESTROYED, enemyUnitId, attackerUnitId}); }
 
 void CSkirmishAIWrapper::EnemyDamaged(
 	int enemyUnitId,
@@ -397,49 +361,40 @@ void CSkirmishAIWrapper::EnemyDamaged(
 	int weaponDefId,
 	bool paralyzer
 ) {
-	float3 cpyDir = dir;
-	const SEnemyDamagedEvent evtData = {enemyUnitId, attackerUnitId, damage, &cpyDir[0], weaponDefId, paralyzer};
-
-	HandleEvent(EVENT_ENEMY_DAMAGED, &evtData);
+	PushEvent({EVENT_ENEMY_DAMAGED, enemyUnitId, attackerUnitId, weaponDefId, damage, paralyzer, dir});
 }
 
 void CSkirmishAIWrapper::Update(int frame) {
+	// never queued, this is the point at which queued events are handed out
 	const SUpdateEvent evtData = {frame};
 	HandleEvent(EVENT_UPDATE, &evtData);
 }
 
 void CSkirmishAIWrapper::SendChatMessage(const char* msg, int fromPlayerId) {
-	const SMessageEvent evtData = {fromPlayerId, msg};
-	HandleEvent(EVENT_MESSAGE, &evtData);
+	QueuedEvent event = {EVENT_MESSAGE, -1, fromPlayerId};
+	event.msg = msg;
+	PushEvent(std::move(event));
 }
 
 void CSkirmishAIWrapper::SendLuaMessage(const char* inData, const char** outData) {
+	// synchronous, the caller waits for outData
 	const SLuaMessageEvent evtData = {inData /*outData*/};
 	HandleEvent(EVENT_LUA_MESSAGE, &evtData);
 }
 
-void CSkirmishAIWrapper::WeaponFired(int unitId, int weaponDefId) {
-	const SWeaponFiredEvent evtData = {unitId, weaponDefId};
-	HandleEvent(EVENT_WEAPON_FIRED, &evtData);
-}
+void CSkirmishAIWrapper::WeaponFired(int unitId, int weaponDefId) { PushEvent({EVENT_WEAPON_FIRED, unitId, weaponDefId}); }
 
 void CSkirmishAIWrapper::PlayerCommandGiven(
 	const std::vector<int>& playerSelectedUnits,
 	const Command& c,
 	int playerId
 ) {
-	std::vector<int> unitIds = playerSelectedUnits;
-
-	const int cCommandId = extractAICommandTopic(&c, unitHandler.MaxUnits());
-	const SPlayerCommandEvent evtData = {&unitIds[0], static_cast<int>(playerSelectedUnits.size()), cCommandId, playerId};
-
-	HandleEvent(EVENT_PLAYER_COMMAND, &evtData);
+	QueuedEvent event = {EVENT_PLAYER_COMMAND, -1, extractAICommandTopic(&c, unitHandler.MaxUnits()), playerId};
+	event.unitIds = playerSelectedUnits;
+	PushEvent(std::move(event));
 }
 
-void CSkirmishAIWrapper::CommandFinished(int unitId, int commandId, int commandTopicId) {
-	const SCommandFinishedEvent evtData = {unitId, commandId, commandTopicId};
-	HandleEvent(EVENT_COMMAND_FINISHED, &evtData);
-}
+void CSkirmishAIWrapper::CommandFinished(int unitId, int commandId, int commandTopicId) { PushEvent({EVENT_COMMAND_FINISHED, unitId, commandId, commandTopicId}); }
 
 void CSkirmishAIWrapper::SeismicPing(
 	int allyTeam,
@@ -447,20 +402,153 @@ void CSkirmishAIWrapper::SeismicPing(
 	const float3& pos,
 	float strength
 ) {
-	/*const*/ float3 cpyPos = pos;
-	const SSeismicPingEvent evtData = {&cpyPos[0], strength};
+	PushEvent({EVENT_SEISMIC_PING, unitId, allyTeam, -1, strength, false, pos});
+}
+
+
+
+void CSkirmishAIWrapper::PushEvent(QueuedEvent&& event)
+{
+	if (!queueEvents) {
+		SendEvent(event);
+		return;
+	}
+
+	eventQueue.push_back(std::move(event));
+}
+
+void CSkirmishAIWrapper::DeliverEvents()
+{
+	for (const QueuedEvent& event: eventBatch) {
+		SendEvent(event);
+	}
 
-	HandleEvent(EVENT_SEISMIC_PING, &evtData);
+	eventBatch.clear();
+}
+
+void CSkirmishAIWrapper::SendQueuedPackets()
+{
+	for (const auto& packet: queuedPackets) {
+		clientNet->Send(packet);
+	}
+
+	queuedPackets.clear();
+}
+
+void CSkirmishAIWrapper::SendEvent(const QueuedEvent& event) const
+{
+	// copies; the interface takes non-const pointers
+	float3 vec = event.vec;
+	std::vector<int> unitIds = event.unitIds;
+
+	switch (event.topic) {
+		case EVENT_UNIT_IDLE: {
+			const SUnitIdleEvent evtData = {event.unitId};
+			HandleEvent(event.topic, &evtData);
+		} break;
+		case EVENT_UNIT_CREATED: {
+			const SUnitCreatedEvent evtData = {event.unitId, event.argA};
+			HandleEvent(event.topic, &evtData);
+		} break;
+		case EVENT_UNIT_FINISHED: {
+			const SUnitFinishedEvent evtData = {event.unitId};
+			HandleEvent(event.topic, &evtData);
+		} break;
+		case EVENT_UNIT_DESTROYED: {
+			const SUnitDestroyedEvent evtData = {event.unitId, event.argA};
+			HandleEvent(event.topic, &evtData);
+		} break;
+		case EVENT_UNIT_DAMAGED: {
+			const SUnitDamagedEvent evtData = {event.unitId, event.argA, event.value, &vec[0], event.argB, event.paralyzer};
+			HandleEvent(event.topic, &evtData);
+		} break;
+		case EVENT_UNIT_MOVE_FAILED: {
+			const SUnitMoveFailedEvent evtData = {event.unitId};
+			HandleEvent(event.topic, &evtData);
+		} break;
+		case EVENT_UNIT_GIVEN: {
+			const SUnitGivenEvent evtData = {event.unitId, event.argA, event.argB};
+			HandleEvent(event.topic, &evtData);
+		} break;
+		case EVENT_UNIT_CAPTURED: {
+			const SUnitCapturedEvent evtData = {event.unitId, event.argA, event.argB};
+			HandleEvent(event.topic, &evtData);
+		} break;
+
+		case EVENT_ENEMY_CREATED: {
+			const SEnemyCreatedEvent evtData = {event.unitId};
+			HandleEvent(event.topic, &evtData);
+		} break;
+		case EVENT_ENEMY_FINISHED: {
+			const SEnemyFinishedEvent evtData = {event.unitId};
+			HandleEvent(event.topic, &evtData);
+		} break;
+		case EVENT_ENEMY_ENTER_LOS: {
+			const SEnemyEnterLOSEvent evtData = {event.unitId};
+			HandleEvent(event.topic, &evtData);
+		} break;
+		case EVENT_ENEMY_LEAVE_LOS: {
+			const SEnemyLeaveLOSEvent evtData = {event.unitId};
+			HandleEvent(event.topic, &evtData);
+		} break;
+		case EVENT_ENEMY_ENTER_RADAR: {
+			const SEnemyEnterRadarEvent evtData = {event.unitId};
+			HandleEvent(event.topic, &evtData);
+		} break;
+		case EVENT_ENEMY_LEAVE_RADAR: {
+			const SEnemyLeaveRadarEvent evtData = {event.unitId};
+			HandleEvent(event.topic, &evtData);
+		} break;
+		case EVENT_ENEMY_DESTROYED: {
+			const SEnemyDestroyedEvent evtData = {event.unitId, event.argA};
+			HandleEvent(event.topic, &evtData);
+		} break;
+		case EVENT_ENEMY_DAMAGED: {
+			const SEnemyDamagedEvent evtData = {event.unitId, event.argA, event.value, &vec[0], event.argB, event.paralyzer};
+			HandleEvent(event.topic, &evtData);
+		} break;
+
+		case EVENT_MESSAGE: {
+			const SMessageEvent evtData = {event.argA, event.msg.c_str()};
+			HandleEvent(event.topic, &evtData);
+		} break;
+		case EVENT_WEAPON_FIRED: {
+			const SWeaponFiredEvent evtData = {event.unitId, event.argA};
+			HandleEvent(event.topic, &evtData);
+		} break;
+		case EVENT_PLAYER_COMMAND: {
+			const SPlayerCommandEvent evtData = {unitIds.data(), static_cast<int>(unitIds.size()), event.argA, event.argB};
+			HandleEvent(event.topic, &evtData);
+		} break;
+		case EVENT_COMMAND_FINISHED: {
+			const SCommandFinishedEvent evtData = {event.unitId, event.argA, event.argB};
+			HandleEvent(event.topic, &evtData);
+		} break;
+		case EVENT_SEISMIC_PING: {
+			const SSeismicPingEvent evtData = {&vec[0], event.value};
+			HandleEvent(event.topic, &evtData);
+		} break;
+
+		default: {
+			assert(false);
+		} break;
+	}
 }
 
 
 int CSkirmishAIWrapper::HandleEvent(int topic, const void* data) const {
-	ScopedTimer timer(GetTimerNameHash());
+	if (blockEvents && (topic != EVENT_RELEASE)) {
+		// to prevent log error spam, signal: OK
+		return 0;
+	}
 
-	if (!blockEvents || (topic == EVENT_RELEASE))
+	// concurrent updates run on pool workers, which can not use ScopedTimer
+	if (ThreadPool::GetThreadNum() != 0) {
+		ScopedMtTimer timer(GetTimerNameHash());
 		return library->HandleEvent(skirmishAIId, topic, data);
+	}
 
-	// to prevent log error spam, signal: OK
-	return 0;
+	ScopedTimer timer(GetTimerNameHash());
+	return library->HandleEvent(skirmishAIId, topic, data);
 }
 
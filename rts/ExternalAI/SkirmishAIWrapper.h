@@ -4,12 +4,20 @@
 #define SKIRMISH_AI_WRAPPER_H
 
 #include "SkirmishAIKey.h"
+#include "System/float3.h"
+
+#include <memory>
+#include <string>
+#include <vector>
 
 class CSkirmishAILibrary;
 struct SSkirmishAICallback;
 
 struct Command;
-class float3;
+
+namespace netcode {
+	class RawPacket;
+}
 
 
 /**
@@ -99,7 +107,42 @@ public:
 
 	bool IsLoadSupported() const;
 
+	/**
+	 * While enabled, events are stored in order instead of being sent to
+	 * the AI right away, and only reach it through DeliverEvents. This is
+	 * what allows updating several AIs concurrently at a fixed point in
+	 * the frame.
+	 */
+	void SetQueueEvents(bool enable) { queueEvents = enable; }
+	/// hands the events queued so far to the next DeliverEvents call
+	void BatchEvents() { std::swap(eventQueue, eventBatch); }
+	void DeliverEvents();
+
+	/// packets sent by the AI during a concurrent update, see CEngineOutHandler
+	void QueuePacket(std::shared_ptr<const netcode::RawPacket> packet) { queuedPackets.push_back(std::move(packet)); }
+	void SendQueuedPackets();
+
 private:
+	struct QueuedEvent {
+		int topic;
+
+		// the meaning of the arguments depends on the topic, see SendEvent
+		int unitId = -1;
+		int argA = -1;
+		int argB = -1;
+
+		float value = 0.0f;
+		bool paralyzer = false;
+
+		float3 vec;
+
+		std::string msg;
+		std::vector<int> unitIds;
+	};
+
+	void PushEvent(QueuedEvent&& event);
+	void SendEvent(const QueuedEvent& event) const;
+
 	bool InitLibrary();
 	void CreateCallback();
 
@@ -134,6 +177,12 @@ private:
 	bool libraryInit = false; // CSkirmishAILibrary::Init retval
 	bool cheatEvents = false;
 	bool blockEvents = false;
+	bool queueEvents = false;
+
+	std::vector<QueuedEvent> eventQueue;
+	std::vector<QueuedEvent> eventBatch;
+
+	std::vector< std::shared_ptr<const netcode::RawPacket> > queuedPackets;
 };
 
 #endif // SKIRMISH_AI_WRAPPER_H
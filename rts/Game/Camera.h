@@ -163,6 +163,7 @@ public:
 	const float3& GetFrustumVert (unsigned int i) const { return frustum.verts [i]; }
 	const float3& GetFrustumPlane(unsigned int i) const { return frustum.planes[i]; }
 	const float3& GetFrustumEdge (unsigned int i) const { return frustum.edges [i]; }
+	const Frustum& GetFrustum() const { return frustum; }
 
 	void LoadMatrices() const;
 	void LoadViewport() const;
@@ -63,9 +63,11 @@
 #include "Map/ReadMap.h"
 #include "Net/GameServer.h"
 #include "Net/Protocol/NetProtocol.h"
+#include "Sim/Features/Feature.h"
 #include "Sim/Features/FeatureDef.h"
 #include "Sim/Features/FeatureDefHandler.h"
 #include "Sim/Features/FeatureHandler.h"
+#include "Sim/Features/FeatureMemPool.h"
 #include "Sim/Misc/CategoryHandler.h"
 #include "Sim/Misc/DamageArrayHandler.h"
 #include "Sim/Misc/GeometricObjects.h"
@@ -77,6 +79,8 @@
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/SideParser.h"
 #include "Sim/Misc/SmoothHeightMesh.h"
+#include "Sim/Misc/SlowUpdateScheduler.h"
+#include "Sim/Misc/Team.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/Wind.h"
 #include "Sim/Misc/ResourceHandler.h"
@@ -86,13 +90,17 @@
 #include "Sim/Projectiles/ExplosionGenerator.h"
 #include "Sim/Projectiles/Projectile.h"
 #include "Sim/Projectiles/ProjectileHandler.h"
+#include "Sim/Projectiles/ProjectileMemPool.h"
 #include "Sim/Units/CommandAI/CommandAI.h"
 #include "Sim/Units/Scripts/UnitScriptFactory.h"
 #include "Sim/Units/Scripts/UnitScriptEngine.h"
+#include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Units/UnitDefHandler.h"
+#include "Sim/Units/UnitMemPool.h"
 #include "Sim/Weapons/WeaponDefHandler.h"
 #include "Sim/Weapons/WeaponLoader.h"
+#include "Sim/Weapons/WeaponMemPool.h"
 #include "UI/CommandColors.h"
 #include "UI/EndGameBox.h"
 #include "UI/GameSetupDrawer.h"
@@ -113,16 +121,20 @@
 #include "System/Sync/FPUCheck.h"
 #include "System/SafeUtil.h"
 #include "System/SpringExitCode.h"
+#include "System/SpringHash.h"
 #include "System/SpringMath.h"
 #include "System/FileSystem/FileSystem.h"
+#include "System/HugePageArena.h"
 #include "System/LoadSave/LoadSaveHandler.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/Log/ILog.h"
+#include "System/MemoryTags.h"
 #include "System/Platform/Misc.h"
 #include "System/Platform/Watchdog.h"
 #include "System/Sound/ISound.h"
 #include "System/Sound/ISoundChannels.h"
 #include "System/Sync/DumpState.h"
+#include "System/Sync/SyncChecker.h"
 #include "System/TimeProfiler.h"
 #include "System/LoadLock.h"
 
@@ -143,6 +155,7 @@ CONFIG(float, GuiOpacity).defaultValue(0.8f).minimumValue(0.0f).maximumValue(1.0
 CONFIG(std::string, InputTextGeo).defaultValue("");
 
 CONFIG(int, SmoothTimeOffset).defaultValue(0).headlessValue(0).description("Enables frametimeoffset smoothing, 0 = off (old version), -1 = forced 0.5,  1-20 smooth, recommended = 2-3");
+CONFIG(bool, HugePageSimPools).defaultValue(true).description("Back the unit, feature, projectile and weapon pools with transparent huge pages where supported (Linux), reducing TLB misses when iterating over sim objects.");
 
 CGame* game = nullptr;
 
@@ -174,6 +187,8 @@ CR_REG_METADATA(CGame, (
 	// FIXME: atomic type deduction
 	CR_IGNORED(loadDone),
 	CR_IGNORED(gameOver),
+	CR_IGNORED(gameOverFrame),
+	CR_IGNORED(gameOverChecksum),
 
 	CR_IGNORED(gameDrawMode),
 	CR_IGNORED(windowedEdgeMove),
@@ -210,6 +225,8 @@ CR_REG_METADATA(CGame, (
 	CR_IGNORED(curKeyCodeChain),
 	CR_IGNORED(curScanCodeChain),
 	CR_IGNORED(worldDrawer),
+	CR_IGNORED(smoothTimeOffset),
+	CR_IGNORED(memoryTagsLogInterval),
 	CR_IGNORED(saveFileHandler),
 
 	// Post Load
@@ -249,6 +266,9 @@ CGame::CGame(const std::string& mapFileName, const std::string& modFileName, ILo
 
 	speedControl = configHandler->GetInt("SpeedControl");
 
+	smoothTimeOffset.Bind("SmoothTimeOffset");
+	memoryTagsLogInterval.Bind("MemoryTagsLogInterval");
+
 	playerRoster.SetSortTypeByCode((PlayerRoster::SortType)configHandler->GetInt("ShowPlayerInfo"));
 
 	CInputReceiver::guiAlpha = configHandler->GetFloat("GuiOpacity");
@@ -260,6 +280,7 @@ CGame::CGame(const std::string& mapFileName, const std::string& modFileName, ILo
 	gameCommandConsole.ResetState();
 
 	envResHandler.ResetState();
+	slowUpdateScheduler.ResetState();
 
 	modInfo.Init(modFileName);
 
@@ -522,6 +543,10 @@ void CGame::LoadMap(const std::string& mapFileName)
 		// half size; building positions are snapped to multiples of BUILD_SQUARE_SIZE
 		buildingMaskMap.Init(mapDims.hmapx * mapDims.hmapy);
 		groundBlockingObjectMap.Init(mapDims.mapSquares);
+
+		// extractor spots are only wanted by AI's, overlap their search with loading
+		if (!gameSetup->GetAIStartingDataCont().empty())
+			resourceHandler->AnalyzeResourceMaps();
 	}
 
 	LEAVE_SYNCED_CODE();
@@ -628,6 +653,8 @@ void CGame::PostLoadSimulation(LuaParser* defsParser)
 		featureDefHandler->Init(defsParser);
 	}
 
+	CHugePageArena::SetHugePagesEnabled(configHandler->GetBool("HugePageSimPools"));
+
 	CUnit::InitStatic();
 	CCommandAI::InitCommandDescriptionCache();
 	CUnitScriptFactory::InitStatic();
@@ -638,6 +665,9 @@ void CGame::PostLoadSimulation(LuaParser* defsParser)
 	unitHandler.Init();
 	featureHandler.Init();
 	projectileHandler.Init();
+
+	LOG("[Game::%s] sim pools using huge pages: units=%d features=%d projectiles=%d weapons=%d", __func__,
+		unitMemPool.huge_pages(), featureMemPool.huge_pages(), projMemPool.huge_pages(), weaponMemPool.huge_pages());
 	CLosHandler::InitStatic();
 
 	readMap->InitHeightMapDigestVectors(losHandler->los.size);
@@ -863,6 +893,11 @@ void CGame::LoadFinalize()
 		);
 	}
 
+	if (!gameSetup->GetAIStartingDataCont().empty()) {
+		loadscreen->SetLoadMessage("[" + std::string(__func__) + "] finalizing resource-map analysis");
+		resourceHandler->FinalizeResourceMaps();
+	}
+
 	lastReadNetTime = spring_gettime();
 	lastSimFrameTime = lastReadNetTime;
 	lastDrawFrameTime = lastReadNetTime;
@@ -1178,6 +1213,7 @@ bool CGame::Update()
 		}
 	}
 
+	MemoryTags::Update(memoryTagsLogInterval);
 	return true;
 }
 
@@ -1243,7 +1279,7 @@ bool CGame::UpdateUnsynced(const spring_time currentTime)
 		globalRendering->lastTimeOffset = globalRendering->timeOffset;
 		globalRendering->timeOffset = (currentTime - lastFrameTime).toMilliSecsf() * globalRendering->weightedSpeedFactor;
 
-		int SmoothTimeOffset = configHandler->GetInt("SmoothTimeOffset");
+		int SmoothTimeOffset = smoothTimeOffset;
 		float strictness = 0.9f; // This defines how strict we are going to be when trying to keep frame timings
 		if (SmoothTimeOffset > 0) {
 			strictness = 1.0f - (SmoothTimeOffset) * 0.025f;
@@ -1692,6 +1728,9 @@ void CGame::SimFrame() {
 		c.SendStateUpdate(/*camera->GetMovState(), mouse->buttons*/);
 
 		CTeamHighlight::Update(gs->frameNum);
+	} else {
+		// AIs are not updated while skipping, but still get their events
+		eoh->DeliverEvents();
 	}
 
 	// everything from here is simulation
@@ -1733,6 +1772,16 @@ void CGame::SimFrame() {
 		playerHandler.GameFrame(gs->frameNum);
 	}
 
+	{
+		SCOPED_TIMER("Lua::QueuedToUnsynced");
+
+		// everything synced Lua passed to QueueToUnsynced during this frame
+		if (luaRules != nullptr)
+			luaRules->DeliverQueuedToUnsynced();
+		if (luaGaia != nullptr)
+			luaGaia->DeliverQueuedToUnsynced();
+	}
+
 	lastSimFrameTime = spring_gettime();
 	gu->avgSimFrameTime = mix(gu->avgSimFrameTime, (lastSimFrameTime - lastFrameTime).toMilliSecsf(), 0.05f);
 	gu->avgSimFrameTime = std::max(gu->avgSimFrameTime, 0.01f);
@@ -1760,6 +1809,43 @@ void CGame::SimFrame() {
 }
 
 
+// hashes the RNG state, frame, id/position/health of every unit and feature and
+// the resources of every team; with SYNCCHECK also the running sync checksum
+static std::uint32_t GetSyncedStateChecksum()
+{
+	std::uint32_t cs = spring::LiteHash(gsRNG.GetGenState(), gs->frameNum);
+
+	for (const CUnit* u: unitHandler.GetActiveUnits()) {
+		cs = spring::LiteHash(u->id, cs);
+		cs = spring::LiteHash(u->pos, cs);
+		cs = spring::LiteHash(u->health, cs);
+	}
+
+	cs = spring::LiteHash(static_cast<std::uint32_t>(unitHandler.GetActiveUnits().size()), cs);
+
+	// active feature IDs are unordered, combine their terms commutatively
+	std::uint32_t fcs = 0;
+
+	for (const int featureID: featureHandler.GetActiveFeatureIDs()) {
+		const CFeature* f = featureHandler.GetFeature(featureID);
+
+		fcs += spring::LiteHash(f->health, spring::LiteHash(f->pos, spring::LiteHash(f->id)));
+	}
+
+	cs = spring::LiteHash(fcs, cs);
+	cs = spring::LiteHash(static_cast<std::uint32_t>(featureHandler.GetActiveFeatureIDs().size()), cs);
+
+	for (int teamNum = 0; teamNum < teamHandler.ActiveTeams(); teamNum++) {
+		cs = spring::LiteHash(teamHandler.Team(teamNum)->res, cs);
+	}
+
+	#ifdef SYNCCHECK
+	cs = spring::LiteHash(CSyncChecker::GetChecksum(), cs);
+	#endif
+
+	return cs;
+}
+
 void CGame::GameEnd(const std::vector<unsigned char>& winningAllyTeams, bool timeout)
 {
 	if (gameOver)
@@ -1782,6 +1868,10 @@ void CGame::GameEnd(const std::vector<unsigned char>& winningAllyTeams, bool tim
 		clientNet->Send(CBaseNetProtocol::Get().SendGameOver(gu->myPlayerNum, winningAllyTeams));
 	}
 
+	// fingerprint of the synced state; matches from identical scripts end with identical
+	// values, which --batch uses to verify nothing leaks from one match into the next
+	gameOverFrame = gs->frameNum;
+	gameOverChecksum = GetSyncedStateChecksum();
 
 	gameOver = true;
 	eventHandler.GameOver(winningAllyTeams);
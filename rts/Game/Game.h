@@ -4,6 +4,7 @@
 #define _GAME_H
 
 #include <atomic>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -13,6 +14,7 @@
 #include "Game/Action.h"
 #include "Rendering/WorldDrawer.h"
 #include "System/UnorderedMap.hpp"
+#include "System/Config/ConfigHandle.h"
 #include "System/creg/creg_cond.h"
 #include "System/Misc/SpringTime.h"
 
@@ -80,6 +82,10 @@ public:
 	bool IsSavedGame() const { return (saveFileHandler != nullptr); }
 	bool IsGameOver() const { return gameOver; }
 
+	/// sim-frame and synced-state checksum at the time GameEnd was called
+	int GetGameOverFrame() const { return gameOverFrame; }
+	std::uint32_t GetGameOverChecksum() const { return gameOverChecksum; }
+
 	const spring::unordered_map<int, PlayerTrafficInfo>& GetPlayerTraffic() const {
 		return playerTraffic;
 	}
@@ -221,6 +227,10 @@ private:
 
 	CWorldDrawer worldDrawer;
 
+	// read every frame
+	ConfigHandle<int> smoothTimeOffset;
+	ConfigHandle<int> memoryTagsLogInterval;
+
 	/// <playerID, <packetCode, total bytes> >
 	spring::unordered_map<int, PlayerTrafficInfo> playerTraffic;
 
@@ -229,6 +239,9 @@ private:
 
 	std::atomic<bool> loadDone = {false};
 	std::atomic<bool> gameOver = {false};
+
+	int gameOverFrame = -1;
+	std::uint32_t gameOverChecksum = 0;
 };
 
 
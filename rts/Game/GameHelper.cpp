@@ -38,6 +38,7 @@
 #include "System/EventHandler.h"
 #include "System/SpringMath.h"
 #include "System/Sound/ISoundChannels.h"
+#include "System/Threading/ThreadPool.h"
 
 
 static CGameHelper gGameHelper;
@@ -96,6 +97,40 @@ float CGameHelper::CalcImpulseScale(const DamageArray& damages, const float expD
 	return Clamp(rawImpulseScale, -MAX_EXPLOSION_IMPULSE, MAX_EXPLOSION_IMPULSE);
 }
 
+CGameHelper::ExplosionHit CGameHelper::CalcExplosionHit(
+	const CUnit* unit,
+	const LocalModelPiece* lhp,
+	const float3& expPos,
+	const float expRadius
+) {
+	const CollisionVolume* vol = unit->GetCollisionVolume(lhp);
+
+	const float3& lhpPos = (lhp != nullptr && vol == lhp->GetCollisionVolume())? lhp->GetAbsolutePos(): ZeroVector;
+	const float3& volPos = vol->GetWorldSpacePos(unit, lhpPos);
+
+	// linear damage falloff with distance
+	const float expDist = (expRadius != 0.0f) ? vol->GetPointSurfaceDistance(unit, lhp, expPos) : 0.0f;
+
+	return {volPos, expDist};
+}
+
+CGameHelper::ExplosionHit CGameHelper::CalcExplosionHit(
+	const CFeature* feature,
+	const LocalModelPiece* lhp,
+	const float3& expPos,
+	const float expRadius
+) {
+	const CollisionVolume* vol = feature->GetCollisionVolume(lhp);
+
+	const float3& lhpPos = (lhp != nullptr && vol == lhp->GetCollisionVolume())? lhp->GetAbsolutePos(): ZeroVector;
+	const float3& volPos = vol->GetWorldSpacePos(feature, lhpPos);
+
+	const float expDist = (expRadius != 0.0f) ? vol->GetPointSurfaceDistance(feature, nullptr, expPos) : 0.0f;
+
+	return {volPos, expDist};
+}
+
+
 void CGameHelper::DoExplosionDamage(
 	CUnit* unit,
 	CUnit* owner,
@@ -113,14 +148,25 @@ void CGameHelper::DoExplosionDamage(
 	if (ignoreOwner && (unit == owner))
 		return;
 
-	const LocalModelPiece* lhp = unit->GetLastHitPiece(gs->frameNum);
-	const CollisionVolume* vol = unit->GetCollisionVolume(lhp);
+	const ExplosionHit hit = CalcExplosionHit(unit, unit->GetLastHitPiece(gs->frameNum), expPos, expRadius);
 
-	const float3& lhpPos = (lhp != nullptr && vol == lhp->GetCollisionVolume())? lhp->GetAbsolutePos(): ZeroVector;
-	const float3& volPos = vol->GetWorldSpacePos(unit, lhpPos);
+	DoExplosionDamage(unit, owner, hit, expPos, expRadius, expSpeed, expEdgeEffect, ignoreOwner, damages, weaponDefID, projectileID);
+}
 
-	// linear damage falloff with distance
-	const float expDist = (expRadius != 0.0f) ? vol->GetPointSurfaceDistance(unit, lhp, expPos) : 0.0f;
+void CGameHelper::DoExplosionDamage(
+	CUnit* unit,
+	CUnit* owner,
+	const ExplosionHit& hit,
+	const float3& expPos,
+	const float expRadius,
+	const float expSpeed,
+	const float expEdgeEffect,
+	const bool ignoreOwner,
+	const DamageArray& damages,
+	const int weaponDefID,
+	const int projectileID
+) {
+	const float expDist = hit.expDist;
 	const float expRim = expDist * expEdgeEffect;
 
 	// return early if (distance > radius)
@@ -142,7 +188,7 @@ void CGameHelper::DoExplosionDamage(
 	// on unit->radius, so the DoDamage() iteration will
 	// include units that should not be touched)
 
-	const float3 impulseDir = (volPos - expPos).SafeNormalize();
+	const float3 impulseDir = (hit.volPos - expPos).SafeNormalize();
 	const float3 expImpulse = impulseDir * modImpulseScale;
 
 	DamageArray expDamages = damages * expDistanceMod;
@@ -168,13 +214,23 @@ void CGameHelper::DoExplosionDamage(
 ) {
 	assert(feature != nullptr);
 
-	const LocalModelPiece* lhp = feature->GetLastHitPiece(gs->frameNum);
-	const CollisionVolume* vol = feature->GetCollisionVolume(lhp);
+	const ExplosionHit hit = CalcExplosionHit(feature, feature->GetLastHitPiece(gs->frameNum), expPos, expRadius);
 
-	const float3& lhpPos = (lhp != nullptr && vol == lhp->GetCollisionVolume())? lhp->GetAbsolutePos(): ZeroVector;
-	const float3& volPos = vol->GetWorldSpacePos(feature, lhpPos);
+	DoExplosionDamage(feature, owner, hit, expPos, expRadius, expEdgeEffect, damages, weaponDefID, projectileID);
+}
 
-	const float expDist = (expRadius != 0.0f) ? vol->GetPointSurfaceDistance(feature, nullptr, expPos) : 0.0f;
+void CGameHelper::DoExplosionDamage(
+	CFeature* feature,
+	CUnit* owner,
+	const ExplosionHit& hit,
+	const float3& expPos,
+	const float expRadius,
+	const float expEdgeEffect,
+	const DamageArray& damages,
+	const int weaponDefID,
+	const int projectileID
+) {
+	const float expDist = hit.expDist;
 	const float expRim = expDist * expEdgeEffect;
 
 	if (expDist > expRadius)
@@ -185,7 +241,7 @@ void CGameHelper::DoExplosionDamage(
 	const float expDistanceMod = (expRadius + 0.001f - expDist) / (expRadius + 0.001f - expRim);
 	const float modImpulseScale = CalcImpulseScale(damages, expDistanceMod);
 
-	const float3 impulseDir = (volPos - expPos).SafeNormalize();
+	const float3 impulseDir = (hit.volPos - expPos).SafeNormalize();
 	const float3 expImpulse = impulseDir * modImpulseScale;
 
 	feature->DoDamage(damages * expDistanceMod, expImpulse, owner, weaponDefID, projectileID);
@@ -193,11 +249,144 @@ void CGameHelper::DoExplosionDamage(
 
 
 
+void CGameHelper::PrepareExplosionBatch(const std::vector<ExplosionBatchQuery>& queries)
+{
+	ClearExplosionBatch();
+
+	// not worth the setup for a few explosions
+	if (queries.size() < 4)
+		return;
+
+	explosionBatch.reserve(queries.size());
+	explosionSpheres.reserve(queries.size());
+
+	for (const ExplosionBatchQuery& query: queries) {
+		explosionSpheres.emplace_back(query.pos, query.radius);
+	}
+
+	quadField.GetUnitsAndFeaturesColVol(explosionSpheres, batchedUnits, batchedUnitRanges, batchedFeatures, batchedFeatureRanges);
+
+	for (size_t i = 0; i < queries.size(); i++) {
+		explosionBatch.push_back({queries[i].pos, queries[i].radius, batchedUnitRanges[i], batchedFeatureRanges[i]});
+	}
+
+	batchedUnitHits.resize(batchedUnits.size());
+	batchedFeatureHits.resize(batchedFeatures.size());
+
+	// objects hit by a projectile this frame use piece volumes whose
+	// matrices are updated lazily, leave those to the main thread
+	for_mt(0, explosionBatch.size(), [&](const int i) {
+		const BatchedExplosion& be = explosionBatch[i];
+
+		for (int n = be.units.x; n < be.units.y; n++) {
+			BatchedHit& bh = batchedUnitHits[n];
+
+			if ((bh.cached = (batchedUnits[n]->GetLastHitPiece(gs->frameNum) == nullptr)))
+				bh.hit = CalcExplosionHit(batchedUnits[n], nullptr, be.pos, be.radius);
+		}
+
+		for (int n = be.features.x; n < be.features.y; n++) {
+			BatchedHit& bh = batchedFeatureHits[n];
+
+			if ((bh.cached = (batchedFeatures[n]->GetLastHitPiece(gs->frameNum) == nullptr)))
+				bh.hit = CalcExplosionHit(batchedFeatures[n], nullptr, be.pos, be.radius);
+		}
+	});
+
+	explosionBatchRevision = quadField.GetSolidsRevision();
+	explosionBatchFrame = gs->frameNum;
+
+	CSolidObject::TrackGeometryChanges(true);
+}
+
+void CGameHelper::ClearExplosionBatch()
+{
+	CSolidObject::TrackGeometryChanges(false);
+
+	explosionBatch.clear();
+	explosionSpheres.clear();
+	batchedUnits.clear();
+	batchedFeatures.clear();
+	batchedUnitHits.clear();
+	batchedFeatureHits.clear();
+
+	explosionBatchIdx = 0;
+	explosionBatchFrame = -1;
+}
+
+bool CGameHelper::DamageBatchedObjectsInExplosionRadius(
+	const CExplosionParams& params,
+	const float expRad,
+	const int weaponDefID
+) {
+	if (explosionBatch.empty())
+		return false;
+
+	// objects were added, deleted or moved between quads since the batch
+	// was joined (or it is stale), its object lists can not be used
+	if (explosionBatchRevision != quadField.GetSolidsRevision() || explosionBatchFrame != gs->frameNum)
+		return false;
+	// objects moved within their quads or changed shape, e.g. by Lua
+	if (CSolidObject::GetGeometryChanges() != 0)
+		return false;
+
+	const auto MatchesBatch = [&](const BatchedExplosion& be) {
+		// float3::operator== is not exact
+		return (be.pos.x == params.pos.x && be.pos.y == params.pos.y && be.pos.z == params.pos.z && be.radius == expRad);
+	};
+
+	size_t batchIdx = explosionBatchIdx;
+
+	// explosions normally go off in the order they were batched
+	while (batchIdx < explosionBatch.size() && !MatchesBatch(explosionBatch[batchIdx]))
+		batchIdx++;
+
+	if (batchIdx == explosionBatch.size())
+		return false;
+
+	// (recursive) explosions triggered by the damage below can also use the batch
+	explosionBatchIdx = batchIdx + 1;
+
+	const BatchedExplosion be = explosionBatch[batchIdx];
+
+	// the object lists are what GetUnitsAndFeaturesColVol would return now;
+	// damage can run arbitrary (Lua) code though, so cached terms are only
+	// used while no object has changed, like the unbatched path computes
+	// each object's terms just before damaging it
+	for (int n = be.units.x; n < be.units.y; n++) {
+		CUnit* unit = batchedUnits[n];
+
+		if (params.ignoreOwner && (unit == params.owner))
+			continue;
+
+		if (batchedUnitHits[n].cached && CSolidObject::GetGeometryChanges() == 0) {
+			DoExplosionDamage(unit, params.owner, batchedUnitHits[n].hit, params.pos, expRad, params.explosionSpeed, params.edgeEffectiveness, params.ignoreOwner, params.damages, weaponDefID, params.projectileID);
+		} else {
+			DoExplosionDamage(unit, params.owner, params.pos, expRad, params.explosionSpeed, params.edgeEffectiveness, params.ignoreOwner, params.damages, weaponDefID, params.projectileID);
+		}
+	}
+
+	for (int n = be.features.x; n < be.features.y; n++) {
+		CFeature* feature = batchedFeatures[n];
+
+		if (batchedFeatureHits[n].cached && CSolidObject::GetGeometryChanges() == 0) {
+			DoExplosionDamage(feature, params.owner, batchedFeatureHits[n].hit, params.pos, expRad, params.edgeEffectiveness, params.damages, weaponDefID, params.projectileID);
+		} else {
+			DoExplosionDamage(feature, params.owner, params.pos, expRad, params.edgeEffectiveness, params.damages, weaponDefID, params.projectileID);
+		}
+	}
+
+	return true;
+}
+
 void CGameHelper::DamageObjectsInExplosionRadius(
 	const CExplosionParams& params,
 	const float expRad,
 	const int weaponDefID
 ) {
+	if (DamageBatchedObjectsInExplosionRadius(params, expRad, weaponDefID))
+		return;
+
 	static std::vector<CUnit*> unitCache;
 	static std::vector<CFeature*> featureCache;
 
@@ -958,11 +1147,8 @@ struct SearchOffset {
 	int qdist; // dx*dx+dy*dy
 };
 
-static const std::vector<SearchOffset>& GetSearchOffsetTable(int radius)
+static void FillSearchOffsetTable(std::vector<SearchOffset>& searchOffsets, int radius)
 {
-	assert(radius >= 0);
-
-	static std::vector<SearchOffset> searchOffsets;
 	static std::function<bool(const SearchOffset&, const SearchOffset&)> searchOffsetCmp = [](const SearchOffset& a, const SearchOffset& b) {
 		return (a.qdist < b.qdist);
 	};
@@ -970,22 +1156,33 @@ static const std::vector<SearchOffset>& GetSearchOffsetTable(int radius)
 	const unsigned int diam = radius * 2;
 	const unsigned int size = Square(diam);
 
-	if (size > searchOffsets.size()) {
-		searchOffsets.resize(size);
+	searchOffsets.resize(size);
 
-		for (unsigned int y = 0; y < diam; y++) {
-			for (unsigned int x = 0; x < diam; x++) {
-				SearchOffset& i = searchOffsets[y * diam + x];
+	for (unsigned int y = 0; y < diam; y++) {
+		for (unsigned int x = 0; x < diam; x++) {
+			SearchOffset& i = searchOffsets[y * diam + x];
 
-				i.dx = x - radius;
-				i.dy = y - radius;
-				i.qdist = Square(i.dx) + Square(i.dy);
-			}
+			i.dx = x - radius;
+			i.dy = y - radius;
+			i.qdist = Square(i.dx) + Square(i.dy);
 		}
-
-		std::stable_sort(searchOffsets.begin(), searchOffsets.end(), searchOffsetCmp);
 	}
 
+	std::stable_sort(searchOffsets.begin(), searchOffsets.end(), searchOffsetCmp);
+}
+
+static const std::vector<SearchOffset>& GetSearchOffsetTable(int radius)
+{
+	assert(radius >= 0);
+
+	static std::vector<SearchOffset> searchOffsets;
+
+	// the table only ever grows, which changes the order in which equidistant
+	// offsets appear (and thereby the results of ClosestBuildPos for smaller
+	// radii); ClosestBuildPositions replicates this
+	if (Square(radius * 2) > searchOffsets.size())
+		FillSearchOffsetTable(searchOffsets, radius);
+
 	return searchOffsets;
 }
 
@@ -1035,6 +1232,10 @@ float3 CGameHelper::ClosestBuildPos(
 
 		// check for nearby blocking objects
 		for (int z = zmin; z < zmax; ++z) {
+			// skip rows without any objects
+			if (!groundBlockingObjectMap.GetOccupancyMap().AnyInRow(xmin, xmax - 1, z))
+				continue;
+
 			for (int x = xmin; x < xmax; ++x) {
 				const CSolidObject* solObj = groundBlockingObjectMap.GroundBlockedUnsafe(z * mapDims.mapx + x);
 
@@ -1057,6 +1258,10 @@ float3 CGameHelper::ClosestBuildPos(
 
 			// none found, check for nearby factories with open yards
 			for (int z = zmin; z < zmax; ++z) {
+				// skip rows without any objects
+				if (!groundBlockingObjectMap.GetOccupancyMap().AnyInRow(xmin, xmax - 1, z))
+					continue;
+
 				for (int x = xmin; x < xmax; ++x) {
 					const CSolidObject* solObj = groundBlockingObjectMap.GroundBlockedUnsafe(z * mapDims.mapx + x);
 
@@ -1080,6 +1285,284 @@ float3 CGameHelper::ClosestBuildPos(
 	return -RgtVector;
 }
 
+
+/**
+ * Summed-area tables of the immobile (and immobile + open-yard) objects on the
+ * blocking-map over a sub-rectangle of the map. These turn the minDistance
+ * area scans of ClosestBuildPos into four lookups. The tables are kept around
+ * until the blocking-map changes, so batches issued during the same frame (or
+ * while nothing moves) share them.
+ */
+class BuildPosBlockingGrid {
+public:
+	bool Covers(int x1, int z1, int x2, int z2) const {
+		if (numChanges != groundBlockingObjectMap.GetNumChanges())
+			return false;
+
+		return (x1 >= rx1 && z1 >= rz1 && x2 <= rx2 && z2 <= rz2);
+	}
+
+	void Update(int x1, int z1, int x2, int z2) {
+		if (Covers(x1, z1, x2, z2))
+			return;
+
+		if (numChanges == groundBlockingObjectMap.GetNumChanges()) {
+			// map unchanged, grow the covered area instead of replacing it
+			x1 = std::min(x1, rx1); x2 = std::max(x2, rx2);
+			z1 = std::min(z1, rz1); z2 = std::max(z2, rz2);
+		}
+
+		rx1 = x1; rx2 = x2;
+		rz1 = z1; rz2 = z2;
+		stride = (rx2 - rx1) + 1;
+
+		numChanges = groundBlockingObjectMap.GetNumChanges();
+
+		immobileSums.clear();
+		immobileSums.resize(stride * ((rz2 - rz1) + 1), 0);
+		openYardSums.clear();
+		openYardSums.resize(stride * ((rz2 - rz1) + 1), 0);
+
+		for (int z = rz1; z < rz2; z++) {
+			int immobileRowSum = 0;
+			int openYardRowSum = 0;
+
+			if (!groundBlockingObjectMap.GetOccupancyMap().AnyInRow(rx1, rx2 - 1, z)) {
+				// empty row, column sums carry over unchanged
+				const int idx = SumIndex(rx1 + 1, z + 1);
+
+				std::copy(immobileSums.begin() + idx - stride, immobileSums.begin() + idx - stride + (rx2 - rx1), immobileSums.begin() + idx);
+				std::copy(openYardSums.begin() + idx - stride, openYardSums.begin() + idx - stride + (rx2 - rx1), openYardSums.begin() + idx);
+				continue;
+			}
+
+			for (int x = rx1; x < rx2; x++) {
+				const CSolidObject* solObj = groundBlockingObjectMap.GroundBlockedUnsafe(z * mapDims.mapx + x);
+
+				// immobile=true implies Feature or Building
+				immobileRowSum += (solObj != nullptr && solObj->immobile);
+				openYardRowSum += (solObj != nullptr && solObj->immobile && solObj->yardOpen);
+
+				const int idx = SumIndex(x + 1, z + 1);
+
+				immobileSums[idx] = immobileSums[idx - stride] + immobileRowSum;
+				openYardSums[idx] = openYardSums[idx - stride] + openYardRowSum;
+			}
+		}
+	}
+
+	// number of squares in [x1,x2) x [z1,z2) whose first object is immobile
+	int CountImmobile(int x1, int z1, int x2, int z2) const { return (CountSquares(immobileSums, x1, z1, x2, z2)); }
+	// number of squares in [x1,x2) x [z1,z2) whose first object is immobile and has an open yard
+	int CountOpenYard(int x1, int z1, int x2, int z2) const { return (CountSquares(openYardSums, x1, z1, x2, z2)); }
+
+private:
+	int SumIndex(int x, int z) const { return ((z - rz1) * stride + (x - rx1)); }
+	int CountSquares(const std::vector<int>& sums, int x1, int z1, int x2, int z2) const {
+		if (x2 <= x1 || z2 <= z1)
+			return 0;
+
+		assert(x1 >= rx1 && z1 >= rz1 && x2 <= rx2 && z2 <= rz2);
+		return (sums[SumIndex(x2, z2)] - sums[SumIndex(x1, z2)] - sums[SumIndex(x2, z1)] + sums[SumIndex(x1, z1)]);
+	}
+
+private:
+	std::vector<int> immobileSums;
+	std::vector<int> openYardSums;
+
+	int rx1 = 0, rz1 = 0;
+	int rx2 = 0, rz2 = 0;
+	int stride = 1;
+
+	unsigned int numChanges = -1u;
+};
+
+static BuildPosBlockingGrid buildPosBlockingGrid;
+
+
+struct BuildPosSearch {
+	const CGameHelper::BuildPosQuery* query;
+	const std::vector<SearchOffset>* offsets;
+
+	int numOffsets;
+	int allyTeam;
+};
+
+// same tests (and order-independent outcome) as one iteration of ClosestBuildPos
+static bool TestBuildPosCandidate(const BuildPosSearch& search, const SearchOffset& offset, bool synced, float3& buildPos)
+{
+	const CGameHelper::BuildPosQuery& q = *search.query;
+
+	const float wxpos = q.worldPos.x + offset.dx * BUILD_SQUARE_SIZE;
+	const float wzpos = q.worldPos.z + offset.dy * BUILD_SQUARE_SIZE;
+
+	BuildInfo bi(q.unitDef, {wxpos, 0.0f, wzpos}, q.buildFacing);
+
+	{
+		// cheap blocking-grid tests first, these reject most of a dense base
+		const int xsqr  = static_cast<int>(wxpos / SQUARE_SIZE);
+		const int zsqr  = static_cast<int>(wzpos / SQUARE_SIZE);
+		const int xsize = bi.GetXSize();
+		const int zsize = bi.GetZSize();
+
+		int xmin = std::max(           0, xsqr - (xsize    ) / 2 - q.minDistance);
+		int zmin = std::max(           0, zsqr - (zsize    ) / 2 - q.minDistance);
+		int xmax = std::min(mapDims.mapx, xsqr + (xsize + 1) / 2 + q.minDistance);
+		int zmax = std::min(mapDims.mapy, zsqr + (zsize + 1) / 2 + q.minDistance);
+
+		if (buildPosBlockingGrid.CountImmobile(xmin, zmin, xmax, zmax) != 0)
+			return false;
+
+		xmin = std::max(           0, xmin - 2);
+		zmin = std::max(           0, zmin - 2);
+		xmax = std::min(mapDims.mapx, xmax + 2);
+		zmax = std::min(mapDims.mapy, zmax + 2);
+
+		if (buildPosBlockingGrid.CountOpenYard(xmin, zmin, xmax, zmax) != 0)
+			return false;
+	}
+
+	CFeature* feature = nullptr;
+
+	bi.pos = CGameHelper::Pos2BuildPos(bi, false);
+
+	if (!CGameHelper::TestUnitBuildSquare(bi, feature, search.allyTeam, synced) && (feature == nullptr || feature->allyteam != search.allyTeam))
+		return false;
+
+	buildPos = bi.pos;
+	return true;
+}
+
+// @return index of the first passing candidate in [begin, end), or -1
+static int FindBuildPosCandidate(const BuildPosSearch& search, int begin, int end, bool synced, float3& buildPos)
+{
+	for (int i = begin; i < end; i++) {
+		if (TestBuildPosCandidate(search, (*search.offsets)[i], synced, buildPos))
+			return i;
+	}
+
+	return -1;
+}
+
+void CGameHelper::ClosestBuildPositions(
+	const std::vector<BuildPosQuery>& queries,
+	std::vector<float3>& results,
+	bool synced
+) {
+	results.clear();
+	results.resize(queries.size(), -RgtVector);
+
+	std::vector<BuildPosSearch> searches;
+	std::vector<size_t> searchIndices;
+	std::vector<size_t> tableSizes;
+
+	searches.reserve(queries.size());
+	searchIndices.reserve(queries.size());
+	tableSizes.reserve(queries.size());
+
+	int bx1 = mapDims.mapx, bz1 = mapDims.mapy;
+	int bx2 =            0, bz2 =            0;
+
+	for (size_t i = 0; i < queries.size(); i++) {
+		const BuildPosQuery& q = queries[i];
+
+		if (q.unitDef == nullptr)
+			continue;
+
+		const int rawRadius = static_cast<int>(q.searchRadius / BUILD_SQUARE_SIZE);
+		const int maxRadius = Clamp(rawRadius, 1, 128);
+
+		// advance the shared table exactly like a sequence of ClosestBuildPos calls
+		// would, every query is searched with the table in effect at its own turn
+		tableSizes.push_back(GetSearchOffsetTable(maxRadius).size());
+		searches.push_back({&q, nullptr, Square(maxRadius * 2), teamHandler.AllyTeam(q.team)});
+		searchIndices.push_back(i);
+
+		// not thread-safe, and TestUnitBuildSquare calls it for every candidate
+		q.unitDef->LoadModel();
+
+		// conservative bounds of every square the blocking tests can touch
+		const float tableRadius = std::sqrt(float(tableSizes.back())) * 0.5f * BUILD_SQUARE_SIZE;
+		const int margin = std::max(q.unitDef->xsize, q.unitDef->zsize) + std::max(q.minDistance, 0) + 4;
+
+		bx1 = std::min(bx1, static_cast<int>(Clamp(q.worldPos.x - tableRadius, 0.0f, float3::maxxpos) / SQUARE_SIZE) - margin);
+		bz1 = std::min(bz1, static_cast<int>(Clamp(q.worldPos.z - tableRadius, 0.0f, float3::maxzpos) / SQUARE_SIZE) - margin);
+		bx2 = std::max(bx2, static_cast<int>(Clamp(q.worldPos.x + tableRadius, 0.0f, float3::maxxpos) / SQUARE_SIZE) + margin);
+		bz2 = std::max(bz2, static_cast<int>(Clamp(q.worldPos.z + tableRadius, 0.0f, float3::maxzpos) / SQUARE_SIZE) + margin);
+	}
+
+	if (searches.empty())
+		return;
+
+	// earlier queries may have used a smaller (differently ordered) table
+	const std::vector<SearchOffset>& sharedTable = GetSearchOffsetTable(1);
+	std::vector< std::vector<SearchOffset> > olderTables;
+
+	for (size_t i = 0; i < searches.size(); i++) {
+		if (tableSizes[i] == sharedTable.size())
+			continue;
+		if (std::find(tableSizes.begin(), tableSizes.begin() + i, tableSizes[i]) != (tableSizes.begin() + i))
+			continue;
+
+		olderTables.emplace_back();
+		FillSearchOffsetTable(olderTables.back(), std::sqrt(float(tableSizes[i])) * 0.5f);
+	}
+	for (size_t i = 0; i < searches.size(); i++) {
+		searches[i].offsets = &sharedTable;
+
+		for (const std::vector<SearchOffset>& olderTable: olderTables) {
+			if (olderTable.size() != tableSizes[i])
+				continue;
+
+			searches[i].offsets = &olderTable;
+			break;
+		}
+	}
+
+	buildPosBlockingGrid.Update(
+		Clamp(bx1, 0, mapDims.mapx), Clamp(bz1, 0, mapDims.mapy),
+		Clamp(bx2, 0, mapDims.mapx), Clamp(bz2, 0, mapDims.mapy)
+	);
+
+	const int numThreads = ThreadPool::GetNumThreads();
+
+	if (searches.size() >= static_cast<size_t>(numThreads * 2)) {
+		// enough queries to keep every thread busy, search each one serially
+		for_mt(0, searches.size(), [&](const int i) {
+			FindBuildPosCandidate(searches[i], 0, searches[i].numOffsets, synced, results[ searchIndices[i] ]);
+		});
+		return;
+	}
+
+	// few queries, split each spiral into blocks and test those in parallel;
+	// the first passing candidate of the first block with a hit wins as before
+	constexpr int BLOCK_SIZE = 64;
+
+	std::vector<int> blockHits(numThreads);
+	std::vector<float3> blockPositions(numThreads);
+
+	for (size_t i = 0; i < searches.size(); i++) {
+		const BuildPosSearch& search = searches[i];
+
+		for (int waveStart = 0; waveStart < search.numOffsets; waveStart += (BLOCK_SIZE * numThreads)) {
+			for_mt(0, numThreads, [&](const int b) {
+				const int blockStart = std::min(waveStart + b * BLOCK_SIZE, search.numOffsets);
+				const int blockEnd = std::min(blockStart + BLOCK_SIZE, search.numOffsets);
+
+				blockHits[b] = FindBuildPosCandidate(search, blockStart, blockEnd, synced, blockPositions[b]);
+			});
+
+			const auto iter = std::find_if(blockHits.begin(), blockHits.end(), [](int hit) { return (hit >= 0); });
+
+			if (iter == blockHits.end())
+				continue;
+
+			results[ searchIndices[i] ] = blockPositions[iter - blockHits.begin()];
+			break;
+		}
+	}
+}
+
 // find the reference height for a build-position
 // against which to compare all footprint squares
 float CGameHelper::GetBuildHeight(const float3& pos, const UnitDef* unitdef, bool synced)
@@ -1195,6 +1678,7 @@ CGameHelper::BuildSquareStatus CGameHelper::TestUnitBuildSquare(
 		testStatus = BUILDSQUARE_BLOCKED;
 
 		QuadFieldQuery qfQuery;
+		qfQuery.threadOwner = ThreadPool::GetThreadNum();
 		quadField.GetFeaturesExact(qfQuery, testPos, std::max(xsize, zsize) * 6);
 
 		const int mindx = xsize * (SQUARE_SIZE >> 1) - (SQUARE_SIZE >> 1);
@@ -19,6 +19,7 @@ class CWeapon;
 class CSolidObject;
 class CFeature;
 class CMobileCAI;
+struct LocalModelPiece;
 struct UnitDef;
 struct MoveDef;
 struct BuildInfo;
@@ -141,6 +142,27 @@ public:
 		bool synced = false
 	);
 
+	struct BuildPosQuery {
+		const UnitDef* unitDef;
+		float3 worldPos;
+		float searchRadius;
+		int team;
+		int minDistance;
+		int buildFacing;
+	};
+
+	/**
+	 * Batched version of ClosestBuildPos, results[i] is the position that
+	 * ClosestBuildPos would return for queries[i] if they were issued one
+	 * after another. Candidates are tested in parallel, so this must only
+	 * be called from the main thread.
+	 */
+	static void ClosestBuildPositions(
+		const std::vector<BuildPosQuery>& queries,
+		std::vector<float3>& results,
+		bool synced = false
+	);
+
 	static size_t GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets);
 
 	void Init();
@@ -174,6 +196,74 @@ public:
 	void DamageObjectsInExplosionRadius(const CExplosionParams& params, const float expRad, const int weaponDefID);
 	void Explosion(const CExplosionParams& params);
 
+	struct ExplosionBatchQuery {
+		float3 pos;
+		float radius;
+	};
+
+	/**
+	 * Joins explosions that are expected to go off next (e.g. projectiles
+	 * that reached the ground) against the objects around them in one
+	 * quadfield pass, and computes their distance terms in parallel.
+	 * Explosions at the same position and radius reuse these as long as no
+	 * object was added, removed, moved or reshaped since; anything else is
+	 * computed as before, and damage itself is still applied in the order
+	 * the explosions happen. Main thread only.
+	 */
+	void PrepareExplosionBatch(const std::vector<ExplosionBatchQuery>& queries);
+	void ClearExplosionBatch();
+
+private:
+	struct ExplosionHit {
+		float3 volPos;
+		float expDist;
+	};
+
+	struct BatchedHit {
+		ExplosionHit hit;
+		// false for objects hit on a piece volume this frame
+		bool cached;
+	};
+
+	struct BatchedExplosion {
+		float3 pos;
+		float radius;
+
+		// [begin, end) in batchedUnits and batchedFeatures, in quadfield order
+		int2 units;
+		int2 features;
+	};
+
+	static ExplosionHit CalcExplosionHit(const CUnit* unit, const LocalModelPiece* lhp, const float3& expPos, const float expRadius);
+	static ExplosionHit CalcExplosionHit(const CFeature* feature, const LocalModelPiece* lhp, const float3& expPos, const float expRadius);
+
+	void DoExplosionDamage(
+		CUnit* unit,
+		CUnit* owner,
+		const ExplosionHit& hit,
+		const float3& expPos,
+		const float expRadius,
+		const float expSpeed,
+		const float expEdgeEffect,
+		const bool ignoreOwner,
+		const DamageArray& damages,
+		const int weaponDefID,
+		const int projectileID
+	);
+	void DoExplosionDamage(
+		CFeature* feature,
+		CUnit* owner,
+		const ExplosionHit& hit,
+		const float3& expPos,
+		const float expRadius,
+		const float expEdgeEffect,
+		const DamageArray& damages,
+		const int weaponDefID,
+		const int projectileID
+	);
+
+	bool DamageBatchedObjectsInExplosionRadius(const CExplosionParams& params, const float expRad, const int weaponDefID);
+
 private:
 	struct WaitingDamage {
 		WaitingDamage(const DamageArray& _damage, const float3& _impulse, int _attackerID, int _targetID, int _weaponID, int _projectileID)
@@ -197,6 +287,21 @@ private:
 	// note: size must be a power of two
 	std::array<std::vector<WaitingDamage>, 128> waitingDamages;
 
+	std::vector<BatchedExplosion> explosionBatch;
+	std::vector<float4> explosionSpheres;
+	std::vector<int2> batchedUnitRanges;
+	std::vector<int2> batchedFeatureRanges;
+
+	std::vector<CUnit*> batchedUnits;
+	std::vector<CFeature*> batchedFeatures;
+	std::vector<BatchedHit> batchedUnitHits;
+	std::vector<BatchedHit> batchedFeatureHits;
+
+	// first batch entry not yet used, quadfield revision and frame the batch is valid for
+	size_t explosionBatchIdx = 0;
+	unsigned int explosionBatchRevision = 0;
+	int explosionBatchFrame = -1;
+
 public:
 	std::vector<int> targetUnitIDs; // GetEnemyUnits{NoLosTest}
 	std::vector<std::pair<float, CUnit*>> targetPairs; // GenerateWeaponTargets
@@ -158,6 +158,99 @@ inline static bool TestTrajectoryConeHelper(
 
 
 
+/**
+ * helpers for TraceRay and TraceBeam, shared so both run the exact same
+ * sequence of hit-tests
+ */
+inline static bool CanRayHitUnit(const CUnit* u, const CUnit* owner, int allyTeam, int traceFlags)
+{
+	if (u == owner)
+		return false;
+
+	if (!u->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
+		return false;
+
+	bool doHitTest = false;
+
+	doHitTest |= (((traceFlags & Collision::NOFRIENDLIES) == 0) && u->allyteam == allyTeam);
+	doHitTest |= (((traceFlags & Collision::NOENEMIES   ) == 0) && u->allyteam != allyTeam);
+	doHitTest |= (((traceFlags & Collision::NONEUTRALS  ) == 0) && u->IsNeutral());
+	doHitTest |= (((traceFlags & Collision::NOCLOAKED   ) == 0) && u->IsCloaked());
+
+	return doHitTest;
+}
+
+template<typename T>
+inline static void TestRayObject(
+	T* obj,
+	const float3& pos,
+	const float3& dir,
+	float& traceLength,
+	CollisionQuery& cq,
+	CollisionQuery* hitColQuery,
+	T*& hitObject
+) {
+	if (!CCollisionHandler::DetectHit(obj, obj->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true))
+		return;
+
+	const float len = cq.GetHitPosDist(pos, dir);
+
+	// we want the closest object (intersection point) on the ray
+	if (len >= traceLength)
+		return;
+
+	traceLength = len;
+
+	hitObject = obj;
+	*hitColQuery = cq;
+}
+
+inline static bool CanRayHitShield(const CPlasmaRepulser* r, const CWeapon* emitter)
+{
+	return (r->CanIntercept(emitter->weaponDef->interceptedByShieldType, emitter->owner->allyteam));
+}
+
+inline static void TestRayShield(
+	CPlasmaRepulser* r,
+	const float3& start,
+	const float3& dir,
+	float length,
+	CollisionQuery& cq,
+	std::vector<TraceRay::SShieldDist>& hitShields
+) {
+	if (!CCollisionHandler::DetectHit(r->owner, &r->collisionVolume, r->owner->GetTransformMatrix(true), start, start + dir * length, &cq, true))
+		return;
+
+	if (cq.InsideHit() && r->weaponDef->exteriorShield)
+		return;
+
+	const float len = cq.GetHitPosDist(start, dir);
+
+	if (len <= 0.0f)
+		return;
+
+	const auto hitCmp = [](const float a, const TraceRay::SShieldDist& b) { return (a < b.dist); };
+	const auto insPos = std::upper_bound(hitShields.begin(), hitShields.end(), len, hitCmp);
+
+	hitShields.insert(insPos, {r, len});
+}
+
+inline static float TraceRayGround(const float3& pos, const float3& dir, float traceLength, CUnit*& hitUnit, CFeature*& hitFeature)
+{
+	// ground intersection
+	const float groundLength = CGround::LineGroundCol(pos, pos + dir * traceLength);
+
+	if (traceLength > groundLength && groundLength > 0.0f) {
+		traceLength = groundLength;
+
+		hitUnit = nullptr;
+		hitFeature = nullptr;
+	}
+
+	return traceLength;
+}
+
+
 //////////////////////////////////////////////////////////////////////
 // Raytracing
 //////////////////////////////////////////////////////////////////////
@@ -225,18 +318,7 @@ float TraceRay(
 					if (!f->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
 						continue;
 
-					if (CCollisionHandler::DetectHit(f, f->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true)) {
-						const float len = cq.GetHitPosDist(pos, dir);
-
-						// we want the closest feature (intersection point) on the ray
-						if (len >= traceLength)
-							continue;
-
-						traceLength = len;
-
-						hitFeature = f;
-						*hitColQuery = cq;
-					}
+					TestRayObject(f, pos, dir, traceLength, cq, hitColQuery, hitFeature);
 				}
 			}
 		}
@@ -247,34 +329,10 @@ float TraceRay(
 				const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
 
 				for (CUnit* u: quad.units) {
-					if (u == owner)
-						continue;
-
-					if (!u->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
-						continue;
-
-					bool doHitTest = false;
-
-					doHitTest |= (scanForAllies   && u->allyteam == owner->allyteam);
-					doHitTest |= (scanForEnemies  && u->allyteam != owner->allyteam);
-					doHitTest |= (scanForNeutrals && u->IsNeutral());
-					doHitTest |= (scanForCloaked  && u->IsCloaked());
-
-					if (!doHitTest)
+					if (!CanRayHitUnit(u, owner, owner->allyteam, traceFlags))
 						continue;
 
-					if (CCollisionHandler::DetectHit(u, u->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true)) {
-						const float len = cq.GetHitPosDist(pos, dir);
-
-						// we want the closest unit (intersection point) on the ray
-						if (len >= traceLength)
-							continue;
-
-						traceLength = len;
-
-						hitUnit = u;
-						*hitColQuery = cq;
-					}
+					TestRayObject(u, pos, dir, traceLength, cq, hitColQuery, hitUnit);
 				}
 			}
 
@@ -285,17 +343,8 @@ float TraceRay(
 		}
 	}
 
-	if (scanForGround) {
-		// ground intersection
-		const float groundLength = CGround::LineGroundCol(pos, pos + dir * traceLength);
-
-		if (traceLength > groundLength && groundLength > 0.0f) {
-			traceLength = groundLength;
-
-			hitUnit = nullptr;
-			hitFeature = nullptr;
-		}
-	}
+	if (scanForGround)
+		traceLength = TraceRayGround(pos, dir, traceLength, hitUnit, hitFeature);
 
 	// no intersection if no decrease in length
 	return traceLength;
@@ -318,25 +367,150 @@ void TraceRayShields(
 		const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
 
 		for (CPlasmaRepulser* r: quad.repulsers) {
-			if (!r->CanIntercept(emitter->weaponDef->interceptedByShieldType, emitter->owner->allyteam))
+			if (!CanRayHitShield(r, emitter))
 				continue;
 
-			if (CCollisionHandler::DetectHit(r->owner, &r->collisionVolume, r->owner->GetTransformMatrix(true), start, start + dir * length, &cq, true)) {
-				if (cq.InsideHit() && r->weaponDef->exteriorShield)
-					continue;
+			TestRayShield(r, start, dir, length, cq, hitShields);
+		}
+	}
+}
 
-				const float len = cq.GetHitPosDist(start, dir);
 
-				if (len <= 0.0f)
-					continue;
+float TraceBeam(
+	const CWeapon* emitter,
+	const float3& pos,
+	const float3& dir,
+	float traceLength,
+	int traceFlags,
+	CUnit*& hitUnit,
+	CFeature*& hitFeature,
+	CollisionQuery* hitColQuery,
+	SBeamCorridor& corridor
+) {
+	const CUnit* owner = emitter->owner;
+
+	const bool scanForFeatures = ((traceFlags & Collision::NOFEATURES) == 0);
+	const bool scanForGround   = ((traceFlags & Collision::NOGROUND  ) == 0);
+	const bool scanForAnyUnits = ((traceFlags & Collision::NOUNITS) != Collision::NOUNITS) || ((traceFlags & Collision::NOCLOAKED) == 0);
+
+	hitFeature = nullptr;
+	hitUnit = nullptr;
+
+	corridor.Clear();
+
+	corridor.pos = pos;
+	corridor.dir = dir;
+	corridor.length = traceLength;
+
+	if (dir == ZeroVector)
+		return -1.0f;
+
+	CollisionQuery cq;
+
+	if (hitColQuery == nullptr)
+		hitColQuery = &cq;
+
+	{
+		QuadFieldQuery qfQuery;
+		quadField.GetQuadsOnRay(qfQuery, pos, dir, traceLength);
+
+		// single pass over the quads; candidates keep their per-quad order
+		// and duplicates so the hit-tests below match TraceRay{Shields}
+		for (const int quadIdx: *qfQuery.quads) {
+			const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
+
+			corridor.AddQuad(quadIdx);
+
+			if (scanForFeatures) {
+				for (CFeature* f: quad.features) {
+					if (!f->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
+						continue;
+
+					corridor.features.push_back(f);
+				}
+			}
+
+			if (scanForAnyUnits) {
+				for (CUnit* u: quad.units) {
+					if (!CanRayHitUnit(u, owner, owner->allyteam, traceFlags))
+						continue;
+
+					corridor.units.push_back(u);
+				}
+			}
 
-				const auto hitCmp = [](const float a, const SShieldDist& b) { return (a < b.dist); };
-				const auto insPos = std::upper_bound(hitShields.begin(), hitShields.end(), len, hitCmp);
+			for (CPlasmaRepulser* r: quad.repulsers) {
+				if (!CanRayHitShield(r, emitter))
+					continue;
 
-				hitShields.insert(insPos, {r, len});
+				corridor.AddRepulser(r);
 			}
 		}
 	}
+
+	corridor.SetGathered();
+
+	for (CFeature* f: corridor.features) {
+		TestRayObject(f, pos, dir, traceLength, cq, hitColQuery, hitFeature);
+	}
+
+	for (CUnit* u: corridor.units) {
+		TestRayObject(u, pos, dir, traceLength, cq, hitColQuery, hitUnit);
+	}
+
+	// units override features, so feature != null implies no unit was hit
+	if (hitUnit != nullptr)
+		hitFeature = nullptr;
+
+	if (scanForGround)
+		traceLength = TraceRayGround(pos, dir, traceLength, hitUnit, hitFeature);
+
+	return traceLength;
+}
+
+void TraceBeamShields(
+	const CWeapon* emitter,
+	float length,
+	const SBeamCorridor& corridor,
+	std::vector<SShieldDist>& hitShields
+) {
+	if (!corridor.gathered) {
+		TraceRayShields(emitter, corridor.pos, corridor.dir, length, hitShields);
+		return;
+	}
+
+	if (length > corridor.length) {
+		TraceRayShields(emitter, corridor.pos, corridor.dir, length, hitShields);
+		return;
+	}
+
+	// the quads on a shorter ray are a subset of those on the full one
+	if (corridor.repulsers.empty())
+		return;
+
+	CollisionQuery cq;
+
+	if (length == corridor.length) {
+		for (CPlasmaRepulser* r: corridor.repulsers) {
+			TestRayShield(r, corridor.pos, corridor.dir, length, cq, hitShields);
+		}
+
+		return;
+	}
+
+	// a shortened beam can pass through fewer quads; clip the corridor to
+	// those so repeated entries (and thus IncomingBeam callins) stay the same
+	QuadFieldQuery qfQuery;
+	quadField.GetQuadsOnRay(qfQuery, corridor.pos, corridor.dir, length);
+
+	const auto testShield = [&](CPlasmaRepulser* r) {
+		TestRayShield(r, corridor.pos, corridor.dir, length, cq, hitShields);
+	};
+
+	if (corridor.ForEachRepulser(*qfQuery.quads, testShield))
+		return;
+
+	TraceRayShields(emitter, corridor.pos, corridor.dir, length, hitShields);
 }
 
 
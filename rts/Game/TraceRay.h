@@ -3,9 +3,11 @@
 #ifndef _TRACE_RAY_H
 #define _TRACE_RAY_H
 
+#include <algorithm>
 #include <vector>
 
-class float3;
+#include "System/float3.h"
+
 class CUnit;
 class CFeature;
 class CWeapon;
@@ -33,6 +35,70 @@ namespace TraceRay {
 		float dist;
 	};
 
+	/**
+	 * Candidate objects along one beam segment, gathered by TraceBeam
+	 * in a single quadfield pass and reused by TraceBeamShields.
+	 */
+	struct SBeamCorridor {
+		void Clear() {
+			features.clear();
+			units.clear();
+			repulsers.clear();
+			repulserQuads.clear();
+			quads.clear();
+
+			gathered = false;
+		}
+
+		void AddQuad(int quadIdx) { quads.push_back(quadIdx); }
+		void AddRepulser(CPlasmaRepulser* r) {
+			repulsers.push_back(r);
+			repulserQuads.push_back(quads.back());
+		}
+
+		void SetGathered() {
+			std::sort(quads.begin(), quads.end());
+			gathered = true;
+		}
+
+		/**
+		 * Calls <f> for every gathered repulser in the order (and with the
+		 * repeats) in which walking <segQuads> would have produced them, so
+		 * a segment shorter than the corridor can reuse it. Returns false
+		 * without calling <f> if one of <segQuads> was not gathered.
+		 */
+		template<typename F> bool ForEachRepulser(const std::vector<int>& segQuads, F&& f) const {
+			for (const int quadIdx: segQuads) {
+				if (!std::binary_search(quads.begin(), quads.end(), quadIdx))
+					return false;
+			}
+
+			for (const int quadIdx: segQuads) {
+				auto it = std::find(repulserQuads.begin(), repulserQuads.end(), quadIdx);
+
+				for (; it != repulserQuads.end() && *it == quadIdx; ++it) {
+					f(repulsers[it - repulserQuads.begin()]);
+				}
+			}
+
+			return true;
+		}
+
+		std::vector<CFeature*> features;
+		std::vector<CUnit*> units;
+		std::vector<CPlasmaRepulser*> repulsers;
+
+		// quad each repulser was gathered from, and all quads on the segment (sorted)
+		std::vector<int> repulserQuads;
+		std::vector<int> quads;
+
+		float3 pos;
+		float3 dir;
+		float length = 0.0f;
+
+		bool gathered = false;
+	};
+
 	float TraceRay(
 		const float3& pos,
 		const float3& dir,
@@ -63,6 +129,34 @@ namespace TraceRay {
 		std::vector<SShieldDist>& hitShields
 	);
 
+	/**
+	 * Same result as TraceRay(pos, dir, traceLength, traceFlags, emitter->owner, ...)
+	 * but also collects the shields along the segment into <corridor>, so a
+	 * subsequent TraceBeamShields does not need its own quadfield query.
+	 */
+	float TraceBeam(
+		const CWeapon* emitter,
+		const float3& pos,
+		const float3& dir,
+		float traceLength,
+		int traceFlags,
+		CUnit*& hitUnit,
+		CFeature*& hitFeature,
+		CollisionQuery* hitColQuery,
+		SBeamCorridor& corridor
+	);
+
+	/**
+	 * Same result as TraceRayShields(emitter, corridor.pos, corridor.dir, length, hitShields);
+	 * reuses the corridor if <length> does not exceed its length.
+	 */
+	void TraceBeamShields(
+		const CWeapon* emitter,
+		float length,
+		const SBeamCorridor& corridor,
+		std::vector<SShieldDist>& hitShields
+	);
+
 	float GuiTraceRay(
 		const float3& start,
 		const float3& dir,
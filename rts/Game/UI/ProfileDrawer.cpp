@@ -21,6 +21,7 @@
 #include "Sim/Projectiles/ProjectileMemPool.h"
 #include "Sim/Weapons/WeaponMemPool.h"
 #include "System/EventHandler.h"
+#include "System/MemoryTags.h"
 #include "System/TimeProfiler.h"
 #include "System/Threading/ThreadPool.h"
 #include "System/SafeUtil.h"
@@ -133,6 +134,44 @@ static void DrawBufferStats(const float2 pos)
 	}
 }
 
+static void DrawMemoryTagStats(const float2 pos)
+{
+	size_t numTags = 0;
+
+	MemoryTags::ForEach([&](const MemoryTag&) { numTags += 1; });
+
+	const float4 drawArea = {pos.x, pos.y + 0.02f, pos.x + 0.2f, pos.y - (0.025f + numTags * LINE_HEIGHT)};
+
+	auto& rb = RenderBuffer::GetTypedRenderBuffer<VA_TYPE_C>();
+
+	// background
+	constexpr SColor bgColor = SColor{ 0.0f, 0.0f, 0.0f, 0.5f };
+	rb.SafeAppend({{drawArea.x - 10.0f * globalRendering->pixelX, drawArea.y - 10.0f * globalRendering->pixelY, 0.0f}, bgColor }); // TL
+	rb.SafeAppend({{drawArea.x - 10.0f * globalRendering->pixelX, drawArea.w + 10.0f * globalRendering->pixelY, 0.0f}, bgColor }); // BL
+	rb.SafeAppend({{drawArea.z + 10.0f * globalRendering->pixelX, drawArea.w + 10.0f * globalRendering->pixelY, 0.0f}, bgColor }); // BR
+
+	rb.SafeAppend({{drawArea.z + 10.0f * globalRendering->pixelX, drawArea.w + 10.0f * globalRendering->pixelY, 0.0f}, bgColor }); // BR
+	rb.SafeAppend({{drawArea.z + 10.0f * globalRendering->pixelX, drawArea.y - 10.0f * globalRendering->pixelY, 0.0f}, bgColor }); // TR
+	rb.SafeAppend({{drawArea.x - 10.0f * globalRendering->pixelX, drawArea.y - 10.0f * globalRendering->pixelY, 0.0f}, bgColor }); // TL
+	rb.Submit(GL_TRIANGLES);
+
+	static constexpr const char* FMT = "\t%s={%.1f/%.1fMB %.0f/s}";
+	font->SetTextColor(1.0f, 1.0f, 0.5f, 0.8f);
+
+	font->glFormat(pos.x, pos.y - 0.005f, 0.5f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, "MEMORY {live/peak, allocs}");
+
+	float bias = 0.0f;
+
+	MemoryTags::ForEach([&](const MemoryTag& tag) {
+		font->glFormat(pos.x, pos.y - (0.025f + bias), 0.5f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, FMT, tag.GetName(),
+			tag.GetLiveBytes() / 1024.0f / 1024.0f,
+			tag.GetPeakBytes() / 1024.0f / 1024.0f,
+			tag.GetAllocRate()
+		);
+		bias += LINE_HEIGHT;
+	});
+}
+
 static void DrawTimeSlices(
 	std::deque<TimeSlice>& frames,
 	const spring_time curTime,
@@ -574,6 +613,7 @@ void ProfileDrawer::DrawScreen()
 	DrawInfoText(rb);
 	DrawProfiler(rb);
 	DrawBufferStats({0.01f, 0.605f});
+	DrawMemoryTagStats({0.24f, 0.605f});
 
 	shader.Disable();
 
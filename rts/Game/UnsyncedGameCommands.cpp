@@ -97,6 +97,7 @@
 
 #include "System/EventHandler.h"
 #include "System/GlobalConfig.h"
+#include "System/MemoryTags.h"
 #include "System/SafeUtil.h"
 #include "System/TimeProfiler.h"
 #include "System/Log/ILog.h"
@@ -3541,7 +3542,7 @@ class DebugInfoActionExecutor : public IUnsyncedActionExecutor {
 public:
 	DebugInfoActionExecutor() : IUnsyncedActionExecutor(
 		"DebugInfo",
-		"Print debug info to the chat/log-file about either sound, profiling, or command-descriptions"
+		"Print debug info to the chat/log-file about either sound, profiling, memory, or command-descriptions"
 	) {
 	}
 
@@ -3558,8 +3559,11 @@ public:
 			case hashString("cmddescrs"): {
 				commandDescriptionCache.Dump(true);
 			} break;
+			case hashString("memory"): {
+				MemoryTags::Print();
+			} break;
 			default: {
-				LOG_L(L_WARNING, "[DbgInfoAction::%s] unknown argument \"%s\" (use \"sound\", \"profiling\", or \"cmddescrs\")", __func__, args.c_str());
+				LOG_L(L_WARNING, "[DbgInfoAction::%s] unknown argument \"%s\" (use \"sound\", \"profiling\", \"memory\", or \"cmddescrs\")", __func__, args.c_str());
 			} break;
 		}
 
@@ -114,6 +114,18 @@ bool LuaFeatureDefs::PushEntries(lua_State* L)
 }*/
 
 
+int LuaFeatureDefs::GetColumns(lua_State* L)
+{
+	if (paramMap.empty())
+		InitParamMap();
+
+	const auto& defsVec = featureDefHandler->GetFeatureDefsVec();
+
+	// ID 0 is the dummy def
+	return LuaUtils::PushDefColumns(L, paramMap, reinterpret_cast<const char*>(defsVec.data()), sizeof(FeatureDef), 1, defsVec.size());
+}
+
+
 /******************************************************************************/
 
 static int FeatureDefIndex(lua_State* L)
@@ -10,6 +10,9 @@ struct lua_State;
 class LuaFeatureDefs {
 public:
 	static bool PushEntries(lua_State* L);
+
+	/// Spring.GetFeatureDefsColumns
+	static int GetColumns(lua_State* L);
 };
 
 #endif /* LUA_FEATUREDEFS_H */
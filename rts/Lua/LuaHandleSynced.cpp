@@ -51,6 +51,8 @@
 #include "System/SpringMath.h"
 #include "System/LoadLock.h"
 
+#include <utility>
+
 
 
 LuaRulesParams::Params  CSplitLuaHandle::gameParams;
@@ -192,6 +194,72 @@ void CUnsyncedLuaHandle::RecvFromSynced(lua_State* srcState, int args)
 	RunCallIn(L, cmdStr, args, 0);
 }
 
+
+/*** Receives all data sent via `QueueToUnsynced` callout since the previous call, once per frame.
+ *
+ * Each message is a table holding the arguments of one `QueueToUnsynced` call
+ * as its array part, plus their count (including nil's) in field `n`.
+ *
+ * @function RecvFromSyncedQueued
+ * @tparam {table,...} messages in the order they were queued
+ */
+void CUnsyncedLuaHandle::RecvFromSyncedQueued()
+{
+	if (numQueuedMessages == 0)
+		return;
+
+	const size_t numMessages = std::exchange(numQueuedMessages, 0);
+
+	if (!IsValid())
+		return;
+
+	LUA_CALL_IN_CHECK(L);
+	luaL_checkstack(L, 5, __func__);
+
+	static const LuaHashString cmdStr(__func__);
+	if (!cmdStr.GetGlobalFunc(L))
+		return; // the call is not defined (anymore)
+
+	lua_createtable(L, numMessages, 0);
+
+	for (size_t i = 0; i < numMessages; i++) {
+		const std::vector<LuaUtils::DataDump>& args = queuedMessages[i];
+		const int numArgs = args.size();
+
+		lua_createtable(L, numArgs, 1);
+		LuaUtils::Restore(args, L);
+
+		// top of the stack holds the last argument
+		for (int j = numArgs; j > 0; j--) {
+			lua_rawseti(L, -(j + 1), j);
+		}
+
+		lua_pushnumber(L, numArgs);
+		lua_setfield(L, -2, "n");
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	// call the routine
+	RunCallIn(L, cmdStr, 1, 0);
+}
+
+void CUnsyncedLuaHandle::QueueFromSynced(lua_State* srcState, int args)
+{
+	static const std::string cmdName = "RecvFromSyncedQueued";
+
+	// nothing would receive it, skip copying (e.g. headless runs without unsynced gadgets)
+	if (!HasCallIn(L, cmdName))
+		return;
+
+	if (numQueuedMessages == queuedMessages.size())
+		queuedMessages.emplace_back();
+
+	std::vector<LuaUtils::DataDump>& message = queuedMessages[numQueuedMessages++];
+
+	message.clear();
+	LuaUtils::Backup(message, srcState, args);
+}
+
 /*** Custom Object Rendering
  *
  * For the following calls drawMode can be one of the following, notDrawing = 0, normalDraw = 1, shadowDraw = 2, reflectionDraw = 3, refractionDraw = 4, and finally gameDeferredDraw = 5 which was added in 102.0.
@@ -464,6 +532,7 @@ bool CSyncedLuaHandle::Init(const std::string& code, const std::string& file)
 
 	// add the custom file loader
 	LuaPushNamedCFunc(L, "SendToUnsynced", SendToUnsynced);
+	LuaPushNamedCFunc(L, "QueueToUnsynced", QueueToUnsynced);
 	LuaPushNamedCFunc(L, "CallAsTeam",     CSplitLuaHandle::CallAsTeam);
 	LuaPushNamedNumber(L, "COBSCALE",      COBSCALE);
 
@@ -1715,6 +1784,43 @@ int CSyncedLuaHandle::SendToUnsynced(lua_State* L)
 }
 
 
+int CSyncedLuaHandle::QueueToUnsynced(lua_State* L)
+{
+	const int args = lua_gettop(L);
+	if (args <= 0) {
+		luaL_error(L, "Incorrect arguments to QueueToUnsynced()");
+	}
+
+	static const int supportedTypes =
+		  (1 << LUA_TNIL)
+		| (1 << LUA_TBOOLEAN)
+		| (1 << LUA_TNUMBER)
+		| (1 << LUA_TSTRING)
+	;
+
+	for (int i = 1; i <= args; i++) {
+		const int t = (1 << lua_type(L, i));
+
+		if (t & supportedTypes)
+			continue;
+
+		if (t != (1 << LUA_TTABLE))
+			luaL_error(L, "Incorrect data type for QueueToUnsynced(), arg %d", i);
+
+		// tables have to be flat, keys and values are limited to the same types
+		for (lua_pushnil(L); lua_next(L, i) != 0; lua_pop(L, 1)) {
+			if (!((1 << lua_type(L, -2)) & supportedTypes) || !((1 << lua_type(L, -1)) & supportedTypes))
+				luaL_error(L, "Incorrect data type for QueueToUnsynced(), arg %d contains a table or other non-basic type", i);
+		}
+	}
+
+	// delivered at the end of the frame, see CGame::SimFrame
+	CUnsyncedLuaHandle* ulh = CSplitLuaHandle::GetUnsyncedHandle(L);
+	ulh->QueueFromSynced(L, args);
+	return 0;
+}
+
+
 int CSyncedLuaHandle::AddSyncedActionFallback(lua_State* L)
 {
 	std::string cmdRaw = "/" + std::string(luaL_checkstring(L, 1));
@@ -4,9 +4,11 @@
 #define LUA_HANDLE_SYNCED
 
 #include <string>
+#include <vector>
 
 #include "LuaHandle.h"
 #include "LuaRulesParams.h"
+#include "LuaUtils.h"
 #include "System/UnorderedMap.hpp"
 
 struct lua_State;
@@ -28,6 +30,9 @@ class CUnsyncedLuaHandle : public CLuaHandle
 
 	public: // all non-eventhandler callins
 		void RecvFromSynced(lua_State* srcState, int args); // not an engine call-in
+		void RecvFromSyncedQueued(); // not an engine call-in
+
+		void QueueFromSynced(lua_State* srcState, int args);
 
 	protected:
 		CUnsyncedLuaHandle(CSplitLuaHandle* base, const std::string& name, int order);
@@ -42,6 +47,12 @@ class CUnsyncedLuaHandle : public CLuaHandle
 
 	protected:
 		CSplitLuaHandle& base;
+
+	private:
+		// messages queued by QueueToUnsynced since the last delivery; inner
+		// vectors are kept around so steady traffic does not reallocate them
+		std::vector< std::vector<LuaUtils::DataDump> > queuedMessages;
+		size_t numQueuedMessages = 0;
 };
 
 
@@ -146,6 +157,7 @@ class CSyncedLuaHandle : public CLuaHandle
 		static int SyncedPairs(lua_State* L);
 
 		static int SendToUnsynced(lua_State* L);
+		static int QueueToUnsynced(lua_State* L);
 
 		static int AddSyncedActionFallback(lua_State* L);
 		static int RemoveSyncedActionFallback(lua_State* L);
@@ -183,6 +195,10 @@ class CSplitLuaHandle
 			return syncedLuaHandle.RecvLuaMsg(msg, playerID);
 		}
 
+		void DeliverQueuedToUnsynced() {
+			unsyncedLuaHandle.RecvFromSyncedQueued();
+		}
+
 	public:
 		void CheckStack() {
 			syncedLuaHandle.CheckStack();
@@ -553,6 +553,7 @@ static int SetSolidObjectCollisionVolumeData(lua_State* L, CSolidObject* o)
 	if (o == nullptr)
 		return 0;
 
+	CSolidObject::GeometryChanged();
 	return LuaUtils::ParseColVolData(L, 2, &o->collisionVolume);
 }
 
@@ -701,6 +702,7 @@ static int SetSolidObjectPieceCollisionVolumeData(lua_State* L, CSolidObject* ob
 	// piece volumes are not allowed to use discrete hit-testing
 	vol->InitShape(scales, offset, vType, CollisionVolume::COLVOL_HITTEST_CONT, pAxis);
 	vol->SetIgnoreHits(!luaL_checkboolean(L, 3));
+	lmp->AddTreeChange();
 	return 0;
 }
 
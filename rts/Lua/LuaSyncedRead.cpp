@@ -5,13 +5,16 @@
 #include "LuaInclude.h"
 
 #include "LuaConfig.h"
+#include "LuaFeatureDefs.h"
 #include "LuaHandle.h"
 #include "LuaHashString.h"
 #include "LuaMetalMap.h"
 #include "LuaPathFinder.h"
 #include "LuaRules.h"
 #include "LuaRulesParams.h"
+#include "LuaUnitDefs.h"
 #include "LuaUtils.h"
+#include "LuaWeaponDefs.h"
 #include "ExternalAI/SkirmishAIHandler.h"
 #include "Game/Game.h"
 #include "Game/GameSetup.h"
@@ -173,6 +176,7 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetUnitsInPlanes);
 	REGISTER_LUA_CFUNC(GetUnitsInSphere);
 	REGISTER_LUA_CFUNC(GetUnitsInCylinder);
+	REGISTER_LUA_CFUNC(GetUnitsInShapes);
 
 	REGISTER_LUA_CFUNC(GetFeaturesInRectangle);
 	REGISTER_LUA_CFUNC(GetFeaturesInSphere);
@@ -241,6 +245,10 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetUnitSeparation);
 	REGISTER_LUA_CFUNC(GetUnitFeatureSeparation);
 	REGISTER_LUA_CFUNC(GetUnitDefDimensions);
+
+	REGISTER_NAMED_LUA_CFUNC("GetUnitDefsColumns", LuaUnitDefs::GetColumns);
+	REGISTER_NAMED_LUA_CFUNC("GetWeaponDefsColumns", LuaWeaponDefs::GetColumns);
+	REGISTER_NAMED_LUA_CFUNC("GetFeatureDefsColumns", LuaFeatureDefs::GetColumns);
 	REGISTER_LUA_CFUNC(GetUnitCollisionVolumeData);
 	REGISTER_LUA_CFUNC(GetUnitPieceCollisionVolumeData);
 
@@ -326,6 +334,7 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(TestBuildOrder);
 	REGISTER_LUA_CFUNC(Pos2BuildPos);
 	REGISTER_LUA_CFUNC(ClosestBuildPos);
+	REGISTER_LUA_CFUNC(ClosestBuildPositions);
 
 	REGISTER_LUA_CFUNC(GetPositionLosState);
 	REGISTER_LUA_CFUNC(IsPosInLos);
@@ -2785,6 +2794,330 @@ int LuaSyncedRead::GetUnitsInPlanes(lua_State* L)
 }
 
 
+/******************************************************************************/
+//
+//  Batched Spatial Unit Queries
+//
+
+namespace {
+	struct AreaQueryShape {
+		enum {
+			SHAPE_RECTANGLE,
+			SHAPE_BOX,
+			SHAPE_CYLINDER,
+			SHAPE_SPHERE,
+			SHAPE_PLANES,
+		};
+
+		int type = SHAPE_RECTANGLE;
+
+		// rectangle and box: {xmin, ymin, zmin}, {xmax, ymax, zmax}
+		// cylinder and sphere: {x, y, z}, {radius, radius^2, -}
+		float3 mins;
+		float3 maxs;
+
+		// planes: [firstPlane, firstPlane + numPlanes) in AreaQueryState::planes
+		size_t firstPlane = 0;
+		size_t numPlanes = 0;
+	};
+
+	// everything the per-shape workers need, resolved on the Lua thread
+	struct AreaQueryState {
+		std::vector<AreaQueryShape> shapes;
+		std::vector<Plane> planes;
+		std::vector< std::vector<int> > results;
+
+		int allegiance = LuaUtils::AllUnits;
+		int readTeam = 0;
+		int readAllyTeam = 0;
+		bool fullRead = false;
+	};
+
+	// only touched by the thread running Lua; results are reused
+	AreaQueryState areaQueryState;
+}
+
+
+// mirrors LuaUtils::IsAlliedAllyTeam and LuaUtils::IsUnitVisible
+static inline bool AreaQueryIsAllyUnit(const AreaQueryState& aqs, const CUnit* unit)
+{
+	if (aqs.readAllyTeam < 0)
+		return aqs.fullRead;
+
+	return (unit->allyteam == aqs.readAllyTeam);
+}
+
+static inline bool AreaQueryIsUnitVisible(const AreaQueryState& aqs, const CUnit* unit)
+{
+	if (AreaQueryIsAllyUnit(aqs, unit))
+		return true;
+	if (aqs.readAllyTeam < 0)
+		return false;
+
+	return (unit->losStatus[aqs.readAllyTeam] & (LOS_INLOS | LOS_INRADAR));
+}
+
+static inline bool AreaQueryIsAlliedTeam(const AreaQueryState& aqs, int team)
+{
+	if (aqs.readAllyTeam < 0)
+		return aqs.fullRead;
+
+	return (teamHandler.AllyTeam(team) == aqs.readAllyTeam);
+}
+
+// same semantics as the allegiance tests used by GetUnitsIn{Rectangle,Box,Cylinder,Sphere}
+static inline bool AreaQueryAllegianceTest(const AreaQueryState& aqs, const CUnit* unit)
+{
+	switch (aqs.allegiance) {
+		case LuaUtils::MyUnits   : { return (unit->team == aqs.readTeam); } break;
+		case LuaUtils::AllyUnits : { return (unit->allyteam == aqs.readAllyTeam); } break;
+		case LuaUtils::EnemyUnits: { return (unit->allyteam != aqs.readAllyTeam && AreaQueryIsUnitVisible(aqs, unit)); } break;
+		case LuaUtils::AllUnits  : { return (AreaQueryIsUnitVisible(aqs, unit)); } break;
+		default: {} break;
+	}
+
+	if (unit->team != aqs.allegiance)
+		return false;
+
+	return (AreaQueryIsAlliedTeam(aqs, aqs.allegiance) || AreaQueryIsUnitVisible(aqs, unit));
+}
+
+static inline bool AreaQueryShapeTest(const AreaQueryState& aqs, const AreaQueryShape& shape, const CUnit* unit)
+{
+	const float3& p = unit->midPos;
+
+	switch (shape.type) {
+		case AreaQueryShape::SHAPE_RECTANGLE: {
+			return true;
+		} break;
+		case AreaQueryShape::SHAPE_BOX: {
+			return (p.y >= shape.mins.y && p.y <= shape.maxs.y);
+		} break;
+		case AreaQueryShape::SHAPE_CYLINDER: {
+			return (p.SqDistance2D(shape.mins) <= shape.maxs.y);
+		} break;
+		case AreaQueryShape::SHAPE_SPHERE: {
+			const float dx = (p.x - shape.mins.x);
+			const float dy = (p.y - shape.mins.y);
+			const float dz = (p.z - shape.mins.z);
+			return (((dx * dx) + (dy * dy) + (dz * dz)) <= shape.maxs.y);
+		} break;
+		default: {
+			assert(false);
+		} break;
+	}
+
+	return false;
+}
+
+static void ExecuteAreaQuery(const AreaQueryState& aqs, const AreaQueryShape& shape, std::vector<int>& result)
+{
+	result.clear();
+
+	if (shape.type == AreaQueryShape::SHAPE_PLANES) {
+		const std::vector<Plane> planes = {aqs.planes.begin() + shape.firstPlane, aqs.planes.begin() + shape.firstPlane + shape.numPlanes};
+
+		int startTeam = 0;
+		int endTeam = teamHandler.ActiveTeams() - 1;
+
+		if (aqs.allegiance >= 0) {
+			startTeam = aqs.allegiance;
+			endTeam = aqs.allegiance;
+		} else if (aqs.allegiance == LuaUtils::MyUnits) {
+			startTeam = aqs.readTeam;
+			endTeam = aqs.readTeam;
+		}
+
+		// same team-level logic as GetUnitsInPlanes
+		for (int team = startTeam; team <= endTeam; team++) {
+			bool visibleTest = false;
+
+			switch (aqs.allegiance) {
+				case LuaUtils::MyUnits   : {                                                                          } break;
+				case LuaUtils::AllyUnits : { if (aqs.readAllyTeam != teamHandler.AllyTeam(team)) continue;             } break;
+				case LuaUtils::EnemyUnits: { if (aqs.readAllyTeam == teamHandler.AllyTeam(team)) continue; visibleTest = true; } break;
+				case LuaUtils::AllUnits  : { visibleTest = !AreaQueryIsAlliedTeam(aqs, team);                          } break;
+				default                  : { visibleTest = !AreaQueryIsAlliedTeam(aqs, team);                          } break;
+			}
+
+			for (const CUnit* unit: unitHandler.GetUnitsByTeam(team)) {
+				if (visibleTest && !AreaQueryIsUnitVisible(aqs, unit))
+					continue;
+				if (!UnitInPlanes(unit, planes))
+					continue;
+
+				result.push_back(unit->id);
+			}
+		}
+
+		return;
+	}
+
+	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = ThreadPool::GetThreadNum();
+
+	if (shape.type == AreaQueryShape::SHAPE_CYLINDER || shape.type == AreaQueryShape::SHAPE_SPHERE) {
+		const float radius = shape.maxs.x;
+		quadField.GetUnitsExact(qfQuery, shape.mins - float3(radius, 0.0f, radius), shape.mins + float3(radius, 0.0f, radius));
+	} else {
+		quadField.GetUnitsExact(qfQuery, shape.mins, shape.maxs);
+	}
+
+	for (const CUnit* unit: *qfQuery.units) {
+		if (!AreaQueryAllegianceTest(aqs, unit))
+			continue;
+		if (!AreaQueryShapeTest(aqs, shape, unit))
+			continue;
+
+		result.push_back(unit->id);
+	}
+}
+
+
+/***
+ * Evaluates many unit area queries in one call, in parallel.
+ *
+ * shapes is an array of {"rectangle", xmin, zmin, xmax, zmax},
+ * {"box", xmin, ymin, zmin, xmax, ymax, zmax}, {"cylinder", x, z, radius},
+ * {"sphere", x, y, z, radius} or {"planes", {a, b, c, d}, ...} entries.
+ * Each shape yields exactly the units the corresponding GetUnitsIn* call
+ * would. The results are returned as one flat array of unitIDs plus an
+ * offsets array, where the units of shape i are at
+ * unitIDs[offsets[i]] ... unitIDs[offsets[i + 1] - 1].
+ *
+ * @function Spring.GetUnitsInShapes
+ * @tparam table shapes
+ * @number[opt] teamID or allegiance (see GetUnitsInRectangle)
+ * @treturn table unitIDs
+ * @treturn table offsets (#shapes + 1 entries)
+ */
+int LuaSyncedRead::GetUnitsInShapes(lua_State* L)
+{
+	luaL_checktype(L, 1, LUA_TTABLE);
+
+	AreaQueryState& aqs = areaQueryState;
+
+	aqs.shapes.clear();
+	aqs.planes.clear();
+
+	aqs.allegiance = LuaUtils::ParseAllegiance(L, __func__, 2);
+	aqs.readTeam = CLuaHandle::GetHandleReadTeam(L);
+	aqs.readAllyTeam = CLuaHandle::GetHandleReadAllyTeam(L);
+	aqs.fullRead = CLuaHandle::GetHandleFullRead(L);
+
+	for (int i = 1, n = lua_objlen(L, 1); i <= n; i++) {
+		lua_rawgeti(L, 1, i);
+
+		if (!lua_istable(L, -1))
+			luaL_error(L, "[%s] shape %d is not a table", __func__, i);
+
+		lua_rawgeti(L, -1, 1);
+
+		const char* shapeName = luaL_checkstring(L, -1);
+		const int shapeTable = lua_gettop(L) - 1;
+
+		float v[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+
+		const auto ParseValues = [&](int count) {
+			for (int j = 0; j < count; j++) {
+				lua_rawgeti(L, shapeTable, j + 2);
+
+				if (!lua_isnumber(L, -1))
+					luaL_error(L, "[%s] shape %d (%s) needs %d numbers", __func__, i, shapeName, count);
+
+				v[j] = lua_tofloat(L, -1);
+				lua_pop(L, 1);
+			}
+		};
+
+		AreaQueryShape shape;
+
+		switch (hashString(shapeName)) {
+			case hashString("rectangle"): {
+				ParseValues(4);
+				shape.type = AreaQueryShape::SHAPE_RECTANGLE;
+				shape.mins = {v[0], 0.0f, v[1]};
+				shape.maxs = {v[2], 0.0f, v[3]};
+			} break;
+			case hashString("box"): {
+				ParseValues(6);
+				shape.type = AreaQueryShape::SHAPE_BOX;
+				shape.mins = {v[0], v[1], v[2]};
+				shape.maxs = {v[3], v[4], v[5]};
+			} break;
+			case hashString("cylinder"): {
+				ParseValues(3);
+				shape.type = AreaQueryShape::SHAPE_CYLINDER;
+				shape.mins = {v[0], 0.0f, v[1]};
+				shape.maxs = {v[2], v[2] * v[2], 0.0f};
+			} break;
+			case hashString("sphere"): {
+				ParseValues(4);
+				shape.type = AreaQueryShape::SHAPE_SPHERE;
+				shape.mins = {v[0], v[1], v[2]};
+				shape.maxs = {v[3], v[3] * v[3], 0.0f};
+			} break;
+			case hashString("planes"): {
+				shape.type = AreaQueryShape::SHAPE_PLANES;
+				shape.firstPlane = aqs.planes.size();
+
+				for (int j = 2, m = lua_objlen(L, shapeTable); j <= m; j++) {
+					lua_rawgeti(L, shapeTable, j);
+
+					if (lua_istable(L, -1) && LuaUtils::ParseFloatArray(L, -1, v, 4) == 4)
+						aqs.planes.push_back({v[0], v[1], v[2], v[3]});
+
+					lua_pop(L, 1);
+				}
+
+				shape.numPlanes = aqs.planes.size() - shape.firstPlane;
+			} break;
+			default: {
+				luaL_error(L, "[%s] unknown shape \"%s\"", __func__, shapeName);
+			} break;
+		}
+
+		aqs.shapes.push_back(shape);
+		lua_pop(L, 2);
+	}
+
+	if (aqs.results.size() < aqs.shapes.size())
+		aqs.results.resize(aqs.shapes.size());
+
+	// read-only w.r.t. the simulation; each worker uses its own quadfield arena
+	for_mt(0, aqs.shapes.size(), [&aqs](const int i) {
+		ExecuteAreaQuery(aqs, aqs.shapes[i], aqs.results[i]);
+	});
+
+	size_t numUnitIDs = 0;
+
+	for (size_t i = 0; i < aqs.shapes.size(); i++) {
+		numUnitIDs += aqs.results[i].size();
+	}
+
+	lua_createtable(L, numUnitIDs, 0);
+
+	for (size_t i = 0, count = 0; i < aqs.shapes.size(); i++) {
+		for (const int unitID: aqs.results[i]) {
+			lua_pushnumber(L, unitID);
+			lua_rawseti(L, -2, ++count);
+		}
+	}
+
+	lua_createtable(L, aqs.shapes.size() + 1, 0);
+
+	for (size_t i = 0, offset = 1; i <= aqs.shapes.size(); i++) {
+		lua_pushnumber(L, offset);
+		lua_rawseti(L, -2, i + 1);
+
+		if (i < aqs.shapes.size())
+			offset += aqs.results[i].size();
+	}
+
+	return 2;
+}
+
+
 /******************************************************************************/
 
 int LuaSyncedRead::GetUnitNearestAlly(lua_State* L)
@@ -5736,6 +6069,62 @@ int LuaSyncedRead::ClosestBuildPos(lua_State* L)
 	return 3;
 }
 
+/***
+ * Batched version of ClosestBuildPos
+ *
+ * Every query is a table {teamID, unitDefID, worldX, worldY, worldZ,
+ * searchRadius, minDist[, buildFacing]} taking the same arguments as
+ * ClosestBuildPos. The results are identical to issuing the ClosestBuildPos
+ * calls one after another, but the candidate positions are tested against
+ * a shared blocking grid and in parallel.
+ *
+ * @function Spring.ClosestBuildPositions
+ * @tparam table queries
+ * @treturn table positions flat array, query i is at positions[3*i-2 ... 3*i]
+ *   ({-1, 0, 0} when no position was found)
+ */
+int LuaSyncedRead::ClosestBuildPositions(lua_State* L)
+{
+	luaL_checktype(L, 1, LUA_TTABLE);
+
+	static std::vector<CGameHelper::BuildPosQuery> queries;
+	static std::vector<float3> results;
+
+	queries.clear();
+
+	for (int i = 1, n = lua_objlen(L, 1); i <= n; i++) {
+		lua_rawgeti(L, 1, i);
+
+		float v[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+
+		if (!lua_istable(L, -1) || LuaUtils::ParseFloatArray(L, -1, v, 8) < 7)
+			luaL_error(L, "[%s] query %d needs at least 7 numbers", __func__, i);
+
+		lua_pop(L, 1);
+
+		CGameHelper::BuildPosQuery& q = queries.emplace_back();
+
+		q.unitDef = unitDefHandler->GetUnitDefByID(v[1]);
+		q.worldPos = {v[2], v[3], v[4]};
+		q.searchRadius = v[5];
+		q.team = v[0];
+		q.minDistance = v[6];
+		q.buildFacing = v[7];
+	}
+
+	CGameHelper::ClosestBuildPositions(queries, results, CLuaHandle::GetHandleSynced(L));
+
+	lua_createtable(L, results.size() * 3, 0);
+
+	for (size_t i = 0; i < results.size(); i++) {
+		lua_pushnumber(L, results[i].x); lua_rawseti(L, -2, i * 3 + 1);
+		lua_pushnumber(L, results[i].y); lua_rawseti(L, -2, i * 3 + 2);
+		lua_pushnumber(L, results[i].z); lua_rawseti(L, -2, i * 3 + 3);
+	}
+
+	return 1;
+}
+
 
 /******************************************************************************/
 /******************************************************************************/
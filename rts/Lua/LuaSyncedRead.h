@@ -85,6 +85,7 @@ class LuaSyncedRead {
 		static int GetUnitsInPlanes(lua_State* L);
 		static int GetUnitsInSphere(lua_State* L);
 		static int GetUnitsInCylinder(lua_State* L);
+		static int GetUnitsInShapes(lua_State* L);
 
 		static int GetUnitNearestAlly(lua_State* L);
 		static int GetUnitNearestEnemy(lua_State* L);
@@ -241,6 +242,7 @@ class LuaSyncedRead {
 		static int TestBuildOrder(lua_State* L);
 		static int Pos2BuildPos(lua_State* L);
 		static int ClosestBuildPos(lua_State* L);
+		static int ClosestBuildPositions(lua_State* L);
 
 		static int GetPositionLosState(lua_State* L);
 		static int IsPosInLos(lua_State* L);
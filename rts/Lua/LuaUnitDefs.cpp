@@ -90,6 +90,18 @@ bool LuaUnitDefs::PushEntries(lua_State* L)
 
 
 
+int LuaUnitDefs::GetColumns(lua_State* L)
+{
+	if (paramMap.empty())
+		InitParamMap();
+
+	const auto& defsVec = unitDefHandler->GetUnitDefsVec();
+
+	// ID 0 is the dummy def
+	return LuaUtils::PushDefColumns(L, paramMap, reinterpret_cast<const char*>(defsVec.data()), sizeof(UnitDef), 1, defsVec.size());
+}
+
+
 /******************************************************************************/
 
 static int UnitDefIndex(lua_State* L)
@@ -10,6 +10,9 @@ struct lua_State;
 class LuaUnitDefs {
 public:
 	static bool PushEntries(lua_State* L);
+
+	/// Spring.GetUnitDefsColumns
+	static int GetColumns(lua_State* L);
 };
 
 #endif /* LUA_UNITDEFS_H */
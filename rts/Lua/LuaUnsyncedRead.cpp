@@ -54,6 +54,7 @@
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/QuadField.h"
+#include "Sim/Misc/ResourceHandler.h"
 #include "Sim/Projectiles/Projectile.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitHandler.h"
@@ -106,6 +107,8 @@ bool LuaUnsyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetLuaMemUsage);
 	REGISTER_LUA_CFUNC(GetVidMemUsage);
 
+	REGISTER_LUA_CFUNC(IsResourceMapAnalyzed);
+
 	REGISTER_LUA_CFUNC(GetDrawFrame);
 	REGISTER_LUA_CFUNC(GetFrameTimeOffset);
 	REGISTER_LUA_CFUNC(GetLastUpdateSeconds);
@@ -519,6 +522,23 @@ int LuaUnsyncedRead::GetVidMemUsage(lua_State* L)
 }
 
 
+int LuaUnsyncedRead::IsResourceMapAnalyzed(lua_State* L)
+{
+	// extractor spots are searched for in the background during loading
+	const std::string& resourceName = StringToLower(luaL_optstring(L, 1, "metal"));
+
+	for (size_t resourceId = 0; resourceId < resourceHandler->GetNumResources(); resourceId++) {
+		if (StringToLower(resourceHandler->GetResource(resourceId)->name) != resourceName)
+			continue;
+
+		lua_pushboolean(L, resourceHandler->IsResourceMapAnalyzed(resourceId));
+		return 1;
+	}
+
+	return 0;
+}
+
+
 /******************************************************************************/
 
 int LuaUnsyncedRead::GetNumDisplays(lua_State* L)
@@ -1210,6 +1210,67 @@ int LuaUtils::Next(const ParamMap& paramMap, lua_State* L)
 }
 
 
+int LuaUtils::PushDefColumns(lua_State* L, const ParamMap& paramMap, const char* defsData, size_t defSize, int minDefID, int endDefID)
+{
+	const int numKeys = lua_gettop(L);
+	const int numDefs = std::max(0, endDefID - minDefID);
+
+	luaL_checkstack(L, numKeys + 4, __func__);
+
+	// one flat array per key, indexed by def ID and holding what
+	// the def proxies' __index would return for it, so callers do
+	// not need a metatable lookup per def and attribute
+	for (int i = 1; i <= numKeys; i++) {
+		const char* key = luaL_checkstring(L, i);
+		const ParamMap::const_iterator it = paramMap.find(key);
+
+		if (it == paramMap.end() || it->second.deprecated || it->second.type == READONLY_TYPE || it->second.type == ERROR_TYPE)
+			luaL_error(L, "[%s] \"%s\" is not a def attribute", __func__, key);
+
+		const DataElement& elem = it->second;
+
+		lua_createtable(L, numDefs, (minDefID == 0));
+
+		for (int defID = minDefID; defID < endDefID; defID++) {
+			const char* p = defsData + defID * defSize + elem.offset;
+
+			switch (elem.type) {
+				case INT_TYPE: {
+					lua_pushnumber(L, *reinterpret_cast<const int*>(p));
+				} break;
+				case BOOL_TYPE: {
+					lua_pushboolean(L, *reinterpret_cast<const bool*>(p));
+				} break;
+				case FLOAT_TYPE: {
+					lua_pushnumber(L, *reinterpret_cast<const float*>(p));
+				} break;
+				case STRING_TYPE: {
+					lua_pushsstring(L, *reinterpret_cast<const std::string*>(p));
+				} break;
+				case FUNCTION_TYPE: {
+					const int top = lua_gettop(L);
+
+					// keep the first result, like an __index call would
+					if (elem.func(L, p) > 0) {
+						lua_settop(L, top + 1);
+					} else {
+						lua_settop(L, top);
+						lua_pushnil(L);
+					}
+				} break;
+				default: {
+					lua_pushnil(L);
+				} break;
+			}
+
+			lua_rawseti(L, -2, defID);
+		}
+	}
+
+	return numKeys;
+}
+
+
 /******************************************************************************/
 /******************************************************************************/
 
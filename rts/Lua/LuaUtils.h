@@ -149,6 +149,8 @@ class LuaUtils {
 		// from LuaFeatureDefs.cpp / LuaUnitDefs.cpp / LuaWeaponDefs.cpp
 		// (helper for the Next() iteration routine)
 		static int Next(const ParamMap& paramMap, lua_State* L);
+		// (helper for the Get*DefsColumns routines)
+		static int PushDefColumns(lua_State* L, const ParamMap& paramMap, const char* defsData, size_t defSize, int minDefID, int endDefID);
 
 		// from LuaParser.cpp / LuaUnsyncedCtrl.cpp
 		// (implementation copied from lua/src/lib/lbaselib.c)
@@ -90,6 +90,18 @@ bool LuaWeaponDefs::PushEntries(lua_State* L)
 }
 
 
+int LuaWeaponDefs::GetColumns(lua_State* L)
+{
+	if (paramMap.empty())
+		InitParamMap();
+
+	const auto& defsVec = weaponDefHandler->GetWeaponDefsVec();
+
+	// IDs start at 0
+	return LuaUtils::PushDefColumns(L, paramMap, reinterpret_cast<const char*>(defsVec.data()), sizeof(WeaponDef), 0, defsVec.size());
+}
+
+
 /******************************************************************************/
 
 static int WeaponDefIndex(lua_State* L)
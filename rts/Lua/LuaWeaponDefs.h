@@ -8,6 +8,9 @@ struct lua_State;
 class LuaWeaponDefs {
 public:
 	static bool PushEntries(lua_State* L);
+
+	/// Spring.GetWeaponDefsColumns
+	static int GetColumns(lua_State* L);
 };
 
 #endif /* LUA_WEAPONDEFS_H */
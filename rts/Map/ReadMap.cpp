@@ -163,8 +163,36 @@ CReadMap* CReadMap::LoadMap(const std::string& mapName)
 	MapBitmapInfo mbi;
 	MapBitmapInfo tbi;
 
-	unsigned char* metalmapPtr = rm->GetInfoMap("metal", &mbi);
-	unsigned char* typemapPtr = rm->GetInfoMap("type", &tbi);
+	unsigned char* metalmapPtr = nullptr;
+	unsigned char* typemapPtr = nullptr;
+
+	// exceptions must not escape a pool task, thrown on the calling thread below
+	std::string taskErrors[2];
+
+	// independent sections (and possibly override-textures), fetch them concurrently
+	for_mt(0, 2, [&](const int i) {
+		try {
+			switch (i) {
+				case 0: { metalmapPtr = rm->GetInfoMap("metal", &mbi); } break;
+				case 1: { typemapPtr  = rm->GetInfoMap("type" , &tbi); } break;
+				default: {} break;
+			}
+		} catch (const content_error& e) {
+			taskErrors[i] = e.what();
+		}
+	});
+
+	for (const std::string& taskError: taskErrors) {
+		if (taskError.empty())
+			continue;
+
+		if (metalmapPtr != nullptr)
+			rm->FreeInfoMap("metal", metalmapPtr);
+		if (typemapPtr != nullptr)
+			rm->FreeInfoMap("type", typemapPtr);
+
+		throw content_error(taskError);
+	}
 
 	assert(mbi.width == mapDims.hmapx);
 	assert(mbi.height == mapDims.hmapy);
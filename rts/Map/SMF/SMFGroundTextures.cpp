@@ -77,6 +77,8 @@ void CSMFGroundTextures::LoadTiles(CSMFMapFile& file)
 {
 	loadscreen->SetLoadMessage("Loading Map Tiles");
 
+	ScopedOnceTimer timer("CSMFGroundTextures::LoadTiles");
+
 	CFileHandler* ifs = file.GetFileHandler();
 	const SMFHeader& header = file.GetHeader();
 
@@ -113,6 +115,17 @@ void CSMFGroundTextures::LoadTiles(CSMFMapFile& file)
 		}
 	}
 
+	struct TileFileEntry {
+		std::string filePath;
+		std::string fallbackPath;
+		std::string error;
+
+		int firstTile;
+		int numTiles;
+	};
+
+	std::vector<TileFileEntry> tileFiles(tileHeader.numTileFiles);
+
 	for (int a = 0, curTile = 0; a < tileHeader.numTileFiles; ++a) {
 		int numSmallTiles = 0;
 		char fileNameBuffer[256] = {0};
@@ -121,42 +134,52 @@ void CSMFGroundTextures::LoadTiles(CSMFMapFile& file)
 		ifs->ReadString(&fileNameBuffer[0], sizeof(char) * (sizeof(fileNameBuffer) - 1));
 		swabDWordInPlace(numSmallTiles);
 
-		std::string smtFileName = fileNameBuffer;
-		std::string smtFilePath = (!smtHeaderOverride)?
-			(smfDir + smtFileName):
-			(smfDir + smf.smtFileNames[a]);
+		const std::string smtFileName = (!smtHeaderOverride)? fileNameBuffer: smf.smtFileNames[a];
+
+		tileFiles[a] = {smfDir + smtFileName, smtFileName, "", curTile, numSmallTiles};
+		curTile += numSmallTiles;
+	}
+
+	// the tile-files are independent of each other and each fill their own range of tiles
+	for_mt(0, tileHeader.numTileFiles, [&](const int a) {
+		TileFileEntry& entry = tileFiles[a];
 
+		std::string& smtFilePath = entry.filePath;
 		CFileHandler tileFile(smtFilePath);
 
 		// try absolute path
 		if (!tileFile.FileExists())
-			tileFile.Open(smtFilePath = (!smtHeaderOverride) ? smtFileName : smf.smtFileNames[a]);
+			tileFile.Open(smtFilePath = entry.fallbackPath);
 
 		if (!tileFile.FileExists()) {
 			LOG_L(L_WARNING,
 				"[SMFGroundTextures::%s] could not find .smt tile-file %d (\"%s\"; ALL %d SMALL TILES WILL BE MADE RED)",
-				__func__, a, smtFilePath.c_str(), numSmallTiles
+				__func__, a, smtFilePath.c_str(), entry.numTiles
 			);
 
-			memset(&tiles[curTile * SMALL_TILE_SIZE], 0xaa, numSmallTiles * SMALL_TILE_SIZE);
-			curTile += numSmallTiles;
-			continue;
+			memset(&tiles[entry.firstTile * SMALL_TILE_SIZE], 0xaa, entry.numTiles * SMALL_TILE_SIZE);
+			return;
 		}
 
 		TileFileHeader tfh;
 		CSMFMapFile::ReadMapTileFileHeader(tfh, tileFile);
 
 		if (strcmp(tfh.magic, "spring tilefile") != 0 || tfh.version != 1 || tfh.tileSize != 32 || tfh.compressionType != 1) {
-			std::string err = fmt::sprintf(
+			// thrown on the calling thread below
+			entry.error = fmt::sprintf(
 				"[SMFGroundTextures::%s] tile-file %d (path=\"%s\" magic=\"%s\" version=%d tileSize=%d comprType=%d) does not match .smt format",
 				__func__, a, smtFilePath.c_str(), tfh.magic, tfh.version, tfh.tileSize, tfh.compressionType
 			);
-			throw content_error(err);
+			return;
 		}
 
-		for (int b = 0; b < numSmallTiles; ++b) {
-			tileFile.Read(&tiles[(curTile++) * SMALL_TILE_SIZE], SMALL_TILE_SIZE);
-		}
+		// tiles are stored back to back
+		tileFile.Read(&tiles[entry.firstTile * SMALL_TILE_SIZE], entry.numTiles * SMALL_TILE_SIZE);
+	});
+
+	for (const TileFileEntry& entry: tileFiles) {
+		if (!entry.error.empty())
+			throw content_error(entry.error);
 	}
 
 	ifs->Read(&tileMap[0], smfMap->tileCount * sizeof(int));
@@ -7,9 +7,19 @@
 #include "System/StringHash.h"
 #include "System/Platform/byteorder.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 
+#ifdef _WIN32
+	#include "System/Platform/Win/win32.h"
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
 
 static bool CheckHeader(const SMFHeader& h)
 {
@@ -26,6 +36,23 @@ static bool CheckHeader(const SMFHeader& h)
 }
 
 
+/// read a float from memory (endian aware)
+static float ReadFloat(const std::uint8_t* data)
+{
+	float __tmpfloat = 0.0f;
+	std::memcpy(&__tmpfloat, data, sizeof(float));
+	return swabFloat(__tmpfloat);
+}
+
+/// read an int from memory (endian aware)
+static int ReadInt(const std::uint8_t* data)
+{
+	unsigned int __tmpdw = 0;
+	std::memcpy(&__tmpdw, data, sizeof(unsigned int));
+	return (int)swabDWord(__tmpdw);
+}
+
+
 void CSMFMapFile::Open(const std::string& mapFileName)
 {
 	char buf[512] = {0};
@@ -35,13 +62,38 @@ void CSMFMapFile::Open(const std::string& mapFileName)
 	memset(&featureHeader, 0, sizeof(featureHeader));
 	memset( featureTypes , 0, sizeof(featureTypes ));
 
-	ifs.Open(mapFileName);
+	// uncompressed maps (loose files or inside .sdd archives) can be mapped
+	// directly; those in compressed archives are already fully unpacked by
+	// the VFS, so sections are decoded straight from its buffer instead
+	const std::string& filePath = CFileHandler::GetFileAbsolutePath(mapFileName, SPRING_VFS_RAW_FIRST);
+
+	if (!filePath.empty() && MapFile(filePath)) {
+		// ifs only serves the legacy GetFileHandler users; keep it unbuffered
+		ifs.Open(filePath, SPRING_VFS_RAW);
+	} else {
+		ifs.Open(mapFileName);
+	}
 
 	if (!ifs.FileExists()) {
 		snprintf(buf, sizeof(buf), fmts[0], __func__, mapFileName.c_str());
 		throw content_error(buf);
 	}
 
+	if (!IsMapped()) {
+		if (!ifs.IsBuffered()) {
+			// mapping failed on a raw file; fall back to one bulk copy
+			fileBuffer.resize(ifs.FileSize());
+			ifs.Read(fileBuffer.data(), fileBuffer.size());
+			ifs.Seek(0);
+
+			fileData = fileBuffer.data();
+			fileDataSize = fileBuffer.size();
+		} else {
+			fileData = ifs.GetBuffer().data();
+			fileDataSize = ifs.GetBuffer().size();
+		}
+	}
+
 	ReadMapHeader(header, ifs);
 
 	if (CheckHeader(header))
@@ -54,6 +106,13 @@ void CSMFMapFile::Open(const std::string& mapFileName)
 void CSMFMapFile::Close()
 {
 	ifs.Close();
+	UnmapFile();
+
+	fileBuffer.clear();
+	fileBuffer.shrink_to_fit();
+
+	fileData = nullptr;
+	fileDataSize = 0;
 
 	memset(&       header, 0, sizeof(       header));
 	memset(&featureHeader, 0, sizeof(featureHeader));
@@ -63,10 +122,96 @@ void CSMFMapFile::Close()
 }
 
 
+bool CSMFMapFile::MapFile(const std::string& filePath)
+{
+	assert(mappedData == nullptr);
+
+#ifdef _WIN32
+	const HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+		CloseHandle(file);
+		return false;
+	}
+
+	const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (mapping != nullptr) {
+		mappedData = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		mappedSize = fileSize.QuadPart;
+
+		// the view keeps the mapping alive
+		CloseHandle(mapping);
+	}
+
+	CloseHandle(file);
+#else
+	const int fd = open(filePath.c_str(), O_RDONLY);
+
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+
+	if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+		close(fd);
+		return false;
+	}
+
+	if ((mappedData = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED)
+		mappedData = nullptr;
+
+	mappedSize = info.st_size;
+
+	// the mapping keeps the file alive
+	close(fd);
+#endif
+
+	if (mappedData == nullptr) {
+		mappedSize = 0;
+		return false;
+	}
+
+	fileData = reinterpret_cast<const std::uint8_t*>(mappedData);
+	fileDataSize = mappedSize;
+	return true;
+}
+
+void CSMFMapFile::UnmapFile()
+{
+	if (mappedData == nullptr)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(mappedData);
+#else
+	munmap(mappedData, mappedSize);
+#endif
+
+	mappedData = nullptr;
+	mappedSize = 0;
+}
+
+
+const std::uint8_t* CSMFMapFile::GetSectionData(int offset, size_t size) const
+{
+	if (offset >= 0 && (offset + size) <= fileDataSize)
+		return (fileData + offset);
+
+	char buf[256] = {0};
+	snprintf(buf, sizeof(buf), "[SMFMapFile::%s] section [%d, %d) exceeds file-size " _STPF_, __func__, offset, int(offset + size), fileDataSize);
+	throw content_error(buf);
+}
+
+
 void CSMFMapFile::ReadMinimap(void* data)
 {
-	ifs.Seek(header.minimapPtr);
-	ifs.Read(data, MINIMAP_SIZE);
+	std::memcpy(data, GetSectionData(header.minimapPtr, MINIMAP_SIZE), MINIMAP_SIZE);
 }
 
 int CSMFMapFile::ReadMinimap(std::vector<std::uint8_t>& data, unsigned miplevel)
@@ -81,8 +226,7 @@ int CSMFMapFile::ReadMinimap(std::vector<std::uint8_t>& data, unsigned miplevel)
 
 	data.resize(Square((mipsize + 3) / 4) * 8);
 
-	ifs.Seek(header.minimapPtr + offset);
-	ifs.Read(data.data(), data.size());
+	std::memcpy(data.data(), GetSectionData(header.minimapPtr + offset, data.size()), data.size());
 	return mipsize;
 }
 
@@ -94,8 +238,7 @@ void CSMFMapFile::ReadHeightmap(unsigned short* heightmap)
 	const int hmy = header.mapy + 1;
 	const int len = hmx * hmy;
 
-	ifs.Seek(header.heightmapPtr);
-	ifs.Read(heightmap, len * sizeof(unsigned short));
+	std::memcpy(heightmap, GetSectionData(header.heightmapPtr, len * sizeof(unsigned short)), len * sizeof(unsigned short));
 
 	for (int i = 0; i < len; ++i) {
 		swabWordInPlace(heightmap[i]);
@@ -104,22 +247,27 @@ void CSMFMapFile::ReadHeightmap(unsigned short* heightmap)
 
 
 void CSMFMapFile::ReadHeightmap(float* sHeightMap, float* uHeightMap, float base, float mod)
+{
+	ReadHeightmap(sHeightMap, uHeightMap, base, mod, 0, header.mapy + 1);
+}
+
+void CSMFMapFile::ReadHeightmap(float* sHeightMap, float* uHeightMap, float base, float mod, int rowBeg, int rowEnd)
 {
 	const int hmx = header.mapx + 1;
 	const int hmy = header.mapy + 1;
 	const int len = hmx * hmy;
 
-	unsigned short word = 0;
-
 	assert(sHeightMap != nullptr);
+	assert(rowBeg >= 0 && rowBeg <= rowEnd && rowEnd <= hmy);
 
 	if (uHeightMap == nullptr)
 		uHeightMap = sHeightMap;
 
-	ifs.Seek(header.heightmapPtr);
+	const std::uint8_t* words = GetSectionData(header.heightmapPtr, len * sizeof(unsigned short));
 
-	for (int i = 0; i < len; ++i) {
-		ifs.Read(&word, sizeof(word));
+	for (int i = rowBeg * hmx, n = rowEnd * hmx; i < n; ++i) {
+		unsigned short word = 0;
+		std::memcpy(&word, words + i * sizeof(word), sizeof(word));
 
 		sHeightMap[i] = base + swabWord(word) * mod;
 		uHeightMap[i] = sHeightMap[i];
@@ -129,8 +277,10 @@ void CSMFMapFile::ReadHeightmap(float* sHeightMap, float* uHeightMap, float base
 
 void CSMFMapFile::ReadFeatureInfo()
 {
-	ifs.Seek(header.featurePtr);
-	ReadMapFeatureHeader(featureHeader, ifs);
+	const std::uint8_t* data = GetSectionData(header.featurePtr, sizeof(int) * 2);
+
+	featureHeader.numFeatureType = ReadInt(data + sizeof(int) * 0);
+	featureHeader.numFeatures    = ReadInt(data + sizeof(int) * 1);
 
 	constexpr size_t S = sizeof(featureTypes   );
 	constexpr size_t K = sizeof(featureTypes[0]);
@@ -141,33 +291,39 @@ void CSMFMapFile::ReadFeatureInfo()
 		throw content_error(featureTypes[0]);
 	}
 
+	int offset = header.featurePtr + sizeof(int) * 2;
+
 	for (int a = 0; a < featureHeader.numFeatureType; ++a) {
 		char* featureType = featureTypes[a];
 
-		for (size_t j = 0, n = K - 1; j < n; j++) {
-			ifs.Read(&featureType[j], 1);
+		// names are 0-terminated; at most K - 1 chars (+ terminator) are consumed per name
+		const size_t maxLen = std::min(K, fileDataSize - std::min(fileDataSize, size_t(offset)));
+		const char* name = reinterpret_cast<const char*>(GetSectionData(offset, maxLen));
+		const size_t len = strnlen(name, std::min(maxLen, K - 1));
 
-			if (featureType[j] == 0)
-				break;
-		}
+		std::memcpy(featureType, name, len);
+		featureType[len] = 0;
+
+		offset += (len + (len < (K - 1)));
 	}
 
-	featureFileOffset = ifs.GetPos();
+	featureFileOffset = offset;
 }
 
 
 void CSMFMapFile::ReadFeatureInfo(MapFeatureInfo* f)
 {
 	assert(featureFileOffset != 0);
-	ifs.Seek(featureFileOffset);
 
-	for (int a = 0; a < featureHeader.numFeatures; ++a) {
-		MapFeatureStruct ffs;
-		ReadMapFeatureStruct(ffs, ifs);
+	constexpr size_t structSize = sizeof(int) + sizeof(float) * 5;
+
+	const std::uint8_t* data = GetSectionData(featureFileOffset, featureHeader.numFeatures * structSize);
 
-		f[a].featureType = ffs.featureType;
-		f[a].pos = float3(ffs.xpos, ffs.ypos, ffs.zpos);
-		f[a].rotation = ffs.rotation;
+	for (int a = 0; a < featureHeader.numFeatures; ++a, data += structSize) {
+		f[a].featureType = ReadInt(data);
+		f[a].pos = float3(ReadFloat(data + 4), ReadFloat(data + 8), ReadFloat(data + 12));
+		f[a].rotation = ReadFloat(data + 16);
+		// relativeSize (data + 20) is unused
 	}
 }
 
@@ -204,14 +360,12 @@ bool CSMFMapFile::ReadInfoMap(const char* name, void* data)
 		} break;
 
 		case hashString("metal"): {
-			ifs.Seek(header.metalmapPtr);
-			ifs.Read(data, header.mapx / 2 * header.mapy / 2);
+			std::memcpy(data, GetSectionData(header.metalmapPtr, header.mapx / 2 * header.mapy / 2), header.mapx / 2 * header.mapy / 2);
 			return true;
 		} break;
 
 		case hashString("type"): {
-			ifs.Seek(header.typeMapPtr);
-			ifs.Read(data, header.mapx / 2 * header.mapy / 2);
+			std::memcpy(data, GetSectionData(header.typeMapPtr, header.mapx / 2 * header.mapy / 2), header.mapx / 2 * header.mapy / 2);
 			return true;
 		} break;
 
@@ -225,31 +379,23 @@ bool CSMFMapFile::ReadInfoMap(const char* name, void* data)
 
 bool CSMFMapFile::ReadGrassMap(void *data)
 {
-	ifs.Seek(sizeof(SMFHeader));
+	int offset = sizeof(SMFHeader);
 
 	for (int a = 0; a < header.numExtraHeaders; ++a) {
-		int size;
-		int type;
-
-		ifs.Read(&size, 4);
-		ifs.Read(&type, 4);
+		const std::uint8_t* extraHeader = GetSectionData(offset, sizeof(int) * 2);
 
-		swabDWordInPlace(size);
-		swabDWordInPlace(type);
+		const int size = ReadInt(extraHeader + sizeof(int) * 0);
+		const int type = ReadInt(extraHeader + sizeof(int) * 1);
 
 		if (type == MEH_Vegetation) {
-			int pos;
-			ifs.Read(&pos, 4);
-			swabDWordInPlace(pos);
-			ifs.Seek(pos);
-			ifs.Read(data, header.mapx / 4 * header.mapy / 4);
+			const int pos = ReadInt(GetSectionData(offset + sizeof(int) * 2, sizeof(int)));
+			std::memcpy(data, GetSectionData(pos, header.mapx / 4 * header.mapy / 4), header.mapx / 4 * header.mapy / 4);
 			/* char; no swabbing. */
 			return true; //we arent interested in other extensions anyway
 		}
 
-		// assumes we can use data as scratch memory
-		assert((size - 8) <= (header.mapx / 4 * header.mapy / 4));
-		ifs.Read(data, size - 8);
+		// size includes the size and type fields
+		offset += size;
 	}
 
 	return false;
@@ -296,24 +442,6 @@ void CSMFMapFile::ReadMapHeader(SMFHeader& head, CFileHandler& file)
 	head.numExtraHeaders = ReadInt(file);
 }
 
-/// Read MapFeatureHeader head from file
-void CSMFMapFile::ReadMapFeatureHeader(MapFeatureHeader& head, CFileHandler& file)
-{
-	head.numFeatureType = ReadInt(file);
-	head.numFeatures = ReadInt(file);
-}
-
-/// Read MapFeatureStruct head from file
-void CSMFMapFile::ReadMapFeatureStruct(MapFeatureStruct& head, CFileHandler& file)
-{
-	head.featureType = ReadInt(file);
-	head.xpos = ReadFloat(file);
-	head.ypos = ReadFloat(file);
-	head.zpos = ReadFloat(file);
-	head.rotation = ReadFloat(file);
-	head.relativeSize = ReadFloat(file);
-}
-
 /// Read MapTileHeader head from file
 void CSMFMapFile::ReadMapTileHeader(MapTileHeader& head, CFileHandler& file)
 {
@@ -6,6 +6,8 @@
 #include "System/FileSystem/FileHandler.h"
 #include "SMFFormat.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -27,6 +29,8 @@ public:
 	int ReadMinimap(std::vector<std::uint8_t>& data, unsigned miplevel);
 	void ReadHeightmap(unsigned short* heightmap);
 	void ReadHeightmap(float* sHeightMap, float* uHeightMap, float base, float mod);
+	/// decodes rows [rowBeg, rowEnd) of the heightmap; may be called concurrently for disjoint ranges
+	void ReadHeightmap(float* sHeightMap, float* uHeightMap, float base, float mod, int rowBeg, int rowEnd);
 	void ReadFeatureInfo();
 	void ReadFeatureInfo(MapFeatureInfo* f);
 	void GetInfoMapSize(const char* name, MapBitmapInfo*) const;
@@ -39,6 +43,9 @@ public:
 
 	const SMFHeader& GetHeader() const { return header; }
 
+	/// true if the file contents are memory-mapped rather than copied
+	bool IsMapped() const { return (mappedData != nullptr); }
+
 	/**
 	 * @deprecated do not use, just here for backward compatibility
 	 *   with SMFGroundTextures.cpp
@@ -49,10 +56,17 @@ public:
 	static void ReadMapTileFileHeader(TileFileHeader& head, CFileHandler& file);
 
 private:
+	bool MapFile(const std::string& filePath);
+	void UnmapFile();
+
+	/**
+	 * @return pointer to the <size> bytes at <offset> in the file
+	 * @throw content_error if the range lies outside of it
+	 */
+	const std::uint8_t* GetSectionData(int offset, size_t size) const;
+
 	bool ReadGrassMap(void* data);
 	void ReadMapHeader(SMFHeader& head, CFileHandler& file);
-	void ReadMapFeatureHeader(MapFeatureHeader& head, CFileHandler& file);
-	void ReadMapFeatureStruct(MapFeatureStruct& head, CFileHandler& file);
 
 	CFileHandler ifs;
 
@@ -61,6 +75,21 @@ private:
 
 	char featureTypes[16384][32];
 
+	/**
+	 * Read-only view of the whole file; section reads go through this
+	 * instead of ifs so they do not share a seek position and can run
+	 * on multiple threads at once. Points into mappedData for mapped
+	 * files, into ifs's buffer for VFS-loaded (archived) ones, and into
+	 * fileBuffer otherwise.
+	 */
+	const std::uint8_t* fileData = nullptr;
+	size_t fileDataSize = 0;
+
+	void* mappedData = nullptr;
+	size_t mappedSize = 0;
+
+	std::vector<std::uint8_t> fileBuffer;
+
 	int featureFileOffset = 0;
 };
 
@@ -26,6 +26,7 @@
 #include "System/SpringMath.h"
 #include "System/SafeUtil.h"
 #include "System/StringHash.h"
+#include "System/TimeProfiler.h"
 #include "System/LoadLock.h"
 
 #define SSMF_UNCOMPRESSED_NORMALS 0
@@ -78,25 +79,32 @@ CSMFReadMap::CSMFReadMap(const std::string& mapName): CEventClient("[CSMFReadMap
 	haveSplatNormalDistribTexture &= !mapInfo->smf.splatDistrTexName.empty();
 
 	ParseHeader();
-	LoadHeightMap();
-	CReadMap::Initialize();
+	LoadSections();
+	{
+		ScopedOnceTimer timer("SMFReadMap::Initialize");
+		CReadMap::Initialize();
+	}
 
 	ConfigureTexAnisotropyLevels();
 	InitializeWaterHeightColors();
 	{
 		auto lock = CLoadLock::GetUniqueLock();
 
-		LoadMinimap();
-
-		CreateSpecularTex();
-		CreateSplatDetailTextures();
-		CreateGrassTex();
-		CreateDetailTex();
-		CreateShadingTex();
-		CreateNormalTex();
+		{
+			ScopedOnceTimer timer("SMFReadMap::LoadMinimap");
+			LoadMinimap();
+		}
+		{
+			ScopedOnceTimer timer("SMFReadMap::CreateTextures");
+
+			CreateSpecularTex();
+			CreateSplatDetailTextures();
+			CreateGrassTex();
+			CreateDetailTex();
+			CreateShadingTex();
+			CreateNormalTex();
+		}
 	}
-
-	mapFile.ReadFeatureInfo();
 }
 
 
@@ -121,7 +129,7 @@ void CSMFReadMap::ParseHeader()
 }
 
 
-void CSMFReadMap::LoadHeightMap()
+void CSMFReadMap::LoadSections()
 {
 	const SMFHeader& header = mapFile.GetHeader();
 
@@ -141,12 +149,63 @@ void CSMFReadMap::LoadHeightMap()
 	float* cornerHeightMapSyncedData = cornerHeightMapSynced.data();
 	float* cornerHeightMapUnsyncedData = cornerHeightMapUnsynced.data();
 
+	// heightmap rows are decoded in blocks, the feature table (needed by
+	// FeatureHandler) is independent of them and forms one extra task
+	constexpr int HEIGHTMAP_BLOCK_ROWS = 128;
+
+	const int numRows = mapDims.mapy + 1;
+	const int numBlocks = (numRows + HEIGHTMAP_BLOCK_ROWS - 1) / HEIGHTMAP_BLOCK_ROWS;
+
+	// one slot per task, so no synchronization is needed
+	std::vector<spring_time> taskTimes(numBlocks + 1);
+	// exceptions must not escape a pool task, thrown on the calling thread below
+	std::vector<std::string> taskErrors(numBlocks + 1);
+
+	const spring_time t0 = spring_gettime();
+
 	// FIXME:
 	//     callchain CReadMap::Initialize --> CReadMap::UpdateHeightMapSynced(0, 0, mapDims.mapx, mapDims.mapy) -->
 	//     PushVisibleHeightMapUpdate --> (next UpdateDraw) UpdateHeightMapUnsynced(0, 0, mapDims.mapx, mapDims.mapy)
 	//     initializes the UHM a second time
 	//     merge them some way so UHM & shadingtex is available from the time readMap got created
-	mapFile.ReadHeightmap(cornerHeightMapSyncedData, cornerHeightMapUnsyncedData, minHgt, (maxHgt - minHgt) / 65536.0f);
+	for_mt(0, numBlocks + 1, [&](const int i) {
+		const spring_time t = spring_gettime();
+
+		try {
+			if (i == numBlocks) {
+				mapFile.ReadFeatureInfo();
+			} else {
+				const int rowBeg = i * HEIGHTMAP_BLOCK_ROWS;
+				const int rowEnd = std::min(rowBeg + HEIGHTMAP_BLOCK_ROWS, numRows);
+
+				mapFile.ReadHeightmap(cornerHeightMapSyncedData, cornerHeightMapUnsyncedData, minHgt, (maxHgt - minHgt) / 65536.0f, rowBeg, rowEnd);
+			}
+		} catch (const content_error& e) {
+			taskErrors[i] = e.what();
+		}
+
+		taskTimes[i] = spring_difftime(spring_gettime(), t);
+	});
+
+	for (const std::string& taskError: taskErrors) {
+		if (!taskError.empty())
+			throw content_error(taskError);
+	}
+
+	spring_time heightMapTime;
+
+	for (int i = 0; i < numBlocks; i++) {
+		heightMapTime += taskTimes[i];
+	}
+
+	LOG("[SMFReadMap::%s] %.2fms (mapped=%d heightmap=%.2fms in %d blocks features=%.2fms)",
+		__func__,
+		spring_difftime(spring_gettime(), t0).toMilliSecsf(),
+		mapFile.IsMapped(),
+		heightMapTime.toMilliSecsf(),
+		numBlocks,
+		taskTimes[numBlocks].toMilliSecsf()
+	);
 }
 
 
@@ -974,6 +1033,8 @@ const char* CSMFReadMap::GetFeatureTypeName(int typeID) { return mapFile.GetFeat
 
 unsigned char* CSMFReadMap::GetInfoMap(const char* name, MapBitmapInfo* bmInfo)
 {
+	ScopedOnceTimer timer(std::string("SMFReadMap::GetInfoMap(") + name + ")");
+
 	// get size
 	mapFile.GetInfoMapSize(name, bmInfo);
 
@@ -149,7 +149,7 @@ public:
 
 private:
 	void ParseHeader();
-	void LoadHeightMap();
+	void LoadSections();
 	void LoadMinimap();
 	void InitializeWaterHeightColors();
 	void CreateSpecularTex();
@@ -671,6 +671,7 @@ CBaseNetProtocol::CBaseNetProtocol()
 	proto->AddType(NETMSG_AI_STATE_CHANGED, 4);
 	proto->AddType(NETMSG_GAME_FRAME_PROGRESS, 5);
 	proto->AddType(NETMSG_PING, 1 + (1 + 1 + 4));
+	proto->AddType(NETMSG_PACKED, -2);
 
 #ifdef SYNCDEBUG
 	proto->AddType(NETMSG_SD_CHKREQUEST, 5);
@@ -681,5 +682,70 @@ CBaseNetProtocol::CBaseNetProtocol()
 #endif // SYNCDEBUG
 
 	proto->AddType(NETMSG_GAMESTATE_DUMP, 1);
+
+	InitPacketDictionary();
+}
+
+void CBaseNetProtocol::InitPacketDictionary()
+{
+	// literal values to keep this independent of Sim and Lua headers;
+	// CMD_{STOP,MOVE,PATROL,FIGHT,ATTACK,GUARD,REPAIR,RECLAIM} and LUA_HANDLE_ORDER_{RULES,UI}
+	constexpr int32_t cmdIDs[] = {0, 10, 15, 16, 20, 25, 40, 90};
+	constexpr uint8_t cmdOpts[] = {0, 1 << 4, 1 << 5, (1 << 4) | (1 << 5)};
+	constexpr uint16_t luaScripts[] = {100, 2000};
+
+	constexpr float cmdPos[] = {1024.0f, 128.0f, 2048.0f};
+
+	const std::vector<uint8_t> luaData = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '.', ':', '|', '-'};
+	const std::vector<int16_t> unitIDs = {1, 2, 3, 4};
+
+	const auto AddPacket = [&](const PacketType& packet) {
+		packetDictionary.insert(packetDictionary.end(), packet->data, packet->data + packet->length);
+	};
+
+	// least frequent first
+	for (const uint16_t script: luaScripts) {
+		AddPacket(SendLuaMsg(0, script, 0, luaData));
+		AddPacket(SendLuaMsg(0, script, 's', luaData));
+	}
+
+	{
+		// see CSelectedUnitsHandler::SendCommandsToUnits; one command for all units
+		const uint32_t packetSize = 1 + 2 + 3 + (4 + 1 + 2) + (2 + unitIDs.size() * 2) + 2 + sizeof(cmdPos);
+
+		PackPacket* packet = new PackPacket(packetSize, NETMSG_AICOMMANDS);
+		*packet << static_cast<uint16_t>(packetSize) << uint8_t(0) << uint8_t(255) << uint8_t(0);
+		*packet << uint32_t(cmdIDs[1]) << cmdOpts[0] << uint16_t(3);
+		*packet << static_cast<uint16_t>(unitIDs.size());
+
+		for (const int16_t unitID: unitIDs) {
+			*packet << unitID;
+		}
+
+		*packet << uint16_t(1) << cmdPos[0] << cmdPos[1] << cmdPos[2];
+		AddPacket(PacketType(packet));
+	}
+
+	AddPacket(SendSelect(0, unitIDs));
+
+	for (const int32_t cmdID: cmdIDs) {
+		AddPacket(SendCommand(0, cmdID, INT32_MAX, cmdOpts[0], (cmdID != 0) * 3, cmdPos));
+	}
+	for (const uint8_t opts: cmdOpts) {
+		AddPacket(SendCommand(0, cmdIDs[1], INT32_MAX, opts, 3, cmdPos));
+	}
+
+	AddPacket(SendCPUUsage(0.5f));
+	AddPacket(SendPlayerInfo(0, 0.5f, 100));
+	AddPacket(SendSyncResponse(0, 0, 0));
+
+	// server frame messages: a keyframe every 16 sim-frames, newframes between
+	AddPacket(SendKeyFrame(0));
+
+	for (int i = 0; i < 15; i++) {
+		AddPacket(SendNewFrame());
+	}
+
+	AddPacket(SendKeyFrame(16));
 }
 
@@ -27,6 +27,8 @@ struct TeamStatistics;
 
 
 static const uint16_t NETWORK_VERSION = atoi(SpringVersion::GetMajor().c_str());
+/// must change whenever CBaseNetProtocol::GetPacketDictionary does
+static const uint8_t PACKET_DICTIONARY_ID = 1;
 
 
 /**
@@ -120,9 +122,22 @@ public:
 
 	PacketType SendGameStateDump();
 
+	/**
+	 * @brief preset dictionary for NETMSG_PACKED (see netcode::PacketCompressor)
+	 *
+	 * Holds the shapes of the messages making up most of a game's traffic,
+	 * the most frequent ones last where deflate reaches them with the
+	 * shortest distances.
+	 */
+	const std::vector<uint8_t>& GetPacketDictionary() const { return packetDictionary; }
+
 private:
 	CBaseNetProtocol();
 
+	void InitPacketDictionary();
+
+private:
+	std::vector<uint8_t> packetDictionary;
 };
 
 #endif // _BASE_NET_PROTOCOL_H
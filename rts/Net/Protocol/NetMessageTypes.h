@@ -95,6 +95,8 @@ enum NETMSG {
 
 	NETMSG_PING = 78, // uint8_t playerNum, uint8_t pingTag, float localTime
 
+	NETMSG_PACKED = 79, // uint16_t messageSize, uint8_t dictionaryID, uint16_t rawSize, std::vector<uint8_t> deflatedMessages #never reaches the message queues, see netcode::PacketCompressor#
+
 	NETMSG_LAST //max types of netmessages, internal only
 };
 
@@ -0,0 +1,110 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "BatchSphereCuller.h"
+
+#include <algorithm>
+#include <cassert>
+#include <xmmintrin.h>
+
+CBatchSphereCuller::View::View(const CCamera::Frustum& frustum, const float3& camPos_, float nearDistSq_, float farDistSq_)
+	: planes{
+		frustum.planes[CCamera::FRUSTUM_PLANE_LFT],
+		frustum.planes[CCamera::FRUSTUM_PLANE_RGT],
+		frustum.planes[CCamera::FRUSTUM_PLANE_TOP],
+		frustum.planes[CCamera::FRUSTUM_PLANE_BOT],
+		frustum.planes[CCamera::FRUSTUM_PLANE_BCK],
+	}
+	// the near-plane is not tested by CCamera::Frustum::IntersectSphere either
+	, planeOffsets{frustum.scales.x, frustum.scales.x, frustum.scales.y, frustum.scales.y, frustum.scales.w}
+	, camPos(camPos_)
+	, nearDistSq(nearDistSq_)
+	, farDistSq(farDistSq_)
+{
+}
+
+
+void CBatchSphereCuller::Resize(size_t n)
+{
+	const size_t paddedSize = (n + SIMD_WIDTH - 1) & ~(SIMD_WIDTH - 1);
+
+	numObjects = n;
+
+	// padding lanes are culled by their index, values do not matter
+	for (std::vector<float>* v: {&midPosX, &midPosY, &midPosZ, &radii, &lodPosX, &lodPosY, &lodPosZ}) {
+		v->resize(paddedSize, 0.0f);
+	}
+}
+
+void CBatchSphereCuller::Cull(const View& view)
+{
+	for (std::vector<int>& v: visible) {
+		v.clear();
+	}
+
+	lodClasses.resize(numObjects);
+	CullRange(view, 0, numObjects, lodClasses.data());
+
+	for (size_t i = 0; i < numObjects; i++) {
+		if (lodClasses[i] == LOD_NONE)
+			continue;
+
+		visible[lodClasses[i]].push_back(i);
+	}
+}
+
+void CBatchSphereCuller::CullRange(const View& view, size_t begin, size_t end, uint8_t* lods) const
+{
+	assert((begin % SIMD_WIDTH) == 0);
+	assert(end <= numObjects);
+
+	const __m128 cpx = _mm_set1_ps(view.camPos.x);
+	const __m128 cpy = _mm_set1_ps(view.camPos.y);
+	const __m128 cpz = _mm_set1_ps(view.camPos.z);
+
+	const __m128 nearSq = _mm_set1_ps(view.nearDistSq);
+	const __m128 farSq = _mm_set1_ps(view.farDistSq);
+
+	for (size_t i = begin; i < end; i += SIMD_WIDTH) {
+		const size_t n = std::min(SIMD_WIDTH, end - i);
+
+		const __m128 vx = _mm_sub_ps(_mm_loadu_ps(&midPosX[i]), cpx);
+		const __m128 vy = _mm_sub_ps(_mm_loadu_ps(&midPosY[i]), cpy);
+		const __m128 vz = _mm_sub_ps(_mm_loadu_ps(&midPosZ[i]), cpz);
+		const __m128 r = _mm_loadu_ps(&radii[i]);
+
+		__m128 outside = _mm_setzero_ps();
+
+		for (int j = 0; j < 5; j++) {
+			const __m128 dx = _mm_mul_ps(vx, _mm_set1_ps(view.planes[j].x));
+			const __m128 dy = _mm_mul_ps(vy, _mm_set1_ps(view.planes[j].y));
+			const __m128 dz = _mm_mul_ps(vz, _mm_set1_ps(view.planes[j].z));
+			const __m128 d = _mm_add_ps(_mm_add_ps(dx, dy), dz);
+
+			outside = _mm_or_ps(outside, _mm_cmpgt_ps(d, _mm_add_ps(_mm_set1_ps(view.planeOffsets[j]), r)));
+		}
+
+		const int outsideMask = _mm_movemask_ps(outside);
+
+		if (outsideMask == 0xF) {
+			std::fill(lods + i, lods + i + n, uint8_t(LOD_NONE));
+			continue;
+		}
+
+		const __m128 lx = _mm_sub_ps(_mm_loadu_ps(&lodPosX[i]), cpx);
+		const __m128 ly = _mm_sub_ps(_mm_loadu_ps(&lodPosY[i]), cpy);
+		const __m128 lz = _mm_sub_ps(_mm_loadu_ps(&lodPosZ[i]), cpz);
+		const __m128 sqDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(lx, lx), _mm_mul_ps(ly, ly)), _mm_mul_ps(lz, lz));
+
+		const int nearMask = _mm_movemask_ps(_mm_cmplt_ps(sqDist, nearSq));
+		const int fadeMask = _mm_movemask_ps(_mm_cmplt_ps(sqDist, farSq));
+
+		for (size_t k = 0; k < n; k++) {
+			if ((outsideMask >> k) & 1) {
+				lods[i + k] = LOD_NONE;
+				continue;
+			}
+
+			lods[i + k] = ((nearMask >> k) & 1)? LOD_NEAR: (((fadeMask >> k) & 1)? LOD_FADE: LOD_FAR);
+		}
+	}
+}
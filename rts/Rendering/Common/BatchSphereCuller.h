@@ -0,0 +1,80 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string> // Camera.h does not include it
+#include <vector>
+
+#include "Game/Camera.h"
+#include "System/float3.h"
+
+/**
+ * Classifies the bounding spheres of many objects against a camera frustum
+ * and two distance thresholds at once, four spheres per SSE step.
+ *
+ * Inputs are kept as structure-of-arrays; visible objects are written to
+ * compact index lists (ascending) per distance class, or to a per-object
+ * class array by CullRange, which may be called concurrently on disjoint
+ * ranges. The frustum test is the same as CCamera::InView(pos, radius) and
+ * the distance the same as (lodPos - camPos).SqLength(), so results match
+ * the per-object path.
+ */
+class CBatchSphereCuller {
+public:
+	enum {
+		LOD_NEAR = 0, // sqDist < nearDistSq
+		LOD_FADE = 1, // sqDist < farDistSq
+		LOD_FAR  = 2,
+		LOD_CNT  = 3,
+		LOD_NONE = LOD_CNT, // outside the frustum
+	};
+
+	// CullRange ranges have to start at a multiple of this
+	static constexpr size_t SIMD_WIDTH = 4;
+
+	struct View {
+		View(const CCamera::Frustum& frustum, const float3& camPos, float nearDistSq, float farDistSq);
+		View(const CCamera* cam, float nearDistSq, float farDistSq): View(cam->GetFrustum(), cam->GetPos(), nearDistSq, farDistSq) {}
+
+		// left, right, top, bottom and far planes (see CCamera::Frustum::IntersectSphere)
+		float3 planes[5];
+		float planeOffsets[5];
+
+		float3 camPos;
+
+		float nearDistSq;
+		float farDistSq;
+	};
+
+public:
+	/// inputs are undefined after resizing until set
+	void Resize(size_t numObjects);
+	void SetObject(size_t i, const float3& midPos, float radius, const float3& lodPos) {
+		midPosX[i] = midPos.x; midPosY[i] = midPos.y; midPosZ[i] = midPos.z;
+		radii[i] = radius;
+		lodPosX[i] = lodPos.x; lodPosY[i] = lodPos.y; lodPosZ[i] = lodPos.z;
+	}
+
+	void Cull(const CCamera::Frustum& frustum, const float3& camPos, float nearDistSq, float farDistSq) { Cull(View(frustum, camPos, nearDistSq, farDistSq)); }
+	void Cull(const CCamera* cam, float nearDistSq, float farDistSq) { Cull(View(cam, nearDistSq, farDistSq)); }
+	void Cull(const View& view);
+
+	/// writes the LOD_* class of objects [begin, end) to lods[begin, end)
+	void CullRange(const View& view, size_t begin, size_t end, uint8_t* lods) const;
+
+	size_t GetNumObjects() const { return numObjects; }
+	const std::vector<int>& GetVisible(int lod) const { return visible[lod]; }
+
+private:
+	size_t numObjects = 0;
+
+	// padded to a multiple of SIMD_WIDTH
+	std::vector<float> midPosX, midPosY, midPosZ;
+	std::vector<float> radii;
+	std::vector<float> lodPosX, lodPosY, lodPosZ;
+
+	std::vector<uint8_t> lodClasses;
+	std::array<std::vector<int>, LOD_CNT> visible;
+};
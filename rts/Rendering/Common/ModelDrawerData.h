@@ -2,7 +2,9 @@
 
 #include <vector>
 #include <array>
+#include <algorithm>
 #include <functional>
+#include <limits>
 
 #include <unordered_map>
 
@@ -12,6 +14,7 @@
 #include "System/Config/ConfigHandler.h"
 #include "System/Threading/ThreadPool.h"
 #include "Rendering/GlobalRendering.h"
+#include "Rendering/Common/BatchSphereCuller.h"
 #include "Rendering/ShadowHandler.h"
 #include "Rendering/Models/ModelsMemStorage.h"
 #include "Rendering/Models/ModelRenderContainer.h"
@@ -37,6 +40,12 @@ public:
 protected:
 	static constexpr int MT_CHUNK_OR_MIN_CHUNK_SIZE_SMMA = -128;
 	static constexpr int MT_CHUNK_OR_MIN_CHUNK_SIZE_UPDT = -256;
+
+	// cull masks hold an in-view bit per camera type and the LOD class of CAMTYPE_PLAYER above those
+	static constexpr uint32_t CULL_LOD_SHIFT = CCamera::CAMTYPE_ENVMAP;
+
+	static bool IsInView(uint8_t cullMask, uint32_t camType) { return (((cullMask >> camType) & 1) != 0); }
+	static int GetCullLod(uint8_t cullMask) { return (cullMask >> CULL_LOD_SHIFT); }
 };
 
 
@@ -59,8 +68,13 @@ protected:
 	void UpdateObject(const T* co, bool init);
 protected:
 	void UpdateCommon();
-	virtual void UpdateObjectDrawFlags(CSolidObject* o) const = 0;
+	virtual void UpdateObjectDrawFlags(CSolidObject* o, uint8_t cullMask) const = 0;
+	/// false if UpdateObjectDrawFlags will not draw <o> from any camera, whatever its cull mask
+	virtual bool IsCullCandidate(const T* o) const { return true; }
+	/// squared distances separating the CAMTYPE_PLAYER LOD classes
+	virtual float2 GetCullDistancesSq() const { return {std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity()}; }
 private:
+	void CullObjects();
 	void UpdateObjectSMMA(const T* o);
 	void UpdateObjectUniforms(const T* o);
 public:
@@ -82,6 +96,11 @@ protected:
 	std::vector<T*> unsortedObjects;
 	std::unordered_map<T*, ScopedMatricesMemAlloc> matricesMemAllocs;
 
+	CBatchSphereCuller culler;
+	std::vector<int> cullIndices; // [culler index] = k
+	std::vector<uint8_t> cullLods; // [culler index]
+	std::vector<uint8_t> cullMasks; // [k], see CullObjects
+
 	bool& mtModelDrawer;
 };
 
@@ -197,13 +216,91 @@ inline void CModelDrawerDataBase<T>::UpdateObjectUniforms(const T* o)
 	}
 }
 
+template<typename T>
+inline void CModelDrawerDataBase<T>::CullObjects()
+{
+	// objects hidden regardless of cameras (no-draw, icons, out of LOS, ...)
+	// keep a zero mask, the remaining ones are culled in blocks of spheres
+	static constexpr int CULL_BLOCK_SIZE = 64;
+	static_assert((CULL_BLOCK_SIZE % CBatchSphereCuller::SIMD_WIDTH) == 0, "");
+
+	cullIndices.clear();
+	cullMasks.clear();
+	cullMasks.resize(unsortedObjects.size(), 0);
+
+	for (int k = 0; k < unsortedObjects.size(); ++k) {
+		if (IsCullCandidate(unsortedObjects[k]))
+			cullIndices.push_back(k);
+	}
+
+	const int numCandidates = cullIndices.size();
+	const int numBlocks = (numCandidates + CULL_BLOCK_SIZE - 1) / CULL_BLOCK_SIZE;
+
+	culler.Resize(numCandidates);
+	cullLods.resize(numCandidates);
+
+	const auto setBody = [this](int i) {
+		const T* o = unsortedObjects[cullIndices[i]];
+		culler.SetObject(i, o->drawMidPos, o->GetDrawRadius(), o->drawPos);
+	};
+
+	if (mtModelDrawer) {
+		for_mt_chunk(0, numCandidates, [&setBody](int i) {
+			setBody(i);
+		}, CModelDrawerDataConcept::MT_CHUNK_OR_MIN_CHUNK_SIZE_UPDT);
+	}
+	else {
+		for (int i = 0; i < numCandidates; ++i)
+			setBody(i);
+	}
+
+	// same cameras as UpdateObjectDrawFlags
+	for (uint32_t camType = CCamera::CAMTYPE_PLAYER; camType < CCamera::CAMTYPE_ENVMAP; ++camType) {
+		if (camType == CCamera::CAMTYPE_UWREFL && !IWater::GetWater()->CanDrawReflectionPass())
+			continue;
+
+		if (camType == CCamera::CAMTYPE_SHADOW && ((shadowHandler.shadowGenBits & CShadowHandler::SHADOWGEN_BIT_MODEL) == 0))
+			continue;
+
+		const bool playerCam = (camType == CCamera::CAMTYPE_PLAYER);
+		const float2 distsSq = playerCam? GetCullDistancesSq(): float2(std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity());
+		const CBatchSphereCuller::View view(CCameraHandler::GetCamera(camType), distsSq.x, distsSq.y);
+
+		const auto cullBody = [this, &view, camType, playerCam, numCandidates](int block) {
+			const int begin = block * CULL_BLOCK_SIZE;
+			const int end = std::min(begin + CULL_BLOCK_SIZE, numCandidates);
+
+			culler.CullRange(view, begin, end, cullLods.data());
+
+			for (int i = begin; i < end; ++i) {
+				const uint8_t lod = cullLods[i];
+
+				if (lod == CBatchSphereCuller::LOD_NONE)
+					continue;
+
+				cullMasks[cullIndices[i]] |= ((1 << camType) | (playerCam? (lod << CULL_LOD_SHIFT): 0));
+			}
+		};
+
+		if (mtModelDrawer) {
+			for_mt_chunk(0, numBlocks, cullBody, CModelDrawerDataConcept::MT_CHUNK_OR_MIN_CHUNK_SIZE_UPDT / CULL_BLOCK_SIZE);
+		}
+		else {
+			for (int block = 0; block < numBlocks; ++block)
+				cullBody(block);
+		}
+	}
+}
+
 template<typename T>
 inline void CModelDrawerDataBase<T>::UpdateCommon()
 {
+	CullObjects();
+
 	const auto updateBody = [this](int k) {
 		T* o = unsortedObjects[k];
 		o->previousDrawFlag = o->drawFlag;
-		UpdateObjectDrawFlags(o);
+		UpdateObjectDrawFlags(o, cullMasks[k]);
 
 		if (o->alwaysUpdateMat || (o->drawFlag > DrawFlags::SO_NODRAW_FLAG && o->drawFlag < DrawFlags::SO_DRICON_FLAG))
 			this->UpdateObjectSMMA(o);
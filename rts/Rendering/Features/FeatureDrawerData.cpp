@@ -106,7 +106,16 @@ bool CFeatureDrawerData::IsAlpha(const CFeature* co) const
 	return (co->drawAlpha < 1.0f);
 }
 
-void CFeatureDrawerData::UpdateObjectDrawFlags(CSolidObject* o) const
+bool CFeatureDrawerData::IsCullCandidate(const CFeature* f) const
+{
+	// per-object conditions of UpdateObjectDrawFlags
+	if (f->noDraw || f->IsInVoid())
+		return false;
+
+	return (f->IsInLosForAllyTeam(gu->myAllyTeam) || gu->spectatingFullView);
+}
+
+void CFeatureDrawerData::UpdateObjectDrawFlags(CSolidObject* o, uint8_t cullMask) const
 {
 	CFeature* f = static_cast<CFeature*>(o);
 	f->ResetDrawFlag();
@@ -129,13 +138,13 @@ void CFeatureDrawerData::UpdateObjectDrawFlags(CSolidObject* o) const
 		if (!f->IsInLosForAllyTeam(gu->myAllyTeam) && !gu->spectatingFullView)
 			continue;
 
-		if (!cam->InView(f->drawMidPos, f->GetDrawRadius()))
+		if (!IsInView(cullMask, camType))
 			continue;
 
 		switch (camType)
 			{
 			case CCamera::CAMTYPE_PLAYER: {
-				const float sqrCamDist = (f->drawPos - cam->GetPos()).SqLength();
+				const int cullLod = GetCullLod(cullMask);
 
 				// special case for non-fading features
 				if (!f->alphaFade) {
@@ -145,7 +154,7 @@ void CFeatureDrawerData::UpdateObjectDrawFlags(CSolidObject* o) const
 				}
 
 				// draw feature as normal, no fading
-				if (sqrCamDist < featureFadeDistanceSq) {
+				if (cullLod == CBatchSphereCuller::LOD_NEAR) {
 					f->SetDrawFlag(DrawFlags::SO_OPAQUE_FLAG);
 
 					if (f->IsInWater())
@@ -156,7 +165,9 @@ void CFeatureDrawerData::UpdateObjectDrawFlags(CSolidObject* o) const
 				}
 
 				// otherwise save it for the fade-pass
-				if (sqrCamDist < featureDrawDistanceSq) {
+				if (cullLod == CBatchSphereCuller::LOD_FADE) {
+					const float sqrCamDist = (f->drawPos - cam->GetPos()).SqLength();
+
 					f->drawAlpha = 1.0f - (sqrCamDist - featureFadeDistanceSq) / (featureDrawDistanceSq - featureFadeDistanceSq);
 					f->SetDrawFlag(DrawFlags::SO_ALPHAF_FLAG);
 
@@ -27,7 +27,9 @@ public:
 	void Update() override;
 	bool IsAlpha(const CFeature* co) const override;
 protected:
-	void UpdateObjectDrawFlags(CSolidObject* o) const override;
+	void UpdateObjectDrawFlags(CSolidObject* o, uint8_t cullMask) const override;
+	bool IsCullCandidate(const CFeature* f) const override;
+	float2 GetCullDistancesSq() const override { return {featureFadeDistanceSq, featureDrawDistanceSq}; }
 private:
 	static void UpdateDrawPos(CFeature* f);
 public:
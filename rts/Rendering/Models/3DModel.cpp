@@ -35,6 +35,7 @@ CR_REG_METADATA(LocalModelPiece, (
 	CR_IGNORED(dirty),
 	CR_IGNORED(modelSpaceMat),
 	CR_IGNORED(pieceSpaceMat),
+	CR_IGNORED(numTreeChanges),
 
 	CR_IGNORED(lodDispLists) //FIXME GL idx!
 ))
@@ -44,7 +45,12 @@ CR_REG_METADATA(LocalModel, (
 	CR_MEMBER(pieces),
 
 	CR_IGNORED(boundingVolume),
-	CR_IGNORED(luaMaterialData)
+	CR_IGNORED(luaMaterialData),
+
+	// rebuilt on the first trace after loading
+	CR_IGNORED(pieceVolumeBVH),
+	CR_IGNORED(pieceVolumeBVHChanges),
+	CR_IGNORED(pieceVolumeBVHMutex)
 ))
 
 
@@ -424,16 +430,41 @@ LocalModelPiece::LocalModelPiece(const S3DModelPiece* piece)
 }
 
 void LocalModelPiece::SetDirty() {
+	LocalModelPiece* lmp = this;
+
+	// a piece that is still dirty was counted when it got flagged, and the
+	// piece-volume tree can not have been refit since (that updates every
+	// matrix); only the first change below a clean path walks to the root
+	while (!lmp->dirty && lmp->parent != nullptr)
+		lmp = lmp->parent;
+
+	// reached the root without meeting a dirty piece
+	if (!lmp->dirty)
+		lmp->numTreeChanges += 1;
+
+	SetDirtyRec();
+}
+
+void LocalModelPiece::SetDirtyRec() {
 	dirty = true;
 	SetGetCustomDirty(true);
 
 	for (LocalModelPiece* child: children) {
 		if (child->dirty)
 			continue;
-		child->SetDirty();
+		child->SetDirtyRec();
 	}
 }
 
+void LocalModelPiece::AddTreeChange() {
+	LocalModelPiece* root = this;
+
+	while (root->parent != nullptr)
+		root = root->parent;
+
+	root->numTreeChanges += 1;
+}
+
 bool LocalModelPiece::SetGetCustomDirty(bool cd) const
 {
 	std::swap(cd, customDirty);
@@ -12,6 +12,7 @@
 #include "Lua/LuaObjectMaterial.h"
 #include "Rendering/GL/VBO.h"
 #include "Sim/Misc/CollisionVolume.h"
+#include "Sim/Misc/PieceVolumeBVH.h"
 #include "System/Matrix44f.h"
 #include "System/type2.h"
 #include "System/SafeUtil.h"
@@ -444,6 +445,9 @@ struct LocalModelPiece
 
 	void SetDirty();
 	bool SetGetCustomDirty(bool cd) const;
+	// counts (on the root piece) every change to a piece transform or volume
+	void AddTreeChange();
+	unsigned int GetNumTreeChanges() const { return numTreeChanges; }
 	void SetPosOrRot(const float3& src, float3& dst); // anim-script only
 	void SetPosition(const float3& p) { SetPosOrRot(p, pos); } // anim-script only
 	void SetRotation(const float3& r) { SetPosOrRot(r, rot); } // anim-script only
@@ -475,6 +479,9 @@ struct LocalModelPiece
 
 	bool GetScriptVisible() const { return scriptSetVisible; }
 	void SetScriptVisible(bool b) { scriptSetVisible = b; SetGetCustomDirty(true); }
+private:
+	void SetDirtyRec();
+
 private:
 	float3 pos; // translation relative to parent LMP, *INITIALLY* equal to original->offset
 	float3 rot; // orientation relative to parent LMP, in radians (updated by scripts)
@@ -488,6 +495,9 @@ private:
 	mutable bool dirty;
 	mutable bool customDirty;
 
+	// only maintained for the root piece, not serialized
+	unsigned int numTreeChanges = 0;
+
 	bool scriptSetVisible; // TODO: add (visibility) maxradius!
 public:
 	bool blockScriptAnims; // if true, Set{Position,Rotation} are ignored for this piece
@@ -585,6 +595,14 @@ private:
 
 	// custom Lua-set material this model should be rendered with
 	LuaObjectMaterialData luaMaterialData;
+
+public:
+	// hierarchy over the piece volumes, refit by CCollisionHandler when
+	// the root's tree-change count differs from pieceVolumeBVHChanges;
+	// traces can run concurrently, so the check and refit hold the lock
+	mutable CPieceVolumeBVH pieceVolumeBVH;
+	mutable unsigned int pieceVolumeBVHChanges = 0;
+	mutable spring::spinlock pieceVolumeBVHMutex;
 };
 
 #endif /* _3DMODEL_H */
@@ -16,7 +16,7 @@
 class MatricesMemStorage : public StablePosAllocator<CMatrix44f> {
 public:
 	explicit MatricesMemStorage()
-		: StablePosAllocator<CMatrix44f>(INIT_NUM_ELEMS)
+		: StablePosAllocator<CMatrix44f>(INIT_NUM_ELEMS, "Models::Matrices")
 		, dirtyMap(INIT_NUM_ELEMS, BUFFERING)
 	{}
 	void Reset() override {
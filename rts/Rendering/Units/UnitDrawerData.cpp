@@ -299,7 +299,16 @@ void CUnitDrawerData::UpdateDrawPos(CUnit* u)
 	u->drawMidPos = u->GetMdlDrawMidPos();
 }
 
-void CUnitDrawerData::UpdateObjectDrawFlags(CSolidObject* o) const
+bool CUnitDrawerData::IsCullCandidate(const CUnit* u) const
+{
+	// per-object conditions of UpdateObjectDrawFlags; the icon flag is set by Update
+	if (u->noDraw || u->GetIsIcon() || u->IsInVoid())
+		return false;
+
+	return ((u->losStatus[gu->myAllyTeam] & LOS_INLOS) || gu->spectatingFullView);
+}
+
+void CUnitDrawerData::UpdateObjectDrawFlags(CSolidObject* o, uint8_t cullMask) const
 {
 	CUnit* u = static_cast<CUnit*>(o);
 
@@ -332,7 +341,7 @@ void CUnitDrawerData::UpdateObjectDrawFlags(CSolidObject* o) const
 		if (!(u->losStatus[gu->myAllyTeam] & LOS_INLOS) && !gu->spectatingFullView)
 			continue;
 
-		if (!cam->InView(u->drawMidPos, u->GetDrawRadius()))
+		if (!IsInView(cullMask, camType))
 			continue;
 
 		switch (camType)
@@ -119,7 +119,8 @@ public:
 
 	const spring::unsynced_map<icon::CIconData*, std::vector<const CUnit*> >& GetUnitsByIcon() const { return unitsByIcon; }
 protected:
-	void UpdateObjectDrawFlags(CSolidObject* o) const override;
+	void UpdateObjectDrawFlags(CSolidObject* o, uint8_t cullMask) const override;
+	bool IsCullCandidate(const CUnit* u) const override;
 private:
 	const icon::CIconData* GetUnitIcon(const CUnit* unit);
 
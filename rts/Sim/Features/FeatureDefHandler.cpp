@@ -68,6 +68,7 @@ void CFeatureDefHandler::AddFeatureDef(const std::string& name, FeatureDef* fd,
 	fd->collisionVolume.SetIgnoreHits(fd->geoThermal);
 
 	featureDefIDs[name] = fd->id;
+	featureDefNameIndex.Insert(name, fd->id);
 }
 
 FeatureDef& CFeatureDefHandler::GetNewFeatureDef()
@@ -199,19 +200,18 @@ FeatureDef* CFeatureDefHandler::CreateDefaultGeoFeatureDef(const std::string& na
 }
 
 
-const FeatureDef* CFeatureDefHandler::GetFeatureDef(string name, const bool showError) const
+const FeatureDef* CFeatureDefHandler::GetFeatureDef(const char* name, const bool showError) const
 {
-	if (name.empty())
+	if (name[0] == 0)
 		return nullptr;
 
-	StringToLowerInPlace(name);
-	const auto fi = featureDefIDs.find(name);
+	const int id = featureDefNameIndex.Find(name);
 
-	if (fi != featureDefIDs.end())
-		return &featureDefsVector[fi->second];
+	if (id != -1)
+		return &featureDefsVector[id];
 
 	if (showError)
-		LOG_L(L_ERROR, "[%s] could not find FeatureDef \"%s\"", __func__, name.c_str());
+		LOG_L(L_ERROR, "[%s] could not find FeatureDef \"%s\"", __func__, StringToLower(name).c_str());
 
 	return nullptr;
 }
@@ -8,6 +8,8 @@
 
 #include "FeatureDef.h"
 
+#include "Sim/Misc/DefNameIndex.h"
+
 #include "System/Misc/NonCopyable.h"
 #include "System/UnorderedMap.hpp"
 
@@ -22,11 +24,14 @@ public:
 	void Init(LuaParser* defsParser);
 	void Kill() {
 		featureDefIDs.clear(); // never iterated in synced code
+		featureDefNameIndex.Clear();
 		featureDefsVector.clear();
 	}
 
 	void LoadFeatureDefsFromMap();
-	const FeatureDef* GetFeatureDef(std::string name, const bool showError = true) const;
+	// NOTE: case-insensitive, no allocations
+	const FeatureDef* GetFeatureDef(const char* name, const bool showError = true) const;
+	const FeatureDef* GetFeatureDef(const std::string& name, const bool showError = true) const { return (GetFeatureDef(name.c_str(), showError)); }
 	const FeatureDef* GetFeatureDefByID(int id) const {
 		if (!IsValidFeatureDefID(id))
 			return nullptr;
@@ -56,6 +61,7 @@ private:
 
 private:
 	spring::unordered_map<std::string, int> featureDefIDs;
+	DefNameIndex featureDefNameIndex;
 	std::vector<FeatureDef> featureDefsVector;
 };
 
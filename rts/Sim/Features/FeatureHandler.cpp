@@ -26,7 +26,7 @@ CR_REG_METADATA(CFeatureHandler, (
 
 /******************************************************************************/
 
-FeatureMemPool featureMemPool;
+FeatureMemPool featureMemPool("Features");
 
 CFeatureHandler featureHandler;
 
@@ -10,6 +10,11 @@
 #include "System/Matrix44f.h"
 #include "System/Log/ILog.h"
 
+// models with fewer pieces are traced linearly, a tree would not pay off
+static constexpr unsigned int MIN_PIECE_BVH_PIECES = 8;
+// model-space padding of the piece boxes (in elmos)
+static constexpr float PIECE_BVH_PADDING = 0.5f;
+
 unsigned int CCollisionHandler::numDiscTests = 0;
 unsigned int CCollisionHandler::numContTests = 0;
 
@@ -251,6 +256,50 @@ bool CCollisionHandler::IntersectPieceTreeHelper(
 }
 */
 
+static const CPieceVolumeBVH& UpdatePieceVolumeBVH(const LocalModel& lm)
+{
+	// pieces only change in serial code, but the traces that notice it
+	// first may run in parallel; once refit the tree is only read again
+	std::lock_guard<spring::spinlock> lock(lm.pieceVolumeBVHMutex);
+
+	CPieceVolumeBVH& bvh = lm.pieceVolumeBVH;
+
+	const unsigned int numTreeChanges = lm.GetRoot()->GetNumTreeChanges();
+
+	if (!bvh.Empty() && bvh.GetNumLeaves() == lm.pieces.size() && lm.pieceVolumeBVHChanges == numTreeChanges)
+		return bvh;
+
+	bvh.Resize(lm.pieces.size());
+
+	for (unsigned int n = 0; n < lm.pieces.size(); n++) {
+		const LocalModelPiece* lmp = lm.GetPiece(n);
+		const CollisionVolume* lmpVol = lmp->GetCollisionVolume();
+		const CMatrix44f& lmpMat = lmp->GetModelSpaceMatrix();
+
+		const float3& offsets = lmpVol->GetOffsets();
+		const float3& hscales = lmpVol->GetHScales();
+
+		float3 mins = lmpMat.Mul(offsets - hscales);
+		float3 maxs = mins;
+
+		for (unsigned int i = 1; i < 8; i++) {
+			const float3 corner = {(i & 1)? hscales.x: -hscales.x, (i & 2)? hscales.y: -hscales.y, (i & 4)? hscales.z: -hscales.z};
+			const float3 vertex = lmpMat.Mul(offsets + corner);
+
+			mins = float3::min(mins, vertex);
+			maxs = float3::max(maxs, vertex);
+		}
+
+		// padded, tracing in model-space has different rounding than in volume-space
+		bvh.SetLeafBox(n, mins - PIECE_BVH_PADDING, maxs + PIECE_BVH_PADDING);
+	}
+
+	bvh.Fit();
+
+	lm.pieceVolumeBVHChanges = numTreeChanges;
+	return bvh;
+}
+
 bool CCollisionHandler::IntersectPiecesHelper(
 	const CSolidObject* o,
 	const CMatrix44f& m,
@@ -263,36 +312,75 @@ bool CCollisionHandler::IntersectPiecesHelper(
 	float minDistSq = std::numeric_limits<float>::max();
 	float curDistSq = minDistSq;
 
-	for (unsigned int n = 0; n < o->localModel.pieces.size(); n++) {
+	// ties between pieces are won by the lowest index, like a linear scan would
+	unsigned int minDistIdx = -1u;
+
+	const auto TestPiece = [&](unsigned int n) {
 		const LocalModelPiece* lmp = o->localModel.GetPiece(n);
 		const CollisionVolume* lmpVol = lmp->GetCollisionVolume();
 
 		if (!lmp->GetScriptVisible() || lmpVol->IgnoreHits())
-			continue;
+			return false;
 
 		volMat = m * lmp->GetModelSpaceMatrix();
 		volMat.Translate(lmpVol->GetOffsets());
 
 		CollisionQuery cqn;
 		if (!CCollisionHandler::Intersect(lmpVol, volMat, p0, p1, &cqn))
-			continue;
+			return false;
 
 		// skip if neither an ingress nor an egress hit
 		if (!cqn.AnyHit())
-			continue;
+			return false;
 
 		// save the closest intersection (others are not needed)
-		if ((curDistSq = (cqn.GetHitPos()).SqDistance(p0)) >= minDistSq)
-			continue;
+		if ((curDistSq = (cqn.GetHitPos()).SqDistance(p0)) > minDistSq)
+			return false;
+		if (curDistSq == minDistSq && (minDistIdx == -1u || n > minDistIdx))
+			return false;
 
 		minDistSq = curDistSq;
+		minDistIdx = n;
 
-		// return early if caller only wants to know a collision exists
 		if (cq == nullptr)
 			return true;
 
 		*cq = cqn;
 		cq->SetHitPiece(lmp);
+		return true;
+	};
+
+	if (o->localModel.pieces.size() < MIN_PIECE_BVH_PIECES) {
+		for (unsigned int n = 0; n < o->localModel.pieces.size(); n++) {
+			// return early if caller only wants to know a collision exists
+			if (TestPiece(n) && cq == nullptr)
+				return true;
+		}
+	} else {
+		const CPieceVolumeBVH& bvh = UpdatePieceVolumeBVH(o->localModel);
+		const CMatrix44f mInv = m.InvertAffine();
+
+		// boxes are in model-space, but parameters along the segment are preserved
+		const float segLength = p0.distance(p1);
+
+		float maxT = 1.0f;
+		bool anyHit = false;
+
+		bvh.Trace(mInv.Mul(p0), mInv.Mul(p1), maxT, [&](int n, float tEnter) {
+			if (!TestPiece(n))
+				return true;
+
+			// inside-hits report a meaningless distance, but only boxes
+			// containing p0 (tEnter=0) can produce them and are never pruned
+			if (segLength > 0.0f)
+				maxT = (math::sqrt(minDistSq) + PIECE_BVH_PADDING) / segLength;
+
+			anyHit = true;
+			return (cq != nullptr);
+		});
+
+		if (anyHit && cq == nullptr)
+			return true;
 	}
 
 	// true iff at least one piece was intersected
@@ -300,7 +388,6 @@ bool CCollisionHandler::IntersectPiecesHelper(
 	return (cq != nullptr && cq->GetHitPiece() != nullptr);
 }
 
-
 bool CCollisionHandler::IntersectPieceTree(
 	const CSolidObject* o,
 	const CMatrix44f& m,
@@ -0,0 +1,133 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef DEF_NAME_INDEX_H
+#define DEF_NAME_INDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Flat open-addressing table mapping def names to def IDs. Names are
+ * hashed lower-case while probing, so case-insensitive lookups of the
+ * const char* names passed in by Lua and AI callbacks need no temporary
+ * std::string; compared to the string-keyed handler maps this saves the
+ * copy, the lower-casing pass and the node-based bucket walk per lookup.
+ *
+ * Stored names must already be lower-case (as def names are) to match.
+ */
+class DefNameIndex {
+public:
+	void Clear() {
+		slots.clear();
+		names.clear();
+	}
+
+	/// re-inserting a name replaces its ID, like assigning to the handler maps does
+	void Insert(const std::string& name, int id) {
+		const uint32_t hash = HashLower(name.c_str());
+		const int slotIdx = FindSlot(name.c_str(), hash);
+
+		if (slotIdx != -1) {
+			slots[slotIdx].id = id;
+			return;
+		}
+
+		if ((names.size() + 1) * 2 > slots.size())
+			Rehash(std::max(size_t(16), slots.size() * 2));
+
+		names.push_back(name);
+		InsertSlot({hash, id, uint32_t(names.size() - 1)});
+	}
+
+	/// @return the ID of the def named <name> (any case) or -1
+	int Find(const char* name) const {
+		const int slotIdx = FindSlot(name, HashLower(name));
+
+		if (slotIdx == -1)
+			return -1;
+
+		return slots[slotIdx].id;
+	}
+	int Find(const std::string& name) const { return (Find(name.c_str())); }
+
+	size_t GetSize() const { return names.size(); }
+
+private:
+	struct Slot {
+		uint32_t hash;
+		int id;
+		uint32_t nameIdx;
+	};
+
+	static char ToLower(char c) { return (c + ('a' - 'A') * (c >= 'A' && c <= 'Z')); }
+
+	// same function as hashStringLower, without recursion
+	static uint32_t HashLower(const char* s) {
+		uint32_t hash = 5381u;
+
+		while (*s != 0) {
+			hash = hash + (hash << 5) + ToLower(*(s++));
+		}
+
+		return hash;
+	}
+
+	static bool EqualLower(const char* s, const std::string& lowerName) {
+		size_t i = 0;
+
+		for (; s[i] != 0 && i < lowerName.size(); i++) {
+			if (ToLower(s[i]) != lowerName[i])
+				return false;
+		}
+
+		return (s[i] == 0 && i == lowerName.size());
+	}
+
+	int FindSlot(const char* name, uint32_t hash) const {
+		if (slots.empty())
+			return -1;
+
+		const uint32_t mask = slots.size() - 1;
+
+		for (uint32_t i = hash & mask; slots[i].id != -1; i = (i + 1) & mask) {
+			if (slots[i].hash != hash)
+				continue;
+			if (!EqualLower(name, names[slots[i].nameIdx]))
+				continue;
+
+			return i;
+		}
+
+		return -1;
+	}
+
+	void InsertSlot(const Slot& slot) {
+		const uint32_t mask = slots.size() - 1;
+
+		uint32_t i = slot.hash & mask;
+
+		while (slots[i].id != -1) {
+			i = (i + 1) & mask;
+		}
+
+		slots[i] = slot;
+	}
+
+	void Rehash(size_t numSlots) {
+		std::vector<Slot> oldSlots(numSlots, Slot{0, -1, 0});
+		slots.swap(oldSlots);
+
+		for (const Slot& s: oldSlots) {
+			if (s.id != -1)
+				InsertSlot(s);
+		}
+	}
+
+private:
+	std::vector<Slot> slots; // power-of-two sized, at most half full
+	std::vector<std::string> names;
+};
+
+#endif // DEF_NAME_INDEX_H
@@ -22,10 +22,40 @@ CR_BIND(CGroundBlockingObjectMap, )
 CR_REG_METADATA(CGroundBlockingObjectMap, (
 	CR_MEMBER(arrCells),
 	CR_MEMBER(vecCells),
-	CR_MEMBER(vecIndcs)
+	CR_MEMBER(vecIndcs),
+	CR_IGNORED(occupancyMap),
+	CR_IGNORED(numChanges),
+	CR_POSTLOAD(PostLoad)
 ))
 
 
+void CGroundBlockingObjectMap::Init(unsigned int numSquares)
+{
+	arrCells.resize(numSquares);
+	vecCells.reserve(32);
+	vecIndcs.reserve(32);
+
+	// add dummy
+	if (vecCells.empty())
+		vecCells.emplace_back();
+
+	occupancyMap.Init(mapDims.mapx, mapDims.mapy);
+}
+
+void CGroundBlockingObjectMap::PostLoad()
+{
+	occupancyMap.Init(mapDims.mapx, mapDims.mapy);
+
+	for (unsigned int i = 0; i < arrCells.size(); ++i) {
+		if (arrCells[i].Empty())
+			continue;
+
+		occupancyMap.Set(i % mapDims.mapx, i / mapDims.mapx);
+	}
+
+	numChanges += 1;
+}
+
 
 void CGroundBlockingObjectMap::AddGroundBlockingObject(CSolidObject* object)
 {
@@ -39,6 +69,8 @@ void CGroundBlockingObjectMap::AddGroundBlockingObject(CSolidObject* object)
 	object->SetPhysicalStateBit(CSolidObject::PSTATE_BIT_BLOCKING);
 	object->SetMapPos(object->GetMapPos());
 
+	numChanges += 1;
+
 	const int bx = object->mapPos.x, sx = object->xsize;
 	const int bz = object->mapPos.y, sz = object->zsize;
 	const int xminSqr = bx, xmaxSqr = bx + sx;
@@ -62,6 +94,8 @@ void CGroundBlockingObjectMap::AddGroundBlockingObject(CSolidObject* object, con
 	object->SetPhysicalStateBit(CSolidObject::PSTATE_BIT_BLOCKING);
 	object->SetMapPos(object->GetMapPos());
 
+	numChanges += 1;
+
 	const int bx = object->mapPos.x, sx = object->xsize;
 	const int bz = object->mapPos.y, sz = object->zsize;
 	const int xminSqr = bx, xmaxSqr = bx + sx;
@@ -95,6 +129,8 @@ void CGroundBlockingObjectMap::RemoveGroundBlockingObject(CSolidObject* object)
 
 	object->ClearPhysicalStateBit(CSolidObject::PSTATE_BIT_BLOCKING);
 
+	numChanges += 1;
+
 	for (int z = bz; z < bz + sz; ++z) {
 		for (int x = bx; x < bx + sx; ++x) {
 			CellErase(z * mapDims.mapx + x, object);
@@ -231,8 +267,10 @@ bool CGroundBlockingObjectMap::CellInsertUnique(unsigned int sqr, CSolidObject*
 
 	if (ac.Contains(o))
 		return false;
-	if (ac.Insert(o))
+	if (ac.Insert(o)) {
+		occupancyMap.Set(sqr % mapDims.mapx, sqr / mapDims.mapx);
 		return true;
+	}
 
 	// array-cell is full, spill over
 	if ((vc = &GetVecCell(sqr)) == &vecCells[0]) {
@@ -254,8 +292,12 @@ bool CGroundBlockingObjectMap::CellErase(unsigned int sqr, CSolidObject* o) {
 	VecCell* vc = nullptr;
 
 	if (ac.Erase(o)) {
-		if (ac.GetVecIndx() == 0)
+		if (ac.GetVecIndx() == 0) {
+			if (ac.Empty())
+				occupancyMap.Reset(sqr % mapDims.mapx, sqr / mapDims.mapx);
+
 			return true;
+		}
 
 		// never allow a hole between array and vector parts
 		assert(!vecCells[ac.GetVecIndx()].empty());
@@ -6,6 +6,7 @@
 #include <array>
 #include <vector>
 
+#include "OccupancyBitMap.h"
 #include "Sim/Objects/SolidObject.h"
 #include "System/creg/creg_cond.h"
 #include "System/float3.h"
@@ -97,15 +98,7 @@ public:
 	};
 
 
-	void Init(unsigned int numSquares) {
-		arrCells.resize(numSquares);
-		vecCells.reserve(32);
-		vecIndcs.reserve(32);
-
-		// add dummy
-		if (vecCells.empty())
-			vecCells.emplace_back();
-	}
+	void Init(unsigned int numSquares);
 	void Kill() {
 		// reuse inner vectors when reloading
 		// vecCells.clear();
@@ -117,9 +110,16 @@ public:
 		}
 
 		vecIndcs.clear();
+		occupancyMap.Clear();
+
+		numChanges += 1;
 	}
 
+	void PostLoad();
+
 	unsigned int CalcChecksum() const;
+	/// incremented on every object insertion or removal (includes yard open/close)
+	unsigned int GetNumChanges() const { return numChanges; }
 
 	void AddGroundBlockingObject(CSolidObject* object);
 	void AddGroundBlockingObject(CSolidObject* object, const YardMapStatus& mask);
@@ -147,6 +147,10 @@ public:
 	}
 
 
+	/// @return true if any square in [xmin, xmax] x [zmin, zmax] (inclusive) contains an object
+	bool AnyBlockedInRect(int xmin, int xmax, int zmin, int zmax) const { return (occupancyMap.AnyInRect(xmin, xmax, zmin, zmax)); }
+	const COccupancyBitMap& GetOccupancyMap() const { return occupancyMap; }
+
 	bool GroundBlocked(int x, int z, const CSolidObject* ignoreObj) const;
 	bool GroundBlocked(const float3& pos, const CSolidObject* ignoreObj) const;
 
@@ -186,6 +190,12 @@ private:
 	std::vector<ArrCell> arrCells;
 	std::vector<VecCell> vecCells;
 	std::vector<uint32_t> vecIndcs;
+
+	// not serialized, rebuilt from arrCells on load; bit is set iff the cell is non-empty
+	COccupancyBitMap occupancyMap;
+
+	// not serialized, only used to validate caches derived from the map
+	unsigned int numChanges = 0;
 };
 
 extern CGroundBlockingObjectMap groundBlockingObjectMap;
@@ -7,6 +7,7 @@
 
 #include "Map/Ground.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/SlowUpdateScheduler.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Weapons/Weapon.h"
 #include "Sim/Projectiles/WeaponProjectiles/WeaponProjectile.h"
@@ -32,6 +33,8 @@ void CInterceptHandler::Update(bool forced) {
 	if (((gs->frameNum % UNIT_SLOWUPDATE_RATE) != 0) && !forced)
 		return;
 
+	slowUpdateScheduler.SetCategoryCost(CSlowUpdateScheduler::CATEGORY_INTERCEPTS, interceptors.size() * interceptables.size() * CSlowUpdateScheduler::INTERCEPT_PAIR_COST);
+
 	for (CWeapon* w: interceptors) {
 		const WeaponDef* wDef = w->weaponDef;
 		const CUnit* wOwner = w->owner;
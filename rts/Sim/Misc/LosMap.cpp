@@ -4,7 +4,7 @@
 #include <array>
 
 #include "LosMap.h"
-#include "LosHandler.h"
+#include "LosInstance.h"
 #include "Map/ReadMap.h"
 #include "System/SpringMath.h"
 #include "System/float3.h"
@@ -434,8 +434,8 @@ void CLosMap::AddRaycast(SLosInstance* instance, int amount)
 
 #ifdef USE_UNSYNCED_HEIGHTMAP
 	// inform ReadMap when squares enter LoS
-	const bool visibleInstanceSquares = (instance->allyteam >= 0 && (instance->allyteam == gu->myAllyTeam || gu->spectatingFullView));
-	const bool updateUnsyncedHeightMap = sendReadmapEvents && visibleInstanceSquares;
+	// test sendReadmapEvents first, only the LOS maps need to know about visibility
+	const bool updateUnsyncedHeightMap = sendReadmapEvents && (instance->allyteam >= 0 && (instance->allyteam == gu->myAllyTeam || gu->spectatingFullView));
 
 	if ((amount > 0) && updateUnsyncedHeightMap) {
 		for (const SLosInstance::RLE rle: losSquares) {
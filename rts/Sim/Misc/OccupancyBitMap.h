@@ -0,0 +1,94 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef OCCUPANCY_BITMAP_H
+#define OCCUPANCY_BITMAP_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+/**
+ * One bit per map square, set while the square holds anything. Rows are
+ * padded to whole 64-bit words so a rectangle query tests up to 64 squares
+ * per operation, letting area scans skip empty regions without touching
+ * the per-square object lists.
+ */
+class COccupancyBitMap {
+public:
+	void Init(int sizeX, int sizeZ) {
+		xsize = sizeX;
+		zsize = sizeZ;
+		wordsPerRow = (sizeX + 63) / 64;
+
+		words.clear();
+		words.resize(wordsPerRow * sizeZ, 0);
+	}
+	void Clear() { std::fill(words.begin(), words.end(), 0); }
+
+	void Set(int x, int z) { words[WordIndex(x, z)] |= BitMask(x); }
+	void Reset(int x, int z) { words[WordIndex(x, z)] &= ~BitMask(x); }
+
+	bool Test(int x, int z) const { return ((words[WordIndex(x, z)] & BitMask(x)) != 0); }
+
+	/// @return true if any square in [xmin, xmax] x [zmin, zmax] (inclusive, clamped to the map) is set
+	bool AnyInRect(int xmin, int xmax, int zmin, int zmax) const {
+		xmin = std::max(xmin, 0); xmax = std::min(xmax, xsize - 1);
+		zmin = std::max(zmin, 0); zmax = std::min(zmax, zsize - 1);
+
+		if (xmin > xmax || zmin > zmax)
+			return false;
+
+		const int wmin = xmin >> 6;
+		const int wmax = xmax >> 6;
+
+		const uint64_t minMask = ~uint64_t(0) << (xmin & 63);
+		const uint64_t maxMask = ~uint64_t(0) >> (63 - (xmax & 63));
+
+		for (int z = zmin; z <= zmax; z++) {
+			const uint64_t* row = &words[z * wordsPerRow];
+
+			if (wmin == wmax) {
+				if ((row[wmin] & minMask & maxMask) != 0)
+					return true;
+
+				continue;
+			}
+
+			uint64_t bits = (row[wmin] & minMask) | (row[wmax] & maxMask);
+
+			for (int w = wmin + 1; w < wmax; w++) {
+				bits |= row[w];
+			}
+
+			if (bits != 0)
+				return true;
+		}
+
+		return false;
+	}
+
+	/// @return true if any square in row <z> within [xmin, xmax] is set
+	bool AnyInRow(int xmin, int xmax, int z) const { return (AnyInRect(xmin, xmax, z, z)); }
+
+	int GetSizeX() const { return xsize; }
+	int GetSizeZ() const { return zsize; }
+
+private:
+	size_t WordIndex(int x, int z) const {
+		assert(x >= 0 && x < xsize);
+		assert(z >= 0 && z < zsize);
+		return (z * wordsPerRow + (x >> 6));
+	}
+
+	static uint64_t BitMask(int x) { return (uint64_t(1) << (x & 63)); }
+
+private:
+	std::vector<uint64_t> words;
+
+	int xsize = 0;
+	int zsize = 0;
+	int wordsPerRow = 0;
+};
+
+#endif
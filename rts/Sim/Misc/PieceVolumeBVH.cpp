@@ -0,0 +1,83 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "PieceVolumeBVH.h"
+
+#include <cassert>
+#include <numeric>
+
+
+void CPieceVolumeBVH::Fit()
+{
+	if (leafMins.empty()) {
+		nodes.clear();
+		return;
+	}
+
+	if (nodes.empty()) {
+		std::vector<int> leafIndices(leafMins.size());
+		std::iota(leafIndices.begin(), leafIndices.end(), 0);
+
+		nodes.reserve(leafMins.size() * 2 - 1);
+		BuildRec(leafIndices.data(), leafIndices.size());
+		return;
+	}
+
+	// children always follow their parent, so a reverse sweep refits bottom-up
+	for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+		Node& node = *it;
+
+		if (node.IsLeaf()) {
+			node.mins = leafMins[node.rgt];
+			node.maxs = leafMaxs[node.rgt];
+			continue;
+		}
+
+		node.mins = float3::min(nodes[node.lft].mins, nodes[node.rgt].mins);
+		node.maxs = float3::max(nodes[node.lft].maxs, nodes[node.rgt].maxs);
+	}
+}
+
+int CPieceVolumeBVH::BuildRec(int* leafIndices, int numIndices)
+{
+	assert(numIndices > 0);
+
+	const int nodeIdx = nodes.size();
+
+	nodes.emplace_back();
+
+	if (numIndices == 1) {
+		nodes[nodeIdx] = {leafMins[leafIndices[0]], leafMaxs[leafIndices[0]], -1, leafIndices[0]};
+		return nodeIdx;
+	}
+
+	// split at the median box-center along the axis where the centers are spread widest
+	float3 cmins = (leafMins[leafIndices[0]] + leafMaxs[leafIndices[0]]) * 0.5f;
+	float3 cmaxs = cmins;
+
+	for (int i = 1; i < numIndices; i++) {
+		const float3 c = (leafMins[leafIndices[i]] + leafMaxs[leafIndices[i]]) * 0.5f;
+
+		cmins = float3::min(cmins, c);
+		cmaxs = float3::max(cmaxs, c);
+	}
+
+	const float3 extents = cmaxs - cmins;
+	const int axis = (extents.x >= extents.y && extents.x >= extents.z)? 0: ((extents.y >= extents.z)? 1: 2);
+	const int half = numIndices / 2;
+
+	std::nth_element(leafIndices, leafIndices + half, leafIndices + numIndices, [&](int a, int b) {
+		return ((leafMins[a][axis] + leafMaxs[a][axis]) < (leafMins[b][axis] + leafMaxs[b][axis]));
+	});
+
+	const int lft = BuildRec(leafIndices, half);
+	const int rgt = BuildRec(leafIndices + half, numIndices - half);
+
+	nodes[nodeIdx] = {
+		float3::min(nodes[lft].mins, nodes[rgt].mins),
+		float3::max(nodes[lft].maxs, nodes[rgt].maxs),
+		lft,
+		rgt
+	};
+
+	return nodeIdx;
+}
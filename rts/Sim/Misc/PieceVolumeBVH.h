@@ -0,0 +1,158 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef PIECE_VOLUME_BVH_H
+#define PIECE_VOLUME_BVH_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include "System/float3.h"
+
+/**
+ * Bounding-volume hierarchy over the model-space boxes enclosing the
+ * per-piece collision volumes of a LocalModel.
+ *
+ * The topology is built once (median splits along the widest axis of the
+ * pose at that time); after that the node boxes are only refit when the
+ * pieces move. This keeps the tree valid for animated models, although it
+ * may become less tight than a rebuilt one.
+ */
+class CPieceVolumeBVH
+{
+public:
+	struct Node {
+		float3 mins;
+		float3 maxs;
+
+		// inner nodes: children (always at higher indices than their parent)
+		// leaves: lft is -1, rgt is the leaf index
+		int lft;
+		int rgt;
+
+		bool IsLeaf() const { return (lft < 0); }
+	};
+
+public:
+	/// discards the topology if the number of leaves changes
+	void Resize(size_t numLeaves) {
+		if (numLeaves == leafMins.size())
+			return;
+
+		nodes.clear();
+		leafMins.resize(numLeaves);
+		leafMaxs.resize(numLeaves);
+	}
+
+	void SetLeafBox(size_t leafIdx, const float3& mins, const float3& maxs) {
+		leafMins[leafIdx] = mins;
+		leafMaxs[leafIdx] = maxs;
+	}
+
+	/// builds the topology on the first call after Resize, refits it otherwise
+	void Fit();
+
+	bool Empty() const { return nodes.empty(); }
+	size_t GetNumLeaves() const { return leafMins.size(); }
+	const std::vector<Node>& GetNodes() const { return nodes; }
+
+	/**
+	 * Visits every leaf whose box is entered by the segment p0 + (p1 - p0) * t
+	 * for some t in [0, maxT], closer subtrees first. The visitor is called as
+	 * visitor(leafIdx, tEnter) and may lower maxT to prune subtrees it is not
+	 * interested in anymore; returning false ends the traversal.
+	 */
+	template<typename Visitor>
+	void Trace(const float3& p0, const float3& p1, float& maxT, Visitor&& visitor) const {
+		if (nodes.empty())
+			return;
+
+		const float3 dir = p1 - p0;
+
+		// inner nodes have at most two children, depth is bounded by the leaf count
+		std::array<std::pair<int, float>, 64> stack;
+		size_t stackSize = 0;
+
+		float tEnter = IntersectSegment(nodes[0].mins, nodes[0].maxs, p0, dir);
+
+		if (tEnter > maxT)
+			return;
+
+		stack[stackSize++] = {0, tEnter};
+
+		while (stackSize > 0) {
+			const auto entry = stack[--stackSize];
+			const Node& node = nodes[entry.first];
+
+			// maxT might have been lowered since this node was pushed
+			if (entry.second > maxT)
+				continue;
+
+			if (node.IsLeaf()) {
+				if (!visitor(node.rgt, entry.second))
+					return;
+
+				continue;
+			}
+
+			const float tl = IntersectSegment(nodes[node.lft].mins, nodes[node.lft].maxs, p0, dir);
+			const float tr = IntersectSegment(nodes[node.rgt].mins, nodes[node.rgt].maxs, p0, dir);
+
+			// push the farther child first so the nearer one is visited next
+			const std::pair<int, float> near = (tl <= tr)? std::pair<int, float>{node.lft, tl}: std::pair<int, float>{node.rgt, tr};
+			const std::pair<int, float> far  = (tl <= tr)? std::pair<int, float>{node.rgt, tr}: std::pair<int, float>{node.lft, tl};
+
+			// building splits at the median, so this can only overflow for absurd piece counts
+			assert((stackSize + 2) <= stack.size());
+
+			if (far.second <= maxT)
+				stack[stackSize++] = far;
+			if (near.second <= maxT)
+				stack[stackSize++] = near;
+		}
+	}
+
+	/**
+	 * @return the segment parameter t in [0, 1] at which p0 + dir * t enters
+	 *   the box (0 if p0 is inside it), or a value greater than 1 on a miss
+	 */
+	static float IntersectSegment(const float3& mins, const float3& maxs, const float3& p0, const float3& dir) {
+		constexpr float MISS = 2.0f;
+
+		float tn = 0.0f;
+		float tf = 1.0f;
+
+		for (int a = 0; a < 3; a++) {
+			if (dir[a] == 0.0f) {
+				if (p0[a] < mins[a] || p0[a] > maxs[a])
+					return MISS;
+
+				continue;
+			}
+
+			const float t0 = (mins[a] - p0[a]) / dir[a];
+			const float t1 = (maxs[a] - p0[a]) / dir[a];
+
+			tn = std::max(tn, std::min(t0, t1));
+			tf = std::min(tf, std::max(t0, t1));
+
+			if (tn > tf)
+				return MISS;
+		}
+
+		return tn;
+	}
+
+private:
+	int BuildRec(int* leafIndices, int numIndices);
+
+private:
+	std::vector<Node> nodes;
+
+	std::vector<float3> leafMins;
+	std::vector<float3> leafMaxs;
+};
+
+#endif // PIECE_VOLUME_BVH_H
@@ -9,6 +9,7 @@
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "System/ContainerUtil.h"
+#include "System/Log/ILog.h"
 #include "System/Threading/ThreadPool.h"
 
 #ifndef UNIT_TEST
@@ -31,7 +32,9 @@ CR_REG_METADATA(CQuadField, (
 	CR_IGNORED(tempFeatures),
 	CR_IGNORED(tempProjectiles),
 	CR_IGNORED(tempSolids),
-	CR_IGNORED(tempQuads)
+	CR_IGNORED(tempQuads),
+
+	CR_IGNORED(solidsRevision)
 ))
 
 CR_BIND(CQuadField::Quad, )
@@ -125,8 +128,9 @@ void CQuadField::Init(int2 mapDims, int quadSize)
 
 	size_t threadCount = ThreadPool::GetNumThreads();
 
+	// nested queries are common (GetUnits* reserve a quads vector internally)
 	for (size_t i = 0; i < threadCount; ++i) {
-		tempQuads[i].ReserveAll(numQuadsX * numQuadsZ);
+		tempQuads[i].Reserve(3, numQuadsX * numQuadsZ);
 		tempQuads[i].ReleaseAll();
 	}
 
@@ -146,19 +150,68 @@ void CQuadField::Kill()
 		quad.Clear();
 	}
 
-	for (auto cache : tempUnits)
+	const auto stats = GetQueryAllocStats();
+
+	LOG("[QuadField::%s] query arenas: %u slots, %u slot-allocs, %u grow-allocs", __func__,
+		static_cast<uint32_t>(stats.numSlots),
+		static_cast<uint32_t>(stats.numSlotAllocs),
+		static_cast<uint32_t>(stats.numGrowAllocs)
+	);
+
+	for (auto& cache: tempUnits)
 		cache.ReleaseAll();
 
-	for (auto cache : tempFeatures)
+	for (auto& cache: tempFeatures)
 		cache.ReleaseAll();
 
-	tempProjectiles.ReleaseAll();
+	for (auto& cache: tempProjectiles)
+		cache.ReleaseAll();
 
-	for (auto cache : tempSolids)
+	for (auto& cache: tempSolids)
 		cache.ReleaseAll();
 
-	for (auto cache : tempQuads)
+	for (auto& cache: tempQuads)
 		cache.ReleaseAll();
+
+	ResetQueryAllocStats();
+}
+
+
+QueryVectorArena<int>::AllocStats CQuadField::GetQueryAllocStats() const
+{
+	QueryVectorArena<int>::AllocStats sum;
+
+	const auto AddStats = [&sum](const auto& arenas) {
+		for (const auto& arena: arenas) {
+			const auto stats = arena.GetStats();
+
+			sum.numSlots += stats.numSlots;
+			sum.numSlotAllocs += stats.numSlotAllocs;
+			sum.numGrowAllocs += stats.numGrowAllocs;
+		}
+	};
+
+	AddStats(tempUnits);
+	AddStats(tempFeatures);
+	AddStats(tempProjectiles);
+	AddStats(tempSolids);
+	AddStats(tempQuads);
+	return sum;
+}
+
+void CQuadField::ResetQueryAllocStats()
+{
+	const auto ResetStats = [](auto& arenas) {
+		for (auto& arena: arenas) {
+			arena.ResetStats();
+		}
+	};
+
+	ResetStats(tempUnits);
+	ResetStats(tempFeatures);
+	ResetStats(tempProjectiles);
+	ResetStats(tempSolids);
+	ResetStats(tempQuads);
 }
 
 
@@ -177,7 +230,6 @@ int CQuadField::WorldPosToQuadFieldIdx(const float3 p) const
 }
 
 
-#ifndef UNIT_TEST
 void CQuadField::GetQuads(QuadFieldQuery& qfq, float3 pos, float radius)
 {
 	pos.AssertNaNs();
@@ -230,7 +282,6 @@ void CQuadField::GetQuadsRectangle(QuadFieldQuery& qfq, const float3& mins, cons
 
 	return;
 }
-#endif // UNIT_TEST
 
 
 /// note: this function got an UnitTest, check the tests/ folder!
@@ -339,6 +390,7 @@ bool CQuadField::InsertUnitIf(CUnit* unit, const float3& wpos)
 
 	spring::VectorInsertUnique(baseQuads[wposQuadIdx].units, unit, false);
 	spring::VectorInsertUnique(baseQuads[wposQuadIdx].teamUnits[unit->allyteam], unit, false);
+	solidsRevision++;
 	return true;
 }
 
@@ -369,6 +421,7 @@ bool CQuadField::RemoveUnitIf(CUnit* unit, const float3& wpos)
 
 	spring::VectorErase(baseQuads[wposQuadIdx].units, unit);
 	spring::VectorErase(baseQuads[wposQuadIdx].teamUnits[unit->allyteam], unit);
+	solidsRevision++;
 	return true;
 }
 #endif
@@ -398,6 +451,7 @@ void CQuadField::MovedUnit(CUnit* unit)
 	}
 
 	unit->quads = std::move(*qfQuery.quads);
+	solidsRevision++;
 }
 
 void CQuadField::RemoveUnit(CUnit* unit)
@@ -408,6 +462,7 @@ void CQuadField::RemoveUnit(CUnit* unit)
 	}
 
 	unit->quads.clear();
+	solidsRevision++;
 
 	#ifdef DEBUG_QUADFIELD
 	for (const Quad& q: baseQuads) {
@@ -471,6 +526,8 @@ void CQuadField::AddFeature(CFeature* feature)
 	for (const int qi: *qfQuery.quads) {
 		spring::VectorInsertUnique(baseQuads[qi].features, feature, false);
 	}
+
+	solidsRevision++;
 }
 
 void CQuadField::RemoveFeature(CFeature* feature)
@@ -482,6 +539,8 @@ void CQuadField::RemoveFeature(CFeature* feature)
 		spring::VectorErase(baseQuads[qi].features, feature);
 	}
 
+	solidsRevision++;
+
 	#ifdef DEBUG_QUADFIELD
 	for (const Quad& q: baseQuads) {
 		for (CFeature* f: q.features) {
@@ -602,8 +661,8 @@ void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& mins, const fl
 {
 	auto curThread = qfq.threadOwner;
 	QuadFieldQuery qfQuery;
-	GetQuadsRectangle(qfQuery, mins, maxs);
 	qfQuery.threadOwner = curThread;
+	GetQuadsRectangle(qfQuery, mins, maxs);
 	const int tempNum = gs->GetMtTempNum(curThread);
 	qfq.units = tempUnits[curThread].ReserveVector();
 
@@ -694,17 +753,19 @@ void CQuadField::GetFeaturesExact(QuadFieldQuery& qfq, const float3& mins, const
 
 void CQuadField::GetProjectilesExact(QuadFieldQuery& qfq, const float3& pos, float radius)
 {
+	auto curThread = qfq.threadOwner;
 	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = curThread;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
-	qfq.projectiles = tempProjectiles.ReserveVector();
+	const int tempNum = gs->GetMtTempNum(curThread);
+	qfq.projectiles = tempProjectiles[curThread].ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CProjectile* p: baseQuads[qi].projectiles) {
-			if (p->tempNum == tempNum)
+			if (p->mtTempNum[curThread] == tempNum)
 				continue;
 
-			p->tempNum = tempNum;
+			p->mtTempNum[curThread] = tempNum;
 
 			if (pos.SqDistance(p->pos) >= Square(radius + p->radius))
 				continue;
@@ -718,17 +779,19 @@ void CQuadField::GetProjectilesExact(QuadFieldQuery& qfq, const float3& pos, flo
 
 void CQuadField::GetProjectilesExact(QuadFieldQuery& qfq, const float3& mins, const float3& maxs)
 {
+	auto curThread = qfq.threadOwner;
 	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = curThread;
 	GetQuadsRectangle(qfQuery, mins, maxs);
-	const int tempNum = gs->GetTempNum();
-	qfq.projectiles = tempProjectiles.ReserveVector();
+	const int tempNum = gs->GetMtTempNum(curThread);
+	qfq.projectiles = tempProjectiles[curThread].ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CProjectile* p: baseQuads[qi].projectiles) {
-			if (p->tempNum == tempNum)
+			if (p->mtTempNum[curThread] == tempNum)
 				continue;
 
-			p->tempNum = tempNum;
+			p->mtTempNum[curThread] = tempNum;
 
 			const float3& pos = p->pos;
 			if (pos.x < mins.x || pos.x > maxs.x)
@@ -846,6 +909,186 @@ bool CQuadField::NoSolidsExact(
 }
 
 
+
+void CQuadField::GatherNeighbourhood(QuadFieldNeighbourhood& nh, const float3& pos, float radius)
+{
+	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = ThreadPool::GetThreadNum();
+	GetQuads(qfQuery, pos, radius);
+
+	nh.quads.assign(qfQuery.quads->begin(), qfQuery.quads->end());
+	nh.units.clear();
+	nh.features.clear();
+
+	nh.pos = pos;
+	nh.radius = radius;
+	nh.revision = solidsRevision;
+
+	// no dedup and a cylindrical test; both keep this a superset of
+	// every (spherical or cylindrical) query the neighbourhood serves
+	for (const int qi: nh.quads) {
+		for (CUnit* u: baseQuads[qi].units) {
+			if (pos.SqDistance2D(u->pos) >= Square(radius + u->radius))
+				continue;
+
+			nh.units.emplace_back(qi, u);
+		}
+
+		for (CFeature* f: baseQuads[qi].features) {
+			if (pos.SqDistance2D(f->pos) >= Square(radius + f->radius))
+				continue;
+
+			nh.features.emplace_back(qi, f);
+		}
+	}
+}
+
+bool CQuadField::CanUseNeighbourhood(const QuadFieldNeighbourhood& nh, const float3& pos, float radius, float maxObjectDist) const
+{
+	if (nh.radius < 0.0f || maxObjectDist < 0.0f)
+		return false;
+	// objects were added to, removed from or moved between quads since
+	if (nh.revision != solidsRevision)
+		return false;
+
+	// anything within <radius> of <pos> now was within this distance
+	// of nh.pos when gathered; the extra elmo absorbs rounding errors
+	return ((radius + pos.distance(nh.pos) + maxObjectDist + 1.0f) <= nh.radius);
+}
+
+
+void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const QuadFieldNeighbourhood& nh, const float3& pos, float radius)
+{
+	auto curThread = qfq.threadOwner;
+	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = curThread;
+	GetQuads(qfQuery, pos, radius);
+	const int tempNum = gs->GetMtTempNum(curThread);
+	qfq.units = tempUnits[curThread].ReserveVector();
+
+	// both are sorted by quad index
+	auto entryIt = nh.units.cbegin();
+
+	for (const int qi: *qfQuery.quads) {
+		assert(std::binary_search(nh.quads.begin(), nh.quads.end(), qi));
+
+		while (entryIt != nh.units.cend() && entryIt->first < qi)
+			++entryIt;
+
+		for (; entryIt != nh.units.cend() && entryIt->first == qi; ++entryIt) {
+			CUnit* u = entryIt->second;
+
+			if (u->mtTempNum[curThread] == tempNum)
+				continue;
+
+			u->mtTempNum[curThread] = tempNum;
+
+			if (pos.SqDistance(u->pos) >= Square(radius + u->radius))
+				continue;
+
+			qfq.units->push_back(u);
+		}
+	}
+}
+
+void CQuadField::GetFeaturesExact(QuadFieldQuery& qfq, const QuadFieldNeighbourhood& nh, const float3& pos, float radius)
+{
+	auto curThread = qfq.threadOwner;
+	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = curThread;
+	GetQuads(qfQuery, pos, radius);
+	const int tempNum = gs->GetMtTempNum(curThread);
+	qfq.features = tempFeatures[curThread].ReserveVector();
+
+	auto entryIt = nh.features.cbegin();
+
+	for (const int qi: *qfQuery.quads) {
+		assert(std::binary_search(nh.quads.begin(), nh.quads.end(), qi));
+
+		while (entryIt != nh.features.cend() && entryIt->first < qi)
+			++entryIt;
+
+		for (; entryIt != nh.features.cend() && entryIt->first == qi; ++entryIt) {
+			CFeature* f = entryIt->second;
+
+			if (f->mtTempNum[curThread] == tempNum)
+				continue;
+
+			f->mtTempNum[curThread] = tempNum;
+
+			if (pos.SqDistance(f->pos) >= Square(radius + f->radius))
+				continue;
+
+			qfq.features->push_back(f);
+		}
+	}
+}
+
+void CQuadField::GetSolidsExact(
+	QuadFieldQuery& qfq,
+	const QuadFieldNeighbourhood& nh,
+	const float3& pos,
+	const float radius,
+	const unsigned int physicalStateBits,
+	const unsigned int collisionStateBits
+) {
+	auto curThread = qfq.threadOwner;
+	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = curThread;
+	GetQuads(qfQuery, pos, radius);
+	const int tempNum = gs->GetMtTempNum(curThread);
+	qfq.solids = tempSolids[curThread].ReserveVector();
+
+	auto unitIt = nh.units.cbegin();
+	auto featureIt = nh.features.cbegin();
+
+	for (const int qi: *qfQuery.quads) {
+		assert(std::binary_search(nh.quads.begin(), nh.quads.end(), qi));
+
+		while (unitIt != nh.units.cend() && unitIt->first < qi)
+			++unitIt;
+		while (featureIt != nh.features.cend() && featureIt->first < qi)
+			++featureIt;
+
+		for (; unitIt != nh.units.cend() && unitIt->first == qi; ++unitIt) {
+			CUnit* u = unitIt->second;
+
+			if (u->mtTempNum[curThread] == tempNum)
+				continue;
+
+			u->mtTempNum[curThread] = tempNum;
+
+			if (!u->HasPhysicalStateBit(physicalStateBits))
+				continue;
+			if (!u->HasCollidableStateBit(collisionStateBits))
+				continue;
+			if ((pos - u->pos).SqLength() >= Square(radius + u->radius))
+				continue;
+
+			qfq.solids->push_back(u);
+		}
+
+		for (; featureIt != nh.features.cend() && featureIt->first == qi; ++featureIt) {
+			CFeature* f = featureIt->second;
+
+			if (f->mtTempNum[curThread] == tempNum)
+				continue;
+
+			f->mtTempNum[curThread] = tempNum;
+
+			if (!f->HasPhysicalStateBit(physicalStateBits))
+				continue;
+			if (!f->HasCollidableStateBit(collisionStateBits))
+				continue;
+			if ((pos - f->pos).SqLength() >= Square(radius + f->radius))
+				continue;
+
+			qfq.solids->push_back(f);
+		}
+	}
+}
+
+
 // optimization specifically for projectile collisions
 void CQuadField::GetUnitsAndFeaturesColVol(
 	const float3& pos,
@@ -913,4 +1156,133 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 		}
 	}
 }
+
+void CQuadField::GetUnitsAndFeaturesColVol(
+	const std::vector<float4>& spheres,
+	std::vector<CUnit*>& units,
+	std::vector<int2>& unitRanges,
+	std::vector<CFeature*>& features,
+	std::vector<int2>& featureRanges
+) {
+	// spheres overlapping each quad, and the (sphere, object) pairs in range
+	static std::vector<int> quadOffsets;
+	static std::vector<int> quadSpheres;
+	static std::vector<int> sphereQuads;
+	static std::vector<std::pair<int, CUnit*>> unitHits;
+	static std::vector<std::pair<int, CFeature*>> featureHits;
+	static std::vector<CUnit*> sortedUnitHits;
+	static std::vector<CFeature*> sortedFeatureHits;
+
+	quadOffsets.clear();
+	quadOffsets.resize(baseQuads.size() + 1, 0);
+	sphereQuads.clear();
+	unitHits.clear();
+	featureHits.clear();
+
+	for (const float4& sphere: spheres) {
+		QuadFieldQuery qfQuery;
+		GetQuads(qfQuery, sphere, sphere.w);
+
+		for (const int qi: *qfQuery.quads) {
+			quadOffsets[qi + 1] += 1;
+		}
+
+		sphereQuads.insert(sphereQuads.end(), qfQuery.quads->begin(), qfQuery.quads->end());
+		sphereQuads.push_back(-1);
+	}
+
+	for (size_t qi = 1; qi < quadOffsets.size(); qi++) {
+		quadOffsets[qi] += quadOffsets[qi - 1];
+	}
+
+	// group the spheres by quad, in given order within each quad
+	quadSpheres.resize(quadOffsets.back());
+
+	for (size_t i = 0, n = 0; i < spheres.size(); i++, n++) {
+		for (; sphereQuads[n] != -1; n++) {
+			quadSpheres[quadOffsets[sphereQuads[n]]++] = i;
+		}
+	}
+
+	// visit the quads in increasing index order like GetQuads lists them;
+	// each object is range-tested against all spheres overlapping its quad
+	for (size_t qi = 0, beg = 0; qi < baseQuads.size(); qi++) {
+		const size_t end = quadOffsets[qi];
+
+		if (beg == end)
+			continue;
+
+		const Quad& quad = baseQuads[qi];
+
+		for (CUnit* u: quad.units) {
+			const auto* colvol = &u->collisionVolume;
+			const float3 colvolPos = colvol->GetWorldSpacePos(u);
+
+			for (size_t k = beg; k < end; k++) {
+				const float4& sphere = spheres[quadSpheres[k]];
+				const float totRad = sphere.w + colvol->GetBoundingRadius();
+
+				if (sphere.SqDistance(colvolPos) >= (totRad * totRad))
+					continue;
+
+				unitHits.emplace_back(quadSpheres[k], u);
+			}
+		}
+
+		for (CFeature* f: quad.features) {
+			const auto* colvol = &f->collisionVolume;
+			const float3 colvolPos = colvol->GetWorldSpacePos(f);
+
+			for (size_t k = beg; k < end; k++) {
+				const float4& sphere = spheres[quadSpheres[k]];
+				const float totRad = sphere.w + colvol->GetBoundingRadius();
+
+				if (sphere.SqDistance(colvolPos) >= (totRad * totRad))
+					continue;
+
+				featureHits.emplace_back(quadSpheres[k], f);
+			}
+		}
+
+		beg = end;
+	}
+
+	// group the hits by sphere (keeping their quad order), objects that
+	// overlap several of a sphere's quads are kept only once
+	const auto SortHits = [&](const auto& hits, auto& sortedHits, auto& objects, std::vector<int2>& ranges) {
+		ranges.clear();
+		ranges.resize(spheres.size(), {0, 0});
+		sortedHits.resize(hits.size());
+
+		for (const auto& hit: hits) {
+			ranges[hit.first].y += 1;
+		}
+		for (size_t i = 0, sum = 0; i < ranges.size(); i++) {
+			ranges[i].x = sum;
+			sum += ranges[i].y;
+			ranges[i].y = ranges[i].x;
+		}
+		for (const auto& hit: hits) {
+			sortedHits[ranges[hit.first].y++] = hit.second;
+		}
+
+		for (int2& range: ranges) {
+			const int tempNum = gs->GetTempNum();
+			const int beg = objects.size();
+
+			for (int n = range.x; n < range.y; n++) {
+				if (sortedHits[n]->tempNum == tempNum)
+					continue;
+
+				sortedHits[n]->tempNum = tempNum;
+				objects.push_back(sortedHits[n]);
+			}
+
+			range = {beg, int(objects.size())};
+		}
+	};
+
+	SortHits(unitHits, sortedUnitHits, units, unitRanges);
+	SortHits(featureHits, sortedFeatureHits, features, featureRanges);
+}
 #endif // UNIT_TEST
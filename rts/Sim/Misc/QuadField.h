@@ -5,12 +5,16 @@
 
 #include <algorithm>
 #include <array>
+#include <deque>
 #include <vector>
 
+#include "QuadFieldNeighbourhood.h"
+#include "System/MemoryTags.h"
 #include "System/Misc/NonCopyable.h"
 #include "System/Threading/ThreadPool.h"
 #include "System/creg/creg_cond.h"
 #include "System/float3.h"
+#include "System/float4.h"
 #include "System/type2.h"
 
 class CUnit;
@@ -20,56 +24,132 @@ class CSolidObject;
 class CPlasmaRepulser;
 struct QuadFieldQuery;
 
+/**
+ * Per-thread scratch arena for query result vectors.
+ * Vectors are handed out in stack order and the top is rewound as soon as
+ * it (and every slot above a released one) is returned, so nested queries
+ * (e.g. from Lua callins during another query) just go one level deeper.
+ * Slots and their capacity are kept forever; once warmed up, reserving a
+ * vector does not allocate.
+ */
 template<typename T>
-class QueryVectorCache {
+class QueryVectorArena {
 public:
-	typedef std::pair<bool, std::vector<T>> PairType;
+	struct AllocStats {
+		size_t numSlots = 0;
+		size_t numSlotAllocs = 0; // slot creations after Reserve
+		size_t numGrowAllocs = 0; // capacity increases of a handed out vector
+	};
 
-	std::vector<T>* ReserveVector(size_t base = 0, size_t capa = 1024) {
-		const auto pred = [](const PairType& p) { return (!p.first); };
-		const auto iter = std::find_if(vectors.begin() + base, vectors.end(), pred);
+	~QueryVectorArena() {
+		for (const Slot& slot: vectors) {
+			GetMemTag()->OnFree(slot.capacity * sizeof(T));
+		}
+	}
 
-		if (iter != vectors.end()) {
-			iter->first = true;
-			iter->second.clear();
-			iter->second.reserve(capa);
-			return &iter->second;
+	std::vector<T>* ReserveVector(size_t capa = 1024) {
+		if (numReserved == vectors.size()) {
+			vectors.emplace_back();
+			stats.numSlotAllocs += 1;
 		}
 
-		assert(false);
-		return nullptr;
-	}
+		Slot& slot = vectors[numReserved++];
 
-	void ReserveAll(size_t capa) {
-		for (size_t i = 0; i < vectors.size(); ++i) {
-			ReserveVector(i, capa);
+		assert(!slot.inUse);
+		slot.inUse = true;
+		slot.vector.clear();
+
+		if (slot.vector.capacity() < capa) {
+			slot.vector.reserve(capa);
+			stats.numGrowAllocs += 1;
 		}
+
+		UpdateSlotCapacity(slot);
+		return &slot.vector;
 	}
 
 	void ReleaseVector(const std::vector<T>* released) {
 		if (released == nullptr)
 			return;
 
-		const auto pred = [&](const PairType& p) { return (&p.second == released); };
-		const auto iter = std::find_if(vectors.begin(), vectors.end(), pred);
+		// almost always the top slot; scopes can overlap in any order though
+		size_t i = numReserved;
+
+		while (i > 0 && &vectors[i - 1].vector != released) {
+			i -= 1;
+		}
 
-		if (iter == vectors.end()) {
+		if (i == 0) {
 			assert(false);
 			return;
 		}
 
-		iter->first = false;
+		Slot& slot = vectors[i - 1];
+
+		assert(slot.inUse);
+		slot.inUse = false;
+		stats.numGrowAllocs += (slot.vector.capacity() != slot.capacity);
+
+		UpdateSlotCapacity(slot);
+
+		// rewind past every released slot at the top
+		while (numReserved > 0 && !vectors[numReserved - 1].inUse) {
+			numReserved -= 1;
+		}
+	}
+
+	// preallocates <numSlots> vectors of capacity <capa>, not counted in stats
+	void Reserve(size_t numSlots, size_t capa) {
+		while (vectors.size() < numSlots) {
+			vectors.emplace_back();
+		}
+
+		for (Slot& slot: vectors) {
+			slot.vector.reserve(capa);
+			UpdateSlotCapacity(slot);
+		}
 	}
+
 	void ReleaseAll() {
-		for (auto& pair: vectors) {
-			ReleaseVector(&pair.second);
+		for (Slot& slot: vectors) {
+			slot.inUse = false;
 		}
+
+		numReserved = 0;
+	}
+
+	void ResetStats() { stats = {}; }
+
+	AllocStats GetStats() const {
+		AllocStats s = stats;
+		s.numSlots = vectors.size();
+		return s;
 	}
+
 private:
-	// There should at most be 2 concurrent users of each vector type
-	// using 3 to be safe, increase this number if the assertions below
-	// fail
-	std::array<PairType, 3> vectors = {{{false, {}}, {false, {}}, {false, {}}}};
+	struct Slot {
+		std::vector<T> vector;
+		size_t capacity = 0;
+		bool inUse = false;
+	};
+
+	// all arenas of all threads are accounted under one tag
+	static MemoryTag* GetMemTag() {
+		static MemoryTag* memTag = MemoryTags::Get("QuadField");
+		return memTag;
+	}
+
+	void UpdateSlotCapacity(Slot& slot) {
+		GetMemTag()->OnResize(slot.capacity * sizeof(T), slot.vector.capacity() * sizeof(T));
+		slot.capacity = slot.vector.capacity();
+	}
+
+	// deque keeps handed out vectors in place when a new slot is added
+	std::deque<Slot> vectors;
+
+	size_t numReserved = 0;
+
+	AllocStats stats;
 };
 
 
@@ -104,6 +184,22 @@ public:
 		std::vector<CFeature*>& features,
 		std::vector<CPlasmaRepulser*>* repulsers = nullptr
 	);
+	/**
+	 * Same results as calling the above for each of @c spheres (xyz is the
+	 * position, w the radius) in turn, gathered in one pass over the quads
+	 * they cover: each object in those quads is range-tested against every
+	 * sphere overlapping its quad at once. The units and features found for
+	 * sphere i are appended in the order the single query returns them, and
+	 * their [begin, end) indices stored in unitRanges[i] and featureRanges[i].
+	 * Main thread only.
+	 */
+	void GetUnitsAndFeaturesColVol(
+		const std::vector<float4>& spheres,
+		std::vector<CUnit*>& units,
+		std::vector<int2>& unitRanges,
+		std::vector<CFeature*>& features,
+		std::vector<int2>& featureRanges
+	);
 
 	/**
 	 * Returns all units within @c radius of @c pos,
@@ -151,6 +247,31 @@ public:
 		const unsigned int collisionStateBits = 0xFFFFFFFF
 	);
 
+	/**
+	 * Collects the units and features a later query within @c radius of
+	 * @c pos, served from @c nh by the overloads below, could return
+	 */
+	void GatherNeighbourhood(QuadFieldNeighbourhood& nh, const float3& pos, float radius);
+	/**
+	 * Returns true if a query within @c radius of @c pos can be served from
+	 * @c nh, given that no unit or feature moved further than @c maxObjectDist
+	 * since it was gathered (movement that does not change quads otherwise
+	 * goes unnoticed); the results are then equal to those of a direct query
+	 */
+	bool CanUseNeighbourhood(const QuadFieldNeighbourhood& nh, const float3& pos, float radius, float maxObjectDist) const;
+
+	// spherical variants of the above, restricted to a neighbourhood
+	void GetUnitsExact(QuadFieldQuery& qfq, const QuadFieldNeighbourhood& nh, const float3& pos, float radius);
+	void GetFeaturesExact(QuadFieldQuery& qfq, const QuadFieldNeighbourhood& nh, const float3& pos, float radius);
+	void GetSolidsExact(
+		QuadFieldQuery& qfq,
+		const QuadFieldNeighbourhood& nh,
+		const float3& pos,
+		const float radius,
+		const unsigned int physicalStateBits = 0xFFFFFFFF,
+		const unsigned int collisionStateBits = 0xFFFFFFFF
+	);
+
 
 	bool InsertUnitIf(CUnit* unit, const float3& wpos);
 	bool RemoveUnitIf(CUnit* unit, const float3& wpos);
@@ -172,10 +293,17 @@ public:
 
 	void ReleaseVector(std::vector<CUnit*>* v       , int onThread = 0) { tempUnits[onThread].ReleaseVector(v); }
 	void ReleaseVector(std::vector<CFeature*>* v    , int onThread = 0) { tempFeatures[onThread].ReleaseVector(v); }
-	void ReleaseVector(std::vector<CProjectile*>* v ) { tempProjectiles.ReleaseVector(v); }
+	void ReleaseVector(std::vector<CProjectile*>* v , int onThread = 0) { tempProjectiles[onThread].ReleaseVector(v); }
 	void ReleaseVector(std::vector<CSolidObject*>* v, int onThread = 0) { tempSolids[onThread].ReleaseVector(v); }
 	void ReleaseVector(std::vector<int>* v          , int onThread = 0) { tempQuads[onThread].ReleaseVector(v); }
 
+	/**
+	 * Summed allocation counters of all query arenas; after warm-up
+	 * numSlotAllocs and numGrowAllocs should stay constant.
+	 */
+	QueryVectorArena<int>::AllocStats GetQueryAllocStats() const;
+	void ResetQueryAllocStats();
+
 	struct Quad {
 	public:
 		CR_DECLARE_STRUCT(Quad)
@@ -232,6 +360,9 @@ public:
 	int GetQuadSizeX() const { return quadSizeX; }
 	int GetQuadSizeZ() const { return quadSizeZ; }
 
+	/// changes whenever units or features are added to, removed from or moved between quads
+	unsigned int GetSolidsRevision() const { return solidsRevision; }
+
 	constexpr static unsigned int BASE_QUAD_SIZE = 128;
 
 private:
@@ -241,12 +372,12 @@ private:
 private:
 	std::vector<Quad> baseQuads;
 
-	// preallocated vectors for Get*Exact functions
-	std::array< QueryVectorCache<CUnit*>, ThreadPool::MAX_THREADS >  tempUnits;
-	std::array< QueryVectorCache<CFeature*>, ThreadPool::MAX_THREADS >  tempFeatures;
-	QueryVectorCache<CProjectile*> tempProjectiles;
-	std::array< QueryVectorCache<CSolidObject*>, ThreadPool::MAX_THREADS > tempSolids;
-	std::array< QueryVectorCache<int>, ThreadPool::MAX_THREADS > tempQuads;
+	// per-thread scratch vectors for Get*Exact functions
+	std::array< QueryVectorArena<CUnit*>, ThreadPool::MAX_THREADS >  tempUnits;
+	std::array< QueryVectorArena<CFeature*>, ThreadPool::MAX_THREADS >  tempFeatures;
+	std::array< QueryVectorArena<CProjectile*>, ThreadPool::MAX_THREADS > tempProjectiles;
+	std::array< QueryVectorArena<CSolidObject*>, ThreadPool::MAX_THREADS > tempSolids;
+	std::array< QueryVectorArena<int>, ThreadPool::MAX_THREADS > tempQuads;
 
 	float2 invQuadSize;
 
@@ -255,6 +386,8 @@ private:
 
 	int quadSizeX;
 	int quadSizeZ;
+
+	unsigned int solidsRevision = 0;
 };
 
 extern CQuadField quadField;
@@ -264,7 +397,7 @@ struct QuadFieldQuery {
 	~QuadFieldQuery() {
 		quadField.ReleaseVector(units, threadOwner);
 		quadField.ReleaseVector(features, threadOwner);
-		quadField.ReleaseVector(projectiles);
+		quadField.ReleaseVector(projectiles, threadOwner);
 		quadField.ReleaseVector(solids, threadOwner);
 		quadField.ReleaseVector(quads, threadOwner);
 	}
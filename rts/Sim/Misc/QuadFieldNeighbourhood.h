@@ -0,0 +1,46 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef QUAD_FIELD_NEIGHBOURHOOD_H
+#define QUAD_FIELD_NEIGHBOURHOOD_H
+
+#include <utility>
+#include <vector>
+
+#include "System/float3.h"
+
+class CUnit;
+class CFeature;
+
+/**
+ * Units and features around a position, gathered by the quadfield once and
+ * filtered by the Get*Exact overloads taking a neighbourhood afterwards, so
+ * an object that queries its surroundings several times per frame only has
+ * to walk the quads once (see CGroundMoveType::UpdateNeighbourhood).
+ *
+ * Objects are stored once per quad they were found in and entries keep the
+ * quadfield's own order, which lets the filtered results match the direct
+ * queries element for element while the neighbourhood is still usable
+ * (see CQuadField::CanUseNeighbourhood).
+ */
+struct QuadFieldNeighbourhood {
+public:
+	void Clear() {
+		quads.clear();
+		units.clear();
+		features.clear();
+
+		radius = -1.0f;
+	}
+
+public:
+	std::vector<int> quads;
+	std::vector< std::pair<int, CUnit*> > units; // (quad, unit)
+	std::vector< std::pair<int, CFeature*> > features; // (quad, feature)
+
+	float3 pos;
+	float radius = -1.0f;
+
+	unsigned int revision = 0;
+};
+
+#endif // QUAD_FIELD_NEIGHBOURHOOD_H
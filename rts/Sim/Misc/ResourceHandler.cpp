@@ -5,6 +5,7 @@
 #include "Map/MapInfo.h" // for the metal extractor radius
 #include "Map/ReadMap.h" // for the metal map
 #include "Map/MetalMap.h"
+#include "System/Threading/SpringThreading.h"
 
 #include <cfloat>
 
@@ -22,6 +23,9 @@ CR_REG_METADATA(CResourceHandler, (
 
 static CResourceHandler instance;
 
+// concurrently updated AIs may query (and thus finalize) analyzers from workers
+static spring::mutex analyzerMutex;
+
 
 CResourceHandler* CResourceHandler::GetInstance() { return &instance; }
 
@@ -124,9 +128,42 @@ const CResourceMapAnalyzer* CResourceHandler::GetResourceMapAnalyzer(int resourc
 
 	CResourceMapAnalyzer* rma = &resourceMapAnalyzers[resourceId];
 
-	if (rma->GetNumSpots() < 0)
-		rma->Init();
+	// waits for (or runs) the analysis if not done yet; a no-op after
+	// FinalizeResourceMaps unless the analyzer was never started
+	std::lock_guard<spring::mutex> lock(analyzerMutex);
+	rma->Finalize();
 
 	return rma;
 }
 
+void CResourceHandler::AnalyzeResourceMaps()
+{
+	for (size_t resourceId = 0; resourceId < resourceMapAnalyzers.size(); resourceId++) {
+		if (GetResourceMapSize(resourceId) == 0)
+			continue;
+
+		resourceMapAnalyzers[resourceId].InitAsync();
+	}
+}
+
+void CResourceHandler::FinalizeResourceMaps()
+{
+	std::lock_guard<spring::mutex> lock(analyzerMutex);
+
+	for (size_t resourceId = 0; resourceId < resourceMapAnalyzers.size(); resourceId++) {
+		if (GetResourceMapSize(resourceId) == 0)
+			continue;
+
+		resourceMapAnalyzers[resourceId].Finalize();
+	}
+}
+
+bool CResourceHandler::IsResourceMapAnalyzed(int resourceId) const
+{
+	if (!IsValidId(resourceId))
+		return false;
+
+	std::lock_guard<spring::mutex> lock(analyzerMutex);
+	return (resourceMapAnalyzers[resourceId].IsReady());
+}
+
@@ -23,6 +23,11 @@ public:
 
 	void Init() { AddResources(); }
 	void Kill() {
+		// background analysis tasks hold pointers into resourceMapAnalyzers
+		for (const CResourceMapAnalyzer& rma: resourceMapAnalyzers) {
+			rma.WaitForInit();
+		}
+
 		resourceDescriptions.clear();
 		resourceMapAnalyzers.clear();
 	}
@@ -104,6 +109,27 @@ public:
 	 */
 	const CResourceMapAnalyzer* GetResourceMapAnalyzer(int resourceId);
 
+	/**
+	 * @brief	start analyzing all resource maps in the background
+	 *
+	 * Called at map load; GetResourceMapAnalyzer will block until the
+	 * analysis of the requested resource is finished.
+	 */
+	void AnalyzeResourceMaps();
+	/**
+	 * @brief	wait for all background resource map analyses
+	 *
+	 * Called on the main thread once loading is done, so that AIs updated
+	 * concurrently never have to finish (or redo) an analysis themselves.
+	 */
+	void FinalizeResourceMaps();
+	/**
+	 * @brief	resource map analysis state
+	 * @param	resourceId index of the resource whichs analyzer to query
+	 * @return	true if GetResourceMapAnalyzer will not block
+	 */
+	bool IsResourceMapAnalyzed(int resourceId) const;
+
 	size_t GetNumResources() const { return resourceDescriptions.size(); }
 
 	int GetMetalId() const { return metalResourceId; }
@@ -15,14 +15,17 @@ using std::fclose;
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitHandler.h"
 #include "Game/GameHelper.h"
-#include "Game/GameSetup.h"
 #include "Map/MapInfo.h"
 #include "Map/MetalMap.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/Log/ILog.h"
+#include "System/Sync/HsiehHash.h"
+#include "System/Threading/ThreadPool.h"
 
+#include <chrono>
+#include <cstring>
 #include <stdexcept>
 
 static constexpr float3 ERRORVECTOR(-1, 0, 0);
@@ -34,6 +37,9 @@ CResourceMapAnalyzer::CResourceMapAnalyzer(int resourceId)
 
 	, extractorRadius(-1.0f)
 	, averageIncome(0.0f)
+	, maxWorth(0.0f)
+
+	, contentHash(0)
 
 	, stopMe(false)
 
@@ -111,25 +117,98 @@ float3 CResourceMapAnalyzer::GetNearestSpot(float3 fromPos, int team, const Unit
 
 
 void CResourceMapAnalyzer::Init() {
+	SetupAnalysis();
+	RunAnalysis();
+}
+
+void CResourceMapAnalyzer::InitAsync() {
+	if (initTask != nullptr || numSpotsFound >= 0)
+		return;
+
+	// snapshot on the calling thread, Lua may modify the map while we run
+	SetupAnalysis();
+
+	initTask = ThreadPool::Enqueue([this]() { RunAnalysis(); });
+}
+
+void CResourceMapAnalyzer::Finalize() {
+	if (initTask == nullptr) {
+		if (numSpotsFound < 0)
+			Init();
+
+		return;
+	}
+
+	initTask->wait();
+	initTask.reset();
+
+	const unsigned char* resourceMapArray = resourceHandler->GetResourceMap(resourceId);
+
+	if (CalcContentHash(resourceMapArray, totalCells, extractorRadius, maxWorth) == contentHash)
+		return;
+
+	LOG("[RMA::%s] resource-map \"%s\" changed during analysis, redoing", __func__, resourceName.c_str());
+	Init();
+}
+
+bool CResourceMapAnalyzer::IsReady() const {
+	if (initTask == nullptr)
+		return (numSpotsFound >= 0);
+
+	if (initTask->wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		return false;
+
+	// a stale result would make Finalize redo the analysis synchronously
+	const unsigned char* resourceMapArray = resourceHandler->GetResourceMap(resourceId);
+
+	return (CalcContentHash(resourceMapArray, totalCells, extractorRadius, maxWorth) == contentHash);
+}
+
+
+void CResourceMapAnalyzer::SetupAnalysis() {
 	const CResourceDescription* resource = resourceHandler->GetResource(resourceId);
+	const unsigned char* resourceMapArray = resourceHandler->GetResourceMap(resourceId);
 
 	mapWidth = resourceHandler->GetResourceMapWidth(resourceId);
 	mapHeight = resourceHandler->GetResourceMapHeight(resourceId);
 
 	totalCells = mapHeight * mapWidth;
 	extractorRadius = resource->extractorRadius;
+	maxWorth = resource->maxWorth;
 	xtractorRadius = static_cast<int>(extractorRadius / (SQUARE_SIZE * 2));
 	doubleRadius = xtractorRadius * 2;
 	squareRadius = xtractorRadius * xtractorRadius;
 	doubleSquareRadius = doubleRadius * doubleRadius;
 
-	rexArrayA.resize(totalCells);
-	rexArrayB.resize(totalCells);
+	resourceName = resource->name;
+
+	// reset the results of any previous run
+	numSpotsFound = -1;
+	averageIncome = 0.0f;
+	maxResource = 0;
+	stopMe = false;
+
+	vectoredSpots.clear();
+
+	rexArrayA.clear();
+	rexArrayA.resize(totalCells, 0);
+	rexArrayB.clear();
+	rexArrayB.resize(totalCells, 0);
 	// used for drawing the TGA, not really needed with a couple of changes
-	rexArrayC.resize(totalCells);
+	rexArrayC.clear();
+	rexArrayC.resize(totalCells, 0);
 
-	tempAverage.resize(totalCells);
+	tempAverage.clear();
+	tempAverage.resize(totalCells, 0);
 
+	// the analysis only ever reads this private copy of the map
+	if (resourceMapArray != nullptr && totalCells > 0)
+		std::memcpy(rexArrayA.data(), resourceMapArray, totalCells);
+
+	contentHash = CalcContentHash(rexArrayA.data(), totalCells, extractorRadius, maxWorth);
+}
+
+void CResourceMapAnalyzer::RunAnalysis() {
 	// if there's no available load file, create one and save it
 	if (!LoadResourceMap()) {
 		GetResourcePoints();
@@ -151,14 +230,13 @@ void CResourceMapAnalyzer::GetResourcePoints() {
 		xend[a] = int(math::sqrt(floatsqrradius - z * z));
 	}
 
-	// load up the resource values in each pixel
-	const unsigned char* resourceMapArray = resourceHandler->GetResourceMap(resourceId);
+	// resource values in each pixel were copied by SetupAnalysis
 	double totalResourcesDouble  = 0;
 
 	for (int i = 0; i < totalCells; i++) {
 		// count the total resources so you can work out
 		// an average of the whole map
-		totalResourcesDouble +=  rexArrayA[i] = resourceMapArray[i];
+		totalResourcesDouble += rexArrayA[i];
 	}
 
 	// do the average
@@ -388,8 +466,7 @@ void CResourceMapAnalyzer::GetResourcePoints() {
 			bufferSpot.x = coordX * (SQUARE_SIZE * 2) + SQUARE_SIZE;
 			bufferSpot.z = coordZ * (SQUARE_SIZE * 2) + SQUARE_SIZE;
 			// gets the actual amount of resource an extractor can make
-			const CResourceDescription* resource = resourceHandler->GetResource(resourceId);
-			bufferSpot.y = tempResources * (resource->maxWorth) * maxResource / 255;
+			bufferSpot.y = tempResources * maxWorth * maxResource / 255;
 			vectoredSpots.push_back(bufferSpot);
 
 			// plot TGA array (not necessary) for debug
@@ -554,6 +631,10 @@ bool CResourceMapAnalyzer::LoadResourceMap() {
 			loaded = true;
 		} catch (const std::runtime_error& err) {
 			LOG_L(L_WARNING, "Failed to load the resource map cache from file %s: %s", cacheFileName.c_str(), err.what());
+
+			numSpotsFound = -1;
+			averageIncome = 0.0f;
+			vectoredSpots.clear();
 		}
 		fclose(cacheFile);
 	}
@@ -563,9 +644,20 @@ bool CResourceMapAnalyzer::LoadResourceMap() {
 
 
 std::string CResourceMapAnalyzer::GetCacheFileName() const {
+	// content-addressed; identical resource maps share a cache entry across map archives
+	char hashBuf[16];
+	snprintf(hashBuf, sizeof(hashBuf), "%08x", contentHash);
 
-	const CResourceDescription* resource = resourceHandler->GetResource(resourceId);
-	std::string absFile = CACHE_BASE + gameSetup->mapName + resource->name;
+	return (CACHE_BASE + resourceName + "_" + hashBuf);
+}
+
+std::uint32_t CResourceMapAnalyzer::CalcContentHash(const unsigned char* resourceMap, int numCells, float radius, float worth) {
+	std::uint32_t hash = 0;
+
+	if (resourceMap != nullptr && numCells > 0)
+		hash = HsiehHash(resourceMap, numCells, hash);
 
-	return absFile;
+	hash = HsiehHash(&radius, sizeof(radius), hash);
+	hash = HsiehHash(&worth, sizeof(worth), hash);
+	return hash;
 }
@@ -4,6 +4,11 @@
 #define _RESOURCE_MAP_ANALYZER_H
 
 #include "System/float3.h"
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
 #include <vector>
 
 class CResource;
@@ -15,6 +20,25 @@ public:
 
 	// deferred to ResourceHandler
 	void Init();
+	/**
+	 * Snapshots the resource map and runs Init on the thread pool.
+	 * Must be called from the main or load thread; Finalize (or any
+	 * accessor going through ResourceHandler) waits for the result.
+	 */
+	void InitAsync();
+	/**
+	 * Blocks until a pending InitAsync task is done; re-analyzes if the
+	 * resource map changed since it was snapshotted (e.g. by Lua) and
+	 * runs Init synchronously if no task was ever started.
+	 */
+	void Finalize();
+
+	// blocks until a pending InitAsync task is done
+	void WaitForInit() const { if (initTask != nullptr) initTask->wait(); }
+
+	// true once spots are available without blocking; false while the
+	// task runs or if the resource map changed since it was snapshotted
+	bool IsReady() const;
 
 	/**
 	 * Returns positions indicating where to place resource extractors on the map.
@@ -33,17 +57,29 @@ public:
 	int GetNumSpots() const { return numSpotsFound; }
 
 private:
+	void SetupAnalysis();
+	void RunAnalysis();
+
 	void GetResourcePoints();
 	void SaveResourceMap();
 	bool LoadResourceMap();
 
 	std::string GetCacheFileName() const;
 
+	static std::uint32_t CalcContentHash(const unsigned char* resourceMap, int numCells, float radius, float worth);
+
 	int resourceId;
 	int numSpotsFound;
 
 	float extractorRadius;
 	float averageIncome;
+	float maxWorth;
+
+	// hash over resource map content, extractor radius and worth; keys the cache
+	std::uint32_t contentHash;
+
+	std::string resourceName;
+	std::shared_ptr<std::future<void>> initTask;
 
 	bool stopMe;
 
@@ -0,0 +1,97 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+#include "SlowUpdateScheduler.h"
+
+CR_BIND(CSlowUpdateScheduler, )
+
+CR_REG_METADATA(CSlowUpdateScheduler, (
+	CR_MEMBER(categoryCosts),
+	CR_MEMBER(cycleFixedCosts),
+	CR_MEMBER(cycleBudgets),
+
+	CR_MEMBER(cycleFrame),
+	CR_MEMBER(cycleCost)
+))
+
+
+CSlowUpdateScheduler slowUpdateScheduler;
+
+
+// frames the fixed categories run in: (frameNum % period) == phase
+static constexpr int FIXED_CATEGORY_PERIODS[CSlowUpdateScheduler::CATEGORY_COUNT] = {0, TEAM_SLOWUPDATE_RATE, UNIT_SLOWUPDATE_RATE};
+static constexpr int FIXED_CATEGORY_PHASES[CSlowUpdateScheduler::CATEGORY_COUNT] = {0, 0, 0};
+
+
+void CSlowUpdateScheduler::ResetState()
+{
+	categoryCosts.fill(0);
+	cycleFixedCosts.fill(0);
+	cycleBudgets.fill(0);
+
+	cycleFrame = 0;
+	cycleCost = 0;
+}
+
+void CSlowUpdateScheduler::BeginCycle(int frameNum, int staggeredCost)
+{
+	assert(IsCycleStart(frameNum));
+	assert(staggeredCost >= 0);
+
+	cycleFrame = frameNum;
+	cycleCost = staggeredCost;
+
+	int64_t maxFixedCost = 0;
+
+	for (int i = 0; i < CYCLE_LENGTH; i++) {
+		cycleFixedCosts[i] = 0;
+
+		for (int c = 0; c < CATEGORY_COUNT; c++) {
+			if (FIXED_CATEGORY_PERIODS[c] == 0)
+				continue;
+			if (((frameNum + i) % FIXED_CATEGORY_PERIODS[c]) != FIXED_CATEGORY_PHASES[c])
+				continue;
+
+			cycleFixedCosts[i] += categoryCosts[c];
+		}
+
+		maxFixedCost = std::max(maxFixedCost, int64_t(cycleFixedCosts[i]));
+	}
+
+	// fill the frames up to the lowest common total cost that fits all staggered
+	// work; frames whose fixed work alone exceeds that level get no share at all
+	const auto StaggeredCost = [&](int64_t level) {
+		int64_t cost = 0;
+
+		for (int i = 0; i < CYCLE_LENGTH; i++) {
+			cost += std::max(level - cycleFixedCosts[i], int64_t(0));
+		}
+
+		return cost;
+	};
+
+	int64_t minLevel = 0;
+	int64_t maxLevel = maxFixedCost + staggeredCost;
+
+	while (minLevel < maxLevel) {
+		const int64_t level = (minLevel + maxLevel) / 2;
+
+		if (StaggeredCost(level) >= staggeredCost) {
+			maxLevel = level;
+		} else {
+			minLevel = level + 1;
+		}
+	}
+
+	int64_t budget = 0;
+
+	for (int i = 0; i < CYCLE_LENGTH; i++) {
+		budget += std::max(minLevel - cycleFixedCosts[i], int64_t(0));
+		cycleBudgets[i] = std::min(budget, int64_t(staggeredCost));
+	}
+
+	cycleBudgets[CYCLE_LENGTH - 1] = staggeredCost;
+}
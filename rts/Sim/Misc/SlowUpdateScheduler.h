@@ -0,0 +1,86 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef SLOW_UPDATE_SCHEDULER_H
+#define SLOW_UPDATE_SCHEDULER_H
+
+#include <array>
+
+#include "Sim/Misc/GlobalConstants.h"
+#include "System/creg/creg_cond.h"
+
+/**
+ * Balances the per-frame cost of all periodic SlowUpdate work.
+ *
+ * Some categories run in one piece on fixed frames (every team's SlowUpdate
+ * on frames divisible by TEAM_SLOWUPDATE_RATE, the interceptor pass on those
+ * divisible by UNIT_SLOWUPDATE_RATE) and can not be moved without changing
+ * game logic. Unit SlowUpdates (which include the CAI, move-type and weapon
+ * SlowUpdates) are staggered over a cycle of UNIT_SLOWUPDATE_RATE frames,
+ * and the scheduler hands out their per-frame budgets such that the fixed
+ * work plus the staggered work is spread evenly over the cycle instead of
+ * stacking up on its first frame.
+ *
+ * Since the budgets decide which units are updated in which frame, costs are
+ * deterministic work counts reported by the owners of each category rather
+ * than measured times; the relative weights below were taken from profiles
+ * of the corresponding Sim::*::SlowUpdate timers.
+ */
+class CSlowUpdateScheduler
+{
+	CR_DECLARE_STRUCT(CSlowUpdateScheduler)
+
+public:
+	enum {
+		CATEGORY_UNITS      = 0, // staggered
+		CATEGORY_TEAMS      = 1, // fixed, TEAM_SLOWUPDATE_RATE
+		CATEGORY_INTERCEPTS = 2, // fixed, UNIT_SLOWUPDATE_RATE
+		CATEGORY_COUNT      = 3,
+	};
+
+	static constexpr int UNIT_COST = 4;
+	static constexpr int UNIT_WEAPON_COST = 2;
+	static constexpr int TEAM_COST = 24;
+	static constexpr int INTERCEPT_PAIR_COST = 1;
+
+	static constexpr int CYCLE_LENGTH = UNIT_SLOWUPDATE_RATE;
+
+	static constexpr int GetUnitCost(int numWeapons) { return (UNIT_COST + UNIT_WEAPON_COST * numWeapons); }
+
+public:
+	CSlowUpdateScheduler() { ResetState(); }
+	CSlowUpdateScheduler(const CSlowUpdateScheduler&) = delete;
+
+	CSlowUpdateScheduler& operator = (const CSlowUpdateScheduler&) = delete;
+
+	void ResetState();
+
+	/// called by fixed categories whenever they run, used from the next cycle on
+	void SetCategoryCost(int category, int cost) { categoryCosts[category] = cost; }
+
+	/// called on the first frame of each cycle with the total cost of its staggered work
+	void BeginCycle(int frameNum, int staggeredCost);
+
+	/// cost of the fixed work in <frameNum>, which must lie in the current cycle
+	int GetFixedCost(int frameNum) const { return cycleFixedCosts[frameNum - cycleFrame]; }
+	/// staggered cost the cycle should have done after <frameNum>, equal to its total cost on the last frame
+	int GetStaggeredBudget(int frameNum) const { return cycleBudgets[frameNum - cycleFrame]; }
+
+	int GetCategoryCost(int category) const { return categoryCosts[category]; }
+	int GetCycleFrame() const { return cycleFrame; }
+	int GetCycleCost() const { return cycleCost; }
+
+	static bool IsCycleStart(int frameNum) { return ((frameNum % CYCLE_LENGTH) == 0); }
+	static bool IsCycleEnd(int frameNum) { return ((frameNum % CYCLE_LENGTH) == (CYCLE_LENGTH - 1)); }
+
+private:
+	std::array<int, CATEGORY_COUNT> categoryCosts;
+	std::array<int, CYCLE_LENGTH> cycleFixedCosts;
+	std::array<int, CYCLE_LENGTH> cycleBudgets; // cumulative
+
+	int cycleFrame = 0;
+	int cycleCost = 0;
+};
+
+extern CSlowUpdateScheduler slowUpdateScheduler;
+
+#endif
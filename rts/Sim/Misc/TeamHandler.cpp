@@ -7,6 +7,8 @@
 #include "Game/GameSetup.h"
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/SlowUpdateScheduler.h"
+#include "System/TimeProfiler.h"
 
 
 CR_BIND(CTeamHandler, )
@@ -114,6 +116,11 @@ void CTeamHandler::GameFrame(int frameNum)
 	if ((frameNum % TEAM_SLOWUPDATE_RATE) != 0)
 		return;
 
+	SCOPED_TIMER("Sim::Team::SlowUpdate");
+
+	// lets the unit SlowUpdate's of the following cycles make room for this
+	slowUpdateScheduler.SetCategoryCost(CSlowUpdateScheduler::CATEGORY_TEAMS, ActiveTeams() * CSlowUpdateScheduler::TEAM_COST);
+
 	for (int a = 0; a < ActiveTeams(); ++a) {
 		teams[a].ResetResourceState();
 	}
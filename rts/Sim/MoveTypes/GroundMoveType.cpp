@@ -34,6 +34,7 @@
 #include "System/type2.h"
 #include "System/Sound/ISoundChannels.h"
 #include "System/Sync/HsiehHash.h"
+#include "System/Threading/ThreadPool.h"
 
 // #define PATHING_DEBUG
 
@@ -82,6 +83,11 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_GMT)
 
 #define WAYPOINT_RADIUS (1.25f * SQUARE_SIZE)
 
+// slack between the radius of a neighbourhood and the largest query it is expected to serve
+#define NEIGHBOURHOOD_MARGIN (2.0f * SQUARE_SIZE)
+// same for skidding units, whose collisions push each other around before later queries
+#define SKID_NEIGHBOURHOOD_MARGIN (4.0f * SQUARE_SIZE)
+
 #define MAXREVERSESPEED_MEMBER_IDX 7
 
 #define MEMBER_CHARPTR_HASH(memberName) HsiehHash(memberName, strlen(memberName),     0)
@@ -179,6 +185,71 @@ static CGroundMoveType::MemberData gmtMemberData = {
 
 
 
+// units skidding in the current frame, added by UpdatePreCollisions in
+// activeUnits order and updated together by UpdateSkiddingUnits; state
+// produced by the parallel integration step is kept per attribute here
+static struct SkidBatch {
+public:
+	struct CollisionDamage {
+		CSolidObject* victim;
+		CUnit* attacker;
+		float3 impulse;
+		float damage;
+	};
+
+	void Add(CGroundMoveType* mt) { moveTypes.push_back(mt); }
+	void Clear() {
+		moveTypes.clear();
+		impactDamages.clear();
+		headingChanges.clear();
+		collisionDamages.clear();
+
+		for (const int unitID: pushedUnitIDs) {
+			pushDists[unitID] = 0.0f;
+		}
+
+		pushedUnitIDs.clear();
+		displacementBound = 0.0f;
+	}
+
+	void Resize() {
+		impactDamages.resize(moveTypes.size(), 0.0f);
+		headingChanges.resize(moveTypes.size(), 0);
+		pushDists.resize(unitHandler.MaxUnits(), 0.0f);
+	}
+
+	void PushUnit(const CUnit* unit, float pushDist) {
+		if (pushDists[unit->id] == 0.0f)
+			pushedUnitIDs.push_back(unit->id);
+
+		displacementBound = std::max(displacementBound, pushDists[unit->id] += pushDist);
+	}
+
+	bool Empty() const { return moveTypes.empty(); }
+	size_t Size() const { return moveTypes.size(); }
+
+public:
+	std::vector<CGroundMoveType*> moveTypes;
+
+	// ground-impact damage and whether the unit came to rest, both
+	// acted on in FinishSkid since they call into scripts and Lua
+	std::vector<float> impactDamages;
+	std::vector<uint8_t> headingChanges;
+
+	// dealt in order once all collisions are resolved, keeps callins
+	// from moving objects while the neighbourhoods are in use
+	std::vector<CollisionDamage> collisionDamages;
+
+	// distance each unit was pushed by collisions since the skidding
+	// units' neighbourhoods were gathered, indexed by unit ID
+	std::vector<float> pushDists;
+	std::vector<int> pushedUnitIDs;
+
+	float displacementBound = 0.0f;
+} skidBatch;
+
+
+
 namespace SAT {
 	static float CalcSeparatingDist(
 		const float3& axis,
@@ -543,7 +614,7 @@ void CGroundMoveType::UpdatePreCollisions()
 	owner->UpdatePhysicalStateBit(CSolidObject::PSTATE_BIT_SKIDDING, owner->IsSkidding() || OnSlope(1.0f));
 
 	if (owner->IsSkidding()) {
-		UpdateSkid();
+		skidBatch.Add(this);
 		return;
 	}
 
@@ -816,14 +887,38 @@ void CGroundMoveType::UpdatePreCollisionsMt() {
 	earlyCurrWayPoint = currWayPoint;
 	earlyNextWayPoint = nextWayPoint;
 
+	// last frame's neighbourhood must never be used, even if no quads changed
+	neighbourhood.Clear();
+
 	if (owner->GetTransporter() != nullptr) return;
 	if (owner->IsSkidding()) return;
 	if (owner->IsFalling()) return;
 
+	UpdateNeighbourhood();
 	UpdateObstacleAvoidance();
 	UpdateOwnerAccelAndHeading();
 }
 
+void CGroundMoveType::UpdateNeighbourhood() {
+	// units are moved in between the avoidance updates of this mode, the
+	// neighbourhood would be outdated before the next unit could use it
+	if (modInfo.forceCollisionAvoidanceSingleThreaded)
+		return;
+
+	// no collisions are handled for these
+	if (owner->beingBuilt)
+		return;
+
+	// large enough for HandleObjectCollisions at up to maxSpeed and, on the
+	// frames it runs, for GetObstacleAvoidanceDir; the margin lets units move
+	// a little in UpdatePreCollisions before collisions are handled
+	const bool avoidanceFrame = (((gs->frameNum + owner->id) % modInfo.groundUnitCollisionAvoidanceUpdateRate) == 0);
+	const float avoidanceRadius = std::max(currentSpeed, 1.0f) * (owner->radius * 2.0f);
+	const float collisionRadius = std::max(owner->speed.w, maxSpeed) + (owner->moveDef->CalcFootPrintMaxInteriorRadius() * 2.0f);
+
+	quadField.GatherNeighbourhood(neighbourhood, owner->pos, std::max(collisionRadius, avoidanceRadius * avoidanceFrame) + NEIGHBOURHOOD_MARGIN);
+}
+
 void CGroundMoveType::UpdateObstacleAvoidance() {
 	if (owner->IsStunned() || owner->beingBuilt)
 		return;
@@ -1233,17 +1328,68 @@ bool CGroundMoveType::CanApplyImpulse(const float3& impulse)
 	return true;
 }
 
-void CGroundMoveType::UpdateSkid()
+void CGroundMoveType::UpdateSkiddingUnits()
 {
-	ASSERT_SYNCED(owner->midPos);
+	if (skidBatch.Empty())
+		return;
+
+	SCOPED_TIMER("Sim::Unit::MoveType::2::UpdateSkid");
+
+	skidBatch.Resize();
+
+	// integration only touches the state of each unit itself
+	for_mt(0, skidBatch.Size(), [](const int i) {
+		CGroundMoveType* mt = skidBatch.moveTypes[i];
+
+		mt->IntegrateSkid(i);
+
+		if (!mt->owner->IsSkidding())
+			return;
+
+		mt->CalcSkidRot();
+	});
+
+	// gathered only once every unit has been integrated; neighbourhoods
+	// reflect the final positions and only collisions move objects after
+	for_mt(0, skidBatch.Size(), [](const int i) {
+		CGroundMoveType* mt = skidBatch.moveTypes[i];
+
+		if (!mt->owner->IsSkidding())
+			return;
 
+		quadField.GatherNeighbourhood(mt->neighbourhood, mt->owner->pos, mt->owner->radius + SKID_NEIGHBOURHOOD_MARGIN);
+	});
+
+	// collisions move other units, resolve them in a fixed order
+	for (CGroundMoveType* mt: skidBatch.moveTypes) {
+		if (!mt->owner->IsSkidding())
+			continue;
+
+		mt->CheckCollisionSkid();
+	}
+
+	for (const SkidBatch::CollisionDamage& cd: skidBatch.collisionDamages) {
+		cd.victim->DoDamage(DamageArray(cd.damage), cd.impulse, cd.attacker, -CSolidObject::DAMAGE_COLLISION_OBJECT, -1);
+	}
+
+	for (size_t i = 0; i < skidBatch.Size(); i++) {
+		skidBatch.moveTypes[i]->FinishSkid(i);
+	}
+
+	skidBatch.Clear();
+}
+
+void CGroundMoveType::IntegrateSkid(size_t batchIdx)
+{
 	const float3& pos = owner->pos;
 	const float4& spd = owner->speed;
 
-	const float minCollSpeed = owner->unitDef->minCollisionSpeed;
 	const float groundHeight = GetGroundHeight(pos);
 	const float negAltitude = groundHeight - pos.y;
 
+	skidBatch.impactDamages[batchIdx] = 0.0f;
+	skidBatch.headingChanges[batchIdx] = false;
+
 	owner->SetVelocity(spd + owner->GetDragAccelerationVec(float4(mapInfo->atmosphere.fluidDensity, mapInfo->water.fluidDensity, 1.0f, 0.01f)));
 
 	if (owner->IsFlying()) {
@@ -1251,6 +1397,7 @@ void CGroundMoveType::UpdateSkid()
 			-spd.dot(CGround::GetNormal(pos.x, pos.z)):
 			-spd.dot(UpVector);
 		const float impactDamageMul = collImpactSpeed * owner->mass * COLLISION_DAMAGE_MULT;
+		const float minCollSpeed = owner->unitDef->minCollisionSpeed;
 
 		if (negAltitude > 0.0f) {
 			// ground impact, stop flying
@@ -1262,7 +1409,7 @@ void CGroundMoveType::UpdateSkid()
 			//   bouncing behaves too much like a rubber-ball,
 			//   most impact energy needs to go into the ground
 			if (modInfo.allowUnitCollisionDamage && collImpactSpeed > minCollSpeed && minCollSpeed >= 0.0f)
-				owner->DoDamage(DamageArray(impactDamageMul), ZeroVector, nullptr, -CSolidObject::DAMAGE_COLLISION_GROUND, -1);
+				skidBatch.impactDamages[batchIdx] = impactDamageMul;
 
 			skidRotSpeed = 0.0f;
 			// skidRotAccel = 0.0f;
@@ -1283,11 +1430,10 @@ void CGroundMoveType::UpdateSkid()
 			skidRotAccel *= math::DEG_TO_RAD;
 
 			owner->ClearPhysicalStateBit(CSolidObject::PSTATE_BIT_SKIDDING);
-			owner->script->StopSkidding();
 
+			// script and wanted-heading are updated after coming to a stop
 			UseHeading(true);
-			// update wanted-heading after coming to a stop
-			ChangeHeading(owner->heading);
+			skidBatch.headingChanges[batchIdx] = true;
 		} else {
 			constexpr float speedReduction = 0.35f;
 
@@ -1347,13 +1493,18 @@ void CGroundMoveType::UpdateSkid()
 	// translate before rotate, match terrain normal if not in air
 	owner->Move(spd, true);
 	owner->UpdateDirVectors(!owner->upright && owner->IsOnGround(), owner->IsInAir(), owner->unitDef->upDirSmoothing);
+}
 
-	if (owner->IsSkidding()) {
-		CalcSkidRot();
-		CheckCollisionSkid();
-	} else {
-		// do this here since ::Update returns early if it calls us
-		// HandleObjectCollisions(); // No longer the case
+void CGroundMoveType::FinishSkid(size_t batchIdx)
+{
+	if (skidBatch.impactDamages[batchIdx] > 0.0f)
+		owner->DoDamage(DamageArray(skidBatch.impactDamages[batchIdx]), ZeroVector, nullptr, -CSolidObject::DAMAGE_COLLISION_GROUND, -1);
+
+	if (skidBatch.headingChanges[batchIdx]) {
+		owner->script->StopSkidding();
+
+		// update wanted-heading after coming to a stop
+		ChangeHeading(owner->heading);
 	}
 
 	AdjustPosToWaterLine();
@@ -1363,7 +1514,10 @@ void CGroundMoveType::UpdateSkid()
 	// to non-skidding
 	oldPos = owner->pos;
 
-	ASSERT_SANE_OWNER_SPEED(spd);
+	// objects have moved since it was gathered
+	neighbourhood.Clear();
+
+	ASSERT_SANE_OWNER_SPEED(owner->speed);
 	ASSERT_SYNCED(owner->midPos);
 }
 
@@ -1401,10 +1555,16 @@ void CGroundMoveType::CheckCollisionSkid()
 	const float colliderMinCollSpeed = collider->unitDef->minCollisionSpeed;
 	      float collideeMinCollSpeed = 0.0f;
 
-	// copy on purpose, since the below can call Lua
 	QuadFieldQuery qfQuery;
-	quadField.GetUnitsExact(qfQuery, pos, collider->radius);
-	quadField.GetFeaturesExact(qfQuery, pos, collider->radius);
+
+	// nothing but collision pushes moved objects since the neighbourhood was gathered
+	if (quadField.CanUseNeighbourhood(neighbourhood, pos, collider->radius, skidBatch.displacementBound)) {
+		quadField.GetUnitsExact(qfQuery, neighbourhood, pos, collider->radius);
+		quadField.GetFeaturesExact(qfQuery, neighbourhood, pos, collider->radius);
+	} else {
+		quadField.GetUnitsExact(qfQuery, pos, collider->radius);
+		quadField.GetFeaturesExact(qfQuery, pos, collider->radius);
+	}
 
 	for (CUnit* collidee: *qfQuery.units) {
 		if (!collidee->HasCollidableStateBit(CSolidObject::CSTATE_BIT_SOLIDOBJECTS))
@@ -1429,14 +1589,16 @@ void CGroundMoveType::CheckCollisionSkid()
 
 			// damage the collider, no added impulse
 			if (modInfo.allowUnitCollisionDamage && collImpactSpeed > colliderMinCollSpeed && colliderMinCollSpeed >= 0.0f)
-				collider->DoDamage(DamageArray(impactDamageMul), ZeroVector, collidee, -CSolidObject::DAMAGE_COLLISION_OBJECT, -1);
+				skidBatch.collisionDamages.push_back({collider, collidee, ZeroVector, impactDamageMul});
 
 			// damage the (static) collidee based on collider's mass, no added impulse
 			if (modInfo.allowUnitCollisionDamage && collImpactSpeed > (collideeMinCollSpeed = collideeUD->minCollisionSpeed) && collideeMinCollSpeed >= 0.0f)
-				collidee->DoDamage(DamageArray(impactDamageMul), ZeroVector, collider, -CSolidObject::DAMAGE_COLLISION_OBJECT, -1);
+				skidBatch.collisionDamages.push_back({collidee, collider, ZeroVector, impactDamageMul});
 
 			collider->Move(collSeparationDir * collImpactSpeed, true);
 			collider->SetVelocity(collider->speed + ((collSeparationDir * collImpactSpeed) * 1.8f));
+
+			skidBatch.PushUnit(collider, collImpactSpeed);
 		} else {
 			assert(collider->mass > 0.0f && collidee->mass > 0.0f);
 
@@ -1459,16 +1621,19 @@ void CGroundMoveType::CheckCollisionSkid()
 
 			// damage the collider
 			if (modInfo.allowUnitCollisionDamage && collImpactSpeed > colliderMinCollSpeed && colliderMinCollSpeed >= 0.0f)
-				collider->DoDamage(DamageArray(colliderImpactDmgMult), collSeparationDir * colliderImpactDmgMult, collidee, -CSolidObject::DAMAGE_COLLISION_OBJECT, -1);
+				skidBatch.collisionDamages.push_back({collider, collidee, collSeparationDir * colliderImpactDmgMult, colliderImpactDmgMult});
 
 			// damage the collidee
 			if (modInfo.allowUnitCollisionDamage && collImpactSpeed > (collideeMinCollSpeed = collideeUD->minCollisionSpeed) && collideeMinCollSpeed >= 0.0f)
-				collidee->DoDamage(DamageArray(collideeImpactDmgMult), collSeparationDir * -collideeImpactDmgMult, collider, -CSolidObject::DAMAGE_COLLISION_OBJECT, -1);
+				skidBatch.collisionDamages.push_back({collidee, collider, collSeparationDir * -collideeImpactDmgMult, collideeImpactDmgMult});
 
 			collider->Move( colliderImpactImpulse, true);
 			collidee->Move(-collideeImpactImpulse, true);
 			collider->SetVelocity        (collider->speed + colliderImpactImpulse);
 			collidee->SetVelocityAndSpeed(collidee->speed - collideeImpactImpulse);
+
+			skidBatch.PushUnit(collider, colliderImpactImpulse.Length());
+			skidBatch.PushUnit(collidee, collideeImpactImpulse.Length());
 		}
 	}
 
@@ -1494,13 +1659,15 @@ void CGroundMoveType::CheckCollisionSkid()
 		// the collidee feature can not be passed along to the collider as attacker
 		// yet, keep symmetry and do not pass collider along to the collidee either
 		if (modInfo.allowUnitCollisionDamage && collImpactSpeed > colliderMinCollSpeed && colliderMinCollSpeed >= 0.0f)
-			collider->DoDamage(DamageArray(impactDamageMul), ZeroVector, nullptr, -CSolidObject::DAMAGE_COLLISION_OBJECT, -1);
+			skidBatch.collisionDamages.push_back({collider, nullptr, ZeroVector, impactDamageMul});
 
 		// damage the collidee feature based on collider's mass
-		collidee->DoDamage(DamageArray(impactDamageMul), -impactImpulse, nullptr, -CSolidObject::DAMAGE_COLLISION_OBJECT, -1);
+		skidBatch.collisionDamages.push_back({collidee, nullptr, -impactImpulse, impactDamageMul});
 
 		collider->Move(impactImpulse, true);
 		collider->SetVelocity(collider->speed + (impactImpulse * 1.8f));
+
+		skidBatch.PushUnit(collider, collImpactSpeed);
 	}
 
 	// finally update speed.w
@@ -1589,7 +1756,13 @@ float3 CGroundMoveType::GetObstacleAvoidanceDir(const float3& desiredDir) {
 
 	QuadFieldQuery qfQuery;
 	qfQuery.threadOwner = ThreadPool::GetThreadNum();
-	quadField.GetSolidsExact(qfQuery, avoider->pos, avoidanceRadius, 0xFFFFFFFF, CSolidObject::CSTATE_BIT_SOLIDOBJECTS);
+
+	// nothing has moved since the neighbourhood was gathered in this pass
+	if (quadField.CanUseNeighbourhood(neighbourhood, avoider->pos, avoidanceRadius, 0.0f)) {
+		quadField.GetSolidsExact(qfQuery, neighbourhood, avoider->pos, avoidanceRadius, 0xFFFFFFFF, CSolidObject::CSTATE_BIT_SOLIDOBJECTS);
+	} else {
+		quadField.GetSolidsExact(qfQuery, avoider->pos, avoidanceRadius, 0xFFFFFFFF, CSolidObject::CSTATE_BIT_SOLIDOBJECTS);
+	}
 
 	for (const CSolidObject* avoidee: *qfQuery.solids) {
 		const MoveDef* avoideeMD = avoidee->moveDef;
@@ -2533,10 +2706,17 @@ void CGroundMoveType::HandleUnitCollisions(
 	const bool allowSAT = modInfo.allowSepAxisCollisionTest;
 	const bool forceSAT = (colliderParams.z > 0.1f);
 
+	const float queryRadius = colliderParams.x + (colliderParams.y * 2.0f);
+
 	// copy on purpose, since the below can call Lua
 	QuadFieldQuery qfQuery;
 	qfQuery.threadOwner = curThread;
-	quadField.GetUnitsExact(qfQuery, collider->pos, colliderParams.x + (colliderParams.y * 2.0f));
+
+	if (quadField.CanUseNeighbourhood(neighbourhood, collider->pos, queryRadius, unitHandler.GetMoveTypeDisplacementBound())) {
+		quadField.GetUnitsExact(qfQuery, neighbourhood, collider->pos, queryRadius);
+	} else {
+		quadField.GetUnitsExact(qfQuery, collider->pos, queryRadius);
+	}
 
 	for (CUnit* collidee: *qfQuery.units) {
 		if (collidee == collider) continue;
@@ -2705,10 +2885,18 @@ void CGroundMoveType::HandleFeatureCollisions(
 	const bool allowSAT = modInfo.allowSepAxisCollisionTest;
 	const bool forceSAT = (colliderParams.z > 0.1f);
 
+	const float queryRadius = colliderParams.x + (colliderParams.y * 2.0f);
+
 	// copy on purpose, since DoDamage below can call Lua
 	QuadFieldQuery qfQuery;
 	qfQuery.threadOwner = curThread;
-	quadField.GetFeaturesExact(qfQuery, collider->pos, colliderParams.x + (colliderParams.y * 2.0f));
+
+	// between the movetype passes, features can only be moved along with their quads (ForcedMove)
+	if (quadField.CanUseNeighbourhood(neighbourhood, collider->pos, queryRadius, 0.0f)) {
+		quadField.GetFeaturesExact(qfQuery, neighbourhood, collider->pos, queryRadius);
+	} else {
+		quadField.GetFeaturesExact(qfQuery, collider->pos, queryRadius);
+	}
 
 	for (CFeature* collidee: *qfQuery.features) {
 		// const FeatureDef* collideeFD = collidee->def;
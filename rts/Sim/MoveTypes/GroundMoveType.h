@@ -7,6 +7,7 @@
 #include <tuple>
 
 #include "MoveType.h"
+#include "Sim/Misc/QuadFieldNeighbourhood.h"
 #include "Sim/Path/IPathController.hpp"
 #include "System/Sync/SyncedFloat3.h"
 
@@ -37,9 +38,13 @@ public:
 	void UpdateCollisionDetections() override;
 	void ProcessCollisionEvents() override;
 
+	void UpdateNeighbourhood();
 	void UpdateObstacleAvoidance();
 	void UpdatePreCollisions() override;
 
+	/// updates all units whose skidding was deferred by UpdatePreCollisions this frame
+	static void UpdateSkiddingUnits();
+
 	void StartMovingRaw(const float3 moveGoalPos, float moveGoalRadius) override;
 	void StartMoving(float3 pos, float moveGoalRadius) override;
 	void StartMoving(float3 pos, float moveGoalRadius, float speed) override { StartMoving(pos, moveGoalRadius); }
@@ -183,7 +188,8 @@ private:
 	void ChangeSpeed(float, bool, bool = false);
 	void ChangeHeading(short newHeading);
 
-	void UpdateSkid();
+	void IntegrateSkid(size_t batchIdx);
+	void FinishSkid(size_t batchIdx);
 	void UpdateControlledDrop();
 	void CheckCollisionSkid();
 	void CalcSkidRot();
@@ -269,6 +275,9 @@ private:
 	std::vector<CFeature*> killFeatures;
 	std::vector<CUnit*> killUnits;
 	std::vector<std::tuple<CFeature*, float3>> moveFeatures;
+
+	/// objects around the owner, shared by obstacle avoidance and collision handling each frame
+	QuadFieldNeighbourhood neighbourhood;
 };
 
 #endif // GROUNDMOVETYPE_H
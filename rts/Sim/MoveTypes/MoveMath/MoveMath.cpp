@@ -115,6 +115,9 @@ CMoveMath::BlockType CMoveMath::IsBlockedNoSpeedModCheck(const MoveDef& moveDef,
 
 	BlockType ret = BLOCK_NONE;
 
+	if (!groundBlockingObjectMap.AnyBlockedInRect(xmin, xmax, zmin, zmax))
+		return ret;
+
 	// footprints are point-symmetric around <xSquare, zSquare>
 	// same as RangeIsBlocked but without anti-duplication test
 	for (int z = zmin; z <= zmax; z += FOOTPRINT_ZSTEP) {
@@ -153,6 +156,9 @@ CMoveMath::BlockType CMoveMath::IsBlockedNoSpeedModCheckDiff(const MoveDef& move
 
 	BlockType ret = BLOCK_NONE;
 
+	if (!groundBlockingObjectMap.AnyBlockedInRect(xmin, xmax, zmin, zmax))
+		return ret;
+
 	const int tempNum = gs->GetMtTempNum(thread);
 
 	// footprints are point-symmetric around <xSquare, zSquare>
@@ -322,6 +328,11 @@ CMoveMath::BlockType CMoveMath::RangeIsBlocked(const MoveDef& moveDef, int xmin,
 	zmax = std::min(zmax, mapDims.mapy - 1);
 
 	BlockType ret = BLOCK_NONE;
+
+	// nothing on the blocking-map in this range; skips the per-square object lists
+	if (!groundBlockingObjectMap.AnyBlockedInRect(xmin, xmax, zmin, zmax))
+		return ret;
+
 	if (ThreadPool::inMultiThreadedSection) {
 		ret = CMoveMath::RangeIsBlockedMt(moveDef, xmin, xmax, zmin, zmax, collider, thread);
 	} else {
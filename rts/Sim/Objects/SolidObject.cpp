@@ -14,6 +14,9 @@
 
 int CSolidObject::deletingRefID = -1;
 
+bool CSolidObject::trackGeometryChanges = false;
+unsigned int CSolidObject::geometryChanges = 0;
+
 
 CR_BIND_DERIVED_INTERFACE(CSolidObject, CWorldObject)
 CR_REG_METADATA(CSolidObject,
@@ -396,6 +399,8 @@ void CSolidObject::UpdateDirVectors(bool useGroundNormal, bool useObjectNormal,
 	frontdir = GetVectorFromHeading(heading);
 	rightdir = (frontdir.cross(updir)).Normalize();
 	frontdir = updir.cross(rightdir);
+
+	GeometryChanged();
 }
 
 
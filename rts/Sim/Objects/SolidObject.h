@@ -135,6 +135,8 @@ public:
 		pos += dv;
 		midPos += dv;
 		aimPos += dv;
+
+		GeometryChanged();
 	}
 
 	// this should be called whenever the direction
@@ -143,6 +145,8 @@ public:
 	void UpdateMidAndAimPos() {
 		midPos = GetMidPos();
 		aimPos = GetAimPos();
+
+		GeometryChanged();
 	}
 	void SetMidAndAimPos(const float3& mp, const float3& ap, bool relative) {
 		SetMidPos(mp, relative);
@@ -155,6 +159,8 @@ public:
 		rightdir.x = -matrix[0]; updir.x = matrix[4]; frontdir.x = matrix[ 8];
 		rightdir.y = -matrix[1]; updir.y = matrix[5]; frontdir.y = matrix[ 9];
 		rightdir.z = -matrix[2]; updir.z = matrix[6]; frontdir.z = matrix[10];
+
+		GeometryChanged();
 	}
 
 	void AddHeading(short deltaHeading, bool useGroundNormal, bool useObjectNormal, float dirSmoothing) { SetHeading(heading + deltaHeading, useGroundNormal, useObjectNormal, dirSmoothing); }
@@ -200,6 +206,8 @@ public:
 	void SetLastHitPiece(const LocalModelPiece* piece, int frame, int synced = true) {
 		hitModelPieces[synced] = piece;
 		pieceHitFrames[synced] = frame;
+
+		GeometryChanged();
 	}
 
 
@@ -314,6 +322,8 @@ private:
 		} else {
 			midPos = mp; relMidPos = midPos - pos;
 		}
+
+		GeometryChanged();
 	}
 	void SetAimPos(const float3& ap, bool relative) {
 		if (relative) {
@@ -449,6 +459,21 @@ public:
 	// returns the object (command reference) id of the object currently being deleted,
 	// for units this equals unit->id, and for features feature->id + unitHandler.MaxUnits()
 	static int GetDeletingRefID() { return deletingRefID; }
+
+	// while tracking is enabled (main thread only, nothing may run concurrently)
+	// every change to the position, orientation, collision volume or hit-piece of
+	// any object is counted; CGameHelper uses this to know when terms it precomputed
+	// for a batch of explosions are no longer valid
+	static void TrackGeometryChanges(bool enable) { trackGeometryChanges = enable; geometryChanges = 0; }
+	static void GeometryChanged() {
+		if (trackGeometryChanges)
+			geometryChanges++;
+	}
+	static unsigned int GetGeometryChanges() { return geometryChanges; }
+
+private:
+	static bool trackGeometryChanges;
+	static unsigned int geometryChanges;
 };
 
 #endif // SOLID_OBJECT_H
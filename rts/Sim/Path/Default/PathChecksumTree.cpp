@@ -0,0 +1,72 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "PathChecksumTree.h"
+#include "System/Threading/ThreadPool.h" // for_mt
+
+#include <algorithm>
+#include <cstring>
+
+
+template<typename T>
+static void CalcSpanDigest(const std::vector<T>& data, size_t begin, size_t end, uint8_t* digest)
+{
+	// a truncated or missing span hashes as empty rather than reading out of bounds
+	begin = std::min(begin, data.size());
+	end = std::min(end, data.size());
+
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data() + begin);
+	sha512::calc_digest(bytes, (end - begin) * sizeof(T), digest);
+}
+
+
+void PathChecksumTree::Calc(
+	const std::vector< std::vector<short2> >& nodeOffsets,
+	const std::vector<float>& vertexCosts,
+	const int2 numBlocks,
+	const unsigned int numBlockVertices
+) {
+	const int numPathTypes = nodeOffsets.size();
+	const int numLeafBlocks = numBlocks.x * numBlocks.y;
+
+	regionRows = std::max(1, (numBlocks.y + MAX_REGIONS - 1) / MAX_REGIONS);
+	numRegions = std::max(1, (numBlocks.y + regionRows - 1) / regionRows);
+
+	leafDigests.clear();
+	leafDigests.resize(numPathTypes * numRegions);
+	pathTypeDigests.clear();
+	pathTypeDigests.resize(numPathTypes);
+
+	// leaf = hash(hash(offsets) | hash(costs)) for the blocks of one region
+	for_mt(0, numPathTypes * numRegions, [&](const int leafIdx) {
+		const int pathType = leafIdx / numRegions;
+		const int region = leafIdx % numRegions;
+
+		const size_t minBlockIdx = std::min(numLeafBlocks, (region + 0) * regionRows * numBlocks.x);
+		const size_t maxBlockIdx = std::min(numLeafBlocks, (region + 1) * regionRows * numBlocks.x);
+		const size_t costsOffset = size_t(pathType) * numLeafBlocks * numBlockVertices;
+
+		uint8_t spanDigests[sha512::SHA_LEN * 2];
+
+		CalcSpanDigest(nodeOffsets[pathType], minBlockIdx, maxBlockIdx, &spanDigests[0]);
+		CalcSpanDigest(vertexCosts, costsOffset + minBlockIdx * numBlockVertices, costsOffset + maxBlockIdx * numBlockVertices, &spanDigests[sha512::SHA_LEN]);
+
+		sha512::calc_digest(spanDigests, sizeof(spanDigests), leafDigests[leafIdx].data());
+	});
+
+	// inner levels are small; combine them in index order on this thread
+	sha512::msg_vector rawBytes(std::max(numRegions, numPathTypes) * sha512::SHA_LEN);
+
+	for (int pathType = 0; pathType < numPathTypes; pathType++) {
+		for (int region = 0; region < numRegions; region++) {
+			std::memcpy(&rawBytes[region * sha512::SHA_LEN], leafDigests[pathType * numRegions + region].data(), sha512::SHA_LEN);
+		}
+
+		sha512::calc_digest(rawBytes.data(), numRegions * sha512::SHA_LEN, pathTypeDigests[pathType].data());
+	}
+
+	for (int pathType = 0; pathType < numPathTypes; pathType++) {
+		std::memcpy(&rawBytes[pathType * sha512::SHA_LEN], pathTypeDigests[pathType].data(), sha512::SHA_LEN);
+	}
+
+	sha512::calc_digest(rawBytes.data(), numPathTypes * sha512::SHA_LEN, rootDigest.data());
+}
@@ -0,0 +1,59 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef PATH_CHECKSUM_TREE_H
+#define PATH_CHECKSUM_TREE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "System/type2.h"
+#include "System/Sync/SHA512.hpp"
+
+/**
+ * Hash of the precomputed estimator data (node offsets and vertex costs),
+ * built as a tree so the leaves can be hashed on the thread pool.
+ *
+ * Leaves cover one path-type and one region, a stripe of block rows, each.
+ * Leaf digests are combined per path-type and path-type digests into the
+ * root, always in index order, so the result does not depend on the number
+ * of threads. When two clients disagree, comparing the per-path-type and
+ * per-region checksums shows which movedef and which part of the map differ.
+ */
+struct PathChecksumTree {
+public:
+	static constexpr int MAX_REGIONS = 8;
+
+	void Calc(
+		const std::vector< std::vector<short2> >& nodeOffsets,
+		const std::vector<float>& vertexCosts,
+		const int2 numBlocks,
+		const unsigned int numBlockVertices
+	);
+
+	const sha512::raw_digest& GetDigest() const { return rootDigest; }
+
+	std::uint32_t GetChecksum() const { return ReduceDigest(rootDigest); }
+	std::uint32_t GetPathTypeChecksum(int pathType) const { return ReduceDigest(pathTypeDigests[pathType]); }
+	std::uint32_t GetRegionChecksum(int pathType, int region) const { return ReduceDigest(leafDigests[pathType * numRegions + region]); }
+
+	int GetNumPathTypes() const { return (pathTypeDigests.size()); }
+	int GetNumRegions() const { return numRegions; }
+	/// block-rows covered by each region; the last one can be shorter
+	int GetRegionRows() const { return regionRows; }
+
+	/// first four bytes of a digest, big-endian
+	static std::uint32_t ReduceDigest(const sha512::raw_digest& digest) {
+		return ((std::uint32_t(digest[0]) << 24) | (std::uint32_t(digest[1]) << 16) | (std::uint32_t(digest[2]) << 8) | (std::uint32_t(digest[3]) << 0));
+	}
+
+private:
+	std::vector<sha512::raw_digest> leafDigests; // [pathType * numRegions + region]
+	std::vector<sha512::raw_digest> pathTypeDigests; // [pathType]
+
+	sha512::raw_digest rootDigest = {};
+
+	int numRegions = 0;
+	int regionRows = 0;
+};
+
+#endif
@@ -8,6 +8,7 @@
 #include "PathEstimator.h"
 #include "PathFinder.h"
 #include "PathFinderDef.h"
+#include "PathChecksumTree.h"
 // #include "PathFlowMap.hpp"
 #include "PathLog.h"
 #include "PathMemPool.h"
@@ -30,14 +31,21 @@
 #include "System/SafeUtil.h"
 #include "System/StringUtil.h"
 #include "System/Sync/SHA512.hpp"
+#include "System/UnorderedMap.hpp"
 
 #define ENABLE_NETLOG_CHECKSUM 1
 
 CONFIG(int, PathingThreadCount).defaultValue(0).safemodeValue(1).minimumValue(0);
 CONFIG(int, MaxPathCostsMemoryFootPrint).defaultValue(512).minimumValue(64).description("Maximum memusage (in MByte) of multithreaded pathcache generator at loading time.");
 
-PCMemPool pcMemPool;
-PEMemPool peMemPool;
+PCMemPool pcMemPool("Path::Default");
+PEMemPool peMemPool("Path::Default");
+
+// pathinfo contents of the last map's estimators, keyed by cache-file name; kept
+// across reloads while retainPathInfo is set so consecutive --batch matches on the
+// same map do not have to read and inflate the cache-files again
+static spring::unordered_map<std::string, std::vector<std::uint8_t>> pathInfoCache;
+static bool retainPathInfo = false;
 
 
 static const std::string GetPathCacheDir() {
@@ -948,7 +956,28 @@ void CPathEstimator::FinishSearch(const MoveDef& moveDef, const CPathFinderDef&
 
 bool CPathEstimator::RemoveCacheFile(const std::string& peFileName, const std::string& mapFileName)
 {
-	return (FileSystem::Remove(GetCacheFileName(IntToString(fileHashCode, "%x"), peFileName, mapFileName)));
+	const std::string cacheFileName = GetCacheFileName(IntToString(fileHashCode, "%x"), peFileName, mapFileName);
+
+	pathInfoCache.erase(cacheFileName);
+	return (FileSystem::Remove(cacheFileName));
+}
+
+void CPathEstimator::SetRetainPathInfo(bool retain)
+{
+	if (!(retainPathInfo = retain))
+		pathInfoCache.clear();
+}
+
+static void RetainPathInfo(const std::string& cacheFileName, std::vector<std::uint8_t>&& buffer)
+{
+	if (!retainPathInfo)
+		return;
+
+	// one entry per estimator; anything else is from a different map or dataset
+	if (pathInfoCache.find(cacheFileName) == pathInfoCache.end() && pathInfoCache.size() >= 2)
+		pathInfoCache.clear();
+
+	pathInfoCache[cacheFileName] = std::move(buffer);
 }
 
 /**
@@ -959,33 +988,42 @@ bool CPathEstimator::ReadFile(const std::string& peFileName, const std::string&
 	const std::string hashHexString = IntToString(fileHashCode, "%x");
 	const std::string cacheFileName = GetCacheFileName(hashHexString, peFileName, mapFileName);
 
-	LOG("[PathEstimator::%s] hash=%s file=\"%s\" (exists=%d)", __func__, hashHexString.c_str(), cacheFileName.c_str(), FileSystem::FileExists(cacheFileName));
+	const auto cacheIter = pathInfoCache.find(cacheFileName);
 
-	if (!FileSystem::FileExists(cacheFileName))
-		return false;
+	std::vector<std::uint8_t> buffer;
 
-	std::unique_ptr<IArchive> upfile(archiveLoader.OpenArchive(dataDirsAccess.LocateFile(cacheFileName), "sdz"));
+	if (cacheIter != pathInfoCache.end()) {
+		LOG("[PathEstimator::%s] hash=%s file=\"%s\" (retained)", __func__, hashHexString.c_str(), cacheFileName.c_str());
 
-	if (upfile == nullptr || !upfile->IsOpen()) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
+		// the retained copy stays untouched, vertex-costs are updated at runtime
+		buffer = cacheIter->second;
+	} else {
+		LOG("[PathEstimator::%s] hash=%s file=\"%s\" (exists=%d)", __func__, hashHexString.c_str(), cacheFileName.c_str(), FileSystem::FileExists(cacheFileName));
 
-	char calcMsg[512];
-	sprintf(calcMsg, "Reading Estimate PathCosts [%d]", BLOCK_SIZE);
-	loadscreen->SetLoadMessage(calcMsg);
+		if (!FileSystem::FileExists(cacheFileName))
+			return false;
 
-	const unsigned fid = upfile->FindFile("pathinfo");
-	if (fid >= upfile->NumFiles()) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
+		std::unique_ptr<IArchive> upfile(archiveLoader.OpenArchive(dataDirsAccess.LocateFile(cacheFileName), "sdz"));
 
-	std::vector<std::uint8_t> buffer;
+		if (upfile == nullptr || !upfile->IsOpen()) {
+			FileSystem::Remove(cacheFileName);
+			return false;
+		}
 
-	if (!upfile->GetFile(fid, buffer) || buffer.size() < 4) {
-		FileSystem::Remove(cacheFileName);
-		return false;
+		char calcMsg[512];
+		sprintf(calcMsg, "Reading Estimate PathCosts [%d]", BLOCK_SIZE);
+		loadscreen->SetLoadMessage(calcMsg);
+
+		const unsigned fid = upfile->FindFile("pathinfo");
+		if (fid >= upfile->NumFiles()) {
+			FileSystem::Remove(cacheFileName);
+			return false;
+		}
+
+		if (!upfile->GetFile(fid, buffer) || buffer.size() < 4) {
+			FileSystem::Remove(cacheFileName);
+			return false;
+		}
 	}
 
 	const unsigned int filehash = *(reinterpret_cast<unsigned int*>(&buffer[0]));
@@ -993,12 +1031,12 @@ bool CPathEstimator::ReadFile(const std::string& peFileName, const std::string&
 	unsigned int pos = sizeof(unsigned);
 
 	if (filehash != fileHashCode) {
-		FileSystem::Remove(cacheFileName);
+		RemoveCacheFile(peFileName, mapFileName);
 		return false;
 	}
 
 	if (buffer.size() < (pos + blockSize * moveDefHandler.GetNumMoveDefs())) {
-		FileSystem::Remove(cacheFileName);
+		RemoveCacheFile(peFileName, mapFileName);
 		return false;
 	}
 
@@ -1010,11 +1048,15 @@ bool CPathEstimator::ReadFile(const std::string& peFileName, const std::string&
 
 	// read vertex-cost data
 	if (buffer.size() < (pos + vertexCosts.size() * sizeof(float))) {
-		FileSystem::Remove(cacheFileName);
+		RemoveCacheFile(peFileName, mapFileName);
 		return false;
 	}
 
 	std::memcpy(&vertexCosts[0], &buffer[pos], vertexCosts.size() * sizeof(float));
+
+	if (cacheIter == pathInfoCache.end())
+		RetainPathInfo(cacheFileName, std::move(buffer));
+
 	return true;
 }
 
@@ -1039,19 +1081,25 @@ bool CPathEstimator::WriteFile(const std::string& peFileName, const std::string&
 	if (file == nullptr)
 		return false;
 
-	zipOpenNewFileInZip(file, "pathinfo", nullptr, nullptr, 0, nullptr, 0, nullptr, Z_DEFLATED, Z_BEST_COMPRESSION);
+	std::vector<std::uint8_t> buffer;
 
-	// write hash-code (NOTE: this also affects the CRC!)
-	zipWriteInFileInZip(file, (const void*) &fileHashCode, 4);
+	const auto AppendData = [&](const void* data, size_t size) {
+		buffer.insert(buffer.end(), reinterpret_cast<const std::uint8_t*>(data), reinterpret_cast<const std::uint8_t*>(data) + size);
+	};
 
-	// write center-offsets
+	// hash-code (NOTE: this also affects the CRC!)
+	AppendData(&fileHashCode, 4);
+
+	// center-offsets
 	for (int pathType = 0; pathType < moveDefHandler.GetNumMoveDefs(); ++pathType) {
-		zipWriteInFileInZip(file, (const void*) &blockStates.peNodeOffsets[pathType][0], blockStates.peNodeOffsets[pathType].size() * sizeof(short2));
+		AppendData(&blockStates.peNodeOffsets[pathType][0], blockStates.peNodeOffsets[pathType].size() * sizeof(short2));
 	}
 
-	// write vertex-costs
-	zipWriteInFileInZip(file, vertexCosts.data(), vertexCosts.size() * sizeof(float));
+	// vertex-costs
+	AppendData(vertexCosts.data(), vertexCosts.size() * sizeof(float));
 
+	zipOpenNewFileInZip(file, "pathinfo", nullptr, nullptr, 0, nullptr, 0, nullptr, Z_DEFLATED, Z_BEST_COMPRESSION);
+	zipWriteInFileInZip(file, buffer.data(), buffer.size());
 	zipCloseFileInZip(file);
 	zipClose(file, nullptr);
 
@@ -1065,50 +1113,44 @@ bool CPathEstimator::WriteFile(const std::string& peFileName, const std::string&
 	}
 
 	assert(upfile->FindFile("pathinfo") < upfile->NumFiles());
-  return true;
+
+	RetainPathInfo(cacheFileName, std::move(buffer));
+	return true;
 }
 
 
 std::uint32_t CPathEstimator::CalcChecksum() const
 {
 	std::uint32_t chksum = 0;
-	std::uint64_t nbytes = vertexCosts.size() * sizeof(float);
-	std::uint64_t offset = 0;
 
-	#if (ENABLE_NETLOG_CHECKSUM == 1)
-	std::array<char, 128 + sha512::SHA_LEN * 2 + 1> msgBuffer;
+	// leaves are hashed on the thread pool and combined in a fixed order
+	PathChecksumTree checksumTree;
+	checksumTree.Calc(blockStates.peNodeOffsets, vertexCosts, nbrOfBlocks, PATH_DIRECTION_VERTICES);
 
-	sha512::hex_digest hexChars;
-	sha512::raw_digest shaBytes;
-	sha512::msg_vector rawBytes;
-	#endif
+	const sha512::raw_digest& shaBytes = checksumTree.GetDigest();
 
 	#if (ENABLE_NETLOG_CHECKSUM == 1)
-	for (const auto& pathTypeOffsets: blockStates.peNodeOffsets) {
-		nbytes += (pathTypeOffsets.size() * sizeof(short2));
-	}
-
-	rawBytes.clear();
-	rawBytes.resize(nbytes);
-
-	for (const auto& pathTypeOffsets: blockStates.peNodeOffsets) {
-		nbytes = pathTypeOffsets.size() * sizeof(short2);
-		offset += nbytes;
-
-		std::memcpy(&rawBytes[offset - nbytes], pathTypeOffsets.data(), nbytes);
-	}
-
 	{
-		nbytes = vertexCosts.size() * sizeof(float);
-		offset += nbytes;
-
-		std::memcpy(&rawBytes[offset - nbytes], vertexCosts.data(), nbytes);
+		std::array<char, 128 + sha512::SHA_LEN * 2 + 1> msgBuffer;
+		std::array<char, 16 + PathChecksumTree::MAX_REGIONS * 9> sumBuffer;
 
-		sha512::calc_digest(rawBytes, shaBytes); // hash(offsets|costs)
+		sha512::hex_digest hexChars;
 		sha512::dump_digest(shaBytes, hexChars); // hexify(hash)
 
 		SNPRINTF(msgBuffer.data(), msgBuffer.size(), "[PE::%s][BLK_SIZE=%d][SHA_DATA=%s]", __func__, BLOCK_SIZE, hexChars.data());
 		CLIENT_NETLOG(gu->myPlayerNum, LOG_LEVEL_INFO, msgBuffer.data());
+
+		// per-movedef and per-region sums, to locate a mismatch between clients
+		for (int pathType = 0; pathType < checksumTree.GetNumPathTypes(); pathType++) {
+			int sumLen = 0;
+
+			for (int region = 0; region < checksumTree.GetNumRegions(); region++) {
+				sumLen += SNPRINTF(&sumBuffer[sumLen], sumBuffer.size() - sumLen, "%s%08x", (region == 0)? "": ",", checksumTree.GetRegionChecksum(pathType, region));
+			}
+
+			SNPRINTF(msgBuffer.data(), msgBuffer.size(), "[PE::%s][BLK_SIZE=%d][PATH_TYPE=%d][SHA_SUM=%08x][REGION_ROWS=%d][REGION_SUMS=%s]", __func__, BLOCK_SIZE, pathType, checksumTree.GetPathTypeChecksum(pathType), checksumTree.GetRegionRows(), sumBuffer.data());
+			CLIENT_NETLOG(gu->myPlayerNum, LOG_LEVEL_INFO, msgBuffer.data());
+		}
 	}
 	#endif
 
@@ -45,6 +45,12 @@ public:
 
 	bool RemoveCacheFile(const std::string& peFileName, const std::string& mapFileName);
 
+	/**
+	 * Keep the pathinfo of the last map's estimators in memory across reloads
+	 * (set for --batch matches); disabling it releases what has been retained.
+	 */
+	static void SetRetainPathInfo(bool retain);
+
 
 	/**
 	 * This is called whenever the ground structure of the map changes
@@ -23,7 +23,7 @@
 using namespace Bitwise;
 using MMBT = CMoveMath::BlockTypes;
 
-PFMemPool pfMemPool;
+PFMemPool pfMemPool("Path::Default");
 
 
 static constexpr uint32_t squareMobileBlockBits =
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "System/float3.h"
+#include "System/MemoryTags.h"
 
 class CSolidObject;
 
@@ -23,9 +24,13 @@ namespace QTPFS {
 			synced = true;
 
 			owner = NULL;
+
+			GetMemTag()->OnAlloc(sizeof(IPath));
 		}
-		IPath(const IPath& p) { *this = p; }
+		IPath(const IPath& p) { GetMemTag()->OnAlloc(sizeof(IPath)); *this = p; }
 		IPath& operator = (const IPath& p) {
+			const size_t oldPointBytes = points.capacity() * sizeof(float3);
+
 			pathID = p.GetID();
 
 			nextPointIndex = p.GetNextPointIndex();
@@ -40,9 +45,20 @@ namespace QTPFS {
 			boundingBoxMaxs = p.GetBoundingBoxMaxs();
 
 			owner = p.GetOwner();
+
+			GetMemTag()->OnResize(oldPointBytes, points.capacity() * sizeof(float3));
 			return *this;
 		}
-		~IPath() { points.clear(); }
+		~IPath() {
+			GetMemTag()->OnFree(sizeof(IPath) + points.capacity() * sizeof(float3));
+			points.clear();
+		}
+
+		// live paths and their waypoints are what the QTPFS path cache holds
+		static MemoryTag* GetMemTag() {
+			static MemoryTag* memTag = MemoryTags::Get("PathCache::QTPFS");
+			return memTag;
+		}
 
 		void SetID(unsigned int pathID) { this->pathID = pathID; }
 		unsigned int GetID() const { return pathID; }
@@ -88,8 +104,12 @@ namespace QTPFS {
 
 		unsigned int NumPoints() const { return (points.size()); }
 		void AllocPoints(unsigned int n) {
+			const size_t oldPointBytes = points.capacity() * sizeof(float3);
+
 			points.clear();
 			points.resize(n);
+
+			GetMemTag()->OnResize(oldPointBytes, points.capacity() * sizeof(float3));
 		}
 		void CopyPoints(const IPath& p) {
 			AllocPoints(p.NumPoints());
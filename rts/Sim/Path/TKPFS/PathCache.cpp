@@ -6,6 +6,7 @@
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "System/Log/ILog.h"
+#include "System/MemoryTags.h"
 
 #define MAX_CACHE_QUEUE_SIZE   200
 #define MAX_PATH_LIFETIME_SECS   6
@@ -13,6 +14,17 @@
 
 namespace TKPFS {
 
+static MemoryTag* const pathCacheMemTag = MemoryTags::Get("PathCache::TKPFS");
+
+static size_t GetCacheItemBytes(const CPathCache::CacheItem& ci)
+{
+	size_t bytes = sizeof(ci);
+
+	bytes += (ci.path.path.capacity() * sizeof(decltype(ci.path.path)::value_type));
+	bytes += (ci.path.squares.capacity() * sizeof(decltype(ci.path.squares)::value_type));
+	return bytes;
+}
+
 CPathCache::CPathCache(int blocksX, int blocksZ)
 	: numBlocksX(blocksX)
 	, numBlocksZ(blocksZ)
@@ -40,6 +52,10 @@ CPathCache::~CPathCache()
 #endif
 
 	LOG(fmt, __FUNCTION__, numBlocksX, numBlocksZ, numCacheHits, GetCacheHitPercentage(), numHashCollisions, maxCacheSize);
+
+	for (const auto& pair: cachedPaths) {
+		pathCacheMemTag->OnFree(GetCacheItemBytes(pair.second));
+	}
 }
 
 bool CPathCache::AddPath(
@@ -71,7 +87,9 @@ bool CPathCache::AddPath(
 	if (iter != cachedPaths.end())
 		return ((numHashCollisions += HashCollision(iter->second, strtBlock, goalBlock, goalRadius, pathType)) != cols);
 
-	cachedPaths[hash] = CacheItem{result, *path, strtBlock, goalBlock, goalRadius, pathType};
+	const CacheItem& ci = (cachedPaths[hash] = CacheItem{result, *path, strtBlock, goalBlock, goalRadius, pathType});
+
+	pathCacheMemTag->OnAlloc(GetCacheItemBytes(ci));
 
 	const int lifeTime = (result == IPath::Ok) ? GAME_SPEED * MAX_PATH_LIFETIME_SECS : GAME_SPEED * (MAX_PATH_LIFETIME_SECS / 2);
 
@@ -126,6 +144,7 @@ void CPathCache::RemoveFrontQueItem()
 	const auto it = cachedPaths.find((cacheQue.front()).hash);
 
 	assert(it != cachedPaths.end());
+	pathCacheMemTag->OnFree(GetCacheItemBytes(it->second));
 	cachedPaths.erase(it);
 	cacheQue.pop_front();
 }
@@ -27,7 +27,7 @@ namespace TKPFS {
 using namespace Bitwise;
 using MMBT = CMoveMath::BlockTypes;
 
-PFMemPool pfMemPool;
+PFMemPool pfMemPool("Path::TKPFS");
 
 
 static constexpr uint32_t squareMobileBlockBits =
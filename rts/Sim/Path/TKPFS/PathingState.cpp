@@ -14,6 +14,7 @@
 #include "Sim/MoveTypes/MoveMath/MoveMath.h"
 #include "PathFinder.h"
 #include "Sim/Path/Default/IPath.h"
+#include "Sim/Path/Default/PathChecksumTree.h"
 #include "PathConstants.h"
 #include "Sim/Path/Default/PathFinderDef.h"
 #include "Sim/Path/Default/PathLog.h"
@@ -41,7 +42,7 @@ bool TEST_ACTIVE = false;
 static std::vector<PathNodeStateBuffer> nodeStateBuffers;
 static size_t pathingStates = 0;
 
-PCMemPool pcMemPool;
+PCMemPool pcMemPool("Path::TKPFS");
 // PEMemPool peMemPool;
 
 static const std::string GetPathCacheDir() {
@@ -805,51 +806,35 @@ void PathingState::MapChanged(unsigned int x1, unsigned int z1, unsigned int x2,
 std::uint32_t PathingState::CalcChecksum() const
 {
 	std::uint32_t chksum = 0;
-	std::uint64_t nbytes = vertexCosts.size() * sizeof(float);
-	std::uint64_t offset = 0;
 
-	#if (ENABLE_NETLOG_CHECKSUM == 1)
-	std::array<char, 128 + sha512::SHA_LEN * 2 + 1> msgBuffer;
+	// leaves are hashed on the thread pool and combined in a fixed order
+	PathChecksumTree checksumTree;
+	checksumTree.Calc(blockStates.peNodeOffsets, vertexCosts, mapDimensionsInBlocks, PATH_DIRECTION_VERTICES);
 
-	sha512::hex_digest hexChars;
-	sha512::raw_digest shaBytes;
-	sha512::msg_vector rawBytes;
-	#endif
+	const sha512::raw_digest& shaBytes = checksumTree.GetDigest();
 
 	#if (ENABLE_NETLOG_CHECKSUM == 1)
-	for (const auto& pathTypeOffsets: blockStates.peNodeOffsets) {
-		nbytes += (pathTypeOffsets.size() * sizeof(short2));
-	}
-
-	rawBytes.clear();
-	rawBytes.resize(nbytes);
-
-	for (const auto& pathTypeOffsets: blockStates.peNodeOffsets) {
-		nbytes = pathTypeOffsets.size() * sizeof(short2);
-		offset += nbytes;
-
-		std::memcpy(&rawBytes[offset - nbytes], pathTypeOffsets.data(), nbytes);
-	}
-
-	// for (int i=0; i<blockStates.peNodeOffsets.size(); i++){
-	// 	for (int j =0; j<blockStates.peNodeOffsets[i].size(); j++){
-	// 		LOG("blockStates.peNodeOffsets[%d][%d] = (%d %d)", i, j
-	// 		, blockStates.peNodeOffsets[i][j].x
-	// 		, blockStates.peNodeOffsets[i][j].y);
-	// 	}
-	// }
-
 	{
-		nbytes = vertexCosts.size() * sizeof(float);
-		offset += nbytes;
-
-		std::memcpy(&rawBytes[offset - nbytes], vertexCosts.data(), nbytes);
+		std::array<char, 128 + sha512::SHA_LEN * 2 + 1> msgBuffer;
+		std::array<char, 16 + PathChecksumTree::MAX_REGIONS * 9> sumBuffer;
 
-		sha512::calc_digest(rawBytes, shaBytes); // hash(offsets|costs)
+		sha512::hex_digest hexChars;
 		sha512::dump_digest(shaBytes, hexChars); // hexify(hash)
 
 		SNPRINTF(msgBuffer.data(), msgBuffer.size(), "[PE::%s][BLK_SIZE=%d][SHA_DATA=%s]", __func__, BLOCK_SIZE, hexChars.data());
 		CLIENT_NETLOG(gu->myPlayerNum, LOG_LEVEL_INFO, msgBuffer.data());
+
+		// per-movedef and per-region sums, to locate a mismatch between clients
+		for (int pathType = 0; pathType < checksumTree.GetNumPathTypes(); pathType++) {
+			int sumLen = 0;
+
+			for (int region = 0; region < checksumTree.GetNumRegions(); region++) {
+				sumLen += SNPRINTF(&sumBuffer[sumLen], sumBuffer.size() - sumLen, "%s%08x", (region == 0)? "": ",", checksumTree.GetRegionChecksum(pathType, region));
+			}
+
+			SNPRINTF(msgBuffer.data(), msgBuffer.size(), "[PE::%s][BLK_SIZE=%d][PATH_TYPE=%d][SHA_SUM=%08x][REGION_ROWS=%d][REGION_SUMS=%s]", __func__, BLOCK_SIZE, pathType, checksumTree.GetPathTypeChecksum(pathType), checksumTree.GetRegionRows(), sumBuffer.data());
+			CLIENT_NETLOG(gu->myPlayerNum, LOG_LEVEL_INFO, msgBuffer.data());
+		}
 	}
 	#endif
 
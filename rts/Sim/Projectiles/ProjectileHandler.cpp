@@ -5,6 +5,7 @@
 #include "Projectile.h"
 #include "ProjectileHandler.h"
 #include "ProjectileMemPool.h"
+#include "Game/GameHelper.h"
 #include "Game/GlobalUnsynced.h"
 #include "Game/TraceRay.h"
 #include "Map/Ground.h"
@@ -59,7 +60,7 @@ CR_REG_METADATA(CProjectileHandler, (
 
 
 // note: stores all ExpGenSpawnable types, not just projectiles
-ProjMemPool projMemPool;
+ProjMemPool projMemPool("Projectiles");
 
 CProjectileHandler projectileHandler;
 
@@ -564,46 +565,92 @@ void CProjectileHandler::CheckUnitFeatureCollisions(bool synced)
 	}
 }
 
-void CProjectileHandler::CheckGroundCollisions(bool synced)
+static bool GetGroundCollisionHeight(const CProjectile* p, float& impactHeight)
 {
-	//can't use iterators here, because instructions inside the loop modify projectiles[synced]
-	for (size_t i = 0; i < projectiles[synced].size(); ++i) {
-		CProjectile* p = projectiles[synced][i];
+	if (!p->checkCol)
+		return false;
 
-		if (!p->checkCol)
-			continue;
+	// NOTE:
+	//   if <p> is a MissileProjectile and does not have
+	//   selfExplode set, tbis will cause it to never be
+	//   removed (!)
+	if (p->GetCollisionFlags() & Collision::NOGROUND)
+		return false;
+
+	// don't collide with ground yet if last update scheduled a bounce
+	if (p->weapon && static_cast<const CWeaponProjectile*>(p)->HasScheduledBounce())
+		return false;
+
+	// NOTE:
+	//   don't add p->radius to groundHeight, or most (esp. modelled)
+	//   projectiles will collide with the ground one or more frames
+	//   too early
+	const float gy = CGround::GetHeightReal(p->pos.x, p->pos.z);
+	const float py = p->pos.y;
+
+	const bool belowGround = (py < gy);
+	const bool insideWater = (py <= 0.0f);
+
+	if (!belowGround && (!insideWater || p->ignoreWater))
+		return false;
+
+	impactHeight = mix(py, gy, belowGround);
+	return true;
+}
 
-		// NOTE:
-		//   if <p> is a MissileProjectile and does not have
-		//   selfExplode set, tbis will cause it to never be
-		//   removed (!)
-		if (p->GetCollisionFlags() & Collision::NOGROUND)
+void CProjectileHandler::PrepareGroundExplosionBatch()
+{
+	static std::vector<CGameHelper::ExplosionBatchQuery> queries;
+
+	// predict where weapon projectiles reaching the ground will explode
+	// (see CWeaponProjectile::Collision); mispredictions only cost time
+	for (const CProjectile* p: projectiles[true]) {
+		float impactHeight = 0.0f;
+
+		if (!p->weapon)
 			continue;
+		if (!GetGroundCollisionHeight(p, impactHeight))
+			continue;
+
+		const CWeaponProjectile* wp = static_cast<const CWeaponProjectile*>(p);
 
-		// don't collide with ground yet if last update scheduled a bounce
-		if (p->weapon && static_cast<const CWeaponProjectile*>(p)->HasScheduledBounce())
+		if (wp->GetWeaponDef()->impactOnly)
 			continue;
 
-		// NOTE:
-		//   don't add p->radius to groundHeight, or most (esp. modelled)
-		//   projectiles will collide with the ground one or more frames
-		//   too early
-		const float gy = CGround::GetHeightReal(p->pos.x, p->pos.z);
-		const float py = p->pos.y;
+		const float3 impactPos = p->hitscan? wp->GetTargetPos(): float3(p->pos.x, impactHeight, p->pos.z);
+		const float impactRadius = std::max(1.0f, wp->damages->damageAreaOfEffect);
 
-		const bool belowGround = (py < gy);
-		const bool insideWater = (py <= 0.0f);
+		queries.push_back({impactPos, impactRadius});
+	}
+
+	helper->PrepareExplosionBatch(queries);
+	queries.clear();
+}
 
-		if (!belowGround && (!insideWater || p->ignoreWater))
+void CProjectileHandler::CheckGroundCollisions(bool synced)
+{
+	if (synced)
+		PrepareGroundExplosionBatch();
+
+	//can't use iterators here, because instructions inside the loop modify projectiles[synced]
+	for (size_t i = 0; i < projectiles[synced].size(); ++i) {
+		CProjectile* p = projectiles[synced][i];
+
+		float impactHeight = 0.0f;
+
+		if (!GetGroundCollisionHeight(p, impactHeight))
 			continue;
 
 		// if position has dropped below terrain or into water
 		// where we can not live, adjust it and explode us now
 		// (if the projectile does not set deleteMe = true, it
 		// will keep hugging the terrain)
-		p->SetPosition((p->pos * XZVector) + (UpVector * mix(py, gy, belowGround)));
+		p->SetPosition((p->pos * XZVector) + (UpVector * impactHeight));
 		p->Collision();
 	}
+
+	if (synced)
+		helper->ClearExplosionBatch();
 }
 
 void CProjectileHandler::CheckCollisions()
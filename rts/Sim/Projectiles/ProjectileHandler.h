@@ -48,6 +48,7 @@ public:
 	void CheckShieldCollisions(CProjectile*, std::vector<CPlasmaRepulser*>&, const float3, const float3);
 	void CheckUnitFeatureCollisions(bool synced);
 	void CheckGroundCollisions(bool synced);
+	void PrepareGroundExplosionBatch();
 	void CheckCollisions();
 
 	void SetMaxParticles(int value) { maxParticles = std::max(0, value); }
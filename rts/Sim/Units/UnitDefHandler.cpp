@@ -81,6 +81,7 @@ int CUnitDefHandler::PushNewUnitDef(const std::string& unitName, const LuaTable&
 	}
 
 	unitDefIDs[unitName] = defID;
+	unitDefNameIndex.Insert(unitName, defID);
 	return defID;
 }
 
@@ -195,19 +196,6 @@ void CUnitDefHandler::LoadSounds(const LuaTable& soundsTable, GuiSoundSet& gsoun
 }
 
 
-const UnitDef* CUnitDefHandler::GetUnitDefByName(std::string name)
-{
-	StringToLowerInPlace(name);
-
-	const auto it = unitDefIDs.find(name);
-
-	if (it == unitDefIDs.end())
-		return nullptr;
-
-	return &unitDefsVector[it->second];
-}
-
-
 void CUnitDefHandler::SetNoCost(bool value)
 {
 	if (noCost == value)
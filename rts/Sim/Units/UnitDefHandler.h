@@ -8,6 +8,7 @@
 
 #include "UnitDef.h"
 #include "Sim/Misc/CommonDefHandler.h"
+#include "Sim/Misc/DefNameIndex.h"
 #include "System/UnorderedMap.hpp"
 
 class LuaTable;
@@ -22,6 +23,7 @@ public:
 	void Kill() {
 		unitDefsVector.clear();
 		unitDefIDs.clear(); // never iterated in synced code
+		unitDefNameIndex.Clear();
 
 		// reuse inner vectors when reloading; keys are never iterated
 		// decoyMap.clear();
@@ -36,8 +38,16 @@ public:
 	bool GetNoCost() { return noCost; }
 	void SetNoCost(bool value);
 
-	// NOTE: safe with unordered_map after Init
-	const UnitDef* GetUnitDefByName(std::string name);
+	// NOTE: case-insensitive, no allocations
+	const UnitDef* GetUnitDefByName(const char* name) const {
+		const int id = unitDefNameIndex.Find(name);
+
+		if (id == -1)
+			return nullptr;
+
+		return &unitDefsVector[id];
+	}
+	const UnitDef* GetUnitDefByName(const std::string& name) const { return (GetUnitDefByName(name.c_str())); }
 	const UnitDef* GetUnitDefByID(int id) {
 		if (!IsValidUnitDefID(id))
 			return nullptr;
@@ -68,6 +78,7 @@ protected:
 private:
 	std::vector<UnitDef> unitDefsVector;
 	spring::unordered_map<std::string, int> unitDefIDs;
+	DefNameIndex unitDefNameIndex;
 	spring::unordered_map<int, std::vector<int> > decoyMap;
 	std::vector< std::pair<std::string, std::string> > decoyNameMap;
 
@@ -13,7 +13,9 @@
 #include "CommandAI/BuilderCAI.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/ModInfo.h"
+#include "Sim/Misc/SlowUpdateScheduler.h"
 #include "Sim/Misc/TeamHandler.h"
+#include "Sim/MoveTypes/GroundMoveType.h"
 #include "Sim/MoveTypes/MoveType.h"
 #include "Sim/Path/IPathManager.h"
 #include "Sim/Weapons/Weapon.h"
@@ -40,16 +42,20 @@ CR_REG_METADATA(CUnitHandler, (
 
 	CR_MEMBER(activeSlowUpdateUnit),
 	CR_MEMBER(activeUpdateUnit),
+	CR_MEMBER(slowUpdateCycleCost),
 
 	CR_MEMBER(maxUnits),
 	CR_MEMBER(maxUnitRadius),
 
+	CR_IGNORED(moveTypeStartPositions),
+	CR_IGNORED(moveTypeDisplacementBound),
+
 	CR_MEMBER(inUpdateCall)
 ))
 
 
 
-UnitMemPool unitMemPool;
+UnitMemPool unitMemPool("Units");
 
 CUnitHandler unitHandler;
 
@@ -101,6 +107,7 @@ void CUnitHandler::Init() {
 	{
 		activeSlowUpdateUnit = 0;
 		activeUpdateUnit = 0;
+		slowUpdateCycleCost = 0;
 	}
 	{
 		units.resize(maxUnits, nullptr);
@@ -300,10 +307,33 @@ void CUnitHandler::DeleteUnit(CUnit* delUnit)
 	CSolidObject::SetDeletingRefID(-1);
 }
 
+float CUnitHandler::CalcMoveTypeDisplacementBound() const
+{
+	// units were added by UpdatePreCollisions, indices no longer match
+	if (moveTypeStartPositions.size() != activeUnits.size())
+		return -1.0f;
+
+	float maxSqDist = 0.0f;
+
+	for (size_t i = 0; i < activeUnits.size(); ++i) {
+		const CUnit* unit = activeUnits[i];
+
+		// ignored by CGroundMoveType::HandleUnitCollisions before anything else
+		if (unit->IsFlying() || unit->IsSkidding())
+			continue;
+
+		maxSqDist = std::max(maxSqDist, moveTypeStartPositions[i].SqDistance(unit->pos));
+	}
+
+	return (math::sqrt(maxSqDist));
+}
+
 void CUnitHandler::UpdateUnitMoveTypes()
 {
 	SCOPED_TIMER("Sim::Unit::MoveType");
 
+	moveTypeDisplacementBound = -1.0f;
+
 	if (modInfo.forceCollisionAvoidanceSingleThreaded)
 	{
 		SCOPED_TIMER("Sim::Unit::MoveType::1::UpdatePreCollisionsST");
@@ -318,9 +348,13 @@ void CUnitHandler::UpdateUnitMoveTypes()
 			moveType->UpdatePreCollisionsMt();
 			moveType->UpdatePreCollisions();
 		}
+
+		// skidding units were deferred by UpdatePreCollisions
+		CGroundMoveType::UpdateSkiddingUnits();
 	} else {
 		{
 		SCOPED_TIMER("Sim::Unit::MoveType::1::UpdatePreCollisionsMT");
+		moveTypeStartPositions.resize(activeUnits.size());
 		for_mt(0, activeUnits.size(), [this](const int i){
 			CUnit* unit = activeUnits[i];
 			AMoveType* moveType = unit->moveType;
@@ -328,6 +362,8 @@ void CUnitHandler::UpdateUnitMoveTypes()
 			unit->SanityCheck();
 			unit->PreUpdate();
 
+			moveTypeStartPositions[i] = unit->pos;
+
 			moveType->UpdatePreCollisionsMt();
 		});
 		}
@@ -341,7 +377,12 @@ void CUnitHandler::UpdateUnitMoveTypes()
 
 			moveType->UpdatePreCollisions();
 		}
+
+		CGroundMoveType::UpdateSkiddingUnits();
 		}
+
+		// lets collision detection reuse the neighbourhoods gathered in phase 1
+		moveTypeDisplacementBound = CalcMoveTypeDisplacementBound();
 	}
 
 	if (modInfo.forceCollisionsSingleThreaded) {
@@ -367,6 +408,8 @@ void CUnitHandler::UpdateUnitMoveTypes()
 		}
 	}
 
+	moveTypeDisplacementBound = -1.0f;
+
 	{
 	// SCOPED_TIMER("Sim::Unit::MoveType::4::ProcessCollisionEvents");
 	for (activeUpdateUnit = 0; activeUpdateUnit < activeUnits.size(); ++activeUpdateUnit) {
@@ -412,14 +455,33 @@ void CUnitHandler::SlowUpdateUnits()
 	assert(activeSlowUpdateUnit >= 0);
 
 	// reset the iterator every <UNIT_SLOWUPDATE_RATE> frames
-	if ((gs->frameNum % UNIT_SLOWUPDATE_RATE) == 0)
+	if (CSlowUpdateScheduler::IsCycleStart(gs->frameNum)) {
+		int cycleCost = 0;
+
+		for (const CUnit* unit: activeUnits) {
+			cycleCost += CSlowUpdateScheduler::GetUnitCost(unit->weapons.size());
+		}
+
 		activeSlowUpdateUnit = 0;
+		slowUpdateCycleCost = 0;
+		slowUpdateScheduler.BeginCycle(gs->frameNum, cycleCost);
+	}
 
 	const size_t idxBeg = activeSlowUpdateUnit;
-	const size_t maximumCnt = activeUnits.size() - idxBeg;
-	const size_t logicalCnt = (activeUnits.size() / UNIT_SLOWUPDATE_RATE) + 1;
-	const size_t indCnt = logicalCnt > maximumCnt ? maximumCnt : logicalCnt;
-	const size_t idxEnd = idxBeg + indCnt;
+	size_t idxEnd = idxBeg;
+
+	// stagger the SlowUpdate's by cost such that frames which also run the
+	// team and interceptor updates do less; the last frame of each cycle
+	// takes everything that is left, including units added during it
+	if (CSlowUpdateScheduler::IsCycleEnd(gs->frameNum)) {
+		idxEnd = activeUnits.size();
+	} else {
+		const int cycleBudget = slowUpdateScheduler.GetStaggeredBudget(gs->frameNum);
+
+		while (idxEnd < activeUnits.size() && slowUpdateCycleCost < cycleBudget) {
+			slowUpdateCycleCost += CSlowUpdateScheduler::GetUnitCost(activeUnits[idxEnd++]->weapons.size());
+		}
+	}
 
 	activeSlowUpdateUnit = idxEnd;
 
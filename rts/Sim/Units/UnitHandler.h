@@ -8,6 +8,7 @@
 
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/SimObjectIDPool.h"
+#include "System/float3.h"
 #include "System/creg/STL_Map.h"
 
 struct UnitDef;
@@ -47,6 +48,13 @@ public:
 
 	float MaxUnitRadius() const { return maxUnitRadius; }
 
+	/**
+	 * Upper bound on how far any unit not skipped by ground collision handling
+	 * has moved since the start of this frame's movetype updates; only known
+	 * while collisions are being detected, negative otherwise
+	 */
+	float GetMoveTypeDisplacementBound() const { return moveTypeDisplacementBound; }
+
 	/// Returns true if a unit of type unitID can be built, false otherwise
 	bool CanBuildUnit(const UnitDef* unitdef, int team) const;
 	bool GarbageCollectUnit(unsigned int id);
@@ -82,6 +90,7 @@ private:
 	void SlowUpdateUnits();
 	void UpdateUnitPathing(const size_t idxBeg, const size_t idxEnd);
 	void UpdateUnitMoveTypes();
+	float CalcMoveTypeDisplacementBound() const;
 	void UpdateUnitLosStates();
 	void UpdateUnits();
 	void UpdateUnitWeapons();
@@ -105,6 +114,8 @@ private:
 	size_t activeSlowUpdateUnit = 0;  ///< first unit of batch that will be SlowUpdate'd this frame
 	size_t activeUpdateUnit = 0;      ///< first unit of batch that will be SlowUpdate'd this frame
 
+	int slowUpdateCycleCost = 0;      ///< scheduler cost of the units SlowUpdate'd so far in this cycle
+
 
 	///< global unit-limit (derived from the per-team limit)
 	///< units.size() is equal to this and constant at runtime
@@ -114,6 +125,11 @@ private:
 	///< spatial query filters in GameHelper use this)
 	float maxUnitRadius = 0.0f;
 
+	///< positions of activeUnits before their movetypes were updated this frame
+	std::vector<float3> moveTypeStartPositions;
+
+	float moveTypeDisplacementBound = -1.0f;
+
 	bool inUpdateCall = false;
 };
 
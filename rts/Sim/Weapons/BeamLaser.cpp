@@ -277,6 +277,7 @@ void CBeamLaser::FireInternal(float3 curDir)
 	CFeature* hitFeature = nullptr;
 	CPlasmaRepulser* hitShield = nullptr;
 	static std::vector<TraceRay::SShieldDist> hitShields;
+	static TraceRay::SBeamCorridor beamCorridor;
 	CollisionQuery hitColQuery;
 
 	if (!sweepFireState.IsSweepFiring()) {
@@ -301,7 +302,7 @@ void CBeamLaser::FireInternal(float3 curDir)
 	}
 
 	for (int tries = 0; tries < 5 && tryAgain; ++tries) {
-		float beamLength = TraceRay::TraceRay(curPos, curDir, maxLength - curLength, collisionFlags, owner, hitUnit, hitFeature, &hitColQuery);
+		float beamLength = TraceRay::TraceBeam(this, curPos, curDir, maxLength - curLength, collisionFlags, hitUnit, hitFeature, &hitColQuery, beamCorridor);
 
 		if (hitUnit != nullptr && teamHandler.AlliedTeams(hitUnit->team, owner->team)) {
 			if (sweepFireState.IsSweepFiring() && !sweepFireState.DamageAllies()) {
@@ -324,7 +325,7 @@ void CBeamLaser::FireInternal(float3 curDir)
 		// we do more than one trace-iteration and set dir to
 		// newDir only in the case there is a shield in our way
 		hitShields.clear();
-		TraceRay::TraceRayShields(this, curPos, curDir, beamLength, hitShields);
+		TraceRay::TraceBeamShields(this, beamLength, beamCorridor, hitShields);
 
 		for (const TraceRay::SShieldDist& sd: hitShields) {
 			if (sd.dist < beamLength && sd.rep->IncomingBeam(this, curPos, curPos + (curDir * sd.dist), salvoDamageMult)) {
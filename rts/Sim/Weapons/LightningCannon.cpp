@@ -37,7 +37,9 @@ void CLightningCannon::FireImpl(const bool scriptCall)
 	CFeature* hitFeature = nullptr;
 	CollisionQuery hitColQuery;
 
-	float boltLength = TraceRay::TraceRay(curPos, curDir, range, collisionFlags, owner, hitUnit, hitFeature, &hitColQuery);
+	static TraceRay::SBeamCorridor boltCorridor;
+
+	float boltLength = TraceRay::TraceBeam(this, curPos, curDir, range, collisionFlags, hitUnit, hitFeature, &hitColQuery, boltCorridor);
 
 	if (!weaponDef->waterweapon) {
 		// terminate bolt at water surface if necessary
@@ -50,7 +52,7 @@ void CLightningCannon::FireImpl(const bool scriptCall)
 
 	static std::vector<TraceRay::SShieldDist> hitShields;
 	hitShields.clear();
-	TraceRay::TraceRayShields(this, curPos, curDir, range, hitShields);
+	TraceRay::TraceBeamShields(this, range, boltCorridor, hitShields);
 	for (const TraceRay::SShieldDist& sd: hitShields) {
 		if (sd.dist < boltLength && sd.rep->IncomingBeam(this, curPos, curPos + (curDir * sd.dist), 1.0f)) {
 			boltLength = sd.dist;
@@ -35,21 +35,20 @@ void CWeaponDefHandler::Init(LuaParser* defsParser)
 		const LuaTable wdTable = rootTable.SubTable(name);
 		weaponDefsVector.emplace_back(wdTable, name, wid);
 		weaponDefIDs[name] = wid;
+		weaponDefNameIndex.Insert(name, wid);
 	}
 }
 
 
 
-const WeaponDef* CWeaponDefHandler::GetWeaponDef(std::string wdName) const
+const WeaponDef* CWeaponDefHandler::GetWeaponDef(const char* wdName) const
 {
-	StringToLowerInPlace(wdName);
+	const int id = weaponDefNameIndex.Find(wdName);
 
-	const auto it = weaponDefIDs.find(wdName);
-
-	if (it == weaponDefIDs.end())
+	if (id == -1)
 		return nullptr;
 
-	return &weaponDefsVector[it->second];
+	return &weaponDefsVector[id];
 }
 
 
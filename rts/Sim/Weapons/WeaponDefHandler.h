@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "Sim/Misc/CommonDefHandler.h"
+#include "Sim/Misc/DefNameIndex.h"
 #include "Sim/Misc/GuiSoundSet.h"
 #include "WeaponDef.h"
 #include "System/float3.h"
@@ -21,6 +22,7 @@ public:
 	void Kill() {
 		weaponDefsVector.clear();
 		weaponDefIDs.clear(); // never iterated
+		weaponDefNameIndex.Clear();
 	}
 
 	bool IsValidWeaponDefID(const int id) const {
@@ -30,8 +32,9 @@ public:
 	// id=0 *is* a valid WeaponDef, hence no -1
 	unsigned int NumWeaponDefs() const { return (weaponDefsVector.size()); }
 
-	// NOTE: safe with unordered_map after Init
-	const WeaponDef* GetWeaponDef(std::string wdName) const;
+	// NOTE: case-insensitive, no allocations
+	const WeaponDef* GetWeaponDef(const char* wdName) const;
+	const WeaponDef* GetWeaponDef(const std::string& wdName) const { return (GetWeaponDef(wdName.c_str())); }
 	const WeaponDef* GetWeaponDefByID(int id) const;
 
 	const std::vector<WeaponDef>& GetWeaponDefsVec() const { return weaponDefsVector; }
@@ -39,6 +42,7 @@ public:
 private:
 	std::vector<WeaponDef> weaponDefsVector;
 	spring::unordered_map<std::string, int> weaponDefIDs;
+	DefNameIndex weaponDefNameIndex;
 };
 
 
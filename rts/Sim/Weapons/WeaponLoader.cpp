@@ -28,7 +28,7 @@
 
 static std::array<uint8_t, 2048> udWeaponCounts;
 
-WeaponMemPool weaponMemPool;
+WeaponMemPool weaponMemPool("Weapons");
 
 static_assert((sizeof(UnitDef::weapons) / sizeof(UnitDef::weapons[0])) == MAX_WEAPONS_PER_UNIT, "");
 static_assert(MAX_WEAPONS_PER_UNIT < std::numeric_limits<decltype(udWeaponCounts)::value_type>::max(), "");
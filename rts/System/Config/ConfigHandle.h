@@ -0,0 +1,76 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef CONFIG_HANDLE_H
+#define CONFIG_HANDLE_H
+
+#include <atomic>
+#include <string>
+
+#include "ConfigHandler.h"
+
+/**
+ * @brief Typed, cached view of one config variable
+ *
+ * Resolved through configHandler once on Bind and refreshed by the
+ * observer mechanism afterwards, so reading it costs an atomic load
+ * instead of a source walk plus string parse. Changes become visible
+ * when configHandler->Update() delivers notifications (once per frame).
+ *
+ * Like any observer, a bound handle must be destroyed (or unbound)
+ * before the configHandler is deallocated; use it as a member of
+ * objects living inside the engine's lifetime, not as a static.
+ */
+template<typename T>
+class ConfigHandle
+{
+public:
+	ConfigHandle() = default;
+	explicit ConfigHandle(const std::string& key) { Bind(key); }
+	ConfigHandle(const ConfigHandle&) = delete;
+	~ConfigHandle() { Unbind(); }
+
+	ConfigHandle& operator = (const ConfigHandle&) = delete;
+
+	void Bind(const std::string& key) {
+		Unbind();
+
+		name = key;
+		value.store(Read(), std::memory_order_relaxed);
+
+		configHandler->NotifyOnChange(this, {name});
+	}
+	void Unbind() {
+		if (name.empty())
+			return;
+
+		if (configHandler != nullptr)
+			configHandler->RemoveObserver(this);
+
+		name.clear();
+	}
+
+	void ConfigNotify(const std::string& key, const std::string& newValue) {
+		// re-read instead of parsing <newValue>, a higher-priority source may still override it
+		value.store(Read(), std::memory_order_relaxed);
+	}
+
+	T Get() const { return (value.load(std::memory_order_relaxed)); }
+	operator T () const { return (Get()); }
+
+	const std::string& GetName() const { return name; }
+
+private:
+	// same parsing as the untyped getters
+	T Read() const { return (Read(static_cast<T*>(nullptr))); }
+
+	bool Read(bool*) const { return (configHandler->GetBool(name)); }
+	int Read(int*) const { return (configHandler->GetInt(name)); }
+	unsigned Read(unsigned*) const { return (configHandler->GetUnsigned(name)); }
+	float Read(float*) const { return (configHandler->GetFloat(name)); }
+
+private:
+	std::string name;
+	std::atomic<T> value = {T()};
+};
+
+#endif /* CONFIG_HANDLE_H */
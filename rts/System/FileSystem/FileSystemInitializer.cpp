@@ -108,12 +108,16 @@ void FileSystemInitializer::Cleanup(bool deallocConfigHandler)
 	}
 }
 
-void FileSystemInitializer::Reload()
+void FileSystemInitializer::Reload(bool rescan)
 {
 	// repopulated by PreGame, etc
 	// stash mod and map archives which may be requested again
 	// useful since reloading the same game is the common case
 	vfsHandler->UnMapArchives(true);
+
+	if (!rescan)
+		return;
+
 	archiveScanner->Reload();
 }
 
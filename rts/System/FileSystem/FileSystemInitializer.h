@@ -14,7 +14,7 @@ public:
 	static bool Initialize();
 	static void InitializeThr(bool* retPtr) { *retPtr = Initialize(); }
 	static void Cleanup(bool deallocConfigHandler = true);
-	static void Reload();
+	static void Reload(bool rescan = true);
 
 	// either result counts
 	static bool Initialized() { return (initSuccess || initFailure); }
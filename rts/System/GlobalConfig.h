@@ -82,6 +82,14 @@ public:
 	 */
 	int linkIncomingMaxWaitingPackets = 512;
 
+	/**
+	 * @brief packetCompression
+	 *
+	 * Whether outgoing messages should be sent in compressed batches
+	 * (NETMSG_PACKED), incoming batches are always accepted
+	 */
+	bool packetCompression = false;
+
 
 	/**
 	 * @brief useNetMessageSmoothingBuffer
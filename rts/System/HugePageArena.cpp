@@ -0,0 +1,106 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/HugePageArena.h"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+#ifdef _WIN32
+	#include "System/Platform/Win/win32.h"
+#else
+	#include <sys/mman.h>
+#endif
+
+
+bool CHugePageArena::hugePagesEnabled = true;
+
+
+uint8_t* CHugePageArena::Reserve(size_t bytes)
+{
+	if (base != nullptr)
+		return base;
+
+	hugePages = false;
+
+	#ifdef _WIN32
+	// large pages need SeLockMemoryPrivilege and are never swapped, so
+	// stick to a regular reservation; committing the whole region would
+	// charge all of it against the commit limit, Commit does that as the
+	// pool grows
+	if ((base = reinterpret_cast<uint8_t*>(VirtualAlloc(nullptr, bytes, MEM_RESERVE, PAGE_READWRITE))) == nullptr)
+		throw std::bad_alloc();
+
+	#else
+
+	// over-reserve so the region can be aligned to a huge-page boundary,
+	// then give back the unaligned head and tail
+	const size_t mapSize = bytes + HUGE_PAGE_SIZE;
+	void* mem = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+	if (mem == MAP_FAILED)
+		throw std::bad_alloc();
+
+	const uintptr_t memAddr = reinterpret_cast<uintptr_t>(mem);
+	const uintptr_t alignedAddr = (memAddr + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+
+	const size_t headSize = alignedAddr - memAddr;
+	const size_t tailSize = mapSize - headSize - bytes;
+
+	if (headSize > 0)
+		munmap(mem, headSize);
+	if (tailSize > 0)
+		munmap(reinterpret_cast<void*>(alignedAddr + bytes), tailSize);
+
+	base = reinterpret_cast<uint8_t*>(alignedAddr);
+
+	#ifdef MADV_HUGEPAGE
+	// only advisory; the kernel silently falls back to 4K pages if THP is disabled
+	if (hugePagesEnabled)
+		hugePages = (madvise(base, bytes, MADV_HUGEPAGE) == 0);
+	#endif
+	#endif
+
+	size = bytes;
+	committed = 0;
+	return base;
+}
+
+void CHugePageArena::Commit(size_t bytes)
+{
+	if (bytes <= committed)
+		return;
+
+	assert(base != nullptr);
+	assert(bytes <= size);
+
+	#ifdef _WIN32
+	const size_t commitEnd = std::min(size, (bytes + COMMIT_GRANULARITY - 1) / COMMIT_GRANULARITY * COMMIT_GRANULARITY);
+
+	// physical pages are still only allocated on first touch
+	if (VirtualAlloc(base + committed, commitEnd - committed, MEM_COMMIT, PAGE_READWRITE) == nullptr)
+		throw std::bad_alloc();
+
+	committed = commitEnd;
+	#else
+	// mmap'ed with MAP_NORESERVE, every page is backed on first touch
+	committed = size;
+	#endif
+}
+
+void CHugePageArena::Release()
+{
+	if (base == nullptr)
+		return;
+
+	#ifdef _WIN32
+	VirtualFree(base, 0, MEM_RELEASE);
+	#else
+	munmap(base, size);
+	#endif
+
+	base = nullptr;
+	size = 0;
+	committed = 0;
+	hugePages = false;
+}
@@ -0,0 +1,56 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef HUGE_PAGE_ARENA_H
+#define HUGE_PAGE_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * One contiguous, lazily committed region of address space. Pages are
+ * zero-filled and only backed by memory on first touch (on Windows, once
+ * Commit has been called for them, which only commits), so they end up
+ * local to whichever thread first writes to them. When huge pages are
+ * enabled the region is 2MB-aligned and marked for transparent huge pages
+ * (Linux), which cuts the number of TLB entries needed to walk large pools
+ * of objects; elsewhere it degrades to an ordinary reservation.
+ */
+class CHugePageArena {
+public:
+	CHugePageArena() = default;
+	CHugePageArena(const CHugePageArena&) = delete;
+	~CHugePageArena() { Release(); }
+
+	CHugePageArena& operator = (const CHugePageArena&) = delete;
+
+	/// reserves <size> bytes once; later calls return the existing region. throws std::bad_alloc on failure
+	uint8_t* Reserve(size_t size);
+	/// makes the first <bytes> of the region usable; only does work on Windows, where reserved pages must be committed
+	void Commit(size_t bytes);
+	void Release();
+
+	uint8_t* GetBase() const { return base; }
+	size_t GetSize() const { return size; }
+
+	bool Reserved() const { return (base != nullptr); }
+	bool UsesHugePages() const { return hugePages; }
+
+	/// applies to subsequent reservations; set from the HugePageSimPools config before the sim pools are used
+	static void SetHugePagesEnabled(bool b) { hugePagesEnabled = b; }
+	static bool GetHugePagesEnabled() { return hugePagesEnabled; }
+
+	static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+	/// Commit rounds up to this, so growing pools do not commit page by page
+	static constexpr size_t COMMIT_GRANULARITY = 256 * 1024;
+
+private:
+	static bool hugePagesEnabled;
+
+	uint8_t* base = nullptr;
+	size_t size = 0;
+	size_t committed = 0;
+
+	bool hugePages = false;
+};
+
+#endif
@@ -26,6 +26,7 @@
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/CategoryHandler.h"
+#include "Sim/Misc/SlowUpdateScheduler.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/Wind.h"
@@ -94,6 +95,7 @@ void CGameStateCollector::Serialize(creg::ISerializer* s)
 	CColorMap::SerializeColorMaps(s);
 	s->SerializeObjectInstance(&waitCommandsAI, waitCommandsAI.GetClass());
 	s->SerializeObjectInstance(&envResHandler, envResHandler.GetClass());
+	s->SerializeObjectInstance(&slowUpdateScheduler, slowUpdateScheduler.GetClass());
 	s->SerializeObjectInstance(&moveDefHandler, moveDefHandler.GetClass());
 	s->SerializeObjectInstance(&teamHandler, teamHandler.GetClass());
 	for (int a = 0; a < teamHandler.ActiveTeams(); a++) {
@@ -186,9 +186,12 @@ void CDemoReader::LoadStats()
 
 		assert(fileHeader.numTeams <= numStatsPerTeam.size());
 		numStatsPerTeam.fill(0);
-		playbackDemo->Read(reinterpret_cast<char*>(numStatsPerTeam.data()), fileHeader.numTeams);
+		// one dword per team, see CDemoRecorder::WriteTeamStats
+		playbackDemo->Read(reinterpret_cast<char*>(numStatsPerTeam.data()), fileHeader.numTeams * sizeof(int));
 
 		for (int teamNum = 0; teamNum < fileHeader.numTeams; ++teamNum) {
+			swabDWordInPlace(numStatsPerTeam[teamNum]);
+
 			for (int i = 0; i < numStatsPerTeam[teamNum]; ++i) {
 				TeamStatistics buf;
 				playbackDemo->Read(reinterpret_cast<char*>(&buf), sizeof(TeamStatistics));
@@ -0,0 +1,137 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "MatchBatch.h"
+
+#include "Game/Game.h"
+#include "Sim/Path/Default/PathEstimator.h"
+#include "System/Exceptions.h"
+#include "System/StringUtil.h"
+#include "System/TdfParser.h"
+#include "System/FileSystem/FileHandler.h"
+#include "System/Log/ILog.h"
+
+
+static std::string LoadScript(const std::string& fileName, const char* what)
+{
+	CFileHandler fh(fileName, SPRING_VFS_PWD_ALL);
+	std::string buf;
+
+	if (!fh.FileExists())
+		throw content_error(std::string(what) + " does not exist in given location: " + fileName);
+	if (!fh.LoadStringData(buf))
+		throw content_error(std::string(what) + " cannot be read: " + fileName);
+
+	return buf;
+}
+
+
+void CMatchBatch::Load(const std::string& listFile)
+{
+	const std::string list = LoadScript(listFile, "Batch-list");
+
+	matches.clear();
+	numStarted = 0;
+
+	for (size_t beg = 0, end = 0; beg < list.size(); beg = end + 1) {
+		if ((end = list.find('\n', beg)) == std::string::npos)
+			end = list.size();
+
+		const std::string line = StringTrim(list.substr(beg, end - beg));
+
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		matches.emplace_back();
+		matches.back().scriptName = line;
+		matches.back().scriptText = LoadScript(line, "Setup-script");
+
+		// without a fixed GameID the server seeds the synced RNG from the clock
+		const TdfParser script(matches.back().scriptText.c_str(), matches.back().scriptText.size());
+
+		matches.back().fixedSeed = !script.SGetValueDef("", "GAME\\GameID").empty();
+	}
+
+	if (matches.empty())
+		throw content_error("Batch-list does not name any setup-scripts: " + listFile);
+
+	CPathEstimator::SetRetainPathInfo(true);
+
+	LOG("[MatchBatch::%s] %u matches listed in \"%s\"", __func__, unsigned(matches.size()), listFile.c_str());
+}
+
+
+std::string CMatchBatch::NextMatch()
+{
+	if (numStarted >= matches.size()) {
+		// batch is over, nothing left to reuse the retained data
+		CPathEstimator::SetRetainPathInfo(false);
+		return "";
+	}
+
+	Match& match = matches[numStarted++];
+
+	// the first match includes engine initialization (a cold start), later ones only the reload
+	match.startTime = (numStarted == 1)? spring_notime: spring_gettime();
+
+	LOG("[MatchBatch::%s] starting match %u/%u (\"%s\")", __func__, unsigned(numStarted), unsigned(matches.size()), match.scriptName.c_str());
+	return match.scriptText;
+}
+
+
+bool CMatchBatch::Update(const CGame* game)
+{
+	if (numStarted == 0 || game == nullptr)
+		return false;
+
+	Match& match = matches[numStarted - 1];
+
+	if (!spring_istime(match.loadTime) && game->IsDoneLoading()) {
+		match.loadTime = spring_gettime() - match.startTime;
+
+		LOG("[MatchBatch::%s] match %u/%u loaded in %ims", __func__, unsigned(numStarted), unsigned(matches.size()), int(spring_tomsecs(match.loadTime)));
+	}
+
+	// game-over is only reported once per match
+	if (!game->IsGameOver() || match.endFrame >= 0)
+		return false;
+
+	match.endFrame = game->GetGameOverFrame();
+	match.endChecksum = game->GetGameOverChecksum();
+
+	LOG("[MatchBatch::%s] match %u/%u ended at frame %d (checksum=%08x)", __func__, unsigned(numStarted), unsigned(matches.size()), match.endFrame, match.endChecksum);
+	return true;
+}
+
+
+bool CMatchBatch::LogSummary() const
+{
+	bool deterministic = true;
+
+	LOG("[MatchBatch::%s] %u/%u matches played", __func__, unsigned(numStarted), unsigned(matches.size()));
+
+	for (size_t i = 0; i < numStarted; i++) {
+		const Match& match = matches[i];
+
+		LOG("\t[%u] load=%ims frame=%d checksum=%08x script=\"%s\"", unsigned(i + 1), int(spring_tomsecs(match.loadTime)), match.endFrame, match.endChecksum, match.scriptName.c_str());
+
+		if (match.endFrame < 0 || !match.fixedSeed)
+			continue;
+
+		// compare against the first earlier match played from the same script
+		for (size_t j = 0; j < i; j++) {
+			const Match& prev = matches[j];
+
+			if (prev.endFrame < 0 || prev.scriptText != match.scriptText)
+				continue;
+
+			if (prev.endFrame != match.endFrame || prev.endChecksum != match.endChecksum) {
+				LOG_L(L_ERROR, "[MatchBatch::%s] match %u ended differently from match %u with the same script", __func__, unsigned(i + 1), unsigned(j + 1));
+				deterministic = false;
+			}
+
+			break;
+		}
+	}
+
+	return deterministic;
+}
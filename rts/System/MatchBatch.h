@@ -0,0 +1,70 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef MATCH_BATCH_H
+#define MATCH_BATCH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "System/Misc/SpringTime.h"
+
+class CGame;
+
+/**
+ * @brief Plays the start-scripts listed in a file as consecutive matches
+ *
+ * Used by --batch, mainly with spring-headless for AI tournaments and balance
+ * tests: instead of idling after a match ends, SpringApp reloads straight into
+ * the next script. The archive scanner is not re-run between matches and the
+ * mapped archives (as well as path-estimator data for the same map) are kept
+ * until the batch ends, while all synced state is reset as for any other reload.
+ *
+ * The load time of each match and the frame and synced-state checksum at its
+ * game-over are logged. Identical scripts with a fixed GameID (which seeds the
+ * synced RNG) must end identically; a mismatch means state leaked from one
+ * match into the next and is reported through the exit code.
+ */
+class CMatchBatch {
+public:
+	/**
+	 * @brief read the list of start-scripts (one path per line, '#' comments)
+	 * @throws content_error if the list or any of the scripts can not be read
+	 */
+	void Load(const std::string& listFile);
+
+	bool IsActive() const { return (!matches.empty()); }
+
+	/// @return script text of the next match, empty if all have been played
+	std::string NextMatch();
+
+	/**
+	 * @brief track loading and game-over of the current match
+	 * @return true once the current match has ended
+	 */
+	bool Update(const CGame* game);
+
+	/// @return false if matches with identical scripts ended differently
+	bool LogSummary() const;
+
+private:
+	struct Match {
+		std::string scriptName;
+		std::string scriptText;
+
+		bool fixedSeed = false;
+
+		spring_time startTime;
+		spring_time loadTime;
+
+		int endFrame = -1;
+		std::uint32_t endChecksum = 0;
+	};
+
+	std::vector<Match> matches;
+
+	// the match being played is matches[numStarted - 1]
+	size_t numStarted = 0;
+};
+
+#endif // MATCH_BATCH_H
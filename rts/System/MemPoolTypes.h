@@ -14,6 +14,8 @@
 
 #include "System/UnorderedMap.hpp"
 #include "System/ContainerUtil.h"
+#include "System/HugePageArena.h"
+#include "System/MemoryTags.h"
 #include "System/SafeUtil.h"
 #include "System/Platform/Threading.h"
 #include "System/Threading/SpringThreading.h"
@@ -21,6 +23,9 @@
 
 template<size_t S> struct DynMemPool {
 public:
+	DynMemPool() = default;
+	explicit DynMemPool(const char* tagName): memTag(MemoryTags::Get(tagName)) {}
+
 	void* allocMem(size_t size) {
 		assert(size <= PAGE_SIZE());
 		uint8_t* m = nullptr;
@@ -38,6 +43,9 @@ public:
 
 		m = pages[curr_page_index = i].data();
 
+		if (memTag != nullptr)
+			memTag->OnAlloc(PAGE_SIZE());
+
 		table.emplace(m, i);
 		return m;
 	}
@@ -57,6 +65,9 @@ public:
 
 		std::memset(pages[pair.second].data(), 0, PAGE_SIZE());
 
+		if (memTag != nullptr)
+			memTag->OnFree(PAGE_SIZE());
+
 		indcs.push_back(pair.second);
 		table.erase(pair.first);
 	}
@@ -82,6 +93,9 @@ public:
 	bool alloced(void* p) const { return ((curr_page_index < pages.size()) && (pages[curr_page_index].data() == p)); }
 
 	void clear() {
+		if (memTag != nullptr && !table.empty())
+			memTag->OnFree(table.size() * PAGE_SIZE());
+
 		pages.clear();
 		indcs.clear();
 		table.clear();
@@ -101,6 +115,8 @@ private:
 	spring::unsynced_map<void*, size_t> table;
 
 	size_t curr_page_index = 0;
+
+	MemoryTag* memTag = nullptr;
 };
 
 
@@ -112,6 +128,9 @@ private:
 // chunk consuming S * K bytes) excluding overhead
 template<size_t S, size_t N, size_t K> struct FixedDynMemPool {
 public:
+	FixedDynMemPool() = default;
+	explicit FixedDynMemPool(const char* tagName): memTag(MemoryTags::Get(tagName)) {}
+
 	template<typename T, typename... A> T* alloc(A&&... a) {
 		static_assert(sizeof(T) <= PAGE_SIZE(), "");
 		return (new (allocMem(sizeof(T))) T(std::forward<A>(a)...));
@@ -140,6 +159,9 @@ public:
 
 		const uint32_t idx = spring::VectorBackPop(indcs);
 
+		if (memTag != nullptr)
+			memTag->OnAlloc(PAGE_SIZE());
+
 		assert(size <= PAGE_SIZE());
 		memcpy(ptr = page_mem(page_index = idx), &idx, sizeof(idx));
 		return (ptr + sizeof(idx));
@@ -162,12 +184,18 @@ public:
 		assert(idx < (N * K));
 		memset(page_mem(idx), 0, sizeof(idx) + S);
 
+		if (memTag != nullptr)
+			memTag->OnFree(PAGE_SIZE());
+
 		indcs.push_back(idx);
 	}
 
 
 	void reserve(size_t n) { indcs.reserve(n); }
 	void clear() {
+		if (memTag != nullptr && (num_chunks * K) > indcs.size())
+			memTag->OnFree(((num_chunks * K) - indcs.size()) * PAGE_SIZE());
+
 		indcs.clear();
 
 		// for every allocated chunk, add back all indices
@@ -209,6 +237,7 @@ public:
 
 	bool mapped(void* ptr) const { return ((page_idx(ptr) < (num_chunks * K)) && (page_mem(page_idx(ptr), sizeof(uint32_t)) == ptr)); }
 	bool alloced(void* ptr) const { return ((page_index < (num_chunks * K)) && (page_mem(page_index, sizeof(uint32_t)) == ptr)); }
+	bool huge_pages() const { return false; }
 
 private:
 	// first sizeof(uint32_t) bytes are reserved for index
@@ -220,14 +249,18 @@ private:
 
 	size_t num_chunks = 0;
 	size_t page_index = 0;
+
+	MemoryTag* memTag = nullptr;
 };
 
 
 
-// fixed-size version
+// fixed-size version; the pages live in one contiguous arena that
+// is reserved up front but only backed by memory as pages get used
 template<size_t N, size_t S> struct StaticMemPool {
 public:
 	StaticMemPool() { clear(); }
+	explicit StaticMemPool(const char* tagName): memTag(MemoryTags::Get(tagName)) { clear(); }
 
 	void* allocMem(size_t size) {
 		assert(size <= PAGE_SIZE());
@@ -243,7 +276,11 @@ public:
 			i = indcs[--free_page_count];
 		}
 
-		return (pages[curr_page_index = i].data());
+		if (memTag != nullptr)
+			memTag->OnAlloc(PAGE_SIZE());
+
+		// first touch happens here, on the thread that owns the objects
+		return (page_mem(curr_page_index = i));
 	}
 
 
@@ -258,6 +295,9 @@ public:
 
 		std::memset(m, 0, PAGE_SIZE());
 
+		if (memTag != nullptr)
+			memTag->OnFree(PAGE_SIZE());
+
 		// mark page as free
 		indcs[free_page_count++] = base_offset(m) / PAGE_SIZE();
 	}
@@ -278,18 +318,24 @@ public:
 	size_t alloc_size() const { return (used_page_count * PAGE_SIZE()); } // size of total number of pages added over the pool's lifetime
 	size_t freed_size() const { return (free_page_count * PAGE_SIZE()); } // size of number of pages that were freed and are awaiting reuse
 	size_t total_size() const { return (NUM_PAGES() * PAGE_SIZE()); }
-	size_t base_offset(const void* p) const { return (reinterpret_cast<const uint8_t*>(p) - reinterpret_cast<const uint8_t*>(pages[0].data())); }
+	size_t base_offset(const void* p) const { return (reinterpret_cast<const uint8_t*>(p) - arena.GetBase()); }
 
 	bool mapped(const void* p) const { return (((base_offset(p) / PAGE_SIZE()) < total_size()) && ((base_offset(p) % PAGE_SIZE()) == 0)); }
-	bool alloced(const void* p) const { return (pages[curr_page_index].data() == p); }
+	bool alloced(const void* p) const { return (arena.GetBase() + curr_page_index * PAGE_SIZE() == p); }
 
 	bool can_alloc() const { return (used_page_count < NUM_PAGES() || free_page_count > 0); }
 	bool can_free() const { return (free_page_count < NUM_PAGES()); }
+	bool huge_pages() const { return arena.UsesHugePages(); }
 
-	void reserve(size_t) {} // no-op
+	// reserves address space only, no memory is committed
+	void reserve(size_t) { arena.Reserve(total_size()); }
 	void clear() {
-		std::memset(pages.data(), 0, total_size());
-		std::memset(indcs.data(), 0, NUM_PAGES());
+		if (memTag != nullptr && used_page_count > free_page_count)
+			memTag->OnFree((used_page_count - free_page_count) * PAGE_SIZE());
+
+		// pages past used_page_count have never been touched and are still zero
+		if (arena.Reserved())
+			std::memset(arena.GetBase(), 0, used_page_count * PAGE_SIZE());
 
 		used_page_count = 0;
 		free_page_count = 0;
@@ -297,12 +343,23 @@ public:
 	}
 
 private:
-	std::array<std::array<uint8_t, S>, N> pages;
+	uint8_t* page_mem(size_t idx) {
+		uint8_t* base = arena.Reserve(total_size());
+
+		arena.Commit((idx + 1) * PAGE_SIZE());
+		return (base + idx * PAGE_SIZE());
+	}
+
+private:
+	CHugePageArena arena;
+
 	std::array<size_t, N> indcs;
 
 	size_t used_page_count = 0;
 	size_t free_page_count = 0; // indcs[fpc-1] is the last recycled page
 	size_t curr_page_index = 0;
+
+	MemoryTag* memTag = nullptr;
 };
 
 
@@ -323,6 +380,11 @@ public:
 	StablePosAllocator(size_t initialSize) :StablePosAllocator() {
 		data.reserve(initialSize);
 	}
+	StablePosAllocator(size_t initialSize, const char* tagName) :StablePosAllocator() {
+		memTag = MemoryTags::Get(tagName);
+		data.reserve(initialSize);
+		UpdateMemTag();
+	}
 	virtual void Reset() {
 		CompactGaps();
 		//upon compaction all allocations should go away
@@ -343,10 +405,22 @@ public:
 	static constexpr std::size_t INVALID_INDEX = ~0u;
 private:
 	void CompactGaps();
+
+	// data only ever grows its capacity, so this is only needed after it was resized up
+	void UpdateMemTag() {
+		if (memTag == nullptr)
+			return;
+
+		memTag->OnResize(memTagBytes, data.capacity() * sizeof(T));
+		memTagBytes = data.capacity() * sizeof(T);
+	}
 private:
 	std::vector<T> data;
 	std::multimap<size_t, size_t> sizeToPositions;
 	std::map<size_t, size_t> positionToSize;
+
+	MemoryTag* memTag = nullptr;
+	size_t memTagBytes = 0;
 };
 
 template<typename T>
@@ -359,6 +433,7 @@ inline size_t StablePosAllocator<T>::Allocate(size_t numElems)
 	if (positionToSize.empty()) {
 		size_t returnPos = data.size();
 		data.resize(data.size() + numElems);
+		UpdateMemTag();
 		myLog("StablePosAllocator<T>::Allocate(%u) = %u [thread_id = %u]", uint32_t(numElems), uint32_t(returnPos), static_cast<uint32_t>(Threading::GetCurrentThreadId()));
 		return returnPos;
 	}
@@ -386,6 +461,7 @@ inline size_t StablePosAllocator<T>::Allocate(size_t numElems)
 	//all gaps are too small
 	size_t returnPos = data.size();
 	data.resize(data.size() + numElems);
+	UpdateMemTag();
 	myLog("StablePosAllocator<T>::Allocate(%u) = %u", uint32_t(numElems), uint32_t(returnPos));
 	return returnPos;
 }
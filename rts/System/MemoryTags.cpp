@@ -0,0 +1,75 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/MemoryTags.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
+
+#include <string>
+
+CONFIG(int, MemoryTagsLogInterval)
+	.defaultValue(0)
+	.headlessValue(60)
+	.minimumValue(0)
+	.description("Seconds between log lines listing the memory used per subsystem (see /DebugInfo memory), 0 to disable.");
+
+
+static spring_time lastRateUpdateTime;
+static spring_time lastLogTime;
+
+
+static std::string FormatTags()
+{
+	std::string str;
+	char buf[256];
+
+	MemoryTags::ForEach([&](const MemoryTag& tag) {
+		snprintf(buf, sizeof(buf), " %s={%.1f/%.1fKB %.0f/s}",
+			tag.GetName(),
+			tag.GetLiveBytes() / 1024.0f,
+			tag.GetPeakBytes() / 1024.0f,
+			tag.GetAllocRate()
+		);
+
+		str += buf;
+	});
+
+	return str;
+}
+
+
+void MemoryTags::Update(int logInterval)
+{
+	const spring_time now = spring_gettime();
+	const spring_time dt = now - lastRateUpdateTime;
+
+	if (dt.toMilliSecsi() >= 1000) {
+		ForEach([&](MemoryTag& tag) { tag.UpdateAllocRate(dt.toSecsf()); });
+		lastRateUpdateTime = now;
+	}
+
+	if (logInterval <= 0)
+		return;
+	if ((now - lastLogTime).toSecsi() < logInterval)
+		return;
+
+	LOG("[MemoryTags] {live/peak, allocs}:%s", FormatTags().c_str());
+	lastLogTime = now;
+}
+
+void MemoryTags::Print()
+{
+	LOG("[MemoryTags::%s] %-24s %12s %12s %12s %12s %10s", __func__, "tag", "live (KB)", "peak (KB)", "allocs", "frees", "allocs/s");
+
+	ForEach([&](const MemoryTag& tag) {
+		LOG("[MemoryTags::%s] %-24s %12.1f %12.1f %12" PRIu64 " %12" PRIu64 " %10.0f",
+			__func__,
+			tag.GetName(),
+			tag.GetLiveBytes() / 1024.0f,
+			tag.GetPeakBytes() / 1024.0f,
+			tag.GetNumAllocs(),
+			tag.GetNumFrees(),
+			tag.GetAllocRate()
+		);
+	});
+}
@@ -0,0 +1,127 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef MEMORY_TAGS_H
+#define MEMORY_TAGS_H
+
+#include <atomic>
+#include <cinttypes>
+#include <cstring>
+#include <deque>
+#include <mutex>
+
+/**
+ * Per-subsystem allocation accounting. Pools and containers that want to
+ * be tracked hold a pointer to a named tag and report every allocation and
+ * free of theirs to it; the counters are relaxed atomics so owners can be
+ * used from any thread. A null tag pointer disables accounting for that
+ * owner at the cost of one branch.
+ */
+struct MemoryTag {
+public:
+	explicit MemoryTag(const char* tagName): name(tagName) {}
+
+	void OnAlloc(size_t bytes) {
+		numAllocs.fetch_add(1, std::memory_order_relaxed);
+		UpdatePeak(liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+	}
+	void OnFree(size_t bytes) {
+		numFrees.fetch_add(1, std::memory_order_relaxed);
+		liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+	}
+
+	/// for containers that grow and shrink in place (vectors, caches)
+	void OnResize(size_t oldBytes, size_t newBytes) {
+		if (newBytes > oldBytes) {
+			OnAlloc(newBytes - oldBytes);
+			return;
+		}
+		if (newBytes < oldBytes) {
+			OnFree(oldBytes - newBytes);
+			return;
+		}
+	}
+
+	const char* GetName() const { return name; }
+
+	int64_t GetLiveBytes() const { return (liveBytes.load(std::memory_order_relaxed)); }
+	int64_t GetPeakBytes() const { return (peakBytes.load(std::memory_order_relaxed)); }
+	uint64_t GetNumAllocs() const { return (numAllocs.load(std::memory_order_relaxed)); }
+	uint64_t GetNumFrees() const { return (numFrees.load(std::memory_order_relaxed)); }
+
+	/// allocations per second, as of the last MemoryTags::Update
+	float GetAllocRate() const { return allocRate; }
+
+	void UpdateAllocRate(float secs) {
+		const uint64_t n = GetNumAllocs();
+
+		allocRate = (n - prevNumAllocs) / secs;
+		prevNumAllocs = n;
+	}
+
+private:
+	void UpdatePeak(int64_t live) {
+		int64_t peak = peakBytes.load(std::memory_order_relaxed);
+
+		while (live > peak && !peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+		}
+	}
+
+private:
+	const char* name;
+
+	std::atomic<int64_t> liveBytes = {0};
+	std::atomic<int64_t> peakBytes = {0};
+	std::atomic<uint64_t> numAllocs = {0};
+	std::atomic<uint64_t> numFrees = {0};
+
+	// only touched by the thread running MemoryTags::Update
+	uint64_t prevNumAllocs = 0;
+	float allocRate = 0.0f;
+};
+
+
+namespace MemoryTags {
+	struct Registry {
+		std::mutex mutex;
+		// deque, tags must never move
+		std::deque<MemoryTag> tags;
+	};
+
+	inline Registry& GetRegistry() {
+		// function-local so tags can be requested during static initialization;
+		// never destroyed since pools with static storage duration (e.g. the
+		// quadfield's query arenas) still report their frees during exit
+		static Registry* registry = new Registry();
+		return *registry;
+	}
+
+	/// @return the tag named <name> (a string literal), created on first use and valid until exit
+	inline MemoryTag* Get(const char* name) {
+		Registry& r = GetRegistry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+
+		for (MemoryTag& tag: r.tags) {
+			if (std::strcmp(tag.GetName(), name) == 0)
+				return &tag;
+		}
+
+		r.tags.emplace_back(name);
+		return &r.tags.back();
+	}
+
+	template<typename F> void ForEach(F&& f) {
+		Registry& r = GetRegistry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+
+		for (MemoryTag& tag: r.tags) {
+			f(tag);
+		}
+	}
+
+	/// refreshes allocation rates and writes a log line every <logInterval> seconds (0 = never); called once per game update
+	void Update(int logInterval);
+	/// logs all tags
+	void Print();
+}
+
+#endif
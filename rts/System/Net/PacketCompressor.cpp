@@ -0,0 +1,130 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "PacketCompressor.h"
+
+#include <cstring>
+
+#include "Net/Protocol/NetMessageTypes.h"
+
+namespace netcode {
+
+PacketCompressor::PacketCompressor(const std::vector<std::uint8_t>& dict, std::uint8_t dictID, int level)
+	: dictionary(dict)
+	, dictionaryID(dictID)
+{
+	memset(&deflateStream, 0, sizeof(deflateStream));
+	memset(&inflateStream, 0, sizeof(inflateStream));
+
+	// negative window bits select raw deflate, the packed header carries all we need
+	deflateReady = (deflateInit2(&deflateStream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+	inflateReady = (inflateInit2(&inflateStream, -MAX_WBITS) == Z_OK);
+}
+
+PacketCompressor::~PacketCompressor()
+{
+	if (deflateReady)
+		deflateEnd(&deflateStream);
+	if (inflateReady)
+		inflateEnd(&inflateStream);
+}
+
+
+bool PacketCompressor::Deflate(const std::uint8_t* data, unsigned length, std::vector<std::uint8_t>& out)
+{
+	if (!deflateReady)
+		return false;
+	if (deflateReset(&deflateStream) != Z_OK)
+		return false;
+	if (!dictionary.empty() && deflateSetDictionary(&deflateStream, dictionary.data(), dictionary.size()) != Z_OK)
+		return false;
+
+	const size_t outPos = out.size();
+
+	out.resize(outPos + deflateBound(&deflateStream, length));
+
+	deflateStream.next_in = const_cast<Bytef*>(data);
+	deflateStream.avail_in = length;
+	deflateStream.next_out = out.data() + outPos;
+	deflateStream.avail_out = out.size() - outPos;
+
+	if (deflate(&deflateStream, Z_FINISH) != Z_STREAM_END) {
+		out.resize(outPos);
+		return false;
+	}
+
+	out.resize(outPos + deflateStream.total_out);
+	return true;
+}
+
+bool PacketCompressor::Inflate(const std::uint8_t* data, unsigned length, unsigned rawLength, std::vector<std::uint8_t>& out)
+{
+	if (!inflateReady)
+		return false;
+	if (inflateReset(&inflateStream) != Z_OK)
+		return false;
+	if (!dictionary.empty() && inflateSetDictionary(&inflateStream, dictionary.data(), dictionary.size()) != Z_OK)
+		return false;
+
+	const size_t outPos = out.size();
+
+	// one spare byte to detect blocks that inflate to more than rawLength
+	out.resize(outPos + rawLength + 1);
+
+	inflateStream.next_in = const_cast<Bytef*>(data);
+	inflateStream.avail_in = length;
+	inflateStream.next_out = out.data() + outPos;
+	inflateStream.avail_out = rawLength + 1;
+
+	const int ret = inflate(&inflateStream, Z_FINISH);
+
+	if (ret != Z_STREAM_END || inflateStream.total_out != rawLength || inflateStream.avail_in != 0) {
+		out.resize(outPos);
+		return false;
+	}
+
+	out.resize(outPos + rawLength);
+	return true;
+}
+
+
+bool PacketCompressor::Pack(const std::uint8_t* messages, unsigned length, std::vector<std::uint8_t>& packet)
+{
+	if (length < minPackSize || length > maxPackSize)
+		return false;
+
+	packet.clear();
+	packet.resize(headerSize);
+
+	if (!Deflate(messages, length, packet))
+		return false;
+	if (packet.size() >= length)
+		return false;
+
+	const std::uint16_t packetSize = packet.size();
+	const std::uint16_t rawSize = length;
+
+	packet[0] = NETMSG_PACKED;
+	memcpy(&packet[1], &packetSize, sizeof(packetSize));
+	packet[3] = dictionaryID;
+	memcpy(&packet[4], &rawSize, sizeof(rawSize));
+	return true;
+}
+
+bool PacketCompressor::Unpack(const std::uint8_t* packet, unsigned length, std::vector<std::uint8_t>& messages)
+{
+	if (length < headerSize || packet[0] != NETMSG_PACKED)
+		return false;
+
+	std::uint16_t packetSize = 0;
+	std::uint16_t rawSize = 0;
+
+	memcpy(&packetSize, &packet[1], sizeof(packetSize));
+	memcpy(&rawSize, &packet[4], sizeof(rawSize));
+
+	if (packetSize != length || packet[3] != dictionaryID)
+		return false;
+
+	return (Inflate(packet + headerSize, length - headerSize, rawSize, messages));
+}
+
+} // namespace netcode
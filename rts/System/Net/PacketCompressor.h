@@ -0,0 +1,93 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef PACKET_COMPRESSOR_H
+#define PACKET_COMPRESSOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include <zlib.h>
+
+namespace netcode
+{
+
+/**
+ * @brief compresses batches of NETMSG_* messages against a static dictionary
+ *
+ * Messages are only a few bytes long and mostly differ in their ID's and
+ * floats, which leaves a general-purpose compressor nothing to work with
+ * inside a single batch. Every batch is therefore deflated (raw, without a
+ * zlib header) with the same preset dictionary holding the common message
+ * shapes, and independently of all other batches so that each one can be
+ * decoded on its own (after packet loss, or when seeking in a container).
+ *
+ * On the wire a batch becomes a single NETMSG_PACKED message:
+ *   uint8_t NETMSG_PACKED, uint16_t messageSize, uint8_t dictionaryID,
+ *   uint16_t rawSize, deflated messages
+ * which the receiver unpacks back into the original message sequence.
+ */
+class PacketCompressor
+{
+public:
+	/// NETMSG_PACKED header, see above
+	static constexpr unsigned headerSize = 1 + 2 + 1 + 2;
+	/// below this the header outweighs anything deflate can save
+	static constexpr unsigned minPackSize = 32;
+	/// limited by the rawSize and messageSize fields
+	static constexpr unsigned maxPackSize = 0xFFFF;
+
+	/**
+	 * @param dictionary preset dictionary, deflate only uses its last 32KB
+	 * @param dictionaryID identifies the dictionary in packed messages, both ends must agree on it
+	 * @param level zlib compression level
+	 */
+	PacketCompressor(const std::vector<std::uint8_t>& dictionary, std::uint8_t dictionaryID, int level = Z_DEFAULT_COMPRESSION);
+	PacketCompressor(const PacketCompressor&) = delete;
+	~PacketCompressor();
+
+	PacketCompressor& operator = (const PacketCompressor&) = delete;
+
+	/**
+	 * @brief deflate a block of data independently of all previous ones
+	 * @param out compressed data is appended to this
+	 */
+	bool Deflate(const std::uint8_t* data, unsigned length, std::vector<std::uint8_t>& out);
+	/**
+	 * @brief inflate a block of data written by Deflate
+	 * @param rawLength exact uncompressed size of the block
+	 * @param out uncompressed data is appended to this
+	 * @return false if the data is corrupt or does not inflate to rawLength bytes
+	 */
+	bool Inflate(const std::uint8_t* data, unsigned length, unsigned rawLength, std::vector<std::uint8_t>& out);
+
+	/**
+	 * @brief wrap a sequence of complete messages into a NETMSG_PACKED message
+	 * @param packet receives the packed message
+	 * @return false (leaving packet in an unspecified state) if packing would not make the data smaller
+	 */
+	bool Pack(const std::uint8_t* messages, unsigned length, std::vector<std::uint8_t>& packet);
+	/**
+	 * @brief unwrap a NETMSG_PACKED message
+	 * @param messages the original message sequence is appended to this
+	 * @return false if the message is malformed or uses a different dictionary
+	 */
+	bool Unpack(const std::uint8_t* packet, unsigned length, std::vector<std::uint8_t>& messages);
+
+	const std::vector<std::uint8_t>& GetDictionary() const { return dictionary; }
+	std::uint8_t GetDictionaryID() const { return dictionaryID; }
+
+private:
+	std::vector<std::uint8_t> dictionary;
+
+	z_stream deflateStream;
+	z_stream inflateStream;
+
+	std::uint8_t dictionaryID;
+
+	bool deflateReady;
+	bool inflateReady;
+};
+
+} // namespace netcode
+
+#endif // PACKET_COMPRESSOR_H
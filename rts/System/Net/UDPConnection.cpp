@@ -7,6 +7,7 @@
 
 #include "Socket.h"
 #include "ProtocolDef.h"
+#include "PacketCompressor.h"
 #include "Exception.h"
 #include "Net/Protocol/BaseNetProtocol.h"
 #include "System/Config/ConfigHandler.h"
@@ -306,6 +307,8 @@ void UDPConnection::Init()
 	resentChunks = 0;
 	sentPackets = 0;
 	recvPackets = 0;
+	packedRawBytes = 0;
+	packedBytes = 0;
 	droppedChunks = 0;
 	mtu = globalConfig.mtu;
 	reconnectTime = globalConfig.reconnectTimeout;
@@ -319,6 +322,7 @@ void UDPConnection::Init()
 	#endif
 
 	netLossFactor = globalConfig.networkLossFactor;
+	packOutgoing = globalConfig.packetCompression;
 	lastMidChunk = -1;
 #if	NETWORK_TEST
 	lossCounter = 0;
@@ -644,36 +648,9 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 
 			// this returns false for zero/invalid pktLength
 			if (ProtocolDef::GetInstance()->IsValidLength(pktLength, msgLength)) {
-				msgQueue.emplace_back(new RawPacket(bufp, pktLength));
-				std::shared_ptr<const RawPacket>& msgPacket = msgQueue.back();
-
-				#ifdef ENABLE_DEBUG_STATS
-				// server sends both of these, clients send only keyframe messages
-				// TODO: would be easy to feed this data into a Q3A-style lagometer
-				//
-				if (msgPacket->data[0] == NETMSG_NEWFRAME || msgPacket->data[0] == NETMSG_KEYFRAME) {
-					const spring_time dt = spring_gettime() - lastFramePacketRecvTime;
-
-					sumDeltaFramePacketRecvTime += dt.toMilliSecsf();
-					minDeltaFramePacketRecvTime = std::min(dt.toMilliSecsf(), minDeltaFramePacketRecvTime);
-					maxDeltaFramePacketRecvTime = std::max(dt.toMilliSecsf(), maxDeltaFramePacketRecvTime);
-
-					numReceivedFramePackets += 1;
-					numEnqueuedFramePackets += 1;
-					lastFramePacketRecvTime = spring_gettime();
-
-					if (logMessages) {
-						LOG_L(L_INFO,
-							"\t[%s] (received=%u enqueued=%u) packets (dt=%fms mindt=%fms maxdt=%fms sumdt=%fms)",
-							__func__, numReceivedFramePackets, numEnqueuedFramePackets, dt.toMilliSecsf(),
-							minDeltaFramePacketRecvTime, maxDeltaFramePacketRecvTime, sumDeltaFramePacketRecvTime
-						);
-					}
-				}
-				#endif
+				EnqueueMessage(bufp, pktLength);
 
 				pos += pktLength;
-				numPings += (msgPacket->data[0] == NETMSG_PING); // incoming
 			} else {
 				if (pktLength >= 0) {
 					// partial packet in buffer
@@ -693,6 +670,106 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 	UpdateWaitingPackets();
 }
 
+void UDPConnection::EnqueueMessage(const unsigned char* data, unsigned length)
+{
+	if (data[0] != NETMSG_PACKED) {
+		msgQueue.emplace_back(new RawPacket(data, length));
+		std::shared_ptr<const RawPacket>& msgPacket = msgQueue.back();
+
+		#ifdef ENABLE_DEBUG_STATS
+		// server sends both of these, clients send only keyframe messages
+		// TODO: would be easy to feed this data into a Q3A-style lagometer
+		//
+		if (msgPacket->data[0] == NETMSG_NEWFRAME || msgPacket->data[0] == NETMSG_KEYFRAME) {
+			const spring_time dt = spring_gettime() - lastFramePacketRecvTime;
+
+			sumDeltaFramePacketRecvTime += dt.toMilliSecsf();
+			minDeltaFramePacketRecvTime = std::min(dt.toMilliSecsf(), minDeltaFramePacketRecvTime);
+			maxDeltaFramePacketRecvTime = std::max(dt.toMilliSecsf(), maxDeltaFramePacketRecvTime);
+
+			numReceivedFramePackets += 1;
+			numEnqueuedFramePackets += 1;
+			lastFramePacketRecvTime = spring_gettime();
+
+			if (logMessages) {
+				LOG_L(L_INFO,
+					"\t[%s] (received=%u enqueued=%u) packets (dt=%fms mindt=%fms maxdt=%fms sumdt=%fms)",
+					__func__, numReceivedFramePackets, numEnqueuedFramePackets, dt.toMilliSecsf(),
+					minDeltaFramePacketRecvTime, maxDeltaFramePacketRecvTime, sumDeltaFramePacketRecvTime
+				);
+			}
+		}
+		#endif
+
+		numPings += (msgPacket->data[0] == NETMSG_PING); // incoming
+		return;
+	}
+
+	if (packetCompressor == nullptr)
+		packetCompressor.reset(new PacketCompressor(CBaseNetProtocol::Get().GetPacketDictionary(), PACKET_DICTIONARY_ID));
+
+	// waitBuffer (which data points into) is still in use by our caller
+	std::vector<std::uint8_t> messages;
+
+	if (!packetCompressor->Unpack(data, length, messages)) {
+		LOG_L(L_ERROR, "\t[%s] discarding incoming corrupt packed packet: LEN %u, DICT %d", __func__, length, (length > 3)? int(data[3]): -1);
+		return;
+	}
+
+	// batches contain only complete messages, a packed one is never nested
+	for (unsigned pos = 0; pos < messages.size(); ) {
+		const unsigned char* msgp = &messages[pos];
+		const unsigned int msgLength = messages.size() - pos;
+
+		const int pktLength = ProtocolDef::GetInstance()->PacketLength(msgp, msgLength);
+
+		if (!ProtocolDef::GetInstance()->IsValidLength(pktLength, msgLength) || *msgp == NETMSG_PACKED) {
+			LOG_L(L_ERROR, "\t[%s] discarding rest of packed packet: ID %d, LEN %d", __func__, (int)*msgp, pktLength);
+			break;
+		}
+
+		EnqueueMessage(msgp, pktLength);
+		pos += pktLength;
+	}
+}
+
+void UDPConnection::PackOutgoingData()
+{
+	if (outgoingData.size() < 2)
+		return;
+
+	packBuffer.clear();
+
+	size_t numPacked = 0;
+
+	for (const std::shared_ptr<const RawPacket>& packet: outgoingData) {
+		if (!ProtocolDef::GetInstance()->IsValidPacket(packet->data, packet->length))
+			break;
+		if ((packBuffer.size() + packet->length) > PacketCompressor::maxPackSize)
+			break;
+
+		packBuffer.insert(packBuffer.end(), packet->data, packet->data + packet->length);
+		numPacked += 1;
+	}
+
+	if (numPacked < 2)
+		return;
+
+	if (packetCompressor == nullptr)
+		packetCompressor.reset(new PacketCompressor(CBaseNetProtocol::Get().GetPacketDictionary(), PACKET_DICTIONARY_ID));
+
+	std::vector<std::uint8_t> packed;
+
+	if (!packetCompressor->Pack(packBuffer.data(), packBuffer.size(), packed))
+		return;
+
+	packedRawBytes += packBuffer.size();
+	packedBytes += packed.size();
+
+	outgoingData.erase(outgoingData.begin(), outgoingData.begin() + numPacked);
+	outgoingData.emplace_front(new RawPacket(packed.data(), packed.size()));
+}
+
 void UDPConnection::Flush(const bool forced)
 {
 	if (muted)
@@ -714,6 +791,9 @@ void UDPConnection::Flush(const bool forced)
 	}
 
 	if (forced || (!waitMore && outgoingLength > requiredLength)) {
+		if (packOutgoing)
+			PackOutgoingData();
+
 		std::uint8_t buffer[udpMaxPacketSize];
 		unsigned pos = 0;
 
@@ -809,6 +889,7 @@ std::string UDPConnection::Statistics() const
 		"\t{%.3fx, %.3fx} relative protocol overhead {up, down}\n",
 		"\t%u incoming chunks dropped, %u outgoing chunks resent\n",
 		"\t%u incoming chunks processed\n",
+		"\t%u message bytes sent packed in %u bytes (%.3fx)\n",
 	};
 
 	std::string msg = "[UDPConnection::Statistics]\n";
@@ -817,6 +898,10 @@ std::string UDPConnection::Statistics() const
 	msg += spring::format(fmts[2], spring::SafeDivide(sentOverhead * 1.0f, dataSent * 1.0f), spring::SafeDivide(recvOverhead * 1.0f, dataRecv * 1.0f));
 	msg += spring::format(fmts[3], droppedChunks, resentChunks);
 	msg += spring::format(fmts[4], lastInOrder + 1);
+
+	if (packedRawBytes > 0)
+		msg += spring::format(fmts[5], packedRawBytes, packedBytes, spring::SafeDivide(packedBytes * 1.0f, packedRawBytes * 1.0f));
+
 	return msg;
 }
 
@@ -26,6 +26,8 @@ namespace netcode {
 #define PACKET_MAX_LATENCY 1250               // in [milliseconds] maximum latency
 #define ENABLE_DEBUG_STATS
 
+class PacketCompressor;
+
 class Chunk
 {
 public:
@@ -155,6 +157,11 @@ private:
 	void UpdateWaitingPackets();
 	void UpdateResendRequests();
 
+	/// replace the outgoing messages by a NETMSG_PACKED batch if that is smaller
+	void PackOutgoingData();
+	/// add a received message to msgQueue, unpacking NETMSG_PACKED batches
+	void EnqueueMessage(const unsigned char* data, unsigned length);
+
 private:
 	spring_time lastChunkCreatedTime;
 	spring_time lastPacketSendTime;
@@ -179,6 +186,7 @@ private:
 	bool resend;
 	bool sharedSocket;
 	bool logMessages;
+	bool packOutgoing;
 
 	int netLossFactor;
 	int reconnectTime;
@@ -205,6 +213,10 @@ private:
 	std::vector<std::uint8_t> sendBuffer;
 	std::vector<std::uint8_t> recvBuffer;
 	std::vector<std::uint8_t> waitBuffer;
+	std::vector<std::uint8_t> packBuffer;
+
+	/// created on first use, see NETMSG_PACKED
+	std::unique_ptr<PacketCompressor> packetCompressor;
 
 	std::vector<int> droppedPackets;
 
@@ -243,6 +255,7 @@ private:
 
 	unsigned int sentOverhead, recvOverhead;
 	unsigned int sentPackets, recvPackets;
+	unsigned int packedRawBytes, packedBytes;
 
 	class BandwidthUsage {
 	public:
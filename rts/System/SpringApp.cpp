@@ -90,6 +90,7 @@
 #include "System/Log/ILog.h"
 #include "System/Log/DefaultFilter.h"
 #include "System/LogOutput.h"
+#include "System/MatchBatch.h"
 #include "System/Platform/errorhandler.h"
 #include "System/Platform/CrashHandler.h"
 #include "System/Platform/Threading.h"
@@ -141,6 +142,7 @@ DEFINE_string   (map,                                      "",    "Specify the m
 DEFINE_string   (menu,                                     "",    "Specify a lua menu archive to be used by spring");
 DEFINE_string   (name,                                     "",    "Set your player name");
 DEFINE_bool     (oldmenu,                                  false, "Start the old menu");
+DEFINE_string   (batch,                                    "",    "Play the setup-scripts listed in this file (one per line) as consecutive matches, then quit");
 
 
 
@@ -149,6 +151,8 @@ int spring::exitCode = spring::EXIT_CODE_SUCCESS;
 static unsigned int reloadCount = 0;
 static unsigned int killedCount = 0;
 
+static CMatchBatch matchBatch;
+
 
 
 // initialize basic systems for command line help / output
@@ -643,6 +647,14 @@ void SpringApp::Startup()
 
 	luaMenuController = new CLuaMenuController(FLAGS_menu);
 
+	if (!FLAGS_batch.empty()) {
+		clientSetup->isHost = true;
+
+		matchBatch.Load(FLAGS_batch);
+		activeController = RunScript(matchBatch.NextMatch());
+		return;
+	}
+
 	// no argument (either game is given or show selectmenu)
 	if (inputFile.empty()) {
 		clientSetup->isHost = true;
@@ -732,7 +744,8 @@ void SpringApp::Reload(const std::string script)
 	// do not cleanup+reinit; LuaVFS thread might see NULL while scanner is temporarily gone
 	// handling that in ScanAllDirs would leave the archive-cache incomplete, which also has
 	// implications for sync
-	FileSystemInitializer::Reload();
+	// the archives of a batch can not change between its matches, so skip the rescan there
+	FileSystemInitializer::Reload(!matchBatch.IsActive());
 	#endif
 
 	LOG("[SpringApp::%s][7]", __func__);
@@ -861,7 +874,17 @@ int SpringApp::Run()
 			} else {
 				gu->globalQuit = (!Update() || gu->globalQuit);
 			}
+
+			if (matchBatch.IsActive() && matchBatch.Update(game)) {
+				// picked up by Reload on the next iteration; quit after the last match
+				gameSetup->reloadScript = matchBatch.NextMatch();
+				gu->globalReload = !gameSetup->reloadScript.empty();
+				gu->globalQuit = gu->globalQuit || !gu->globalReload;
+			}
 		}
+
+		if (matchBatch.IsActive() && !matchBatch.LogSummary())
+			spring::exitCode = spring::EXIT_CODE_DESYNC;
 	} CATCH_SPRING_ERRORS
 
 	// no exception from main, check if some other thread interrupted our regular loop
@@ -7,7 +7,7 @@ namespace spring {
 	enum {
 		EXIT_CODE_CRASHED = -1003, // ErrorHandler::ExitProcess
 		EXIT_CODE_NOINIT  = -1002, // SpringApp::Run
-		EXIT_CODE_DESYNC  = -1001, // GameServer::CheckSync
+		EXIT_CODE_DESYNC  = -1001, // GameServer::CheckSync, SpringApp::Run (--batch)
 		EXIT_CODE_SUCCESS =     0,
 		EXIT_CODE_FAILURE =     1, // SpringApp::ParseCmdLine
 		EXIT_CODE_TIMEOUT =  1001, // PreGame::UpdateClientNet
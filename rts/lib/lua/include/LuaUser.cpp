@@ -11,6 +11,7 @@
 #include "Lua/LuaMemPool.h"
 
 #include "System/GlobalRNG.h"
+#include "System/MemoryTags.h"
 #include "System/SpringMath.h"
 
 #if (ENABLE_USERSTATE_LOCKS != 0)
@@ -257,6 +258,9 @@ void spring_lua_alloc_log_error(const luaContextData* lcd)
 	e.msgPtr += SNPRINTF(e.msgPtr, sizeof(e.msgBuf) - (e.msgPtr - &e.msgBuf[0]), fmt, __func__, lhn, lcd->synced, s.allocedBytes.load(), MAX_ALLOC_BYTES[__archBits__ == 64]);
 }
 
+// covers every Lua heap, pooled (LuaMemPool) or not
+static MemoryTag* const luaMemTag = MemoryTags::Get("Lua");
+
 void* spring_lua_alloc(void* ud, void* ptr, size_t osize, size_t nsize)
 {
 	luaContextData* lcd = static_cast<luaContextData*>(ud);
@@ -268,6 +272,8 @@ void* spring_lua_alloc(void* ud, void* ptr, size_t osize, size_t nsize)
 	las->allocedBytes -= osize;
 	las->allocedBytes += nsize;
 
+	luaMemTag->OnResize(osize, nsize);
+
 	if (nsize == 0) {
 		// deallocation; must return NULL
 		lmp->Free(ptr, osize);
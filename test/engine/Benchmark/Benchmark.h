@@ -0,0 +1,170 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef TEST_BENCHMARK_H
+#define TEST_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+/**
+ * Harness shared by the engine microbenchmarks (test/engine/Benchmark).
+ *
+ * A workload is a callable returning a checksum of the work it did; it is
+ * run once to warm up and then <numRuns> more times. Every run has to
+ * produce the same checksum (workloads are seeded, so this also checks
+ * that the code under test is deterministic), and the minimum and median
+ * time per operation are reported.
+ *
+ * Results are written as one JSON object per line, to stdout prefixed by
+ * "[Benchmark] " and, if the environment variable SPRING_BENCHMARK_OUTPUT
+ * names a file, appended to that file without the prefix so results from
+ * different builds can be collected and compared by scripts.
+ */
+namespace Benchmark {
+	struct Result {
+		const char* suite = "";
+		const char* name = "";
+
+		uint64_t numOps = 0; // per run
+		uint64_t checksum = 0;
+
+		int numRuns = 0;
+
+		double minNsPerOp = 0.0;
+		double medNsPerOp = 0.0;
+
+		bool deterministic = true;
+	};
+
+
+	inline void Report(const Result& r)
+	{
+		char buf[512];
+
+		snprintf(buf, sizeof(buf),
+			"{\"suite\":\"%s\",\"name\":\"%s\",\"runs\":%d,\"ops\":%" PRIu64 ",\"min_ns_per_op\":%.3f,\"median_ns_per_op\":%.3f,\"checksum\":%" PRIu64 ",\"deterministic\":%s}",
+			r.suite,
+			r.name,
+			r.numRuns,
+			r.numOps,
+			r.minNsPerOp,
+			r.medNsPerOp,
+			r.checksum,
+			r.deterministic? "true": "false"
+		);
+
+		printf("[Benchmark] %s\n", buf);
+		fflush(stdout);
+
+		const char* outFileName = getenv("SPRING_BENCHMARK_OUTPUT");
+
+		if (outFileName == nullptr || outFileName[0] == 0)
+			return;
+
+		FILE* outFile = fopen(outFileName, "a");
+
+		if (outFile == nullptr)
+			return;
+
+		fprintf(outFile, "%s\n", buf);
+		fclose(outFile);
+	}
+
+
+	/// runs <workload> (which performs <numOps> operations per call) and reports its timings
+	template<typename Workload>
+	Result Run(const char* suite, const char* name, uint64_t numOps, Workload&& workload, int numRuns = 7)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		Result r;
+		r.suite = suite;
+		r.name = name;
+		r.numOps = std::max(numOps, uint64_t(1));
+		r.numRuns = numRuns;
+		r.checksum = workload();
+
+		std::vector<double> nsPerOp;
+		nsPerOp.reserve(numRuns);
+
+		for (int n = 0; n < numRuns; n++) {
+			const Clock::time_point t0 = Clock::now();
+			const uint64_t checksum = workload();
+			const Clock::time_point t1 = Clock::now();
+
+			nsPerOp.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count() / r.numOps);
+			r.deterministic &= (checksum == r.checksum);
+		}
+
+		std::sort(nsPerOp.begin(), nsPerOp.end());
+
+		r.minNsPerOp = nsPerOp.front();
+		r.medNsPerOp = nsPerOp[nsPerOp.size() / 2];
+
+		Report(r);
+		return r;
+	}
+
+
+	/// seeded generator so every run and every build sees the same workload
+	struct Rng {
+	public:
+		explicit Rng(uint64_t seed): state(seed ^ 0x9E3779B97F4A7C15ull) {}
+
+		uint32_t NextInt() {
+			// xorshift64*
+			state ^= (state >> 12);
+			state ^= (state << 25);
+			state ^= (state >> 27);
+			return ((state * 0x2545F4914F6CDD1Dull) >> 32);
+		}
+		uint32_t NextInt(uint32_t n) { return (NextInt() % n); }
+		float NextFloat() { return (NextInt() * (1.0f / 4294967296.0f)); }
+		float NextFloat(float lo, float hi) { return (lo + NextFloat() * (hi - lo)); }
+
+	private:
+		uint64_t state;
+	};
+
+
+	/**
+	 * Fills <heightMap> (sizeX * sizeZ values, row-major) with overlapping
+	 * hills and craters, in the height range of a typical map.
+	 */
+	inline void GenerateHeightMap(std::vector<float>& heightMap, int sizeX, int sizeZ, uint64_t seed)
+	{
+		Rng rng(seed);
+
+		struct Hill { float x, z, r, h; };
+		std::vector<Hill> hills(64);
+
+		for (Hill& hill: hills) {
+			hill = {rng.NextFloat(0.0f, sizeX), rng.NextFloat(0.0f, sizeZ), rng.NextFloat(8.0f, sizeX * 0.2f), rng.NextFloat(-120.0f, 250.0f)};
+		}
+
+		heightMap.clear();
+		heightMap.resize(sizeX * sizeZ, 0.0f);
+
+		for (int z = 0; z < sizeZ; z++) {
+			for (int x = 0; x < sizeX; x++) {
+				float h = 20.0f;
+
+				for (const Hill& hill: hills) {
+					const float dx = (x - hill.x) / hill.r;
+					const float dz = (z - hill.z) / hill.r;
+					const float d2 = dx * dx + dz * dz;
+
+					h += hill.h * std::max(0.0f, 1.0f - d2) * std::max(0.0f, 1.0f - d2);
+				}
+
+				heightMap[z * sizeX + x] = h;
+			}
+		}
+	}
+}
+
+#endif // TEST_BENCHMARK_H
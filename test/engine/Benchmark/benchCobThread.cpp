@@ -0,0 +1,198 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Benchmark.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Units/Scripts/CobScriptNames.h"
+#include "System/Log/ILog.h"
+#include "System/creg/creg_cond.h"
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+// CCobThread::Tick is run as it is, the instance, file, engine and LuaRules it
+// talks to are replaced by the stubs below: the real ones need a CUnit (and
+// with it the whole sim) and a lua_State, which can not be built into a unit
+// test. Animation calls are only counted, so this measures the interpreter.
+
+#define COB_INSTANCE_H
+#define COB_FILE_H
+#define COB_ENGINE_H
+#define LUA_RULES_H
+
+static constexpr unsigned int MAX_COB_ARGS = 16;
+#define MAX_LUA_COB_ARGS 10
+
+class CUnit;
+class CCobFile;
+
+class CUnitScript {
+public:
+	enum AnimType {ANone = -1, ATurn = 0, ASpin = 1, AMove = 2};
+};
+
+class CCobInstance: public CUnitScript {
+public:
+	enum ThreadCallbackType { CBNone, CBKilled, CBAimWeapon, CBAimShield };
+
+	void Turn(int piece, int axis, int speed, int destination) { animChecksum += (piece * 31u + axis) ^ (speed + destination); }
+	void Move(int piece, int axis, int speed, int destination) { animChecksum += (piece * 37u + axis) ^ (speed - destination); }
+	void Spin(int piece, int axis, int speed, int accel) { animChecksum += speed + accel; }
+	void StopSpin(int piece, int axis, int decel) { animChecksum += decel; }
+	void TurnNow(int piece, int axis, int destination) { animChecksum += destination; }
+	void MoveNow(int piece, int axis, int destination) { animChecksum += destination; }
+	bool NeedsWait(AnimType type, int piece, int axis) { return false; }
+
+	void Explode(int piece, int flags) {}
+	void PlayUnitSound(int snr, int attr) {}
+	void EmitSfx(int sfxType, int sfxPiece) {}
+	void Signal(int signal) {}
+	void SetVisibility(int piece, bool visible) {}
+	void ShowFlare(int piece) {}
+	void AttachUnit(int piece, int unit) {}
+	void DropUnit(int unit) {}
+
+	int GetUnitVal(int val, int p1, int p2, int p3, int p4) { return val; }
+	void SetUnitVal(int val, int param) {}
+
+	void ThreadCallback(ThreadCallbackType type, int retCode, int cbParam) {}
+	bool RemoveThreadID(int threadID) { return true; }
+	const CUnit* GetUnit() const { return nullptr; }
+
+	CCobFile* cobFile = nullptr;
+
+	std::vector<int> staticVars;
+	uint32_t animChecksum = 0;
+};
+
+class CCobFile {
+public:
+	std::vector<int> code;
+	std::vector<std::string> scriptNames;
+	std::vector<int> scriptOffsets;
+	std::vector<int> scriptLengths;
+	std::array<int, COBFN_NumUnitFuncs> scriptIndex;
+	std::vector<int> luaScripts;
+
+	std::string name;
+};
+
+class CCobThread;
+
+class CCobEngine {
+public:
+	int GetCurrentTime() const { return 0; }
+	int GenThreadID() { return threadCounter++; }
+
+	void ScheduleThread(const CCobThread* thread) {}
+	void QueueAddThread(CCobThread&& thread) {}
+
+	int threadCounter = 0;
+};
+
+class CLuaRules {
+public:
+	void Cob2Lua(int name, const CUnit* unit, int& argsCount, int* args) {}
+};
+
+static CCobEngine cobEngineObj;
+CCobEngine* cobEngine = &cobEngineObj;
+CLuaRules* luaRules = nullptr;
+
+CGlobalSyncedRNG gsRNG;
+
+#include "Sim/Units/Scripts/CobThread.cpp"
+
+
+static constexpr int NUM_INSTANCES = 256;
+static constexpr int NUM_LOOP_ITERS = 64; // per thread
+
+
+// an AimWeapon-like script: a counted loop doing arithmetic on locals
+// and statics, calling a helper and issuing a turn per iteration
+static void GenerateScript(CCobFile& file)
+{
+	std::vector<int>& c = file.code;
+
+	file.name = "bench.cob";
+	file.scriptNames = {"Bench", "Helper"};
+	file.scriptIndex.fill(-1);
+
+	// Bench(): i = 0, acc = 0
+	file.scriptOffsets.push_back(c.size());
+	c.insert(c.end(), {CREATE_LOCAL_VAR, CREATE_LOCAL_VAR});
+
+	const int loopStart = c.size();
+
+	// while (i < NUM_LOOP_ITERS)
+	c.insert(c.end(), {PUSH_LOCAL_VAR, 0, PUSH_CONSTANT, NUM_LOOP_ITERS, SET_LESS, JUMP_NOT_EQUAL, -1});
+	const int loopExitOperand = c.size() - 1;
+
+	// acc = ((acc + i * 3) ^ 7) % 100003
+	c.insert(c.end(), {PUSH_LOCAL_VAR, 1, PUSH_LOCAL_VAR, 0, PUSH_CONSTANT, 3, MUL, ADD, PUSH_CONSTANT, 7, BITWISE_XOR, PUSH_CONSTANT, 100003, MOD, POP_LOCAL_VAR, 1});
+	// static[0] = static[0] + acc
+	c.insert(c.end(), {PUSH_STATIC, 0, PUSH_LOCAL_VAR, 1, ADD, POP_STATIC, 0});
+	// turn piece 1 around the y-axis at speed acc to i
+	c.insert(c.end(), {PUSH_LOCAL_VAR, 1, PUSH_LOCAL_VAR, 0, TURN, 1, 1});
+	// Helper(i)
+	c.insert(c.end(), {PUSH_LOCAL_VAR, 0, CALL, 1, 1});
+	// i = i + 1
+	c.insert(c.end(), {PUSH_LOCAL_VAR, 0, PUSH_CONSTANT, 1, ADD, POP_LOCAL_VAR, 0, JUMP, loopStart});
+
+	c[loopExitOperand] = c.size();
+
+	// return acc
+	c.insert(c.end(), {PUSH_LOCAL_VAR, 1, RETURN});
+	file.scriptLengths.push_back(c.size() - file.scriptOffsets.back());
+
+	// Helper(x): static[1] = static[1] ^ (x * x); return 0
+	file.scriptOffsets.push_back(c.size());
+	c.insert(c.end(), {CREATE_LOCAL_VAR, PUSH_STATIC, 1, PUSH_LOCAL_VAR, 0, PUSH_LOCAL_VAR, 0, MUL, BITWISE_XOR, POP_STATIC, 1, PUSH_CONSTANT, 0, RETURN});
+	file.scriptLengths.push_back(c.size() - file.scriptOffsets.back());
+}
+
+
+TEST_CASE("CobThreadTick")
+{
+	CCobFile file;
+	GenerateScript(file);
+
+	std::vector<CCobInstance> instances(NUM_INSTANCES);
+
+	const Benchmark::Result result = Benchmark::Run("CobThread", "Tick", NUM_INSTANCES * NUM_LOOP_ITERS, [&]() {
+		uint64_t checksum = 0;
+
+		for (int i = 0; i < NUM_INSTANCES; i++) {
+			CCobInstance& inst = instances[i];
+
+			inst.cobFile = &file;
+			inst.staticVars.assign(2, i);
+			inst.animChecksum = 0;
+
+			CCobThread thread(&inst);
+
+			thread.SetID(i);
+			thread.Start(0, 0, {{0}}, false);
+
+			// runs to completion, nothing in the script sleeps or waits
+			while (thread.Tick());
+
+			checksum += thread.GetRetCode();
+			checksum += inst.staticVars[0] * 31u + inst.staticVars[1];
+			checksum += inst.animChecksum;
+		}
+
+		return checksum;
+	});
+
+	CHECK(result.deterministic);
+	CHECK(result.checksum != 0);
+
+	// the CALL got rewritten into a REAL_CALL by the first run
+	CHECK(std::find(file.code.begin(), file.code.end(), CALL) == file.code.end());
+}
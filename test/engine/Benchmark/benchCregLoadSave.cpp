@@ -0,0 +1,185 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Benchmark.h"
+#include "System/creg/creg_cond.h"
+#include "System/creg/Serializer.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+static constexpr int NUM_OBJECTS = 4096;
+
+
+// loosely shaped like a sim object: plain state, containers and cross-references
+struct BenchVec {
+	CR_DECLARE_STRUCT(BenchVec);
+	float x, y, z;
+};
+
+CR_BIND(BenchVec, );
+CR_REG_METADATA(BenchVec, (CR_MEMBER(x), CR_MEMBER(y), CR_MEMBER(z)));
+
+
+struct BenchObject {
+	CR_DECLARE(BenchObject);
+
+	virtual ~BenchObject() {}
+
+	int id = 0;
+	int team = 0;
+	float health = 0.0f;
+	bool active = false;
+
+	BenchVec pos;
+	BenchVec speed;
+
+	std::string name;
+	std::vector<int> commands;
+	std::vector<float> weaponReloads;
+
+	BenchObject* target = nullptr;
+	BenchObject* transporter = nullptr;
+};
+
+CR_BIND(BenchObject, );
+CR_REG_METADATA(BenchObject, (
+	CR_MEMBER(id),
+	CR_MEMBER(team),
+	CR_MEMBER(health),
+	CR_MEMBER(active),
+	CR_MEMBER(pos),
+	CR_MEMBER(speed),
+	CR_MEMBER(name),
+	CR_MEMBER(commands),
+	CR_MEMBER(weaponReloads),
+	CR_MEMBER(target),
+	CR_MEMBER(transporter)
+));
+
+
+struct BenchWorld {
+	CR_DECLARE(BenchWorld);
+
+	virtual ~BenchWorld() {
+		for (BenchObject* o: objects) {
+			delete o;
+		}
+	}
+
+	int frameNum = 0;
+	std::vector<BenchObject*> objects;
+};
+
+CR_BIND(BenchWorld, );
+CR_REG_METADATA(BenchWorld, (
+	CR_MEMBER(frameNum),
+	CR_MEMBER(objects)
+));
+
+
+static BenchWorld* GenerateWorld()
+{
+	Benchmark::Rng rng(7);
+	BenchWorld* world = new BenchWorld();
+
+	world->frameNum = 30 * 60 * 20;
+	world->objects.resize(NUM_OBJECTS);
+
+	for (int i = 0; i < NUM_OBJECTS; i++) {
+		BenchObject* o = new BenchObject();
+
+		o->id = i;
+		o->team = rng.NextInt(8);
+		o->health = rng.NextFloat(1.0f, 5000.0f);
+		o->active = (rng.NextInt(4) != 0);
+		o->pos = {rng.NextFloat(0.0f, 8192.0f), rng.NextFloat(0.0f, 300.0f), rng.NextFloat(0.0f, 8192.0f)};
+		o->speed = {rng.NextFloat(-3.0f, 3.0f), 0.0f, rng.NextFloat(-3.0f, 3.0f)};
+		o->name = "benchobject" + std::to_string(rng.NextInt(64));
+		o->commands.resize(rng.NextInt(16));
+		o->weaponReloads.resize(rng.NextInt(4));
+
+		for (int& c: o->commands) {
+			c = rng.NextInt();
+		}
+		for (float& r: o->weaponReloads) {
+			r = rng.NextFloat(0.0f, 100.0f);
+		}
+
+		world->objects[i] = o;
+	}
+
+	for (BenchObject* o: world->objects) {
+		if (rng.NextInt(2) == 0)
+			o->target = world->objects[rng.NextInt(NUM_OBJECTS)];
+		if (rng.NextInt(16) == 0)
+			o->transporter = world->objects[rng.NextInt(NUM_OBJECTS)];
+	}
+
+	return world;
+}
+
+static uint64_t HashWorld(const BenchWorld* world)
+{
+	uint64_t hash = world->frameNum;
+
+	for (const BenchObject* o: world->objects) {
+		hash = (hash * 31) + o->id + o->team + o->commands.size() + o->weaponReloads.size() + o->name.size();
+		hash = (hash * 31) + ((o->target != nullptr)? o->target->id: -1);
+		hash = (hash * 31) + ((o->transporter != nullptr)? o->transporter->id: -1);
+		hash = (hash * 31) + static_cast<uint64_t>(o->health + o->pos.x + o->pos.z);
+	}
+
+	return hash;
+}
+
+
+TEST_CASE("CregLoadSave")
+{
+	BenchWorld* world = GenerateWorld();
+	std::string savedData;
+
+	const Benchmark::Result save = Benchmark::Run("Creg", "SavePackage", NUM_OBJECTS, [&]() {
+		std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+
+		creg::COutputStreamSerializer os;
+		os.SavePackage(&ss, world, world->GetClass());
+
+		savedData = ss.str();
+
+		// FNV-1a
+		uint64_t hash = 14695981039346656037ull;
+
+		for (const char c: savedData) {
+			hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+		}
+
+		return hash;
+	});
+
+	const Benchmark::Result load = Benchmark::Run("Creg", "LoadPackage", NUM_OBJECTS, [&]() {
+		std::stringstream ss(savedData, std::ios::in | std::ios::binary);
+
+		void* root = nullptr;
+		creg::Class* rootCls = nullptr;
+
+		creg::CInputStreamSerializer is;
+		is.LoadPackage(&ss, root, rootCls);
+
+		BenchWorld* loadedWorld = static_cast<BenchWorld*>(root);
+		const uint64_t hash = HashWorld(loadedWorld);
+
+		delete loadedWorld;
+		return hash;
+	});
+
+	CHECK(save.deterministic);
+	CHECK(load.deterministic);
+	CHECK(load.checksum == HashWorld(world));
+
+	delete world;
+}
@@ -0,0 +1,136 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Benchmark.h"
+#include "Game/GlobalUnsynced.h"
+#include "Map/ReadMap.h"
+#include "Sim/Misc/LosInstance.h"
+#include "Sim/Misc/LosMap.h"
+
+#include <algorithm>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+// normally defined by ReadMap.cpp and GlobalUnsynced.cpp, which can not be linked into a unit test
+CReadMap* readMap = nullptr;
+MapDimensions mapDims;
+CGlobalUnsynced* gu = nullptr;
+
+// only called for maps initialized with sendReadmapEvents
+void CReadMap::UpdateLOS(const SRectangle& hgtMapRect) {}
+
+
+static constexpr int MAP_SIZE_X = 1024; // squares
+static constexpr int MAP_SIZE_Z = 1024;
+static constexpr int LOS_MIP_LEVEL = 1; // the default modInfo.losMipLevel
+
+static constexpr int NUM_INSTANCES = 2048;
+
+
+struct LosMapFixture {
+	LosMapFixture() {
+		mapDims.mapx = MAP_SIZE_X;
+		mapDims.mapy = MAP_SIZE_Z;
+		mapDims.Initialize();
+
+		losSize = {MAP_SIZE_X >> LOS_MIP_LEVEL, MAP_SIZE_Z >> LOS_MIP_LEVEL};
+
+		Benchmark::GenerateHeightMap(ctrHeightMap, MAP_SIZE_X, MAP_SIZE_Z, 5);
+
+		// box-filtered like the readmap's MIP levels
+		mipHeightMap.resize(losSize.x * losSize.y, 0.0f);
+
+		for (int z = 0; z < MAP_SIZE_Z; z++) {
+			for (int x = 0; x < MAP_SIZE_X; x++) {
+				mipHeightMap[(z >> LOS_MIP_LEVEL) * losSize.x + (x >> LOS_MIP_LEVEL)] += ctrHeightMap[z * MAP_SIZE_X + x] / (1 << (LOS_MIP_LEVEL * 2));
+			}
+		}
+
+		losMap.Init(losSize, int2(MAP_SIZE_X, MAP_SIZE_Z), ctrHeightMap.data(), mipHeightMap.data(), false);
+
+		Benchmark::Rng rng(6);
+
+		instances.reserve(NUM_INSTANCES);
+
+		for (int i = 0; i < NUM_INSTANCES; i++) {
+			// radii of typical units' sight at LOS_MIP_LEVEL, some of them along the map edges
+			const int radius = 12 + rng.NextInt(36);
+			const int2 basePos = {int(rng.NextInt(losSize.x)), int(rng.NextInt(losSize.y))};
+			const float groundHeight = mipHeightMap[basePos.y * losSize.x + basePos.x];
+
+			instances.emplace_back(i);
+			instances.back().radius = radius;
+			instances.back().allyteam = 0;
+			instances.back().basePos = basePos;
+			instances.back().baseHeight = std::max(groundHeight, 0.0f) + rng.NextFloat(10.0f, 80.0f);
+		}
+	}
+
+	int2 losSize;
+
+	std::vector<float> ctrHeightMap;
+	std::vector<float> mipHeightMap;
+	std::vector<SLosInstance> instances;
+
+	CLosMap losMap;
+};
+
+
+TEST_CASE("LosMapRaycast")
+{
+	LosMapFixture fixture;
+
+	const Benchmark::Result raycast = Benchmark::Run("LosMap", "PrepareRaycast", NUM_INSTANCES, [&]() {
+		uint64_t checksum = 0;
+
+		for (SLosInstance& li: fixture.instances) {
+			li.squares.clear();
+			fixture.losMap.PrepareRaycast(&li);
+
+			for (const SLosInstance::RLE& rle: li.squares) {
+				checksum += (rle.start * 31u) + rle.length;
+			}
+		}
+
+		return checksum;
+	});
+
+	CHECK(raycast.deterministic);
+	CHECK(raycast.checksum != 0);
+
+	// the squares of every instance are cached now, this only touches the map
+	const Benchmark::Result addRemove = Benchmark::Run("LosMap", "AddRemoveRaycast", NUM_INSTANCES * 2, [&]() {
+		uint64_t checksum = 0;
+
+		for (SLosInstance& li: fixture.instances) {
+			fixture.losMap.AddRaycast(&li, 1);
+		}
+
+		for (int z = 0; z < fixture.losSize.y; z++) {
+			for (int x = 0; x < fixture.losSize.x; x++) {
+				checksum += fixture.losMap.At({x, z});
+			}
+		}
+
+		for (SLosInstance& li: fixture.instances) {
+			fixture.losMap.AddRaycast(&li, -1);
+		}
+
+		return checksum;
+	});
+
+	CHECK(addRemove.deterministic);
+	CHECK(addRemove.checksum != 0);
+
+	bool cleared = true;
+
+	for (int z = 0; z < fixture.losSize.y; z++) {
+		for (int x = 0; x < fixture.losSize.x; x++) {
+			cleared &= (fixture.losMap.At({x, z}) == 0);
+		}
+	}
+
+	CHECK(cleared);
+}
@@ -0,0 +1,202 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Benchmark.h"
+#include "Lua/LuaHashString.h"
+
+#include <cstring>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+static constexpr int NUM_CALLINS = 100000;
+
+
+// a handle defining some of the callins, counting how often each one ran
+static const char* HANDLE_CODE =
+	"numCalls = 0\n"
+	"damageSum = 0\n"
+	"function GameFrame(frameNum)\n"
+	"  numCalls = numCalls + 1\n"
+	"end\n"
+	"function UnitDamaged(unitID, unitDefID, unitTeam, damage, paralyzer, weaponDefID, projectileID, attackerID, attackerDefID, attackerTeam)\n"
+	"  numCalls = numCalls + 1\n"
+	"  damageSum = damageSum + damage\n"
+	"end\n"
+	"function AllowCommand(unitID, unitDefID, unitTeam, cmdID, cmdParams, cmdOptions, cmdTag, synced)\n"
+	"  numCalls = numCalls + 1\n"
+	"  return (cmdParams[1] ~= nil)\n"
+	"end\n";
+
+
+/**
+ * Mirrors the dispatch sequence of a CLuaHandle callin (see CLuaHandle::GameFrame):
+ * traceback handler, hashed global lookup, argument push and a protected call
+ * with GC stopped afterwards. The engine-side bookkeeping around it (timers,
+ * handle-running counts, GL matrix checks) needs a full CLuaHandle and is not
+ * part of this benchmark.
+ */
+struct CallInDispatcher {
+public:
+	CallInDispatcher() {
+		L = luaL_newstate();
+
+		SPRING_LUA_OPEN_LIB(L, luaopen_base);
+		SPRING_LUA_OPEN_LIB(L, luaopen_math);
+		SPRING_LUA_OPEN_LIB(L, luaopen_table);
+		SPRING_LUA_OPEN_LIB(L, luaopen_string);
+		SPRING_LUA_OPEN_LIB(L, luaopen_debug);
+
+		lua_settop(L, 0);
+
+		if (luaL_loadbuffer(L, HANDLE_CODE, strlen(HANDLE_CODE), "handle") != 0 || lua_pcall(L, 0, 0, 0) != 0)
+			FAIL(lua_tostring(L, -1));
+
+		lua_gc(L, LUA_GCSTOP, 0);
+	}
+	~CallInDispatcher() { lua_close(L); }
+
+	template<typename PushArgs>
+	bool RunCallIn(const LuaHashString& cmdStr, int numArgs, int numResults, PushArgs&& pushArgs) {
+		luaL_checkstack(L, numArgs + 3, __func__);
+
+		// same handler as LuaUtils::ScopedDebugTraceBack
+		lua_getglobal(L, "debug");
+		lua_getfield(L, -1, "traceback");
+		lua_remove(L, -2);
+
+		const int errFuncIdx = lua_gettop(L);
+
+		if (!cmdStr.GetGlobalFunc(L)) {
+			lua_pop(L, 1);
+			return false;
+		}
+
+		pushArgs();
+
+		const int error = lua_pcall(L, numArgs, numResults, errFuncIdx);
+		lua_gc(L, LUA_GCSTOP, 0);
+
+		if (error != 0) {
+			lua_pop(L, 2);
+			return false;
+		}
+
+		// leave results on the stack for the caller, drop the handler
+		lua_remove(L, errFuncIdx);
+		return true;
+	}
+
+	lua_Number GetGlobalNumber(const char* name) {
+		lua_getglobal(L, name);
+		const lua_Number n = lua_tonumber(L, -1);
+		lua_pop(L, 1);
+		return n;
+	}
+
+public:
+	lua_State* L = nullptr;
+};
+
+
+TEST_CASE("LuaCallInDispatch")
+{
+	CallInDispatcher dispatcher;
+	lua_State* L = dispatcher.L;
+
+	const Benchmark::Result gameFrame = Benchmark::Run("LuaCallIn", "GameFrame", NUM_CALLINS, [&]() {
+		static const LuaHashString cmdStr("GameFrame");
+		uint64_t numRun = 0;
+
+		for (int n = 0; n < NUM_CALLINS; n++) {
+			numRun += dispatcher.RunCallIn(cmdStr, 1, 0, [&]() { lua_pushnumber(L, n); });
+		}
+
+		return numRun;
+	});
+
+	const Benchmark::Result unitDamaged = Benchmark::Run("LuaCallIn", "UnitDamaged", NUM_CALLINS, [&]() {
+		static const LuaHashString cmdStr("UnitDamaged");
+		uint64_t numRun = 0;
+
+		for (int n = 0; n < NUM_CALLINS; n++) {
+			numRun += dispatcher.RunCallIn(cmdStr, 10, 0, [&]() {
+				lua_pushnumber(L, n & 1023);
+				lua_pushnumber(L, 17);
+				lua_pushnumber(L, n & 7);
+				lua_pushnumber(L, 12.5f);
+				lua_pushboolean(L, false);
+				lua_pushnumber(L, 3);
+				lua_pushnumber(L, n);
+				lua_pushnumber(L, (n + 1) & 1023);
+				lua_pushnumber(L, 23);
+				lua_pushnumber(L, (n + 1) & 7);
+			});
+		}
+
+		return numRun;
+	});
+
+	const Benchmark::Result allowCommand = Benchmark::Run("LuaCallIn", "AllowCommand", NUM_CALLINS, [&]() {
+		static const LuaHashString cmdStr("AllowCommand");
+		uint64_t numAllowed = 0;
+
+		for (int n = 0; n < NUM_CALLINS; n++) {
+			// table arguments are what make command callins expensive
+			const bool ran = dispatcher.RunCallIn(cmdStr, 8, 1, [&]() {
+				lua_pushnumber(L, n & 1023);
+				lua_pushnumber(L, 17);
+				lua_pushnumber(L, n & 7);
+				lua_pushnumber(L, 10);
+				lua_createtable(L, 3, 0);
+				for (int i = 1; i <= 3; i++) {
+					lua_pushnumber(L, n * i);
+					lua_rawseti(L, -2, i);
+				}
+				lua_createtable(L, 0, 4);
+				lua_pushboolean(L, n & 1); lua_setfield(L, -2, "shift");
+				lua_pushboolean(L, n & 2); lua_setfield(L, -2, "ctrl");
+				lua_pushboolean(L, n & 4); lua_setfield(L, -2, "alt");
+				lua_pushboolean(L, n & 8); lua_setfield(L, -2, "right");
+				lua_pushnumber(L, n);
+				lua_pushboolean(L, true);
+			});
+
+			if (!ran)
+				continue;
+
+			numAllowed += lua_toboolean(L, -1);
+			lua_pop(L, 1);
+		}
+
+		// tables are only collected when the engine asks for it
+		lua_gc(L, LUA_GCCOLLECT, 0);
+		lua_gc(L, LUA_GCSTOP, 0);
+		return numAllowed;
+	});
+
+	const Benchmark::Result undefined = Benchmark::Run("LuaCallIn", "Undefined", NUM_CALLINS, [&]() {
+		static const LuaHashString cmdStr("UnitMoved");
+		uint64_t numRun = 0;
+
+		for (int n = 0; n < NUM_CALLINS; n++) {
+			numRun += dispatcher.RunCallIn(cmdStr, 1, 0, [&]() { lua_pushnumber(L, n); });
+		}
+
+		return numRun;
+	});
+
+	CHECK(gameFrame.deterministic);
+	CHECK(unitDamaged.deterministic);
+	CHECK(allowCommand.deterministic);
+	CHECK(undefined.deterministic);
+
+	CHECK(gameFrame.checksum == NUM_CALLINS);
+	CHECK(unitDamaged.checksum == NUM_CALLINS);
+	CHECK(allowCommand.checksum == NUM_CALLINS);
+	CHECK(undefined.checksum == 0);
+
+	// warm-up run plus the timed ones
+	CHECK(dispatcher.GetGlobalNumber("numCalls") == (3.0 * NUM_CALLINS * (1 + 7)));
+	CHECK(lua_gettop(L) == 0);
+}
@@ -0,0 +1,234 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <cassert> // NodeHeap.hpp relies on it being included first
+
+#include "Benchmark.h"
+#include "Sim/Path/QTPFS/NodeHeap.hpp"
+#include "Sim/Path/QTPFS/PathEnums.hpp"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+// QTPFS::PathSearch can not run here: its nodes are tessellated by NodeLayer
+// from the live readMap through CMoveMath and MoveDefHandler, which need a
+// loaded map and mod, and searches requested by Lua or units are only run by
+// PathManager::Update on the next sim frame. This stands in for it with the
+// same search loop (PathSearch::IterateNodes and IterateNodeNeighbors with a
+// single transition-point per edge) over a regular grid of nodes, whose move
+// costs are derived from the slope of a generated heightmap, on the engine's
+// QTPFS::binary_heap open-list.
+
+
+static constexpr int MAP_SIZE_X = 1024; // squares
+static constexpr int MAP_SIZE_Z = 1024;
+static constexpr int NODE_SIZE = 8; // squares per node edge, a mid-sized QTPFS node
+
+static constexpr int NODES_X = MAP_SIZE_X / NODE_SIZE;
+static constexpr int NODES_Z = MAP_SIZE_Z / NODE_SIZE;
+
+static constexpr int NUM_SEARCHES = 256;
+
+
+struct GridNode {
+	unsigned int GetHeapIndex() const { return heapIndex; }
+	void SetHeapIndex(unsigned int n) { heapIndex = n; }
+
+	bool operator <  (const GridNode* n) const { return (fCost <  n->fCost); }
+	bool operator >  (const GridNode* n) const { return (fCost >  n->fCost); }
+	bool operator == (const GridNode* n) const { return (fCost == n->fCost); }
+	bool operator <= (const GridNode* n) const { return (fCost <= n->fCost); }
+	bool operator >= (const GridNode* n) const { return (fCost >= n->fCost); }
+
+	void SetPathCosts(float g, float h) { fCost = g + h; gCost = g; hCost = h; }
+
+	unsigned int heapIndex = -1u;
+	unsigned int searchState = 0;
+
+	float fCost = 0.0f;
+	float gCost = 0.0f;
+	float hCost = 0.0f;
+
+	// reciprocal of the average speed-modifier, infinite if impassable
+	float moveCost = 1.0f;
+
+	float xmid = 0.0f;
+	float zmid = 0.0f;
+
+	GridNode* prevNode = nullptr;
+};
+
+
+struct GridSearch {
+	GridSearch() {
+		std::vector<float> heightMap;
+		Benchmark::GenerateHeightMap(heightMap, MAP_SIZE_X + 1, MAP_SIZE_Z + 1, 7);
+
+		nodes.resize(NODES_X * NODES_Z);
+		openNodes.reserve(nodes.size());
+
+		for (int nz = 0; nz < NODES_Z; nz++) {
+			for (int nx = 0; nx < NODES_X; nx++) {
+				GridNode& n = nodes[nz * NODES_X + nx];
+
+				float speedModSum = 0.0f;
+				int numPassable = 0;
+
+				// average speed-mod of the node's squares, as NodeLayer::UpdateSquares does
+				for (int z = nz * NODE_SIZE; z < (nz + 1) * NODE_SIZE; z++) {
+					for (int x = nx * NODE_SIZE; x < (nx + 1) * NODE_SIZE; x++) {
+						const float dx = heightMap[z * (MAP_SIZE_X + 1) + x + 1] - heightMap[z * (MAP_SIZE_X + 1) + x];
+						const float dz = heightMap[(z + 1) * (MAP_SIZE_X + 1) + x] - heightMap[z * (MAP_SIZE_X + 1) + x];
+						const float slope = std::sqrt(dx * dx + dz * dz) / 8.0f;
+
+						if (slope > 0.8f)
+							continue;
+
+						speedModSum += (1.0f - slope);
+						numPassable += 1;
+					}
+				}
+
+				n.xmid = (nx + 0.5f) * NODE_SIZE;
+				n.zmid = (nz + 0.5f) * NODE_SIZE;
+				n.moveCost = (numPassable > (NODE_SIZE * NODE_SIZE / 2))? (numPassable / speedModSum): std::numeric_limits<float>::infinity();
+			}
+		}
+	}
+
+	float Distance(const GridNode* a, const GridNode* b) const {
+		return std::sqrt((a->xmid - b->xmid) * (a->xmid - b->xmid) + (a->zmid - b->zmid) * (a->zmid - b->zmid));
+	}
+
+	// returns the number of nodes on the path found, 0 if the target is unreachable
+	int Execute(GridNode* srcNode, GridNode* tgtNode) {
+		// move-costs are >= 1, so this keeps the heuristic admissible
+		const float hCostMult = 1.0f;
+
+		searchState += QTPFS::NODE_STATE_OFFSET;
+
+		srcNode->prevNode = nullptr;
+		srcNode->SetPathCosts(0.0f, Distance(srcNode, tgtNode) * hCostMult);
+		srcNode->searchState = searchState | QTPFS::NODE_STATE_OPEN;
+
+		openNodes.reset();
+		openNodes.push(srcNode);
+
+		while (!openNodes.empty()) {
+			GridNode* curNode = openNodes.top();
+			curNode->searchState = searchState | QTPFS::NODE_STATE_CLOSED;
+
+			openNodes.pop();
+
+			if (curNode == tgtNode) {
+				openNodes.reset();
+				break;
+			}
+
+			const int cx = curNode->xmid / NODE_SIZE;
+			const int cz = curNode->zmid / NODE_SIZE;
+
+			for (int dz = -1; dz <= 1; dz++) {
+				for (int dx = -1; dx <= 1; dx++) {
+					if ((dx | dz) == 0)
+						continue;
+					if ((cx + dx) < 0 || (cx + dx) >= NODES_X || (cz + dz) < 0 || (cz + dz) >= NODES_Z)
+						continue;
+
+					GridNode* nxtNode = &nodes[(cz + dz) * NODES_X + (cx + dx)];
+
+					if (std::isinf(nxtNode->moveCost))
+						continue;
+
+					const bool isCurrent = (nxtNode->searchState >= searchState);
+					const bool isClosed = ((nxtNode->searchState & 1) == QTPFS::NODE_STATE_CLOSED);
+
+					const float gCost = curNode->gCost + curNode->moveCost * Distance(curNode, nxtNode);
+					const float hCost = Distance(nxtNode, tgtNode) * hCostMult;
+
+					if (!isCurrent) {
+						nxtNode->prevNode = curNode;
+						nxtNode->SetPathCosts(gCost, hCost);
+						nxtNode->searchState = searchState | QTPFS::NODE_STATE_OPEN;
+
+						openNodes.push(nxtNode);
+						continue;
+					}
+
+					if (gCost >= nxtNode->gCost)
+						continue;
+					if (isClosed)
+						openNodes.push(nxtNode);
+
+					nxtNode->prevNode = curNode;
+					nxtNode->SetPathCosts(gCost, hCost);
+					nxtNode->searchState = searchState | QTPFS::NODE_STATE_OPEN;
+
+					openNodes.resort(nxtNode);
+				}
+			}
+		}
+
+		if (tgtNode->searchState < searchState)
+			return 0;
+
+		int numPathNodes = 1;
+
+		for (const GridNode* n = tgtNode; n != srcNode; n = n->prevNode) {
+			numPathNodes += 1;
+		}
+
+		return numPathNodes;
+	}
+
+	std::vector<GridNode> nodes;
+	QTPFS::binary_heap<GridNode*> openNodes;
+
+	unsigned int searchState = 0;
+};
+
+
+TEST_CASE("QTPFSSearch")
+{
+	GridSearch search;
+
+	std::vector<std::pair<int, int>> queries;
+	queries.reserve(NUM_SEARCHES);
+
+	Benchmark::Rng rng(8);
+
+	while (queries.size() < NUM_SEARCHES) {
+		const int srcIdx = rng.NextInt(search.nodes.size());
+		const int tgtIdx = rng.NextInt(search.nodes.size());
+
+		if (std::isinf(search.nodes[srcIdx].moveCost) || std::isinf(search.nodes[tgtIdx].moveCost))
+			continue;
+
+		queries.emplace_back(srcIdx, tgtIdx);
+	}
+
+	int numFound = 0;
+
+	const Benchmark::Result result = Benchmark::Run("QTPFS", "GridSearch", NUM_SEARCHES, [&]() {
+		uint64_t checksum = 0;
+
+		numFound = 0;
+
+		for (const auto& q: queries) {
+			GridNode* tgtNode = &search.nodes[q.second];
+			const int numPathNodes = search.Execute(&search.nodes[q.first], tgtNode);
+
+			numFound += (numPathNodes > 0);
+			checksum += numPathNodes * 31u + uint32_t(tgtNode->gCost * 16.0f) * (numPathNodes > 0);
+		}
+
+		return checksum;
+	});
+
+	CHECK(result.deterministic);
+	CHECK(numFound > NUM_SEARCHES / 2);
+}
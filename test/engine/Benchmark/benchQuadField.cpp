@@ -0,0 +1,201 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Benchmark.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Misc/QuadField.h"
+#include "System/ContainerUtil.h"
+#include "System/float3.h"
+
+#include <algorithm>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+static constexpr int MAP_SIZE_X = 1024; // squares
+static constexpr int MAP_SIZE_Z = 1024;
+static constexpr int QUAD_SIZE = 128; // elmos, the default quadFieldQuadSizeInElmos
+
+static constexpr int NUM_QUERIES = 100000;
+static constexpr int NUM_OBJECTS = 4096;
+static constexpr int NUM_FRAMES = 32;
+
+
+struct MovingObject {
+	float3 pos;
+	float3 vel;
+	float radius;
+
+	std::vector<int> quads;
+};
+
+
+static void InitQuadField()
+{
+	float3::maxxpos = MAP_SIZE_X * SQUARE_SIZE - 1.0f;
+	float3::maxzpos = MAP_SIZE_Z * SQUARE_SIZE - 1.0f;
+
+	quadField.Init(int2(MAP_SIZE_X, MAP_SIZE_Z), QUAD_SIZE);
+}
+
+static float3 RandomPos(Benchmark::Rng& rng)
+{
+	return {rng.NextFloat(0.0f, MAP_SIZE_X * SQUARE_SIZE), 0.0f, rng.NextFloat(0.0f, MAP_SIZE_Z * SQUARE_SIZE)};
+}
+
+static float3 RandomDir(Benchmark::Rng& rng)
+{
+	return (float3(rng.NextFloat(-1.0f, 1.0f), 0.0f, rng.NextFloat(-1.0f, 1.0f)) + float3(0.001f, 0.0f, 0.0f)).Normalize();
+}
+
+static uint64_t SumQuads(const std::vector<int>& quads)
+{
+	uint64_t sum = quads.size();
+
+	for (const int qi: quads) {
+		sum += qi;
+	}
+
+	return sum;
+}
+
+
+TEST_CASE("QuadFieldQueries")
+{
+	InitQuadField();
+
+	const Benchmark::Result circle = Benchmark::Run("QuadField", "GetQuads", NUM_QUERIES, []() {
+		Benchmark::Rng rng(1);
+		uint64_t checksum = 0;
+
+		for (int n = 0; n < NUM_QUERIES; n++) {
+			QuadFieldQuery qfQuery;
+			quadField.GetQuads(qfQuery, RandomPos(rng), rng.NextFloat(8.0f, 512.0f));
+			checksum += SumQuads(*qfQuery.quads);
+		}
+
+		return checksum;
+	});
+
+	const Benchmark::Result rectangle = Benchmark::Run("QuadField", "GetQuadsRectangle", NUM_QUERIES, []() {
+		Benchmark::Rng rng(2);
+		uint64_t checksum = 0;
+
+		for (int n = 0; n < NUM_QUERIES; n++) {
+			const float3 pos = RandomPos(rng);
+			const float3 ext = {rng.NextFloat(8.0f, 512.0f), 0.0f, rng.NextFloat(8.0f, 512.0f)};
+
+			QuadFieldQuery qfQuery;
+			quadField.GetQuadsRectangle(qfQuery, pos - ext, pos + ext);
+			checksum += SumQuads(*qfQuery.quads);
+		}
+
+		return checksum;
+	});
+
+	const Benchmark::Result ray = Benchmark::Run("QuadField", "GetQuadsOnRay", NUM_QUERIES, []() {
+		Benchmark::Rng rng(3);
+		uint64_t checksum = 0;
+
+		for (int n = 0; n < NUM_QUERIES; n++) {
+			QuadFieldQuery qfQuery;
+			quadField.GetQuadsOnRay(qfQuery, RandomPos(rng), RandomDir(rng), rng.NextFloat(64.0f, 2048.0f));
+			checksum += SumQuads(*qfQuery.quads);
+		}
+
+		return checksum;
+	});
+
+	CHECK(circle.deterministic);
+	CHECK(rectangle.deterministic);
+	CHECK(ray.deterministic);
+
+	CHECK(circle.checksum != 0);
+	CHECK(rectangle.checksum != 0);
+	CHECK(ray.checksum != 0);
+}
+
+
+TEST_CASE("QuadFieldInsertMove")
+{
+	InitQuadField();
+
+	const int numQuads = quadField.GetNumQuadsX() * quadField.GetNumQuadsZ();
+
+	// CUnit can not be constructed in a unit test; objects are ids here and
+	// per-quad membership is kept in the same way CQuadField::MovedUnit does
+	std::vector<std::vector<int>> quadObjects(numQuads);
+	std::vector<MovingObject> objects(NUM_OBJECTS);
+
+	const auto MoveObject = [&](int objectID) {
+		MovingObject& o = objects[objectID];
+
+		QuadFieldQuery qfQuery;
+		quadField.GetQuads(qfQuery, o.pos, o.radius);
+
+		if (qfQuery.quads->size() == o.quads.size()) {
+			if (std::equal(qfQuery.quads->begin(), qfQuery.quads->end(), o.quads.begin()))
+				return;
+		}
+
+		for (const int qi: o.quads) {
+			spring::VectorErase(quadObjects[qi], objectID);
+		}
+
+		for (const int qi: *qfQuery.quads) {
+			spring::VectorInsertUnique(quadObjects[qi], objectID, false);
+		}
+
+		o.quads.assign(qfQuery.quads->begin(), qfQuery.quads->end());
+	};
+
+	const Benchmark::Result insert = Benchmark::Run("QuadField", "InsertObjects", NUM_OBJECTS, [&]() {
+		Benchmark::Rng rng(4);
+		uint64_t checksum = 0;
+
+		for (std::vector<int>& q: quadObjects) {
+			q.clear();
+		}
+
+		for (int i = 0; i < NUM_OBJECTS; i++) {
+			objects[i] = {RandomPos(rng), RandomDir(rng) * rng.NextFloat(0.5f, 8.0f), rng.NextFloat(8.0f, 96.0f), {}};
+			MoveObject(i);
+			checksum += SumQuads(objects[i].quads);
+		}
+
+		return checksum;
+	});
+
+	const Benchmark::Result move = Benchmark::Run("QuadField", "MoveObjects", NUM_OBJECTS * NUM_FRAMES, [&]() {
+		uint64_t checksum = 0;
+
+		for (int frame = 0; frame < NUM_FRAMES; frame++) {
+			for (int i = 0; i < NUM_OBJECTS; i++) {
+				MovingObject& o = objects[i];
+
+				o.pos += o.vel;
+
+				// bounce off the map edges
+				if (o.pos.x < 0.0f || o.pos.x > float3::maxxpos) o.vel.x = -o.vel.x;
+				if (o.pos.z < 0.0f || o.pos.z > float3::maxzpos) o.vel.z = -o.vel.z;
+
+				MoveObject(i);
+			}
+		}
+
+		// objects keep moving between runs, so only the membership invariant is stable
+		for (const MovingObject& o: objects) {
+			checksum += o.quads.size();
+		}
+		for (const std::vector<int>& q: quadObjects) {
+			checksum -= q.size();
+		}
+
+		return checksum;
+	});
+
+	CHECK(insert.deterministic);
+	CHECK(move.deterministic);
+	CHECK(move.checksum == 0);
+}
@@ -0,0 +1,170 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Game/TraceRay.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Misc/QuadField.h"
+#include "System/float3.h"
+
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+// TraceBeamShields reuses the shields TraceBeam gathered along the full beam
+// for a beam that got shortened, by clipping them to the quads on the shorter
+// segment. Here the shields of each quad are stand-in pointers (only compared,
+// never dereferenced) and the clipped sequence is checked against what walking
+// the shorter segment's quads directly, as TraceRayShields does, gives.
+
+static constexpr int MAP_SIZE_X = 1024; // squares
+static constexpr int MAP_SIZE_Z = 1024;
+static constexpr int QUAD_SIZE = 128;
+
+static constexpr int NUM_SHIELDS = 256;
+static constexpr int NUM_RAYS = 4096;
+
+
+struct ShieldQuads {
+	ShieldQuads(std::mt19937& rng): storage(NUM_SHIELDS) {
+		std::uniform_real_distribution<float> posDist(0.0f, MAP_SIZE_X * SQUARE_SIZE);
+		std::uniform_real_distribution<float> radDist(50.0f, 400.0f);
+
+		quadShields.resize(quadField.GetNumQuadsX() * quadField.GetNumQuadsZ());
+
+		// a shield is linked into every quad its sphere overlaps, like CPlasmaRepulser
+		for (int i = 0; i < NUM_SHIELDS; i++) {
+			QuadFieldQuery qfQuery;
+			quadField.GetQuads(qfQuery, float3(posDist(rng), 0.0f, posDist(rng)), radDist(rng));
+
+			for (const int quadIdx: *qfQuery.quads) {
+				quadShields[quadIdx].push_back(reinterpret_cast<CPlasmaRepulser*>(&storage[i]));
+			}
+		}
+	}
+
+	std::vector<CPlasmaRepulser*> TraceShields(const float3& pos, const float3& dir, float length) const {
+		std::vector<CPlasmaRepulser*> shields;
+
+		QuadFieldQuery qfQuery;
+		quadField.GetQuadsOnRay(qfQuery, pos, dir, length);
+
+		for (const int quadIdx: *qfQuery.quads) {
+			shields.insert(shields.end(), quadShields[quadIdx].begin(), quadShields[quadIdx].end());
+		}
+
+		return shields;
+	}
+
+	void GatherCorridor(const float3& pos, const float3& dir, float length, TraceRay::SBeamCorridor& corridor) const {
+		corridor.Clear();
+		corridor.pos = pos;
+		corridor.dir = dir;
+		corridor.length = length;
+
+		QuadFieldQuery qfQuery;
+		quadField.GetQuadsOnRay(qfQuery, pos, dir, length);
+
+		for (const int quadIdx: *qfQuery.quads) {
+			corridor.AddQuad(quadIdx);
+
+			for (CPlasmaRepulser* r: quadShields[quadIdx]) {
+				corridor.AddRepulser(r);
+			}
+		}
+
+		corridor.SetGathered();
+	}
+
+	std::vector<int> storage;
+	std::vector<std::vector<CPlasmaRepulser*>> quadShields;
+};
+
+
+static void InitQuadField()
+{
+	float3::maxxpos = MAP_SIZE_X * SQUARE_SIZE - 1.0f;
+	float3::maxzpos = MAP_SIZE_Z * SQUARE_SIZE - 1.0f;
+
+	quadField.Init(int2(MAP_SIZE_X, MAP_SIZE_Z), QUAD_SIZE);
+}
+
+
+TEST_CASE("BeamCorridor")
+{
+	InitQuadField();
+
+	std::mt19937 rng(87);
+	std::uniform_real_distribution<float> posDist(-256.0f, MAP_SIZE_X * SQUARE_SIZE + 256.0f);
+	std::uniform_real_distribution<float> dirDist(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> lenDist(16.0f, 3000.0f);
+	std::uniform_real_distribution<float> fracDist(0.0f, 1.0f);
+
+	const ShieldQuads shields(rng);
+
+	TraceRay::SBeamCorridor corridor;
+
+	int numClipped = 0;
+	int numNonEmpty = 0;
+
+	for (int n = 0; n < NUM_RAYS; n++) {
+		const float3 pos = {posDist(rng), dirDist(rng) * 100.0f, posDist(rng)};
+		const float3 dir = float3(dirDist(rng), dirDist(rng) * 0.2f, dirDist(rng) + 0.001f).Normalize();
+		const float length = lenDist(rng);
+
+		shields.GatherCorridor(pos, dir, length, corridor);
+
+		// the unclipped corridor is the full segment's walk
+		CHECK(corridor.repulsers == shields.TraceShields(pos, dir, length));
+
+		// BeamLaser shortens a beam to where it hit something, or to the
+		// corridor's start for sweeps; also cover the edges of that range
+		for (const float frac: {fracDist(rng), fracDist(rng) * 0.05f, 0.0f, 0.999f, 1.0f}) {
+			const float segLength = length * frac;
+			const std::vector<CPlasmaRepulser*> expected = shields.TraceShields(pos, dir, segLength);
+
+			QuadFieldQuery qfQuery;
+			quadField.GetQuadsOnRay(qfQuery, pos, dir, segLength);
+
+			std::vector<CPlasmaRepulser*> clipped;
+
+			const bool reused = corridor.ForEachRepulser(*qfQuery.quads, [&](CPlasmaRepulser* r) { clipped.push_back(r); });
+
+			// the quads on a shorter segment are always among the full one's
+			CHECK(reused);
+			CHECK(clipped == expected);
+
+			numClipped += reused;
+			numNonEmpty += !expected.empty();
+		}
+	}
+
+	CHECK(numClipped == NUM_RAYS * 5);
+	CHECK(numNonEmpty > NUM_RAYS);
+}
+
+TEST_CASE("BeamCorridorOutsideQuads")
+{
+	InitQuadField();
+
+	std::mt19937 rng(91);
+
+	const ShieldQuads shields(rng);
+
+	TraceRay::SBeamCorridor corridor;
+
+	const float3 pos = {100.0f, 0.0f, 100.0f};
+	const float3 dir = {1.0f, 0.0f, 0.0f};
+
+	shields.GatherCorridor(pos, dir, 1000.0f, corridor);
+
+	// a segment leaving the gathered quads must not be answered from them
+	QuadFieldQuery qfQuery;
+	quadField.GetQuadsOnRay(qfQuery, pos, float3(0.0f, 0.0f, 1.0f), 1000.0f);
+
+	int numVisited = 0;
+
+	CHECK_FALSE(corridor.ForEachRepulser(*qfQuery.quads, [&](CPlasmaRepulser* r) { numVisited += 1; }));
+	CHECK(numVisited == 0);
+}
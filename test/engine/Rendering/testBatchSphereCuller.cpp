@@ -0,0 +1,170 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Rendering/Common/BatchSphereCuller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+static constexpr int NUM_OBJECTS = 10001; // not a multiple of the SIMD width
+
+
+struct Sphere {
+	float3 midPos;
+	float3 lodPos;
+	float radius;
+};
+
+
+// CCamera::UpdateFrustum for a camera looking along <forward>
+static CCamera::Frustum MakeFrustum(const float3& forward, bool ortho)
+{
+	const float3 right = forward.cross(UpVector).Normalize();
+	const float3 up = right.cross(forward).Normalize();
+
+	const float tanHalfFov = std::tan(0.5f * 45.0f * math::DEG_TO_RAD);
+	const float aspectRatio = 16.0f / 9.0f;
+
+	CCamera::Frustum frustum;
+
+	if (ortho) {
+		frustum.scales = {1500.0f, 1000.0f, 0.0f, 6000.0f};
+
+		frustum.planes[CCamera::FRUSTUM_PLANE_TOP] =     up;
+		frustum.planes[CCamera::FRUSTUM_PLANE_BOT] =    -up;
+		frustum.planes[CCamera::FRUSTUM_PLANE_RGT] =  right;
+		frustum.planes[CCamera::FRUSTUM_PLANE_LFT] = -right;
+	} else {
+		frustum.scales = {0.0f, 0.0f, 1.0f, 8000.0f};
+
+		const float3 forwardy = (-forward *                                         tanHalfFov);
+		const float3 forwardx = (-forward * std::tan(aspectRatio * 0.5f * 45.0f * math::DEG_TO_RAD));
+
+		frustum.planes[CCamera::FRUSTUM_PLANE_TOP] = (forwardy +    up).Normalize();
+		frustum.planes[CCamera::FRUSTUM_PLANE_BOT] = (forwardy -    up).Normalize();
+		frustum.planes[CCamera::FRUSTUM_PLANE_RGT] = (forwardx + right).Normalize();
+		frustum.planes[CCamera::FRUSTUM_PLANE_LFT] = (forwardx - right).Normalize();
+	}
+
+	frustum.planes[CCamera::FRUSTUM_PLANE_FRN] = -forward;
+	frustum.planes[CCamera::FRUSTUM_PLANE_BCK] =  forward;
+
+	return frustum;
+}
+
+// CCamera::Frustum::IntersectSphere, which needs Camera.cpp
+static bool IntersectSphere(const CCamera::Frustum& frustum, const float3& cp, const float3& pos, float radius)
+{
+	const float3 vec = pos - cp;
+
+	const float xyPlaneOffsets[2] = {frustum.scales.x, frustum.scales.y};
+
+	for (unsigned int i = CCamera::FRUSTUM_PLANE_LFT; i < CCamera::FRUSTUM_PLANE_FRN; i++) {
+		if (vec.dot(frustum.planes[i]) > (xyPlaneOffsets[i >> 1] + radius))
+			return false;
+	}
+
+	return !(vec.dot(frustum.planes[CCamera::FRUSTUM_PLANE_BCK]) > (frustum.scales.w + radius));
+}
+
+static size_t CheckAgainstScalar(const std::vector<Sphere>& spheres, const CCamera::Frustum& frustum, const float3& camPos, float nearDistSq, float farDistSq)
+{
+	CBatchSphereCuller culler;
+	culler.Resize(spheres.size());
+
+	for (size_t i = 0; i < spheres.size(); i++) {
+		culler.SetObject(i, spheres[i].midPos, spheres[i].radius, spheres[i].lodPos);
+	}
+
+	culler.Cull(frustum, camPos, nearDistSq, farDistSq);
+
+	std::vector<int> expected[CBatchSphereCuller::LOD_CNT];
+
+	for (size_t i = 0; i < spheres.size(); i++) {
+		if (!IntersectSphere(frustum, camPos, spheres[i].midPos, spheres[i].radius))
+			continue;
+
+		const float sqDist = (spheres[i].lodPos - camPos).SqLength();
+
+		if (sqDist < nearDistSq) {
+			expected[CBatchSphereCuller::LOD_NEAR].push_back(i);
+		} else if (sqDist < farDistSq) {
+			expected[CBatchSphereCuller::LOD_FADE].push_back(i);
+		} else {
+			expected[CBatchSphereCuller::LOD_FAR].push_back(i);
+		}
+	}
+
+	size_t numVisible = 0;
+
+	for (int lod = CBatchSphereCuller::LOD_NEAR; lod < CBatchSphereCuller::LOD_CNT; lod++) {
+		CHECK(culler.GetVisible(lod) == expected[lod]);
+		numVisible += expected[lod].size();
+	}
+
+	// ranged culling as done by CModelDrawerDataBase, block size is a multiple of the SIMD width
+	const CBatchSphereCuller::View view(frustum, camPos, nearDistSq, farDistSq);
+
+	std::vector<uint8_t> lods(spheres.size(), 0xFF);
+	std::vector<int> rangeVisible[CBatchSphereCuller::LOD_CNT];
+
+	for (size_t begin = 0; begin < spheres.size(); begin += 12) {
+		culler.CullRange(view, begin, std::min(begin + 12, spheres.size()), lods.data());
+	}
+
+	for (size_t i = 0; i < spheres.size(); i++) {
+		REQUIRE(lods[i] <= CBatchSphereCuller::LOD_NONE);
+
+		if (lods[i] != CBatchSphereCuller::LOD_NONE)
+			rangeVisible[lods[i]].push_back(i);
+	}
+
+	for (int lod = CBatchSphereCuller::LOD_NEAR; lod < CBatchSphereCuller::LOD_CNT; lod++) {
+		CHECK(rangeVisible[lod] == expected[lod]);
+	}
+
+	return numVisible;
+}
+
+
+TEST_CASE("BatchSphereCuller")
+{
+	std::mt19937 rng(95);
+	std::uniform_real_distribution<float> xzDist(0.0f, 8192.0f);
+	std::uniform_real_distribution<float> yDist(-50.0f, 400.0f);
+	std::uniform_real_distribution<float> radiusDist(4.0f, 120.0f);
+	std::uniform_real_distribution<float> offsetDist(-20.0f, 20.0f);
+
+	std::vector<Sphere> spheres(NUM_OBJECTS);
+
+	for (Sphere& s: spheres) {
+		s.lodPos = {xzDist(rng), yDist(rng), xzDist(rng)};
+		s.midPos = s.lodPos + float3(offsetDist(rng), std::abs(offsetDist(rng)), offsetDist(rng));
+		s.radius = radiusDist(rng);
+	}
+
+	const float3 camPos = {4096.0f, 1800.0f, 1000.0f};
+	const float3 camDir = float3(0.1f, -0.6f, 1.0f).Normalize();
+
+	SECTION("Perspective") {
+		const size_t numVisible = CheckAgainstScalar(spheres, MakeFrustum(camDir, false), camPos, 1500.0f * 1500.0f, 3000.0f * 3000.0f);
+
+		CHECK(numVisible > 0);
+		CHECK(numVisible < spheres.size());
+	}
+	SECTION("Orthographic") {
+		const size_t numVisible = CheckAgainstScalar(spheres, MakeFrustum(camDir, true), camPos, std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity());
+
+		CHECK(numVisible > 0);
+		CHECK(numVisible < spheres.size());
+	}
+	SECTION("Empty") {
+		CHECK(CheckAgainstScalar({}, MakeFrustum(camDir, false), camPos, 1.0f, 2.0f) == 0);
+	}
+}
@@ -0,0 +1,63 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/DefNameIndex.h"
+
+#include <string>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+TEST_CASE("DefNameIndex")
+{
+	DefNameIndex index;
+
+	CHECK(index.Find("armcom") == -1);
+
+	std::vector<std::string> names;
+
+	// enough to rehash a few times
+	for (int i = 0; i < 1000; i++) {
+		names.push_back("unit" + std::to_string(i) + "_def");
+		index.Insert(names.back(), i + 1);
+	}
+
+	CHECK(index.GetSize() == names.size());
+
+	SECTION("Lookup") {
+		bool allFound = true;
+
+		for (size_t i = 0; i < names.size(); i++) {
+			allFound &= (index.Find(names[i]) == int(i + 1));
+		}
+
+		CHECK(allFound);
+	}
+
+	SECTION("CaseInsensitive") {
+		CHECK(index.Find("UNIT17_DEF") == 18);
+		CHECK(index.Find("Unit999_Def") == 1000);
+	}
+
+	SECTION("Missing") {
+		CHECK(index.Find("") == -1);
+		CHECK(index.Find("unit17") == -1);
+		CHECK(index.Find("unit17_def_") == -1);
+		CHECK(index.Find("unit1000_def") == -1);
+	}
+
+	SECTION("Reinsert") {
+		index.Insert("unit5_def", 4242);
+
+		CHECK(index.Find("unit5_def") == 4242);
+		CHECK(index.GetSize() == names.size());
+	}
+
+	SECTION("Clear") {
+		index.Clear();
+
+		CHECK(index.Find("unit5_def") == -1);
+		CHECK(index.GetSize() == 0);
+	}
+}
@@ -0,0 +1,87 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/OccupancyBitMap.h"
+
+#include <random>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+static constexpr int SIZE_X = 200;
+static constexpr int SIZE_Z = 150;
+
+
+static bool AnyInRectLinear(const std::vector<bool>& cells, int xmin, int xmax, int zmin, int zmax)
+{
+	for (int z = std::max(zmin, 0); z <= std::min(zmax, SIZE_Z - 1); z++) {
+		for (int x = std::max(xmin, 0); x <= std::min(xmax, SIZE_X - 1); x++) {
+			if (cells[z * SIZE_X + x])
+				return true;
+		}
+	}
+
+	return false;
+}
+
+
+TEST_CASE("OccupancyBitMap")
+{
+	std::mt19937 rng(4321);
+	std::uniform_int_distribution<int> xdist(-8, SIZE_X + 8);
+	std::uniform_int_distribution<int> zdist(-8, SIZE_Z + 8);
+	std::uniform_int_distribution<int> ldist(0, 80);
+
+	COccupancyBitMap bitMap;
+	std::vector<bool> cells(SIZE_X * SIZE_Z, false);
+
+	bitMap.Init(SIZE_X, SIZE_Z);
+
+	REQUIRE(!bitMap.AnyInRect(0, SIZE_X - 1, 0, SIZE_Z - 1));
+
+	// sparse, so that many queries hit empty rects
+	for (int i = 0; i < 60; i++) {
+		const int x = rng() % SIZE_X;
+		const int z = rng() % SIZE_Z;
+
+		bitMap.Set(x, z);
+		cells[z * SIZE_X + x] = true;
+	}
+
+	for (int i = 0; i < 20; i++) {
+		const int x = rng() % SIZE_X;
+		const int z = rng() % SIZE_Z;
+
+		bitMap.Reset(x, z);
+		cells[z * SIZE_X + x] = false;
+	}
+
+	for (int z = 0; z < SIZE_Z; z++) {
+		for (int x = 0; x < SIZE_X; x++) {
+			CHECK(bitMap.Test(x, z) == cells[z * SIZE_X + x]);
+		}
+	}
+
+	int numHits = 0;
+	int numMismatches = 0;
+
+	for (int i = 0; i < 20000; i++) {
+		const int xmin = xdist(rng);
+		const int zmin = zdist(rng);
+		const int xmax = xmin + ldist(rng);
+		const int zmax = zmin + ldist(rng) / 4;
+
+		const bool linear = AnyInRectLinear(cells, xmin, xmax, zmin, zmax);
+
+		numHits += linear;
+		numMismatches += (linear != bitMap.AnyInRect(xmin, xmax, zmin, zmax));
+	}
+
+	CHECK(numHits > 0);
+	CHECK(numHits < 20000);
+	CHECK(numMismatches == 0);
+
+	bitMap.Clear();
+	CHECK(!bitMap.AnyInRect(0, SIZE_X - 1, 0, SIZE_Z - 1));
+}
@@ -0,0 +1,148 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/PieceVolumeBVH.h"
+
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+static constexpr int NUM_PIECES = 64;
+static constexpr int NUM_TRACES = 20000;
+
+
+struct PieceBoxes {
+	std::vector<float3> mins;
+	std::vector<float3> maxs;
+};
+
+static float RandFloat(std::mt19937& rng, float lo, float hi)
+{
+	return std::uniform_real_distribution<float>(lo, hi)(rng);
+}
+
+static float3 RandFloat3(std::mt19937& rng, float lo, float hi)
+{
+	return {RandFloat(rng, lo, hi), RandFloat(rng, lo, hi), RandFloat(rng, lo, hi)};
+}
+
+static void RandomizeBoxes(std::mt19937& rng, PieceBoxes& boxes)
+{
+	boxes.mins.resize(NUM_PIECES);
+	boxes.maxs.resize(NUM_PIECES);
+
+	for (int i = 0; i < NUM_PIECES; i++) {
+		const float3 center = RandFloat3(rng, -60.0f, 60.0f);
+		const float3 hsize = RandFloat3(rng, 1.0f, 12.0f);
+
+		boxes.mins[i] = center - hsize;
+		boxes.maxs[i] = center + hsize;
+	}
+}
+
+// closest entry (lowest index on ties) via a linear scan, as the collision handler does without a tree
+static std::pair<int, float> TraceLinear(const PieceBoxes& boxes, const float3& p0, const float3& p1)
+{
+	std::pair<int, float> best = {-1, std::numeric_limits<float>::max()};
+
+	for (int i = 0; i < NUM_PIECES; i++) {
+		const float t = CPieceVolumeBVH::IntersectSegment(boxes.mins[i], boxes.maxs[i], p0, p1 - p0);
+
+		if (t > 1.0f || t >= best.second)
+			continue;
+
+		best = {i, t};
+	}
+
+	return best;
+}
+
+static std::pair<int, float> TraceTree(const CPieceVolumeBVH& bvh, const PieceBoxes& boxes, const float3& p0, const float3& p1)
+{
+	std::pair<int, float> best = {-1, std::numeric_limits<float>::max()};
+
+	float maxT = 1.0f;
+
+	bvh.Trace(p0, p1, maxT, [&](int i, float tEnter) {
+		const float t = CPieceVolumeBVH::IntersectSegment(boxes.mins[i], boxes.maxs[i], p0, p1 - p0);
+
+		if (t > 1.0f || t > best.second)
+			return true;
+		if (t == best.second && i > best.first)
+			return true;
+
+		best = {i, t};
+		maxT = t;
+		return true;
+	});
+
+	return best;
+}
+
+static void FitTree(CPieceVolumeBVH& bvh, const PieceBoxes& boxes)
+{
+	bvh.Resize(NUM_PIECES);
+
+	for (int i = 0; i < NUM_PIECES; i++) {
+		bvh.SetLeafBox(i, boxes.mins[i], boxes.maxs[i]);
+	}
+
+	bvh.Fit();
+}
+
+static void CheckTraces(std::mt19937& rng, const CPieceVolumeBVH& bvh, const PieceBoxes& boxes)
+{
+	int numHits = 0;
+	int numMismatches = 0;
+
+	for (int n = 0; n < NUM_TRACES; n++) {
+		const float3 p0 = RandFloat3(rng, -100.0f, 100.0f);
+		const float3 p1 = RandFloat3(rng, -100.0f, 100.0f);
+
+		const std::pair<int, float> linear = TraceLinear(boxes, p0, p1);
+		const std::pair<int, float> tree = TraceTree(bvh, boxes, p0, p1);
+
+		numHits += (linear.first >= 0);
+		numMismatches += (linear != tree);
+	}
+
+	CHECK(numHits > 0);
+	CHECK(numMismatches == 0);
+}
+
+
+TEST_CASE("PieceVolumeBVH")
+{
+	std::mt19937 rng(1234);
+
+	PieceBoxes boxes;
+	CPieceVolumeBVH bvh;
+
+	RandomizeBoxes(rng, boxes);
+	FitTree(bvh, boxes);
+
+	REQUIRE(bvh.GetNodes().size() == (NUM_PIECES * 2 - 1));
+	CheckTraces(rng, bvh, boxes);
+
+	// "animate" the pieces; the topology is kept and only refit
+	RandomizeBoxes(rng, boxes);
+	FitTree(bvh, boxes);
+
+	REQUIRE(bvh.GetNodes().size() == (NUM_PIECES * 2 - 1));
+	CheckTraces(rng, bvh, boxes);
+
+	for (const CPieceVolumeBVH::Node& node: bvh.GetNodes()) {
+		if (node.IsLeaf())
+			continue;
+
+		const CPieceVolumeBVH::Node& lft = bvh.GetNodes()[node.lft];
+		const CPieceVolumeBVH::Node& rgt = bvh.GetNodes()[node.rgt];
+
+		CHECK(node.mins == float3::min(lft.mins, rgt.mins));
+		CHECK(node.maxs == float3::max(lft.maxs, rgt.maxs));
+	}
+}
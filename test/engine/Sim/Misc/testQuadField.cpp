@@ -1,14 +1,106 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/QuadField.h"
 #include "System/float3.h"
+#include "System/float4.h"
 #include "System/SpringMath.h"
+#include "System/Threading/SpringThreading.h"
+#include "System/Threading/ThreadPool.h"
+#include <algorithm>
+#include <array>
 #include <stdlib.h>
 #include <time.h>
+#include <vector>
 
 #define CATCH_CONFIG_MAIN
 #include "lib/catch.hpp"
 
+
+// CUnit and friends can not be constructed in a unit test, so QuadField.cpp
+// is compiled right here against minimal stand-ins that only carry what the
+// quadfield touches; defining the real headers' include guards keeps those
+// out, and with them the object queries are compiled as in the engine
+#define UNIT_H
+#define _FEATURE_H
+#define PROJECTILE_H
+#define PLASMAREPULSER_H
+#define TEAMHANDLER_H
+
+struct StubColVol {
+	float GetBoundingRadius() const { return boundingRadius; }
+	template<typename T> float3 GetWorldSpacePos(const T* o) const { return (o->pos + offset); }
+
+	float3 offset;
+	float boundingRadius = 0.0f;
+};
+
+class CSolidObject {
+public:
+	CSolidObject() { mtTempNum.fill(-1); }
+
+	bool HasPhysicalStateBit(unsigned int bits) const { return ((physicalState & bits) != 0); }
+	bool HasCollidableStateBit(unsigned int bits) const { return ((collidableState & bits) != 0); }
+
+	int id = 0;
+	int allyteam = 0;
+	int tempNum = 0;
+
+	unsigned int physicalState = 1;
+	unsigned int collidableState = 1;
+
+	float3 pos;
+	float radius = 0.0f;
+
+	StubColVol collisionVolume;
+
+	std::array<int, ThreadPool::MAX_THREADS> mtTempNum;
+	std::vector<int> quads;
+};
+
+class CUnit: public CSolidObject {};
+class CFeature: public CSolidObject {};
+
+class CProjectile {
+public:
+	CProjectile() { mtTempNum.fill(-1); }
+
+	bool synced = true;
+	bool hitscan = false;
+	int tempNum = 0;
+	float radius = 0.0f;
+
+	float3 pos;
+	float3 dir;
+	float4 speed;
+
+	std::array<int, ThreadPool::MAX_THREADS> mtTempNum;
+	std::vector<int> quads;
+};
+
+class CPlasmaRepulser {
+public:
+	float GetRadius() const { return 0.0f; }
+	const std::vector<int>& GetQuads() const { return quads; }
+	void SetQuads(std::vector<int>&& q) { quads = std::move(q); }
+	void ClearQuads() { quads.clear(); }
+
+	int tempNum = 0;
+	float3 weaponMuzzlePos;
+	StubColVol collisionVolume;
+	std::vector<int> quads;
+};
+
+static struct {
+	int ActiveAllyTeams() const { return 1; }
+} teamHandler;
+
+static CGlobalSynced gsObj;
+CGlobalSynced* gs = &gsObj;
+
+#undef UNIT_TEST
+#include "Sim/Misc/QuadField.cpp"
+
 static inline float randf()
 {
 	return rand() / float(RAND_MAX);
@@ -99,3 +191,416 @@ TEST_CASE("QuadField")
 	INFO("Too little quads returned!");
 	CHECK_FALSE(fail);
 }
+
+
+
+TEST_CASE("QuadFieldNestedQueries")
+{
+	static constexpr int WIDTH  = 8;
+	static constexpr int HEIGHT = 8;
+	static constexpr int MAX_DEPTH = 16;
+
+	quadField.Init(int2(WIDTH, HEIGHT), SQUARE_SIZE);
+
+	// recursion mimics queries issued from callins during another query
+	const auto RunQueries = [](const auto& self, int depth) -> void {
+		if (depth == MAX_DEPTH)
+			return;
+
+		QuadFieldQuery qfQuery;
+		quadField.GetQuadsOnRay(qfQuery, float3(), float3(1.0f, 0.0f, 1.0f).Normalize(), (depth + 1) * SQUARE_SIZE * 0.5f);
+
+		CHECK(qfQuery.quads != nullptr);
+		CHECK_FALSE(qfQuery.quads->empty());
+
+		self(self, depth + 1);
+
+		// overlapping (non-LIFO) scopes must rewind as well
+		QuadFieldQuery qfQueryA;
+		QuadFieldQuery qfQueryB;
+		quadField.GetQuadsOnRay(qfQueryB, float3(), RgtVector, SQUARE_SIZE);
+		quadField.GetQuadsOnRay(qfQueryA, float3(), FwdVector, SQUARE_SIZE);
+	};
+
+	// warm up; nesting beyond the preallocated slots has to allocate once
+	RunQueries(RunQueries, 0);
+
+	quadField.ResetQueryAllocStats();
+
+	for (int n = 0; n < 100; ++n) {
+		RunQueries(RunQueries, 0);
+	}
+
+	const auto stats = quadField.GetQueryAllocStats();
+
+	CHECK(stats.numSlots >= MAX_DEPTH);
+	CHECK(stats.numSlotAllocs == 0);
+	CHECK(stats.numGrowAllocs == 0);
+}
+
+
+
+TEST_CASE("QuadFieldThreadedQueries")
+{
+	static constexpr int WIDTH  = 32;
+	static constexpr int HEIGHT = 32;
+	static constexpr int NUM_RECTS = 4096;
+	static constexpr int NUM_THREADS = std::min(4, ThreadPool::MAX_THREADS);
+
+	REQUIRE(NUM_THREADS > 1);
+
+	quadField.Init(int2(WIDTH, HEIGHT), SQUARE_SIZE);
+
+	std::vector<float3> mins(NUM_RECTS);
+	std::vector<float3> maxs(NUM_RECTS);
+	std::vector<std::vector<int>> expected(NUM_RECTS);
+	std::vector<std::vector<int>> results(NUM_RECTS);
+
+	for (int i = 0; i < NUM_RECTS; ++i) {
+		mins[i] = float3(randf() * WIDTH, 0.0f, randf() * HEIGHT) * SQUARE_SIZE;
+		maxs[i] = mins[i] + float3(randf() * WIDTH, 0.0f, randf() * HEIGHT) * SQUARE_SIZE * 0.25f;
+
+		QuadFieldQuery qfQuery;
+		quadField.GetQuadsRectangle(qfQuery, mins[i], maxs[i]);
+		expected[i] = *qfQuery.quads;
+	}
+
+	// same pattern as the multi-shape Lua area queries (for_mt over shapes), but
+	// on dedicated threads so they really overlap even on single-core machines:
+	// every thread tags its (nested) queries with its own number and thereby
+	// only ever touches its own arena
+	const auto RunQueries = [&](int threadNum) {
+		for (int i = threadNum; i < NUM_RECTS; i += NUM_THREADS) {
+			QuadFieldQuery outerQuery;
+			outerQuery.threadOwner = threadNum;
+			quadField.GetQuadsRectangle(outerQuery, mins[i], maxs[i]);
+
+			QuadFieldQuery innerQuery;
+			innerQuery.threadOwner = threadNum;
+			quadField.GetQuadsRectangle(innerQuery, mins[i], maxs[i]);
+
+			results[i] = *outerQuery.quads;
+
+			if (*innerQuery.quads != results[i])
+				results[i].clear();
+		}
+	};
+
+	std::vector<spring::thread> threads;
+
+	for (int n = 0; n < 100; ++n) {
+		for (int t = 1; t < NUM_THREADS; ++t) {
+			threads.emplace_back(RunQueries, t);
+		}
+
+		RunQueries(0);
+
+		for (spring::thread& t: threads) {
+			t.join();
+		}
+
+		threads.clear();
+	}
+
+	int numMismatches = 0;
+
+	for (int i = 0; i < NUM_RECTS; ++i) {
+		numMismatches += (results[i] != expected[i]);
+	}
+
+	CHECK(numMismatches == 0);
+}
+
+
+
+TEST_CASE("QuadFieldThreadedObjectQueries")
+{
+	static constexpr int WIDTH  = 32;
+	static constexpr int HEIGHT = 32;
+	static constexpr int NUM_OBJECTS = 1024;
+	static constexpr int NUM_QUERIES = 2048;
+	static constexpr int NUM_THREADS = std::min(4, ThreadPool::MAX_THREADS);
+
+	REQUIRE(NUM_THREADS > 1);
+
+	quadField.Init(int2(WIDTH, HEIGHT), SQUARE_SIZE);
+
+	// set by CReadMap in the engine, sphere queries clamp to it
+	float3::maxxpos = WIDTH  * SQUARE_SIZE - 1;
+	float3::maxzpos = HEIGHT * SQUARE_SIZE - 1;
+
+	std::vector<CUnit> units(NUM_OBJECTS);
+	std::vector<CFeature> features(NUM_OBJECTS);
+
+	// radii of up to two quads, so most objects are listed in several of them
+	for (int i = 0; i < NUM_OBJECTS; ++i) {
+		units[i].id = i;
+		units[i].pos = float3(randf() * WIDTH, 0.0f, randf() * HEIGHT) * SQUARE_SIZE;
+		units[i].radius = randf() * SQUARE_SIZE * 2.0f;
+		units[i].physicalState = 1 << (i & 1);
+		quadField.MovedUnit(&units[i]);
+
+		features[i].id = NUM_OBJECTS + i;
+		features[i].pos = float3(randf() * WIDTH, 0.0f, randf() * HEIGHT) * SQUARE_SIZE;
+		features[i].radius = randf() * SQUARE_SIZE * 2.0f;
+		quadField.AddFeature(&features[i]);
+	}
+
+	struct Query {
+		float3 pos;
+		float3 mins;
+		float3 maxs;
+		float radius;
+	};
+	struct Result {
+		std::vector<int> sphereUnits;
+		std::vector<int> rectUnits;
+		std::vector<int> solids;
+
+		bool operator == (const Result& r) const { return (sphereUnits == r.sphereUnits && rectUnits == r.rectUnits && solids == r.solids); }
+	};
+
+	std::vector<Query> queries(NUM_QUERIES);
+	std::vector<Result> expected(NUM_QUERIES);
+	std::vector<Result> results(NUM_QUERIES);
+
+	for (Query& q: queries) {
+		q.pos = float3(randf() * WIDTH, 0.0f, randf() * HEIGHT) * SQUARE_SIZE;
+		q.radius = randf() * SQUARE_SIZE * 4.0f;
+		q.mins = q.pos - float3(randf(), 0.0f, randf()) * SQUARE_SIZE * 4.0f;
+		q.maxs = q.pos + float3(randf(), 0.0f, randf()) * SQUARE_SIZE * 4.0f;
+	}
+
+	const auto GetIDs = [](const auto* objects) {
+		std::vector<int> ids;
+
+		for (const auto* o: *objects) {
+			ids.push_back(o->id);
+		}
+
+		// query order depends on quad order only, but keep the comparison independent of it
+		std::sort(ids.begin(), ids.end());
+		return ids;
+	};
+
+	const auto RunQuery = [&](const Query& q, int threadNum) {
+		Result r;
+
+		{
+			QuadFieldQuery qfQuery;
+			qfQuery.threadOwner = threadNum;
+			quadField.GetUnitsExact(qfQuery, q.pos, q.radius);
+			r.sphereUnits = GetIDs(qfQuery.units);
+		}
+		{
+			QuadFieldQuery qfQuery;
+			qfQuery.threadOwner = threadNum;
+			quadField.GetUnitsExact(qfQuery, q.mins, q.maxs);
+			r.rectUnits = GetIDs(qfQuery.units);
+		}
+		{
+			// only every other unit is in the queried physical state
+			QuadFieldQuery qfQuery;
+			qfQuery.threadOwner = threadNum;
+			quadField.GetSolidsExact(qfQuery, q.pos, q.radius, 1, 1);
+			r.solids = GetIDs(qfQuery.solids);
+		}
+
+		return r;
+	};
+
+	for (int i = 0; i < NUM_QUERIES; ++i) {
+		expected[i] = RunQuery(queries[i], 0);
+	}
+
+	// overlapping queries on dedicated threads, each tagged with its own
+	// number; the de-duplication marks of one thread must never make
+	// another skip (or repeat) an object spanning several quads
+	const auto RunQueries = [&](int threadNum) {
+		for (int i = threadNum; i < NUM_QUERIES; i += NUM_THREADS) {
+			results[i] = RunQuery(queries[i], threadNum);
+		}
+	};
+
+	std::vector<spring::thread> threads;
+
+	for (int n = 0; n < 20; ++n) {
+		for (int t = 1; t < NUM_THREADS; ++t) {
+			threads.emplace_back(RunQueries, t);
+		}
+
+		RunQueries(0);
+
+		for (spring::thread& t: threads) {
+			t.join();
+		}
+
+		threads.clear();
+	}
+
+	int numEmpty = 0;
+	int numMismatches = 0;
+
+	for (int i = 0; i < NUM_QUERIES; ++i) {
+		numEmpty += expected[i].sphereUnits.empty();
+		numMismatches += !(results[i] == expected[i]);
+	}
+
+	CHECK(numEmpty < NUM_QUERIES);
+	CHECK(numMismatches == 0);
+
+	for (CUnit& u: units) {
+		quadField.RemoveUnit(&u);
+	}
+	for (CFeature& f: features) {
+		quadField.RemoveFeature(&f);
+	}
+}
+
+
+
+TEST_CASE("QuadFieldExplosionJoin")
+{
+	static constexpr int WIDTH  = 64;
+	static constexpr int HEIGHT = 64;
+	static constexpr int QUAD_SIZE = SQUARE_SIZE * 4;
+	static constexpr int NUM_OBJECTS = 512;
+	static constexpr int NUM_EXPLOSIONS = 256;
+
+	quadField.Init(int2(WIDTH, HEIGHT), QUAD_SIZE);
+
+	float3::maxxpos = WIDTH  * SQUARE_SIZE - 1;
+	float3::maxzpos = HEIGHT * SQUARE_SIZE - 1;
+
+	std::vector<CUnit> units(NUM_OBJECTS);
+	std::vector<CFeature> features(NUM_OBJECTS);
+
+	const auto InitObject = [](CSolidObject& o, int id) {
+		o.id = id;
+		o.pos = float3(randf() * WIDTH, randf() * 4.0f, randf() * HEIGHT) * SQUARE_SIZE;
+		o.radius = (0.25f + randf() * 4.0f) * SQUARE_SIZE;
+		o.collisionVolume.offset = float3(randf() - 0.5f, randf(), randf() - 0.5f) * o.radius;
+		o.collisionVolume.boundingRadius = o.radius * 0.75f;
+	};
+
+	for (int i = 0; i < NUM_OBJECTS; ++i) {
+		InitObject(units[i], i);
+		quadField.MovedUnit(&units[i]);
+
+		InitObject(features[i], NUM_OBJECTS + i);
+		quadField.AddFeature(&features[i]);
+	}
+
+	// volleys land in clusters, so many explosions overlap (some exactly)
+	std::vector<float4> explosions;
+
+	while (explosions.size() < NUM_EXPLOSIONS) {
+		const float3 center = float3(randf() * 1.2f - 0.1f, 0.0f, randf() * 1.2f - 0.1f) * float3(WIDTH, 0.0f, HEIGHT) * SQUARE_SIZE;
+
+		for (int n = 0; n < 8; ++n) {
+			explosions.emplace_back(center + float3(randf() - 0.5f, randf() * 0.25f, randf() - 0.5f) * QUAD_SIZE * 2.0f, (0.5f + randf() * 10.0f) * SQUARE_SIZE);
+		}
+
+		explosions.push_back(explosions.back());
+	}
+
+	// stand-in for the distance and impulse-direction terms of an explosion
+	// hit (CGameHelper::CalcExplosionHit), and the damage and impulse the
+	// engine derives from them (CGameHelper::DoExplosionDamage)
+	struct Hit {
+		float3 volPos;
+		float expDist;
+	};
+	struct Effect {
+		int id;
+		float damage;
+		float3 impulse;
+
+		bool operator == (const Effect& e) const {
+			return (id == e.id && damage == e.damage && impulse.x == e.impulse.x && impulse.y == e.impulse.y && impulse.z == e.impulse.z);
+		}
+	};
+
+	const auto CalcHit = [](const CSolidObject* o, const float4& e) -> Hit {
+		const float3 volPos = o->collisionVolume.GetWorldSpacePos(o);
+		return {volPos, std::max(0.0f, volPos.distance(e) - o->collisionVolume.GetBoundingRadius())};
+	};
+	const auto ApplyHit = [](const CSolidObject* o, const Hit& hit, const float4& e, std::vector<Effect>& effects) {
+		if (hit.expDist > e.w)
+			return;
+
+		const float expRim = hit.expDist * 0.25f;
+		const float expDistanceMod = (e.w + 0.001f - hit.expDist) / (e.w + 0.001f - expRim);
+
+		effects.push_back({o->id, 100.0f * expDistanceMod, (hit.volPos - e).SafeNormalize() * (50.0f * expDistanceMod)});
+	};
+
+	// per-explosion path: one query per explosion, terms computed on use
+	std::vector<Effect> expected;
+
+	for (const float4& e: explosions) {
+		std::vector<CUnit*> unitCache;
+		std::vector<CFeature*> featureCache;
+
+		quadField.GetUnitsAndFeaturesColVol(e, e.w, unitCache, featureCache);
+
+		for (const CUnit* u: unitCache) {
+			ApplyHit(u, CalcHit(u, e), e, expected);
+		}
+		for (const CFeature* f: featureCache) {
+			ApplyHit(f, CalcHit(f, e), e, expected);
+		}
+	}
+
+	// batched path: one join for all explosions, terms computed up front
+	std::vector<CUnit*> batchUnits;
+	std::vector<CFeature*> batchFeatures;
+	std::vector<int2> unitRanges;
+	std::vector<int2> featureRanges;
+
+	quadField.GetUnitsAndFeaturesColVol(explosions, batchUnits, unitRanges, batchFeatures, featureRanges);
+
+	REQUIRE(unitRanges.size() == explosions.size());
+	REQUIRE(featureRanges.size() == explosions.size());
+
+	std::vector<Hit> unitHits(batchUnits.size());
+	std::vector<Hit> featureHits(batchFeatures.size());
+
+	for (size_t i = 0; i < explosions.size(); ++i) {
+		for (int n = unitRanges[i].x; n < unitRanges[i].y; ++n) {
+			unitHits[n] = CalcHit(batchUnits[n], explosions[i]);
+		}
+		for (int n = featureRanges[i].x; n < featureRanges[i].y; ++n) {
+			featureHits[n] = CalcHit(batchFeatures[n], explosions[i]);
+		}
+	}
+
+	std::vector<Effect> results;
+
+	for (size_t i = 0; i < explosions.size(); ++i) {
+		for (int n = unitRanges[i].x; n < unitRanges[i].y; ++n) {
+			ApplyHit(batchUnits[n], unitHits[n], explosions[i], results);
+		}
+		for (int n = featureRanges[i].x; n < featureRanges[i].y; ++n) {
+			ApplyHit(batchFeatures[n], featureHits[n], explosions[i], results);
+		}
+	}
+
+	int numMultiQuadUnits = 0;
+
+	for (const CUnit& u: units) {
+		numMultiQuadUnits += (u.quads.size() > 1);
+	}
+
+	CHECK(numMultiQuadUnits > NUM_OBJECTS / 4);
+	CHECK(expected.size() > NUM_EXPLOSIONS);
+	CHECK(results.size() == expected.size());
+	CHECK(results == expected);
+
+	for (CUnit& u: units) {
+		quadField.RemoveUnit(&u);
+	}
+	for (CFeature& f: features) {
+		quadField.RemoveFeature(&f);
+	}
+}
@@ -0,0 +1,157 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/SlowUpdateScheduler.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+// mirrors CUnitHandler::SlowUpdateUnits, returns the number of units updated per frame of a cycle
+static std::vector<int> RunCycle(CSlowUpdateScheduler& scheduler, int cycleFrame, const std::vector<int>& unitCosts)
+{
+	std::vector<int> frameUnits;
+
+	int cycleCost = 0;
+	int doneCost = 0;
+
+	for (const int c: unitCosts) {
+		cycleCost += c;
+	}
+
+	scheduler.BeginCycle(cycleFrame, cycleCost);
+
+	size_t idx = 0;
+
+	for (int frameNum = cycleFrame; frameNum < cycleFrame + CSlowUpdateScheduler::CYCLE_LENGTH; frameNum++) {
+		const size_t idxBeg = idx;
+
+		if (CSlowUpdateScheduler::IsCycleEnd(frameNum)) {
+			idx = unitCosts.size();
+		} else {
+			while (idx < unitCosts.size() && doneCost < scheduler.GetStaggeredBudget(frameNum)) {
+				doneCost += unitCosts[idx++];
+			}
+		}
+
+		frameUnits.push_back(idx - idxBeg);
+	}
+
+	return frameUnits;
+}
+
+
+TEST_CASE("SlowUpdateScheduler")
+{
+	CSlowUpdateScheduler scheduler;
+
+	// a mix of unarmed and armed units
+	std::vector<int> unitCosts(3000);
+
+	for (size_t i = 0; i < unitCosts.size(); i++) {
+		unitCosts[i] = CSlowUpdateScheduler::GetUnitCost(i % 4);
+	}
+
+	const int maxUnitCost = CSlowUpdateScheduler::GetUnitCost(3);
+
+	const auto FrameCost = [&](int cycleFrame, const std::vector<int>& frameUnits, int frame) {
+		int cost = scheduler.GetFixedCost(cycleFrame + frame);
+		int unit = 0;
+
+		for (int i = 0; i < frame; i++) {
+			unit += frameUnits[i];
+		}
+		for (int i = 0; i < frameUnits[frame]; i++) {
+			cost += unitCosts[unit + i];
+		}
+
+		return cost;
+	};
+
+	SECTION("Staggered") {
+		const std::vector<int> frameUnits = RunCycle(scheduler, 0, unitCosts);
+
+		size_t numUnits = 0;
+
+		for (int i = 0; i < CSlowUpdateScheduler::CYCLE_LENGTH; i++) {
+			CHECK(scheduler.GetFixedCost(i) == 0);
+			numUnits += frameUnits[i];
+		}
+
+		CHECK(numUnits == unitCosts.size());
+		CHECK(scheduler.GetStaggeredBudget(CSlowUpdateScheduler::CYCLE_LENGTH - 1) == scheduler.GetCycleCost());
+
+		// without fixed work every frame gets an equal share
+		const int frameCost = scheduler.GetCycleCost() / CSlowUpdateScheduler::CYCLE_LENGTH;
+
+		for (int i = 0; i < CSlowUpdateScheduler::CYCLE_LENGTH; i++) {
+			CHECK(std::abs(FrameCost(0, frameUnits, i) - frameCost) <= maxUnitCost);
+		}
+	}
+
+	SECTION("Fixed") {
+		const int teamCost = 16 * CSlowUpdateScheduler::TEAM_COST;
+		const int interceptCost = 20 * 40 * CSlowUpdateScheduler::INTERCEPT_PAIR_COST;
+
+		scheduler.SetCategoryCost(CSlowUpdateScheduler::CATEGORY_TEAMS, teamCost);
+		scheduler.SetCategoryCost(CSlowUpdateScheduler::CATEGORY_INTERCEPTS, interceptCost);
+
+		// teams run every other cycle
+		for (const int cycleFrame: {TEAM_SLOWUPDATE_RATE, TEAM_SLOWUPDATE_RATE + UNIT_SLOWUPDATE_RATE}) {
+			const std::vector<int> frameUnits = RunCycle(scheduler, cycleFrame, unitCosts);
+			const int fixedCost = interceptCost + teamCost * ((cycleFrame % TEAM_SLOWUPDATE_RATE) == 0);
+
+			CHECK(scheduler.GetFixedCost(cycleFrame) == fixedCost);
+			CHECK(scheduler.GetFixedCost(cycleFrame + 1) == 0);
+
+			size_t numUnits = 0;
+			int maxFrameCost = 0;
+			int minFrameCost = FrameCost(cycleFrame, frameUnits, 0);
+
+			for (int i = 0; i < CSlowUpdateScheduler::CYCLE_LENGTH; i++) {
+				numUnits += frameUnits[i];
+				maxFrameCost = std::max(maxFrameCost, FrameCost(cycleFrame, frameUnits, i));
+				minFrameCost = std::min(minFrameCost, FrameCost(cycleFrame, frameUnits, i));
+			}
+
+			CHECK(numUnits == unitCosts.size());
+			CHECK(frameUnits[0] < frameUnits[1]);
+
+			// first frame no longer carries the fixed work on top of its share
+			CHECK((maxFrameCost - minFrameCost) <= (maxUnitCost * 2));
+		}
+	}
+
+	SECTION("Overloaded") {
+		// more fixed work in the first frame than the average frame would do,
+		// that frame gets no units and the others share them evenly
+		scheduler.SetCategoryCost(CSlowUpdateScheduler::CATEGORY_INTERCEPTS, 1000000);
+
+		const std::vector<int> frameUnits = RunCycle(scheduler, UNIT_SLOWUPDATE_RATE, unitCosts);
+		const int frameCost = scheduler.GetCycleCost() / (CSlowUpdateScheduler::CYCLE_LENGTH - 1);
+
+		size_t numUnits = 0;
+
+		for (int i = 0; i < CSlowUpdateScheduler::CYCLE_LENGTH; i++) {
+			numUnits += frameUnits[i];
+		}
+		for (int i = 1; i < CSlowUpdateScheduler::CYCLE_LENGTH; i++) {
+			CHECK(std::abs(FrameCost(UNIT_SLOWUPDATE_RATE, frameUnits, i) - frameCost) <= (maxUnitCost * 2));
+		}
+
+		CHECK(frameUnits[0] == 0);
+		CHECK(numUnits == unitCosts.size());
+	}
+
+	SECTION("Empty") {
+		const std::vector<int> frameUnits = RunCycle(scheduler, 0, {});
+
+		for (int i = 0; i < CSlowUpdateScheduler::CYCLE_LENGTH; i++) {
+			CHECK(frameUnits[i] == 0);
+			CHECK(scheduler.GetStaggeredBudget(i) == 0);
+		}
+	}
+}
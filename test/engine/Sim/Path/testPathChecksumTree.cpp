@@ -0,0 +1,97 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Path/Default/PathChecksumTree.h"
+
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+static constexpr int NUM_PATH_TYPES = 5;
+static constexpr int NUM_BLOCK_VERTICES = 4;
+
+static const int2 NUM_BLOCKS = {37, 29};
+
+
+struct EstimatorData {
+	EstimatorData() {
+		const int numBlocks = NUM_BLOCKS.x * NUM_BLOCKS.y;
+
+		nodeOffsets.resize(NUM_PATH_TYPES);
+		vertexCosts.resize(NUM_PATH_TYPES * numBlocks * NUM_BLOCK_VERTICES);
+
+		for (int pathType = 0; pathType < NUM_PATH_TYPES; pathType++) {
+			nodeOffsets[pathType].resize(numBlocks);
+
+			for (int blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+				nodeOffsets[pathType][blockIdx] = short2((blockIdx * 7 + pathType) % 16, (blockIdx * 3) % 16);
+			}
+		}
+		for (size_t i = 0; i < vertexCosts.size(); i++) {
+			vertexCosts[i] = (i % 13) * 0.5f;
+		}
+	}
+
+	PathChecksumTree Calc() const {
+		PathChecksumTree tree;
+		tree.Calc(nodeOffsets, vertexCosts, NUM_BLOCKS, NUM_BLOCK_VERTICES);
+		return tree;
+	}
+
+	std::vector< std::vector<short2> > nodeOffsets;
+	std::vector<float> vertexCosts;
+};
+
+
+TEST_CASE("PathChecksumTreeLayout")
+{
+	const EstimatorData data;
+	const PathChecksumTree tree = data.Calc();
+
+	// 29 rows in stripes of ceil(29 / 8) = 4 rows
+	CHECK(tree.GetNumPathTypes() == NUM_PATH_TYPES);
+	CHECK(tree.GetRegionRows() == 4);
+	CHECK(tree.GetNumRegions() == 8);
+	CHECK(tree.GetChecksum() == PathChecksumTree::ReduceDigest(tree.GetDigest()));
+
+	const PathChecksumTree again = data.Calc();
+
+	CHECK(again.GetDigest() == tree.GetDigest());
+}
+
+
+TEST_CASE("PathChecksumTreeLocality")
+{
+	EstimatorData data;
+	const PathChecksumTree tree = data.Calc();
+
+	// change one vertex cost of a block in the sixth region of the third path-type
+	const int pathType = 2;
+	const int blockIdx = 21 * NUM_BLOCKS.x + 10;
+	const int region = 21 / tree.GetRegionRows();
+
+	data.vertexCosts[(pathType * NUM_BLOCKS.x * NUM_BLOCKS.y + blockIdx) * NUM_BLOCK_VERTICES + 1] += 1.0f;
+
+	const PathChecksumTree costTree = data.Calc();
+
+	CHECK(costTree.GetChecksum() != tree.GetChecksum());
+
+	for (int p = 0; p < NUM_PATH_TYPES; p++) {
+		CHECK((costTree.GetPathTypeChecksum(p) != tree.GetPathTypeChecksum(p)) == (p == pathType));
+
+		for (int r = 0; r < tree.GetNumRegions(); r++) {
+			CHECK((costTree.GetRegionChecksum(p, r) != tree.GetRegionChecksum(p, r)) == (p == pathType && r == region));
+		}
+	}
+
+	// offsets are covered by the same leaves
+	data.vertexCosts[(pathType * NUM_BLOCKS.x * NUM_BLOCKS.y + blockIdx) * NUM_BLOCK_VERTICES + 1] -= 1.0f;
+	data.nodeOffsets[0][0].x += 1;
+
+	const PathChecksumTree offsetTree = data.Calc();
+
+	CHECK(offsetTree.GetRegionChecksum(0, 0) != tree.GetRegionChecksum(0, 0));
+	CHECK(offsetTree.GetRegionChecksum(0, 1) == tree.GetRegionChecksum(0, 1));
+	CHECK(offsetTree.GetPathTypeChecksum(pathType) == tree.GetPathTypeChecksum(pathType));
+}
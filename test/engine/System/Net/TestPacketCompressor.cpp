@@ -0,0 +1,136 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Net/Protocol/BaseNetProtocol.h"
+#include "System/Net/PacketCompressor.h"
+#include "System/Net/ProtocolDef.h"
+#include "System/Net/RawPacket.h"
+
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+using netcode::PacketCompressor;
+
+
+static void AddPacket(std::vector<uint8_t>& buffer, const CBaseNetProtocol::PacketType& packet)
+{
+	buffer.insert(buffer.end(), packet->data, packet->data + packet->length);
+}
+
+// a typical server batch: the frames of half a second plus a few orders
+static std::vector<uint8_t> MakeBatch(int frameNum)
+{
+	CBaseNetProtocol& proto = CBaseNetProtocol::Get();
+	std::vector<uint8_t> batch;
+
+	const std::vector<int16_t> unitIDs = {int16_t(frameNum & 1023), 117, 118};
+	const float params[] = {frameNum * 1.5f, 87.25f, 3100.0f - frameNum};
+
+	AddPacket(batch, proto.SendSelect(3, unitIDs));
+	AddPacket(batch, proto.SendCommand(3, 10, INT32_MAX, 1 << 5, 3, params));
+	AddPacket(batch, proto.SendCommand(3, 16, INT32_MAX, 0, 3, params));
+
+	for (int i = frameNum; i < (frameNum + 16); i++) {
+		AddPacket(batch, ((i % 16) == 0)? proto.SendKeyFrame(i): proto.SendNewFrame());
+	}
+
+	AddPacket(batch, proto.SendSyncResponse(3, frameNum, 0xDEADBEEF));
+	return batch;
+}
+
+
+TEST_CASE("PacketCompressor")
+{
+	const std::vector<uint8_t>& dictionary = CBaseNetProtocol::Get().GetPacketDictionary();
+
+	PacketCompressor compressor(dictionary, PACKET_DICTIONARY_ID);
+	PacketCompressor receiver(dictionary, PACKET_DICTIONARY_ID);
+
+	REQUIRE(!dictionary.empty());
+
+	SECTION("RoundTrip") {
+		for (const int frameNum: {0, 16, 4096, 123456}) {
+			const std::vector<uint8_t> batch = MakeBatch(frameNum);
+
+			std::vector<uint8_t> packed;
+			std::vector<uint8_t> unpacked;
+
+			REQUIRE(compressor.Pack(batch.data(), batch.size(), packed));
+			CHECK(packed.size() < batch.size());
+
+			// a packed batch is a regular message
+			CHECK(netcode::ProtocolDef::GetInstance()->IsValidPacket(packed.data(), packed.size()));
+			CHECK(packed[0] == NETMSG_PACKED);
+
+			REQUIRE(receiver.Unpack(packed.data(), packed.size(), unpacked));
+			CHECK(unpacked == batch);
+		}
+	}
+
+	SECTION("Dictionary") {
+		PacketCompressor plain({}, 0);
+
+		const std::vector<uint8_t> batch = MakeBatch(4096);
+
+		std::vector<uint8_t> packed;
+		std::vector<uint8_t> plainPacked;
+
+		REQUIRE(compressor.Pack(batch.data(), batch.size(), packed));
+		REQUIRE(plain.Pack(batch.data(), batch.size(), plainPacked));
+
+		// small batches are where the dictionary matters
+		CHECK(packed.size() < plainPacked.size());
+	}
+
+	SECTION("Independent") {
+		// every block decodes on its own, in any order
+		const std::vector<uint8_t> batchA = MakeBatch(16);
+		const std::vector<uint8_t> batchB = MakeBatch(32);
+
+		std::vector<uint8_t> blocks;
+		std::vector<uint8_t> unpacked;
+
+		REQUIRE(compressor.Deflate(batchA.data(), batchA.size(), blocks));
+		const size_t sizeA = blocks.size();
+		REQUIRE(compressor.Deflate(batchB.data(), batchB.size(), blocks));
+
+		REQUIRE(receiver.Inflate(blocks.data() + sizeA, blocks.size() - sizeA, batchB.size(), unpacked));
+		REQUIRE(receiver.Inflate(blocks.data(), sizeA, batchA.size(), unpacked));
+
+		CHECK(std::equal(batchB.begin(), batchB.end(), unpacked.begin()));
+		CHECK(std::equal(batchA.begin(), batchA.end(), unpacked.begin() + batchB.size()));
+	}
+
+	SECTION("Rejected") {
+		const std::vector<uint8_t> batch = MakeBatch(64);
+
+		std::vector<uint8_t> packed;
+		std::vector<uint8_t> unpacked;
+
+		// too small to be worth it
+		CHECK(!compressor.Pack(batch.data(), PacketCompressor::minPackSize - 1, packed));
+
+		REQUIRE(compressor.Pack(batch.data(), batch.size(), packed));
+
+		// unknown dictionary
+		PacketCompressor other(dictionary, PACKET_DICTIONARY_ID + 1);
+		CHECK(!other.Unpack(packed.data(), packed.size(), unpacked));
+
+		// truncated
+		CHECK(!receiver.Unpack(packed.data(), packed.size() - 1, unpacked));
+
+		// corrupted payload
+		std::vector<uint8_t> corrupt = packed;
+		corrupt[PacketCompressor::headerSize] ^= 0xFF;
+		corrupt[PacketCompressor::headerSize + 1] ^= 0xFF;
+		CHECK(!receiver.Unpack(corrupt.data(), corrupt.size(), unpacked));
+
+		// wrong rawSize
+		corrupt = packed;
+		corrupt[4] += 1;
+		CHECK(!receiver.Unpack(corrupt.data(), corrupt.size(), unpacked));
+
+		CHECK(unpacked.empty());
+	}
+}
@@ -0,0 +1,204 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/Config/ConfigHandle.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
+#include "System/StringUtil.h"
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+InitSpringTime ist;
+
+ConfigHandler* configHandler = nullptr;
+
+// defined in ConfigHandler.cpp, which drags in the whole source chain
+bool ConfigHandler::Get(const std::string& key) const { return StringToBool(GetString(key)); }
+
+
+/**
+ * In-memory stand-in for ConfigHandlerImpl: values are resolved by walking
+ * a list of layered sources (overlay, user, defaults) and observers are
+ * notified on Update(), as in the real handler.
+ */
+class TestConfigHandler: public ConfigHandler
+{
+public:
+	TestConfigHandler() {
+		for (int i = 0; i < 64; i++) {
+			sources[DEFAULT_SOURCE]["Filler" + std::to_string(i)] = std::to_string(i);
+		}
+
+		sources[DEFAULT_SOURCE]["IntVar"] = "42";
+		sources[DEFAULT_SOURCE]["FloatVar"] = "0.5";
+		sources[DEFAULT_SOURCE]["BoolVar"] = "0";
+	}
+
+	void SetString(const std::string& key, const std::string& value, bool useOverlay, bool notify) override {
+		sources[useOverlay? OVERLAY_SOURCE: USER_SOURCE][key] = value;
+
+		if (notify)
+			changedValues[key] = value;
+	}
+	std::string GetString(const std::string& key) const override {
+		for (const auto& source: sources) {
+			const auto it = source.find(key);
+
+			if (it != source.end())
+				return it->second;
+		}
+
+		throw std::runtime_error("unknown config key " + key);
+	}
+
+	bool IsSet(const std::string& key) const override {
+		for (const auto& source: sources) {
+			if (source.find(key) != source.end())
+				return true;
+		}
+
+		return false;
+	}
+	bool IsReadOnly(const std::string& key) const override { return false; }
+	void Delete(const std::string& key) override { sources[USER_SOURCE].erase(key); }
+
+	std::string GetConfigFile() const override { return ""; }
+	const std::map<std::string, std::string> GetData() const override { return sources[DEFAULT_SOURCE]; }
+	std::map<std::string, std::string> GetDataWithoutDefaults() const override { return sources[USER_SOURCE]; }
+
+	void Update() override {
+		for (const auto& p: changedValues) {
+			for (const auto& ncb: callbacks) {
+				if (ncb.first == p.first)
+					ncb.second.first(p.first, p.second);
+			}
+		}
+
+		changedValues.clear();
+	}
+	void EnableWriting(bool write) override {}
+
+	size_t GetNumObservers() const { return callbacks.size(); }
+
+protected:
+	void AddObserver(ConfigNotifyCallback callback, void* observer, const std::vector<std::string>& configs) override {
+		for (const std::string& config: configs) {
+			callbacks.emplace_back(config, std::make_pair(callback, observer));
+		}
+	}
+	void RemoveObserver(void* observer) override {
+		for (size_t i = 0; i < callbacks.size(); ) {
+			if (callbacks[i].second.second == observer) {
+				callbacks[i] = callbacks.back();
+				callbacks.pop_back();
+				continue;
+			}
+
+			i++;
+		}
+	}
+
+private:
+	enum {
+		OVERLAY_SOURCE = 0,
+		USER_SOURCE    = 1,
+		DEFAULT_SOURCE = 2,
+	};
+
+	std::array<std::map<std::string, std::string>, 3> sources;
+	std::map<std::string, std::string> changedValues;
+
+	std::vector< std::pair<std::string, std::pair<ConfigNotifyCallback, void*> > > callbacks;
+};
+
+
+
+TEST_CASE("ConfigHandle")
+{
+	TestConfigHandler testConfigHandler;
+	configHandler = &testConfigHandler;
+
+	{
+		ConfigHandle<int> intVar("IntVar");
+		ConfigHandle<float> floatVar("FloatVar");
+		ConfigHandle<bool> boolVar("BoolVar");
+
+		CHECK(intVar.Get() == 42);
+		CHECK(floatVar.Get() == 0.5f);
+		CHECK(boolVar.Get() == false);
+		CHECK(testConfigHandler.GetNumObservers() == 3);
+
+		// cached values only change once notifications are delivered
+		configHandler->Set("IntVar", 7);
+		configHandler->Set("BoolVar", 1, true);
+		CHECK(intVar.Get() == 42);
+
+		configHandler->Update();
+		CHECK(intVar.Get() == configHandler->GetInt("IntVar"));
+		CHECK(intVar.Get() == 7);
+		CHECK(boolVar.Get() == configHandler->GetBool("BoolVar"));
+		CHECK(floatVar.Get() == 0.5f);
+
+		// an overlay value takes precedence over the one set afterwards without it
+		configHandler->Set("IntVar", 9, true);
+		configHandler->Set("IntVar", 11, false);
+		configHandler->Update();
+		CHECK(intVar.Get() == configHandler->GetInt("IntVar"));
+		CHECK(intVar.Get() == 9);
+
+		intVar.Unbind();
+		CHECK(testConfigHandler.GetNumObservers() == 2);
+	}
+
+	CHECK(testConfigHandler.GetNumObservers() == 0);
+	configHandler = nullptr;
+}
+
+
+TEST_CASE("ConfigHandleBenchmark")
+{
+	TestConfigHandler testConfigHandler;
+	configHandler = &testConfigHandler;
+
+	constexpr int NUM_READS = 2000000;
+
+	ConfigHandle<int> intVar("IntVar");
+	ConfigHandle<float> floatVar("FloatVar");
+
+	int64_t sumUncached = 0;
+	int64_t sumCached = 0;
+
+	const spring_time t0 = spring_gettime();
+
+	for (int i = 0; i < NUM_READS; i++) {
+		sumUncached += configHandler->GetInt("IntVar");
+		sumUncached += static_cast<int>(configHandler->GetFloat("FloatVar") * 2.0f);
+	}
+
+	const spring_time t1 = spring_gettime();
+
+	for (int i = 0; i < NUM_READS; i++) {
+		sumCached += intVar.Get();
+		sumCached += static_cast<int>(floatVar.Get() * 2.0f);
+	}
+
+	const spring_time t2 = spring_gettime();
+
+	const float uncachedNs = (t1 - t0).toNanoSecsf() / (NUM_READS * 2);
+	const float cachedNs = (t2 - t1).toNanoSecsf() / (NUM_READS * 2);
+
+	LOG("[ConfigHandle] uncached=%.2fns/read cached=%.2fns/read (%.0fx)", uncachedNs, cachedNs, uncachedNs / std::max(cachedNs, 0.001f));
+
+	CHECK(sumCached == sumUncached);
+	CHECK(cachedNs < uncachedNs);
+
+	configHandler = nullptr;
+}
@@ -0,0 +1,96 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/MemPoolTypes.h"
+#include "System/MemoryTags.h"
+
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+struct Item {
+	int data[16];
+};
+
+
+TEST_CASE("MemoryTags")
+{
+	SECTION("registry") {
+		MemoryTag* a = MemoryTags::Get("Test::A");
+		MemoryTag* b = MemoryTags::Get("Test::B");
+
+		CHECK(a != b);
+		CHECK(a == MemoryTags::Get("Test::A"));
+
+		a->OnResize(0, 100);
+		a->OnResize(100, 40);
+
+		CHECK(a->GetLiveBytes() == 40);
+		CHECK(a->GetPeakBytes() == 100);
+		CHECK(a->GetNumAllocs() == 1);
+		CHECK(a->GetNumFrees() == 1);
+	}
+
+	SECTION("FixedDynMemPool") {
+		typedef FixedDynMemPool<sizeof(Item), 16, 8> Pool;
+
+		Pool pool("Test::FixedDynMemPool");
+		MemoryTag* tag = MemoryTags::Get("Test::FixedDynMemPool");
+		std::vector<Item*> items;
+
+		for (int i = 0; i < 20; i++) {
+			items.push_back(pool.alloc<Item>());
+		}
+
+		CHECK(tag->GetLiveBytes() == (20 * Pool::PAGE_SIZE()));
+
+		for (int i = 0; i < 5; i++) {
+			pool.free(items[i]);
+		}
+
+		CHECK(tag->GetLiveBytes() == (15 * Pool::PAGE_SIZE()));
+		CHECK(tag->GetPeakBytes() == (20 * Pool::PAGE_SIZE()));
+		CHECK(tag->GetNumAllocs() == 20);
+		CHECK(tag->GetNumFrees() == 5);
+
+		// pages still in use are released by clear
+		pool.clear();
+		CHECK(tag->GetLiveBytes() == 0);
+	}
+
+	SECTION("DynMemPool") {
+		typedef DynMemPool<sizeof(Item)> Pool;
+
+		Pool pool("Test::DynMemPool");
+		MemoryTag* tag = MemoryTags::Get("Test::DynMemPool");
+
+		Item* p = pool.alloc<Item>();
+		Item* q = pool.alloc<Item>();
+
+		CHECK(tag->GetLiveBytes() == (2 * Pool::PAGE_SIZE()));
+
+		pool.free(p);
+		CHECK(tag->GetLiveBytes() == Pool::PAGE_SIZE());
+
+		pool.free(q);
+		CHECK(tag->GetLiveBytes() == 0);
+		CHECK(tag->GetPeakBytes() == (2 * Pool::PAGE_SIZE()));
+	}
+
+	SECTION("StaticMemPool") {
+		typedef StaticMemPool<8, sizeof(Item)> Pool;
+
+		Pool pool("Test::StaticMemPool");
+		MemoryTag* tag = MemoryTags::Get("Test::StaticMemPool");
+
+		for (int i = 0; i < 3; i++) {
+			pool.alloc<Item>();
+		}
+
+		CHECK(tag->GetLiveBytes() == (3 * Pool::PAGE_SIZE()));
+
+		pool.clear();
+		CHECK(tag->GetLiveBytes() == 0);
+	}
+}
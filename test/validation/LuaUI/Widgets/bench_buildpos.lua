@@ -0,0 +1,77 @@
+function widget:GetInfo()
+return {
+	name    = "BuildPos-Benchmark",
+	desc    = "Compares Spring.ClosestBuildPos against Spring.ClosestBuildPositions on the current bases",
+	license = "GNU GPL, v2 or later",
+	layer   = 0,
+	enabled = true,
+}
+end
+
+local numQueries = 1000
+local firstFrame = 30 * 60 * 8 -- bases should be dense by then
+local benchRate = 30 * 60 * 2
+local searchRadius = 512
+local minDist = 2
+
+local function GetBuildingDefIDs()
+	local defIDs = {}
+	for defID, def in pairs(UnitDefs) do
+		if def.isBuilding then
+			defIDs[#defIDs + 1] = defID
+		end
+	end
+	table.sort(defIDs)
+	return defIDs
+end
+
+local function RunBenchmark()
+	local defIDs = GetBuildingDefIDs()
+	local unitIDs = Spring.GetAllUnits()
+
+	if #defIDs == 0 or #unitIDs == 0 then
+		return
+	end
+
+	-- queries centered on existing units, i.e. on the densest parts of the map
+	local queries = {}
+	for i = 1, numQueries do
+		local unitID = unitIDs[(i % #unitIDs) + 1]
+		local x, y, z = Spring.GetUnitPosition(unitID)
+		queries[i] = {Spring.GetUnitTeam(unitID), defIDs[(i % #defIDs) + 1], x, y, z, searchRadius, minDist, i % 4}
+	end
+
+	local timer = Spring.GetTimer()
+	local single = {}
+	for i = 1, numQueries do
+		local q = queries[i]
+		single[i * 3 - 2], single[i * 3 - 1], single[i * 3] = Spring.ClosestBuildPos(q[1], q[2], q[3], q[4], q[5], q[6], q[7], q[8])
+	end
+	local singleTime = Spring.DiffTimers(Spring.GetTimer(), timer, true)
+
+	timer = Spring.GetTimer()
+	local batched = Spring.ClosestBuildPositions(queries)
+	local batchTime = Spring.DiffTimers(Spring.GetTimer(), timer, true)
+
+	local numFound = 0
+	for i = 1, numQueries do
+		local j = i * 3 - 2
+		if single[j] ~= batched[j] or single[j + 1] ~= batched[j + 1] or single[j + 2] ~= batched[j + 2] then
+			Spring.Log("bench_buildpos.lua", LOG.ERROR, string.format("query %i: ClosestBuildPos (%f, %f, %f) ~= ClosestBuildPositions (%f, %f, %f)",
+				i, single[j], single[j + 1], single[j + 2], batched[j], batched[j + 1], batched[j + 2]))
+			return
+		end
+		if single[j] >= 0 then
+			numFound = numFound + 1
+		end
+	end
+
+	Spring.Echo(string.format("[bench_buildpos] %i queries (%i found, %i units): ClosestBuildPos %.2fms, ClosestBuildPositions %.2fms",
+		numQueries, numFound, #unitIDs, singleTime, batchTime))
+end
+
+function widget:GameFrame(n)
+	if n >= firstFrame and (n - firstFrame) % benchRate == 0 then
+		RunBenchmark()
+	end
+end
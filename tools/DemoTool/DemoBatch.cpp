@@ -0,0 +1,400 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "DemoBatch.h"
+#include "DemoExtractors.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystemAbstraction.h"
+#include "System/LoadSave/DemoReader.h"
+#include "System/Net/RawPacket.h"
+#include "Net/Protocol/BaseNetProtocol.h"
+
+
+/**
+ * Sink for the tables produced by one extractor over all demos.
+ * Tables arrive in demo order; every writer emits an implicit leading
+ * "demo" column holding the (batch-dir relative) demo path.
+ */
+class IDemoStatWriter
+{
+public:
+	virtual ~IDemoStatWriter() {}
+
+	virtual bool Open(const std::string& path, const DemoStatTable& schema) = 0;
+	virtual void Write(const DemoStatTable& table) = 0;
+	virtual void Close() = 0;
+};
+
+
+class CSVStatWriter : public IDemoStatWriter
+{
+public:
+	bool Open(const std::string& path, const DemoStatTable& schema) override {
+		out.open(path.c_str(), std::ios::out | std::ios::trunc);
+
+		if (!out.is_open())
+			return false;
+
+		out << "demo";
+
+		for (const DemoStatTable::Column& col: schema.GetColumns()) {
+			out << ',' << col.name;
+		}
+
+		out << '\n';
+		out.precision(9);
+		return true;
+	}
+
+	void Write(const DemoStatTable& table) override {
+		const std::vector<DemoStatTable::Column>& columns = table.GetColumns();
+
+		for (size_t row = 0, numRows = table.GetNumRows(); row < numRows; ++row) {
+			WriteString(table.GetDemoName());
+
+			for (const DemoStatTable::Column& col: columns) {
+				out << ',';
+
+				switch (col.type) {
+					case DemoStatTable::COLUMN_INT   : { out << col.ints[row]; } break;
+					case DemoStatTable::COLUMN_FLOAT : { out << col.floats[row]; } break;
+					case DemoStatTable::COLUMN_STRING: { WriteString(col.strings[row]); } break;
+				}
+			}
+
+			out << '\n';
+		}
+	}
+
+	void Close() override { out.close(); }
+
+private:
+	void WriteString(const std::string& str) {
+		if (str.find_first_of(",\"\n\r") == std::string::npos) {
+			out << str;
+			return;
+		}
+
+		// RFC 4180 quoting
+		out << '"';
+
+		for (const char c: str) {
+			if (c == '"')
+				out << '"';
+
+			out << c;
+		}
+
+		out << '"';
+	}
+
+private:
+	std::ofstream out;
+};
+
+
+/**
+ * Simple column-oriented binary format, laid out like a Parquet file
+ * without encodings or compression (all values little-endian):
+ *
+ *   char[8] magic "SDCOL\0\0\1"
+ *   uint32  numColumns
+ *   numColumns * {uint8 type (0=int64, 1=float64, 2=string), uint16 nameLength, char[nameLength] name}
+ *   row groups (one per demo that produced rows):
+ *     uint32 numRows
+ *     numColumns * column chunk:
+ *       int64/float64: numRows contiguous values
+ *       string       : uint32[numRows] lengths, then the concatenated bytes
+ *   uint32 0 (terminator)
+ *
+ * Column 0 is always the string column "demo".
+ */
+class ColumnarStatWriter : public IDemoStatWriter
+{
+public:
+	bool Open(const std::string& path, const DemoStatTable& schema) override {
+		out.open(path.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+
+		if (!out.is_open())
+			return false;
+
+		const std::vector<DemoStatTable::Column>& columns = schema.GetColumns();
+
+		out.write("SDCOL\0\0\1", 8);
+		WriteValue<uint32_t>(columns.size() + 1);
+		WriteColumnHeader("demo", DemoStatTable::COLUMN_STRING);
+
+		for (const DemoStatTable::Column& col: columns) {
+			WriteColumnHeader(col.name, col.type);
+		}
+
+		return true;
+	}
+
+	void Write(const DemoStatTable& table) override {
+		const size_t numRows = table.GetNumRows();
+
+		if (numRows == 0)
+			return;
+
+		WriteValue<uint32_t>(numRows);
+
+		{
+			const std::string& demoName = table.GetDemoName();
+
+			for (size_t row = 0; row < numRows; ++row) {
+				WriteValue<uint32_t>(demoName.size());
+			}
+			for (size_t row = 0; row < numRows; ++row) {
+				out.write(demoName.data(), demoName.size());
+			}
+		}
+
+		for (const DemoStatTable::Column& col: table.GetColumns()) {
+			switch (col.type) {
+				case DemoStatTable::COLUMN_INT: {
+					out.write(reinterpret_cast<const char*>(col.ints.data()), col.ints.size() * sizeof(int64_t));
+				} break;
+				case DemoStatTable::COLUMN_FLOAT: {
+					out.write(reinterpret_cast<const char*>(col.floats.data()), col.floats.size() * sizeof(double));
+				} break;
+				case DemoStatTable::COLUMN_STRING: {
+					for (const std::string& str: col.strings) {
+						WriteValue<uint32_t>(str.size());
+					}
+					for (const std::string& str: col.strings) {
+						out.write(str.data(), str.size());
+					}
+				} break;
+			}
+		}
+	}
+
+	void Close() override {
+		WriteValue<uint32_t>(0);
+		out.close();
+	}
+
+private:
+	template<typename T> void WriteValue(T value) {
+		out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	void WriteColumnHeader(const std::string& name, DemoStatTable::ColumnType type) {
+		WriteValue<uint8_t>(type);
+		WriteValue<uint16_t>(name.size());
+		out.write(name.data(), name.size());
+	}
+
+private:
+	std::ofstream out;
+};
+
+
+
+struct DemoBatchResult {
+	std::vector<DemoStatTable> tables;
+
+	bool done = false;
+	bool failed = false;
+};
+
+
+static bool ExtractDemo(
+	const std::string& demoPath,
+	const std::string& demoName,
+	const std::vector<std::string>& extractorNames,
+	DemoBatchResult& result
+) {
+	std::vector< std::unique_ptr<IDemoExtractor> > extractors;
+	std::vector<IDemoExtractor*> packetExtractors;
+
+	bool wantStats = false;
+
+	extractors.reserve(extractorNames.size());
+	result.tables.resize(extractorNames.size());
+
+	for (size_t i = 0; i < extractorNames.size(); ++i) {
+		extractors.emplace_back(DemoExtractors::Create(extractorNames[i]));
+		extractors.back()->DefineColumns(result.tables[i]);
+		result.tables[i].SetDemoName(demoName);
+
+		if (extractors.back()->WantsPackets())
+			packetExtractors.push_back(extractors.back().get());
+
+		wantStats |= extractors.back()->WantsStats();
+	}
+
+	try {
+		CDemoReader reader(demoPath, 0.0f);
+
+		int frameNum = 0;
+
+		if (!packetExtractors.empty()) {
+			while (!reader.ReachedEnd()) {
+				std::unique_ptr<netcode::RawPacket> packet(reader.GetData(FLT_MAX));
+
+				if (packet == nullptr || packet->length == 0)
+					continue;
+
+				switch (packet->data[0]) {
+					case NETMSG_KEYFRAME:
+					case NETMSG_NEWFRAME: {
+						++frameNum;
+					} break;
+					case NETMSG_GAME_FRAME_PROGRESS: {
+						// unsynced, see TrafficDump
+						continue;
+					} break;
+					default: {
+					} break;
+				}
+
+				for (IDemoExtractor* extractor: packetExtractors) {
+					extractor->ProcessPacket(packet.get(), frameNum);
+				}
+			}
+		}
+
+		// stats trailer follows the stream; the whole file is already in memory
+		if (wantStats)
+			reader.LoadStats();
+
+		for (size_t i = 0; i < extractors.size(); ++i) {
+			extractors[i]->Finish(reader, frameNum, result.tables[i]);
+		}
+	} catch (const std::exception& ex) {
+		std::cerr << "[" << __func__ << "] skipping demo \"" << demoPath << "\": " << ex.what() << std::endl;
+		result.tables.clear();
+		return false;
+	}
+
+	return true;
+}
+
+
+int RunDemoBatch(const DemoBatchOptions& options)
+{
+	const auto startTime = std::chrono::steady_clock::now();
+
+	for (const std::string& name: options.extractors) {
+		if (DemoExtractors::Create(name) != nullptr)
+			continue;
+
+		std::cerr << "Unknown extractor \"" << name << "\", valid extractors are:";
+
+		for (const std::string& validName: DemoExtractors::GetNames()) {
+			std::cerr << " " << validName;
+		}
+
+		std::cerr << std::endl;
+		return 1;
+	}
+	if (options.extractors.empty()) {
+		std::cerr << "No extractors selected" << std::endl;
+		return 1;
+	}
+	if (options.format != "csv" && options.format != "sdcol") {
+		std::cerr << "Unknown output format \"" << options.format << "\" (valid formats are: csv sdcol)" << std::endl;
+		return 1;
+	}
+
+	const std::string demoDir = FileSystemAbstraction::EnsurePathSepAtEnd(options.demoDir);
+	const std::string outDir = FileSystemAbstraction::EnsurePathSepAtEnd(options.outDir);
+
+	std::vector<std::string> demoNames;
+	FileSystemAbstraction::FindFiles(demoNames, demoDir, "", ".*\\.sdfz", FileQueryFlags::RECURSE);
+
+	// sorted, so output does not depend on directory iteration order or thread scheduling
+	std::sort(demoNames.begin(), demoNames.end());
+
+	if (demoNames.empty()) {
+		std::cerr << "No demos found in \"" << demoDir << "\"" << std::endl;
+		return 1;
+	}
+
+	std::vector< std::unique_ptr<IDemoStatWriter> > writers;
+
+	for (const std::string& name: options.extractors) {
+		DemoStatTable schema;
+		DemoExtractors::Create(name)->DefineColumns(schema);
+
+		if (options.format == "csv") {
+			writers.emplace_back(new CSVStatWriter());
+		} else {
+			writers.emplace_back(new ColumnarStatWriter());
+		}
+
+		const std::string outFile = outDir + name + "." + options.format;
+
+		if (!writers.back()->Open(outFile, schema)) {
+			std::cerr << "Could not open \"" << outFile << "\" for writing" << std::endl;
+			return 1;
+		}
+	}
+
+	const unsigned int numThreads = std::max(1u, std::min(
+		(options.numThreads != 0)? options.numThreads: std::thread::hardware_concurrency(),
+		static_cast<unsigned int>(demoNames.size())
+	));
+
+	std::vector<DemoBatchResult> results(demoNames.size());
+	std::vector<std::thread> workers;
+	workers.reserve(numThreads);
+
+	std::atomic<size_t> nextDemoIdx = {0};
+	std::mutex resultMutex;
+
+	size_t nextWriteIdx = 0;
+	size_t numFailed = 0;
+
+	const auto WorkerFunc = [&]() {
+		for (size_t demoIdx = nextDemoIdx++; demoIdx < demoNames.size(); demoIdx = nextDemoIdx++) {
+			DemoBatchResult result;
+			result.failed = !ExtractDemo(demoDir + demoNames[demoIdx], demoNames[demoIdx], options.extractors, result);
+			result.done = true;
+
+			std::lock_guard<std::mutex> lock(resultMutex);
+			results[demoIdx] = std::move(result);
+
+			// stream out every consecutive finished demo, keeps memory bounded by thread skew
+			for (; nextWriteIdx < results.size() && results[nextWriteIdx].done; ++nextWriteIdx) {
+				DemoBatchResult& r = results[nextWriteIdx];
+
+				for (size_t i = 0; i < r.tables.size(); ++i) {
+					writers[i]->Write(r.tables[i]);
+				}
+
+				numFailed += r.failed;
+				r.tables = {};
+			}
+		}
+	};
+
+	for (unsigned int i = 0; i < numThreads; ++i) {
+		workers.emplace_back(WorkerFunc);
+	}
+	for (std::thread& t: workers) {
+		t.join();
+	}
+	for (const auto& writer: writers) {
+		writer->Close();
+	}
+
+	const auto endTime = std::chrono::steady_clock::now();
+	const float seconds = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count() * 0.001f;
+
+	std::cout << "Processed " << demoNames.size() << " demos (" << numFailed << " failed) with " << numThreads << " threads in " << seconds << "s" << std::endl;
+	return 0;
+}
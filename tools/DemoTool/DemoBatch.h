@@ -0,0 +1,31 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef DEMO_BATCH_H
+#define DEMO_BATCH_H
+
+#include <string>
+#include <vector>
+
+struct DemoBatchOptions {
+	std::string demoDir;
+	std::string outDir;
+	/// "csv" or "sdcol"
+	std::string format;
+
+	std::vector<std::string> extractors;
+
+	/// 0 means one worker per hardware thread
+	unsigned int numThreads = 0;
+};
+
+/**
+ * @brief Runs the selected extractors over every demo below demoDir
+ *
+ * Demos are distributed over worker threads; results are written in
+ * sorted demo-path order (independent of thread count) as one output
+ * file per extractor in outDir.
+ * @return process exit code
+ */
+int RunDemoBatch(const DemoBatchOptions& options);
+
+#endif // DEMO_BATCH_H
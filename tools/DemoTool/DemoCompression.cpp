@@ -0,0 +1,434 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "DemoCompression.h"
+#include "PackedDemo.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+
+#include <zlib.h>
+
+#include "Net/Protocol/BaseNetProtocol.h"
+#include "System/LoadSave/demofile.h"
+#include "System/Net/PacketCompressor.h"
+
+
+/// room for the most valuable shapes while leaving most of deflate's 32KB window to the data
+static constexpr size_t TRAINED_DICTIONARY_SIZE = 16 * 1024;
+/// longest sample of a single message kept in a trained dictionary
+static constexpr size_t TRAINED_SAMPLE_SIZE = 64;
+/// bytes of a message that identify its shape (ID, size, player, command or script ID, ...)
+static constexpr size_t TRAINED_SHAPE_SIZE = 12;
+
+/// not valid on the network, only used to tell the dictionaries apart here
+static constexpr uint8_t TRAINED_DICTIONARY_ID = 0xFF;
+
+
+typedef std::chrono::steady_clock Clock;
+
+static double SecondsSince(const Clock::time_point& t) { return std::chrono::duration<double>(Clock::now() - t).count(); }
+
+
+/**
+ * Messages of a demo stream without the chunk headers, i.e. as they went over
+ * the network, cut into one batch per sim-frame (every batch starts with the
+ * frame's NETMSG_NEWFRAME or NETMSG_KEYFRAME, like the server sends them).
+ */
+struct DemoMessages {
+public:
+	void Extract(const std::vector<uint8_t>& stream) {
+		data.clear();
+		batchEnds.clear();
+		msgEnds.clear();
+
+		size_t batchBeg = 0;
+
+		for (size_t pos = 0; (pos + sizeof(DemoStreamChunkHeader)) <= stream.size(); ) {
+			DemoStreamChunkHeader chunkHeader;
+			memcpy(&chunkHeader, &stream[pos], sizeof(chunkHeader));
+			chunkHeader.swab();
+
+			const size_t msgPos = pos + sizeof(chunkHeader);
+
+			if ((pos = msgPos + chunkHeader.length) > stream.size())
+				break;
+			if (chunkHeader.length == 0)
+				continue;
+
+			const uint8_t msgID = stream[msgPos];
+			const bool frameMsg = (msgID == NETMSG_NEWFRAME || msgID == NETMSG_KEYFRAME);
+
+			// batches hold complete messages and have to fit a NETMSG_PACKED
+			if ((frameMsg || (data.size() + chunkHeader.length - batchBeg) > netcode::PacketCompressor::maxPackSize) && data.size() > batchBeg)
+				batchEnds.push_back(batchBeg = data.size());
+
+			data.insert(data.end(), stream.begin() + msgPos, stream.begin() + pos);
+			msgEnds.push_back(data.size());
+		}
+
+		if (data.size() > batchBeg)
+			batchEnds.push_back(data.size());
+	}
+
+public:
+	std::vector<uint8_t> data;
+	std::vector<size_t> batchEnds;
+	std::vector<size_t> msgEnds;
+};
+
+
+struct CompressionResult {
+	std::string name;
+
+	uint64_t rawSize = 0;
+	uint64_t packedSize = 0;
+	uint64_t numBlocks = 0;
+
+	double compressTime = 0.0;
+	double decompressTime = 0.0;
+
+	bool lossless = true;
+};
+
+
+/**
+ * Counts message shapes over all demos; the dictionary holds one sample per
+ * shape, picked by the number of bytes it can be expected to cover.
+ */
+class DictionaryTrainer
+{
+public:
+	void AddMessages(const DemoMessages& messages) {
+		size_t msgBeg = 0;
+
+		for (const size_t msgEnd: messages.msgEnds) {
+			const uint8_t* msg = &messages.data[msgBeg];
+			const size_t msgSize = msgEnd - msgBeg;
+
+			Shape& shape = shapes[std::string(reinterpret_cast<const char*>(msg), std::min(msgSize, TRAINED_SHAPE_SIZE))];
+			shape.count += 1;
+			shape.sample.assign(msg, msg + std::min(msgSize, TRAINED_SAMPLE_SIZE));
+
+			msgBeg = msgEnd;
+		}
+	}
+
+	std::vector<uint8_t> GetDictionary() const {
+		std::vector<const Shape*> sorted;
+		std::vector<uint8_t> dictionary;
+
+		sorted.reserve(shapes.size());
+
+		for (const auto& p: shapes) {
+			sorted.push_back(&p.second);
+		}
+
+		// most valuable first, ties broken by content for a reproducible result
+		std::sort(sorted.begin(), sorted.end(), [](const Shape* a, const Shape* b) {
+			if (a->GetScore() != b->GetScore())
+				return (a->GetScore() > b->GetScore());
+
+			return (a->sample < b->sample);
+		});
+
+		size_t numUsed = 0;
+		size_t dictSize = 0;
+
+		for (; numUsed < sorted.size() && (dictSize + sorted[numUsed]->sample.size()) <= TRAINED_DICTIONARY_SIZE; numUsed++) {
+			dictSize += sorted[numUsed]->sample.size();
+		}
+
+		// deflate reaches the end of the dictionary with the shortest distances
+		for (size_t i = numUsed; i > 0; i--) {
+			dictionary.insert(dictionary.end(), sorted[i - 1]->sample.begin(), sorted[i - 1]->sample.end());
+		}
+
+		return dictionary;
+	}
+
+private:
+	struct Shape {
+		uint64_t GetScore() const { return (count * sample.size()); }
+
+		uint64_t count = 0;
+		std::vector<uint8_t> sample;
+	};
+
+	std::unordered_map<std::string, Shape> shapes;
+};
+
+
+
+static void CompressStream(const std::vector<uint8_t>& stream, CompressionResult& result)
+{
+	std::vector<uint8_t> packed(compressBound(stream.size()));
+	std::vector<uint8_t> unpacked(stream.size());
+
+	uLongf packedSize = packed.size();
+	uLongf unpackedSize = unpacked.size();
+
+	Clock::time_point t = Clock::now();
+	result.lossless &= (compress2(packed.data(), &packedSize, stream.data(), stream.size(), Z_BEST_COMPRESSION) == Z_OK);
+	result.compressTime += SecondsSince(t);
+
+	t = Clock::now();
+	result.lossless &= (uncompress(unpacked.data(), &unpackedSize, packed.data(), packedSize) == Z_OK);
+	result.decompressTime += SecondsSince(t);
+
+	result.lossless &= (unpacked == stream);
+	result.rawSize += stream.size();
+	result.packedSize += packedSize;
+	result.numBlocks += 1;
+}
+
+static void CompressBatches(const DemoMessages& messages, netcode::PacketCompressor& compressor, CompressionResult& result)
+{
+	std::vector<uint8_t> packed;
+	std::vector<uint8_t> unpacked;
+
+	// whether each batch went out packed, and where
+	std::vector<size_t> packedEnds;
+	std::vector<uint8_t> packedBatches;
+
+	packedEnds.reserve(messages.batchEnds.size());
+
+	Clock::time_point t = Clock::now();
+
+	for (size_t i = 0, batchBeg = 0; i < messages.batchEnds.size(); batchBeg = messages.batchEnds[i++]) {
+		const size_t batchSize = messages.batchEnds[i] - batchBeg;
+
+		// batches that do not shrink are sent as they are, see UDPConnection::PackOutgoingData
+		if (compressor.Pack(&messages.data[batchBeg], batchSize, packed)) {
+			packedBatches.insert(packedBatches.end(), packed.begin(), packed.end());
+		} else {
+			packedBatches.insert(packedBatches.end(), messages.data.begin() + batchBeg, messages.data.begin() + messages.batchEnds[i]);
+		}
+
+		packedEnds.push_back(packedBatches.size());
+	}
+
+	result.compressTime += SecondsSince(t);
+
+	unpacked.reserve(messages.data.size());
+	t = Clock::now();
+
+	for (size_t i = 0, batchBeg = 0; i < packedEnds.size(); batchBeg = packedEnds[i++]) {
+		if (packedBatches[batchBeg] == NETMSG_PACKED) {
+			result.lossless &= compressor.Unpack(&packedBatches[batchBeg], packedEnds[i] - batchBeg, unpacked);
+		} else {
+			unpacked.insert(unpacked.end(), packedBatches.begin() + batchBeg, packedBatches.begin() + packedEnds[i]);
+		}
+	}
+
+	result.decompressTime += SecondsSince(t);
+
+	result.lossless &= (unpacked == messages.data);
+	result.rawSize += messages.data.size();
+	result.packedSize += packedBatches.size();
+	result.numBlocks += messages.batchEnds.size();
+}
+
+static void CompressContainer(const std::vector<uint8_t>& stream, const std::vector<uint8_t>& dictionary, unsigned int blockSize, CompressionResult& result)
+{
+	netcode::PacketCompressor compressor(dictionary, 0, Z_BEST_COMPRESSION);
+
+	std::vector<PackedDemo::Block> blocks;
+	std::vector<uint8_t> packed;
+	std::vector<uint8_t> unpacked;
+
+	Clock::time_point t = Clock::now();
+	result.lossless &= PackedDemo::PackStream(stream, compressor, blockSize, packed, blocks);
+	result.compressTime += SecondsSince(t);
+
+	unpacked.reserve(stream.size());
+	t = Clock::now();
+
+	for (const PackedDemo::Block& block: blocks) {
+		result.lossless &= compressor.Inflate(&packed[block.offset], block.packedSize, block.rawSize, unpacked);
+	}
+
+	result.decompressTime += SecondsSince(t);
+
+	// chunks cut off by a crash are not stored
+	result.lossless &= std::equal(unpacked.begin(), unpacked.end(), stream.begin());
+	result.rawSize += stream.size();
+	result.packedSize += packed.size() + blocks.size() * sizeof(PackedDemo::Block);
+	result.numBlocks += blocks.size();
+}
+
+
+static void PrintResults(const std::vector<CompressionResult>& results)
+{
+	std::cout << std::left << std::setw(36) << "mode"
+	          << std::right << std::setw(14) << "raw bytes"
+	          << std::setw(14) << "packed bytes"
+	          << std::setw(8) << "ratio"
+	          << std::setw(12) << "comp MB/s"
+	          << std::setw(12) << "decomp MB/s"
+	          << std::setw(14) << "us/block"
+	          << std::endl;
+
+	for (const CompressionResult& r: results) {
+		const double rawMB = r.rawSize / (1024.0 * 1024.0);
+
+		std::cout << std::left << std::setw(36) << r.name
+		          << std::right << std::setw(14) << r.rawSize
+		          << std::setw(14) << r.packedSize
+		          << std::fixed << std::setprecision(3)
+		          << std::setw(8) << ((r.rawSize > 0)? (r.packedSize * 1.0 / r.rawSize): 0.0)
+		          << std::setprecision(1)
+		          << std::setw(12) << ((r.compressTime > 0.0)? (rawMB / r.compressTime): 0.0)
+		          << std::setw(12) << ((r.decompressTime > 0.0)? (rawMB / r.decompressTime): 0.0)
+		          << std::setprecision(2)
+		          << std::setw(14) << ((r.numBlocks > 0)? (r.decompressTime * 1e6 / r.numBlocks): 0.0)
+		          << (r.lossless? "": "  ROUNDTRIP FAILED")
+		          << std::endl;
+	}
+}
+
+
+static bool ReadDictionary(const std::string& path, std::vector<uint8_t>& dictionary)
+{
+	std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+
+	if (!in.is_open())
+		return false;
+
+	dictionary.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	return true;
+}
+
+static bool WriteDictionary(const std::string& path, const std::vector<uint8_t>& dictionary)
+{
+	std::ofstream out(path.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+
+	if (!out.is_open())
+		return false;
+
+	out.write(reinterpret_cast<const char*>(dictionary.data()), dictionary.size());
+	return out.good();
+}
+
+
+int RunDemoCompression(const DemoCompressionOptions& options)
+{
+	if (options.demoPaths.empty()) {
+		std::cerr << "No demos given" << std::endl;
+		return 1;
+	}
+
+	const std::vector<uint8_t>& builtinDictionary = CBaseNetProtocol::Get().GetPacketDictionary();
+	std::vector<uint8_t> trainedDictionary;
+
+	if (!options.dictionaryFile.empty() && !ReadDictionary(options.dictionaryFile, trainedDictionary)) {
+		std::cerr << "Could not read dictionary \"" << options.dictionaryFile << "\"" << std::endl;
+		return 1;
+	}
+
+	DemoFileData demo;
+	DemoMessages messages;
+
+	std::string error;
+	std::vector<std::string> demoPaths;
+
+	// skip unreadable demos once, up front
+	for (const std::string& path: options.demoPaths) {
+		if (!demo.Load(path, error)) {
+			std::cerr << "[" << __func__ << "] skipping demo \"" << path << "\": " << error << std::endl;
+			continue;
+		}
+
+		demoPaths.push_back(path);
+	}
+
+	if (demoPaths.empty())
+		return 1;
+
+	if (!options.trainFile.empty()) {
+		DictionaryTrainer trainer;
+
+		for (const std::string& path: demoPaths) {
+			demo.Load(path, error);
+			messages.Extract(demo.stream);
+			trainer.AddMessages(messages);
+		}
+
+		trainedDictionary = trainer.GetDictionary();
+
+		if (!WriteDictionary(options.trainFile, trainedDictionary)) {
+			std::cerr << "Could not write dictionary \"" << options.trainFile << "\"" << std::endl;
+			return 1;
+		}
+
+		std::cout << "Trained a " << trainedDictionary.size() << " byte dictionary on " << demoPaths.size() << " demos" << std::endl;
+	}
+
+	if (!options.packFile.empty()) {
+		demo.Load(demoPaths[0], error);
+
+		const std::vector<uint8_t>& dictionary = trainedDictionary.empty()? builtinDictionary: trainedDictionary;
+
+		if (!PackedDemo::Write(options.packFile, demo, dictionary, options.blockSize)) {
+			std::cerr << "Could not write \"" << options.packFile << "\"" << std::endl;
+			return 1;
+		}
+	}
+
+	netcode::PacketCompressor plainCompressor({}, 0);
+	netcode::PacketCompressor builtinCompressor(builtinDictionary, PACKET_DICTIONARY_ID);
+	std::unique_ptr<netcode::PacketCompressor> trainedCompressor;
+
+	std::vector<CompressionResult> results;
+
+	results.emplace_back();
+	results.back().name = "stream, gzip -9 (sdfz)";
+	results.emplace_back();
+	results.back().name = "frame batches, no dictionary";
+	results.emplace_back();
+	results.back().name = "frame batches, built-in dictionary";
+
+	if (!trainedDictionary.empty()) {
+		trainedCompressor.reset(new netcode::PacketCompressor(trainedDictionary, TRAINED_DICTIONARY_ID));
+
+		results.emplace_back();
+		results.back().name = "frame batches, trained dictionary";
+	}
+
+	results.emplace_back();
+	results.back().name = "container, built-in dictionary";
+
+	if (!trainedDictionary.empty()) {
+		results.emplace_back();
+		results.back().name = "container, trained dictionary";
+	}
+
+	for (const std::string& path: demoPaths) {
+		demo.Load(path, error);
+		messages.Extract(demo.stream);
+
+		auto result = results.begin();
+
+		CompressStream(demo.stream, *(result++));
+		CompressBatches(messages, plainCompressor, *(result++));
+		CompressBatches(messages, builtinCompressor, *(result++));
+
+		if (trainedCompressor != nullptr)
+			CompressBatches(messages, *trainedCompressor, *(result++));
+
+		CompressContainer(demo.stream, builtinDictionary, options.blockSize, *(result++));
+
+		if (trainedCompressor != nullptr)
+			CompressContainer(demo.stream, trainedDictionary, options.blockSize, *(result++));
+	}
+
+	std::cout << "Compression of " << demoPaths.size() << " demos (" << options.blockSize << " byte container blocks)" << std::endl;
+	PrintResults(results);
+
+	return (std::all_of(results.begin(), results.end(), [](const CompressionResult& r) { return r.lossless; })? 0: 1);
+}
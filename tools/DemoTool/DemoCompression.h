@@ -0,0 +1,36 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef DEMO_COMPRESSION_H
+#define DEMO_COMPRESSION_H
+
+#include <string>
+#include <vector>
+
+struct DemoCompressionOptions {
+	/// .sdfz files to compare on
+	std::vector<std::string> demoPaths;
+
+	/// trained dictionary to compare in addition to the built-in one
+	std::string dictionaryFile;
+	/// if set, a dictionary trained on the demos is written here
+	std::string trainFile;
+	/// if set, the first demo is written here as packed container (see PackedDemo)
+	std::string packFile;
+
+	/// stream bytes per container block
+	unsigned int blockSize = 32 * 1024;
+};
+
+/**
+ * @brief Compares the compression modes for demo streams and network traffic
+ *
+ * Reports size and throughput of the whole-stream gzip used by .sdfz files,
+ * of NETMSG_PACKED batches (one per sim-frame, as UDPConnection would send
+ * them) without, with the built-in and with a trained dictionary, and of the
+ * seekable container including the cost of decoding a single block.
+ * Batch sizes do not include the demo chunk headers, which are not sent.
+ * @return process exit code
+ */
+int RunDemoCompression(const DemoCompressionOptions& options);
+
+#endif // DEMO_COMPRESSION_H
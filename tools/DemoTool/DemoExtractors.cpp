@@ -0,0 +1,262 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "DemoExtractors.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <map>
+#include <tuple>
+
+#include "Net/Protocol/BaseNetProtocol.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "System/LoadSave/DemoReader.h"
+#include "System/Net/RawPacket.h"
+
+
+void DemoStatTable::AddRow(std::initializer_list<Value> values)
+{
+	assert(values.size() == columns.size());
+
+	auto col = columns.begin();
+
+	for (const Value& v: values) {
+		assert(static_cast<size_t>(col->type) == v.index());
+
+		switch (col->type) {
+			case COLUMN_INT   : { col->ints.push_back(std::get<int64_t>(v)); } break;
+			case COLUMN_FLOAT : { col->floats.push_back(std::get<double>(v)); } break;
+			case COLUMN_STRING: { col->strings.push_back(std::get<std::string>(v)); } break;
+		}
+
+		++col;
+	}
+
+	numRows += 1;
+}
+
+
+
+static std::string ReadPacketString(const netcode::RawPacket* packet, unsigned int offset)
+{
+	if (offset >= packet->length)
+		return "";
+
+	const char* str = reinterpret_cast<const char*>(packet->data + offset);
+	return {str, strnlen(str, packet->length - offset)};
+}
+
+
+/**
+ * Counts the orders each player gave over the whole game, and the resulting
+ * commands-per-minute rate. AI commands are attributed to the hosting player.
+ */
+class CommandsExtractor : public IDemoExtractor
+{
+public:
+	const char* GetName() const override { return "commands"; }
+	bool WantsPackets() const override { return true; }
+
+	void DefineColumns(DemoStatTable& table) const override {
+		table.AddColumn("player", DemoStatTable::COLUMN_INT);
+		table.AddColumn("name", DemoStatTable::COLUMN_STRING);
+		table.AddColumn("commands", DemoStatTable::COLUMN_INT);
+		table.AddColumn("aiCommands", DemoStatTable::COLUMN_INT);
+		table.AddColumn("selections", DemoStatTable::COLUMN_INT);
+		table.AddColumn("activeMinutes", DemoStatTable::COLUMN_FLOAT);
+		table.AddColumn("commandsPerMinute", DemoStatTable::COLUMN_FLOAT);
+	}
+
+	void ProcessPacket(const netcode::RawPacket* packet, int frameNum) override {
+		const uint8_t* buffer = packet->data;
+
+		switch (buffer[0]) {
+			case NETMSG_PLAYERNAME: {
+				if (packet->length > 3)
+					players[buffer[2]].name = ReadPacketString(packet, 3);
+			} break;
+			case NETMSG_CREATE_NEWPLAYER: {
+				if (packet->length > 6)
+					players[buffer[3]].name = ReadPacketString(packet, 6);
+			} break;
+			case NETMSG_COMMAND: {
+				if (packet->length > 3)
+					players[buffer[3]].AddCommand(frameNum, &PlayerCounters::commands);
+			} break;
+			case NETMSG_AICOMMAND:
+			case NETMSG_AICOMMANDS: {
+				if (packet->length > 3)
+					players[buffer[3]].AddCommand(frameNum, &PlayerCounters::aiCommands);
+			} break;
+			case NETMSG_SELECT: {
+				if (packet->length > 3)
+					players[buffer[3]].AddCommand(frameNum, &PlayerCounters::selections);
+			} break;
+			default: {
+			} break;
+		}
+	}
+
+	void Finish(const CDemoReader& reader, int numFrames, DemoStatTable& table) override {
+		for (size_t playerNum = 0; playerNum < players.size(); ++playerNum) {
+			const PlayerCounters& pc = players[playerNum];
+
+			if (pc.firstFrame < 0)
+				continue;
+
+			// a player is active from their first order until the end of the game
+			const double activeMinutes = std::max(0, numFrames - pc.firstFrame) / (GAME_SPEED * 60.0);
+			const double cpm = (activeMinutes > 0.0)? (pc.commands / activeMinutes): 0.0;
+
+			table.AddRow({int64_t(playerNum), pc.name, pc.commands, pc.aiCommands, pc.selections, activeMinutes, cpm});
+		}
+	}
+
+private:
+	struct PlayerCounters {
+		void AddCommand(int frameNum, int64_t PlayerCounters::*counter) {
+			if (firstFrame < 0)
+				firstFrame = std::max(frameNum, 0);
+
+			this->*counter += 1;
+		}
+
+		std::string name;
+
+		int64_t commands = 0;
+		int64_t aiCommands = 0;
+		int64_t selections = 0;
+
+		int firstFrame = -1;
+	};
+
+	std::array<PlayerCounters, 256> players;
+};
+
+
+/**
+ * Counts LuaUI/LuaRules/... messages and their payload sizes per player,
+ * script and mode.
+ */
+class LuaMessagesExtractor : public IDemoExtractor
+{
+public:
+	const char* GetName() const override { return "luamsg"; }
+	bool WantsPackets() const override { return true; }
+
+	void DefineColumns(DemoStatTable& table) const override {
+		table.AddColumn("player", DemoStatTable::COLUMN_INT);
+		table.AddColumn("script", DemoStatTable::COLUMN_INT);
+		table.AddColumn("mode", DemoStatTable::COLUMN_INT);
+		table.AddColumn("messages", DemoStatTable::COLUMN_INT);
+		table.AddColumn("bytes", DemoStatTable::COLUMN_INT);
+	}
+
+	void ProcessPacket(const netcode::RawPacket* packet, int frameNum) override {
+		if (packet->data[0] != NETMSG_LUAMSG || packet->length < 7)
+			return;
+
+		// uint8 msgid, uint16 msgsize, uint8 playerNum, uint16 script, uint8 mode, uint8[] msg
+		uint16_t script = 0;
+		std::memcpy(&script, packet->data + 4, sizeof(script));
+
+		MsgCounters& mc = messages[{packet->data[3], script, packet->data[6]}];
+		mc.count += 1;
+		mc.bytes += packet->length - 7;
+	}
+
+	void Finish(const CDemoReader& reader, int numFrames, DemoStatTable& table) override {
+		for (const auto& pair: messages) {
+			const auto& key = pair.first;
+			table.AddRow({int64_t(std::get<0>(key)), int64_t(std::get<1>(key)), int64_t(std::get<2>(key)), pair.second.count, pair.second.bytes});
+		}
+	}
+
+private:
+	struct MsgCounters {
+		int64_t count = 0;
+		int64_t bytes = 0;
+	};
+
+	// ordered, so output is deterministic
+	std::map<std::tuple<uint8_t, uint16_t, uint8_t>, MsgCounters> messages;
+};
+
+
+/**
+ * Emits the per-team statistics history stored in the demo trailer
+ * (see CDemoRecorder::WriteTeamStats); does not need the packet stream.
+ */
+class TeamStatsExtractor : public IDemoExtractor
+{
+public:
+	const char* GetName() const override { return "teamstats"; }
+	bool WantsStats() const override { return true; }
+
+	void DefineColumns(DemoStatTable& table) const override {
+		table.AddColumn("team", DemoStatTable::COLUMN_INT);
+		table.AddColumn("frame", DemoStatTable::COLUMN_INT);
+		table.AddColumn("metalUsed", DemoStatTable::COLUMN_FLOAT);
+		table.AddColumn("energyUsed", DemoStatTable::COLUMN_FLOAT);
+		table.AddColumn("metalProduced", DemoStatTable::COLUMN_FLOAT);
+		table.AddColumn("energyProduced", DemoStatTable::COLUMN_FLOAT);
+		table.AddColumn("metalExcess", DemoStatTable::COLUMN_FLOAT);
+		table.AddColumn("energyExcess", DemoStatTable::COLUMN_FLOAT);
+		table.AddColumn("metalReceived", DemoStatTable::COLUMN_FLOAT);
+		table.AddColumn("energyReceived", DemoStatTable::COLUMN_FLOAT);
+		table.AddColumn("metalSent", DemoStatTable::COLUMN_FLOAT);
+		table.AddColumn("energySent", DemoStatTable::COLUMN_FLOAT);
+		table.AddColumn("damageDealt", DemoStatTable::COLUMN_FLOAT);
+		table.AddColumn("damageReceived", DemoStatTable::COLUMN_FLOAT);
+		table.AddColumn("unitsProduced", DemoStatTable::COLUMN_INT);
+		table.AddColumn("unitsDied", DemoStatTable::COLUMN_INT);
+		table.AddColumn("unitsReceived", DemoStatTable::COLUMN_INT);
+		table.AddColumn("unitsSent", DemoStatTable::COLUMN_INT);
+		table.AddColumn("unitsCaptured", DemoStatTable::COLUMN_INT);
+		table.AddColumn("unitsOutCaptured", DemoStatTable::COLUMN_INT);
+		table.AddColumn("unitsKilled", DemoStatTable::COLUMN_INT);
+	}
+
+	void Finish(const CDemoReader& reader, int numFrames, DemoStatTable& table) override {
+		const std::vector< std::vector<TeamStatistics> >& teamStats = reader.GetTeamStats();
+
+		for (size_t teamNum = 0; teamNum < teamStats.size(); ++teamNum) {
+			for (const TeamStatistics& ts: teamStats[teamNum]) {
+				table.AddRow({
+					int64_t(teamNum), int64_t(ts.frame),
+					double(ts.metalUsed), double(ts.energyUsed),
+					double(ts.metalProduced), double(ts.energyProduced),
+					double(ts.metalExcess), double(ts.energyExcess),
+					double(ts.metalReceived), double(ts.energyReceived),
+					double(ts.metalSent), double(ts.energySent),
+					double(ts.damageDealt), double(ts.damageReceived),
+					int64_t(ts.unitsProduced), int64_t(ts.unitsDied),
+					int64_t(ts.unitsReceived), int64_t(ts.unitsSent),
+					int64_t(ts.unitsCaptured), int64_t(ts.unitsOutCaptured),
+					int64_t(ts.unitsKilled),
+				});
+			}
+		}
+	}
+};
+
+
+
+const std::vector<std::string>& DemoExtractors::GetNames()
+{
+	static const std::vector<std::string> names = {"commands", "luamsg", "teamstats"};
+	return names;
+}
+
+std::unique_ptr<IDemoExtractor> DemoExtractors::Create(const std::string& name)
+{
+	if (name == "commands")
+		return std::make_unique<CommandsExtractor>();
+	if (name == "luamsg")
+		return std::make_unique<LuaMessagesExtractor>();
+	if (name == "teamstats")
+		return std::make_unique<TeamStatsExtractor>();
+
+	return nullptr;
+}
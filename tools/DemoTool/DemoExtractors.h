@@ -0,0 +1,97 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef DEMO_EXTRACTORS_H
+#define DEMO_EXTRACTORS_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+class CDemoReader;
+namespace netcode { class RawPacket; }
+
+/**
+ * @brief Column-major table of values extracted from a single demo
+ *
+ * Every extractor fills one table per demo; the batch runner writes
+ * the tables of all demos (in demo order) into one output per extractor.
+ * The name of the demo a table belongs to is emitted as implicit first
+ * column by the writers, so extractors only describe their own columns.
+ */
+class DemoStatTable
+{
+public:
+	enum ColumnType {
+		COLUMN_INT    = 0,
+		COLUMN_FLOAT  = 1,
+		COLUMN_STRING = 2,
+	};
+
+	typedef std::variant<int64_t, double, std::string> Value;
+
+	struct Column {
+		std::string name;
+		ColumnType type;
+
+		std::vector<int64_t> ints;
+		std::vector<double> floats;
+		std::vector<std::string> strings;
+	};
+
+public:
+	void AddColumn(const std::string& name, ColumnType type) { columns.push_back({name, type, {}, {}, {}}); }
+	/// values must be given in column order and match the column types
+	void AddRow(std::initializer_list<Value> values);
+
+	void SetDemoName(const std::string& name) { demoName = name; }
+	const std::string& GetDemoName() const { return demoName; }
+
+	const std::vector<Column>& GetColumns() const { return columns; }
+	size_t GetNumRows() const { return numRows; }
+
+private:
+	std::string demoName;
+	std::vector<Column> columns;
+
+	size_t numRows = 0;
+};
+
+
+/**
+ * @brief Pluggable per-demo statistics extractor
+ *
+ * A new instance is created for every demo, so implementations can keep
+ * per-demo state in members and need not be thread-safe.
+ */
+class IDemoExtractor
+{
+public:
+	virtual ~IDemoExtractor() {}
+
+	virtual const char* GetName() const = 0;
+	virtual void DefineColumns(DemoStatTable& table) const = 0;
+
+	/// if no active extractor wants packets the demo stream is not decoded at all
+	virtual bool WantsPackets() const { return false; }
+	/// if no active extractor wants stats, the stats block is not loaded
+	virtual bool WantsStats() const { return false; }
+
+	/// called for every packet in the demo stream; frameNum is the current sim frame
+	virtual void ProcessPacket(const netcode::RawPacket* packet, int frameNum) {}
+	/// called once after the stream (and stats) have been read
+	virtual void Finish(const CDemoReader& reader, int numFrames, DemoStatTable& table) = 0;
+};
+
+
+namespace DemoExtractors {
+	/// names accepted by Create, in their canonical order
+	const std::vector<std::string>& GetNames();
+
+	/// @return nullptr for unknown names
+	std::unique_ptr<IDemoExtractor> Create(const std::string& name);
+}
+
+#endif // DEMO_EXTRACTORS_H
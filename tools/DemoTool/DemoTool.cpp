@@ -1,14 +1,20 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <string>
 #include <map>
 #include <iostream>
+#include <sstream>
 #include <gflags/gflags.h>
 #include <iomanip> //hex
 
 #include "StringSerializer.h"
+#include "DemoBatch.h"
+#include "DemoCompression.h"
 
 #include "Net/Protocol/BaseNetProtocol.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystemAbstraction.h"
 #include "System/LoadSave/DemoReader.h"
 #include "System/Net/RawPacket.h"
 #include "Sim/Units/CommandAI/Command.h"
@@ -22,6 +28,16 @@ Please note that not all NETMSG's are implemented, expand if needed.
 When compiling for windows with MinGW, make sure to use the
 -Wl,-subsystem,console flag when linking, as otherwise there will be
 no console output (you still could use this.exe > z.tzt though).
+
+Batch mode:
+  demotool --batchdir=/path/to/demos --outdir=. --extractors=commands,luamsg,teamstats --format=csv
+processes every demo below batchdir on all cores and writes one
+<extractor>.csv (or .sdcol, a columnar binary format) per extractor.
+
+Compression comparison:
+  demotool --compress --batchdir=/path/to/demos [--train_dictionary=dict.bin | --dictionary=dict.bin] [--pack=out.sdpk]
+compares the size and speed of the sdfz format against NETMSG_PACKED batches
+and the seekable container (on --demofile, or every demo below batchdir).
 */
 
 	DEFINE_string(demofile,     "",    "Path to demo file");
@@ -32,6 +48,16 @@ no console output (you still could use this.exe > z.tzt though).
 	DEFINE_bool  (teamstats,    false, "Print teamstats");
 	DEFINE_int32 (team,         -1,    "Select team");
 	DEFINE_string(teamsstatcsv, "",    "Write teamstats in a csv file");
+	DEFINE_string(batchdir,     "",    "Run the extractors over all demos in this directory (recursive)");
+	DEFINE_string(outdir,       ".",   "Output directory for batch mode");
+	DEFINE_string(extractors,   "commands,luamsg,teamstats", "Comma-separated list of batch mode extractors");
+	DEFINE_string(format,       "csv", "Batch mode output format (csv or sdcol)");
+	DEFINE_int32 (threads,      0,     "Batch mode worker threads (0 = one per core)");
+	DEFINE_bool  (compress,     false, "Compare stream compression modes on the given demos");
+	DEFINE_string(dictionary,   "",    "Compression mode: trained dictionary to compare against the built-in one");
+	DEFINE_string(train_dictionary, "", "Compression mode: train a dictionary on the demos and write it to this file");
+	DEFINE_string(pack,         "",    "Compression mode: write the first demo as seekable container to this file");
+	DEFINE_int32 (blocksize,    32768, "Compression mode: stream bytes per container block");
 
 
 void TrafficDump(CDemoReader& reader, bool trafficStats);
@@ -43,6 +69,46 @@ int main (int argc, char* argv[])
 
 	gflags::SetUsageMessage(std::string("Usage: ") + argv[0] + " [options] path_to_demo.sdfz");
 	gflags::ParseCommandLineFlags(&argc, &argv, true);
+	if (FLAGS_compress) {
+		DemoCompressionOptions options;
+		options.dictionaryFile = FLAGS_dictionary;
+		options.trainFile = FLAGS_train_dictionary;
+		options.packFile = FLAGS_pack;
+		options.blockSize = std::max(1, FLAGS_blocksize);
+
+		if (!FLAGS_batchdir.empty()) {
+			const std::string demoDir = FileSystemAbstraction::EnsurePathSepAtEnd(FLAGS_batchdir);
+
+			std::vector<std::string> demoNames;
+			FileSystemAbstraction::FindFiles(demoNames, demoDir, "", ".*\\.sdfz", FileQueryFlags::RECURSE);
+			std::sort(demoNames.begin(), demoNames.end());
+
+			for (const std::string& name: demoNames) {
+				options.demoPaths.push_back(demoDir + name);
+			}
+		} else if (!FLAGS_demofile.empty()) {
+			options.demoPaths.push_back(FLAGS_demofile);
+		} else if (argc >= 2) {
+			options.demoPaths.push_back(argv[1]);
+		}
+
+		return RunDemoCompression(options);
+	}
+	if (!FLAGS_batchdir.empty()) {
+		DemoBatchOptions options;
+		options.demoDir = FLAGS_batchdir;
+		options.outDir = FLAGS_outdir;
+		options.format = FLAGS_format;
+		options.numThreads = std::max(0, FLAGS_threads);
+
+		std::istringstream extractors(FLAGS_extractors);
+		for (std::string name; std::getline(extractors, name, ',');) {
+			if (!name.empty())
+				options.extractors.push_back(name);
+		}
+
+		return RunDemoBatch(options);
+	}
 	if (!FLAGS_demofile.empty()) {
 		filename = FLAGS_demofile;
 	} else if (argc >= 2) {
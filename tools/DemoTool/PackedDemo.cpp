@@ -0,0 +1,267 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "PackedDemo.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <zlib.h>
+
+#include "Net/Protocol/NetMessageTypes.h"
+#include "System/LoadSave/demofile.h"
+
+
+static constexpr char PACKED_DEMO_MAGIC[8] = {'S', 'D', 'P', 'A', 'C', 'K', '\0', '\1'};
+static constexpr size_t PACKED_DEMO_FOOTER_SIZE = sizeof(uint64_t) + sizeof(uint32_t) + sizeof(PACKED_DEMO_MAGIC);
+
+
+template<typename T>
+static void WriteValue(std::ofstream& out, T value) { out.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+static void WriteBytes(std::ofstream& out, const uint8_t* data, size_t size) { out.write(reinterpret_cast<const char*>(data), size); }
+
+template<typename T>
+static bool ReadValue(std::ifstream& in, T& value) { return (in.read(reinterpret_cast<char*>(&value), sizeof(T)).good()); }
+
+static bool ReadBytes(std::ifstream& in, std::vector<uint8_t>& data)
+{
+	uint32_t size = 0;
+
+	if (!ReadValue(in, size))
+		return false;
+
+	data.resize(size);
+	return (in.read(reinterpret_cast<char*>(data.data()), size).good());
+}
+
+
+
+bool DemoFileData::Load(const std::string& path, std::string& error)
+{
+	gzFile file = gzopen(path.c_str(), "rb");
+
+	if (file == nullptr) {
+		error = "could not open file";
+		return false;
+	}
+
+	std::vector<uint8_t> buffer;
+
+	for (int numRead = 0; ; ) {
+		buffer.resize(buffer.size() + (1 << 20));
+
+		if ((numRead = gzread(file, buffer.data() + buffer.size() - (1 << 20), 1 << 20)) < 0) {
+			gzclose(file);
+			error = "decompression failed";
+			return false;
+		}
+
+		buffer.resize(buffer.size() - (1 << 20) + numRead);
+
+		if (numRead == 0)
+			break;
+	}
+
+	gzclose(file);
+
+	DemoFileHeader header;
+
+	if (buffer.size() < sizeof(header)) {
+		error = "file too short";
+		return false;
+	}
+
+	memcpy(&header, buffer.data(), sizeof(header));
+	header.swab();
+
+	if (memcmp(header.magic, DEMOFILE_MAGIC, sizeof(DEMOFILE_MAGIC)) != 0 || header.version != DEMOFILE_VERSION) {
+		error = "not a demo of version " + std::to_string(DEMOFILE_VERSION);
+		return false;
+	}
+
+	const size_t streamBeg = size_t(header.headerSize) + header.scriptSize;
+	// a zero stream size means the recording engine crashed, the stream then runs to the end
+	const size_t streamEnd = (header.demoStreamSize != 0)? (streamBeg + header.demoStreamSize): buffer.size();
+
+	if (header.headerSize < int(sizeof(header)) || header.scriptSize < 0 || streamEnd < streamBeg || streamEnd > buffer.size()) {
+		error = "corrupt header";
+		return false;
+	}
+
+	preamble.assign(buffer.begin(), buffer.begin() + streamBeg);
+	stream.assign(buffer.begin() + streamBeg, buffer.begin() + streamEnd);
+	trailer.assign(buffer.begin() + streamEnd, buffer.end());
+	return true;
+}
+
+
+
+bool PackedDemo::PackStream(
+	const std::vector<uint8_t>& stream,
+	netcode::PacketCompressor& compressor,
+	unsigned int blockSize,
+	std::vector<uint8_t>& packed,
+	std::vector<Block>& blocks
+) {
+	const auto PackBlock = [&](size_t beg, size_t end) {
+		blocks.back().offset = packed.size();
+		blocks.back().rawSize = end - beg;
+
+		if (!compressor.Deflate(stream.data() + beg, end - beg, packed))
+			return false;
+
+		blocks.back().packedSize = packed.size() - blocks.back().offset;
+		return true;
+	};
+
+	size_t blockBeg = 0;
+	size_t pos = 0;
+
+	int frameNum = 0;
+
+	while ((pos + sizeof(DemoStreamChunkHeader)) <= stream.size()) {
+		DemoStreamChunkHeader chunkHeader;
+		memcpy(&chunkHeader, &stream[pos], sizeof(chunkHeader));
+		chunkHeader.swab();
+
+		const size_t msgPos = pos + sizeof(chunkHeader);
+		const size_t nextPos = msgPos + chunkHeader.length;
+
+		// the last chunk of a crashed recording can be cut off
+		if (nextPos > stream.size())
+			break;
+
+		const bool frameMsg = (chunkHeader.length > 0) && (stream[msgPos] == NETMSG_NEWFRAME || stream[msgPos] == NETMSG_KEYFRAME);
+
+		if (frameMsg && (pos - blockBeg) >= blockSize) {
+			if (!PackBlock(blockBeg, pos))
+				return false;
+
+			blockBeg = pos;
+		}
+
+		frameNum += frameMsg;
+
+		if (pos == blockBeg)
+			blocks.push_back({frameNum, chunkHeader.modGameTime, 0, 0, 0});
+
+		pos = nextPos;
+	}
+
+	return (pos == blockBeg || PackBlock(blockBeg, pos));
+}
+
+bool PackedDemo::Write(const std::string& path, const DemoFileData& demo, const std::vector<uint8_t>& dictionary, unsigned int blockSize)
+{
+	netcode::PacketCompressor compressor(dictionary, 0, Z_BEST_COMPRESSION);
+
+	std::vector<Block> blocks;
+	std::vector<uint8_t> packed;
+
+	if (!PackStream(demo.stream, compressor, blockSize, packed, blocks))
+		return false;
+
+	std::ofstream out(path.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+
+	if (!out.is_open())
+		return false;
+
+	out.write(PACKED_DEMO_MAGIC, sizeof(PACKED_DEMO_MAGIC));
+	WriteValue<uint32_t>(out, dictionary.size());
+	WriteBytes(out, dictionary.data(), dictionary.size());
+	WriteValue<uint32_t>(out, demo.preamble.size());
+	WriteBytes(out, demo.preamble.data(), demo.preamble.size());
+
+	const uint64_t blocksOffset = out.tellp();
+
+	WriteBytes(out, packed.data(), packed.size());
+	WriteValue<uint32_t>(out, demo.trailer.size());
+	WriteBytes(out, demo.trailer.data(), demo.trailer.size());
+
+	const uint64_t indexOffset = out.tellp();
+
+	for (const Block& block: blocks) {
+		WriteValue(out, block.frameNum);
+		WriteValue(out, block.modGameTime);
+		WriteValue(out, blocksOffset + block.offset);
+		WriteValue(out, block.packedSize);
+		WriteValue(out, block.rawSize);
+	}
+
+	WriteValue<uint64_t>(out, indexOffset);
+	WriteValue<uint32_t>(out, blocks.size());
+	out.write(PACKED_DEMO_MAGIC, sizeof(PACKED_DEMO_MAGIC));
+
+	return out.good();
+}
+
+
+
+bool PackedDemo::Reader::Open(const std::string& path)
+{
+	file.open(path.c_str(), std::ios::in | std::ios::binary);
+
+	if (!file.is_open())
+		return false;
+
+	char magic[sizeof(PACKED_DEMO_MAGIC)];
+
+	if (!file.read(magic, sizeof(magic)).good() || memcmp(magic, PACKED_DEMO_MAGIC, sizeof(magic)) != 0)
+		return false;
+	if (!ReadBytes(file, dictionary) || !ReadBytes(file, preamble))
+		return false;
+
+	uint64_t indexOffset = 0;
+	uint32_t numBlocks = 0;
+
+	if (!file.seekg(-std::streamoff(PACKED_DEMO_FOOTER_SIZE), std::ios::end).good())
+		return false;
+	if (!ReadValue(file, indexOffset) || !ReadValue(file, numBlocks))
+		return false;
+	if (!file.read(magic, sizeof(magic)).good() || memcmp(magic, PACKED_DEMO_MAGIC, sizeof(magic)) != 0)
+		return false;
+	if (!file.seekg(indexOffset).good())
+		return false;
+
+	blocks.resize(numBlocks);
+
+	for (Block& block: blocks) {
+		bool ok = true;
+
+		ok &= ReadValue(file, block.frameNum);
+		ok &= ReadValue(file, block.modGameTime);
+		ok &= ReadValue(file, block.offset);
+		ok &= ReadValue(file, block.packedSize);
+		ok &= ReadValue(file, block.rawSize);
+
+		if (!ok)
+			return false;
+	}
+
+	compressor.reset(new netcode::PacketCompressor(dictionary, 0));
+	return true;
+}
+
+size_t PackedDemo::Reader::FindBlock(int frameNum) const
+{
+	const auto pred = [](int frame, const Block& block) { return (frame < block.frameNum); };
+	const auto iter = std::upper_bound(blocks.begin(), blocks.end(), frameNum, pred);
+
+	return (std::max(iter - blocks.begin(), std::ptrdiff_t(1)) - 1);
+}
+
+bool PackedDemo::Reader::ReadBlock(size_t i, std::vector<uint8_t>& data)
+{
+	if (i >= blocks.size())
+		return false;
+
+	const Block& block = blocks[i];
+
+	packedData.resize(block.packedSize);
+
+	if (!file.seekg(block.offset).good())
+		return false;
+	if (!file.read(reinterpret_cast<char*>(packedData.data()), packedData.size()).good())
+		return false;
+
+	return (compressor->Inflate(packedData.data(), packedData.size(), block.rawSize, data));
+}
@@ -0,0 +1,105 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef PACKED_DEMO_H
+#define PACKED_DEMO_H
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "System/Net/PacketCompressor.h"
+
+/**
+ * @brief Uncompressed contents of a demo file, split into its parts
+ */
+struct DemoFileData {
+	/// DemoFileHeader and script
+	std::vector<uint8_t> preamble;
+	/// DemoStreamChunkHeader + message pairs
+	std::vector<uint8_t> stream;
+	/// player and team statistics
+	std::vector<uint8_t> trailer;
+
+	/**
+	 * @brief read and decompress a .sdfz
+	 * @return false (with a message in error) if the file is not a valid demo
+	 */
+	bool Load(const std::string& path, std::string& error);
+};
+
+
+/**
+ * @brief Seekable demo container
+ *
+ * The demo stream is cut into blocks at frame boundaries, every block is
+ * deflated on its own against a shared dictionary (see netcode::PacketCompressor)
+ * and an index maps frames to blocks, so playback can start at any frame by
+ * inflating a single block instead of the whole stream as with a .sdfz
+ * (all values little-endian):
+ *
+ *   char[8] magic "SDPACK\0\0\1"
+ *   uint32  dictionarySize, uint8[dictionarySize] dictionary
+ *   uint32  preambleSize, uint8[preambleSize] DemoFileHeader and script (stored)
+ *   blocks: uint8[packedSize] deflated stream data, chunk headers included
+ *   uint32  trailerSize, uint8[trailerSize] statistics (stored)
+ *   index:  numBlocks * {int32 frameNum, float modGameTime, uint64 offset, uint32 packedSize, uint32 rawSize}
+ *   uint64  indexOffset, uint32 numBlocks, char[8] magic
+ *
+ * frameNum and modGameTime are those of the first message in each block.
+ */
+namespace PackedDemo {
+	struct Block {
+		int32_t frameNum;
+		float modGameTime;
+		uint64_t offset;
+		uint32_t packedSize;
+		uint32_t rawSize;
+	};
+
+	/**
+	 * @brief cut a demo stream into blocks and deflate each of them
+	 * @param packed receives the deflated blocks back to back, block offsets are relative to it
+	 */
+	bool PackStream(
+		const std::vector<uint8_t>& stream,
+		netcode::PacketCompressor& compressor,
+		unsigned int blockSize,
+		std::vector<uint8_t>& packed,
+		std::vector<Block>& blocks
+	);
+
+	/**
+	 * @brief write a demo as container
+	 * @param blockSize blocks are cut at the first frame boundary after this many stream bytes
+	 */
+	bool Write(const std::string& path, const DemoFileData& demo, const std::vector<uint8_t>& dictionary, unsigned int blockSize);
+
+
+	class Reader {
+	public:
+		bool Open(const std::string& path);
+
+		const std::vector<Block>& GetBlocks() const { return blocks; }
+		const std::vector<uint8_t>& GetDictionary() const { return dictionary; }
+		const std::vector<uint8_t>& GetPreamble() const { return preamble; }
+
+		/// index of the block holding the messages of frameNum
+		size_t FindBlock(int frameNum) const;
+		/// append the uncompressed stream data of block i to data
+		bool ReadBlock(size_t i, std::vector<uint8_t>& data);
+
+	private:
+		std::ifstream file;
+
+		std::vector<Block> blocks;
+		std::vector<uint8_t> dictionary;
+		std::vector<uint8_t> preamble;
+		std::vector<uint8_t> packedData;
+
+		std::unique_ptr<netcode::PacketCompressor> compressor;
+	};
+}
+
+#endif // PACKED_DEMO_H